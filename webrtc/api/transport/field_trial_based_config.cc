@@ -8,10 +8,10 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 #include "api/transport/field_trial_based_config.h"
-#include "system_wrappers/include/field_trial.h"
+#include "rtc_base/experiments/field_trial_snapshot.h"
 
 namespace webrtc {
 std::string FieldTrialBasedConfig::Lookup(absl::string_view key) const {
-  return webrtc::field_trial::FindFullName(std::string(key));
+  return GetFieldTrialSnapshot()->FindFullName(key);
 }
 }  // namespace webrtc
@@ -71,6 +71,7 @@ bool RtpDemuxer::AddSink(const RtpDemuxerCriteria& criteria,
   }
 
   RefreshKnownMids();
+  cached_sink_by_ssrc_.clear();
 
   return true;
 }
@@ -148,11 +149,37 @@ bool RtpDemuxer::RemoveSink(const RtpPacketSinkInterface* sink) {
                        RemoveFromMapByValue(&sink_by_mid_and_rsid_, sink) +
                        RemoveFromMapByValue(&sink_by_rsid_, sink);
   RefreshKnownMids();
+  cached_sink_by_ssrc_.clear();
   return num_removed > 0;
 }
 
 bool RtpDemuxer::OnRtpPacket(const RtpPacketReceived& packet) {
-  RtpPacketSinkInterface* sink = ResolveSink(packet);
+  const uint32_t ssrc = packet.Ssrc();
+  const bool cacheable = !HasRoutingExtension(packet);
+  RtpPacketSinkInterface* sink = nullptr;
+  if (cacheable) {
+    const auto it = cached_sink_by_ssrc_.find(ssrc);
+    if (it != cached_sink_by_ssrc_.end()) {
+      sink = it->second;
+    }
+  }
+
+  if (sink == nullptr) {
+    // Packets carrying routing extensions may change the MID/RSID learned for
+    // the SSRC, so the cached route can't be trusted after them.
+    cached_sink_by_ssrc_.erase(ssrc);
+    sink = ResolveSink(packet);
+    // A resolved sink which the SSRC is now bound to will be chosen again for
+    // the next packet without routing extensions, regardless of its payload
+    // type, until sinks or learned MID/RSID change.
+    if (cacheable && sink != nullptr) {
+      const auto it = sink_by_ssrc_.find(ssrc);
+      if (it != sink_by_ssrc_.end() && it->second == sink) {
+        cached_sink_by_ssrc_.emplace(ssrc, sink);
+      }
+    }
+  }
+
   if (sink != nullptr) {
     sink->OnRtpPacket(packet);
     return true;
@@ -160,6 +187,12 @@ bool RtpDemuxer::OnRtpPacket(const RtpPacketReceived& packet) {
   return false;
 }
 
+bool RtpDemuxer::HasRoutingExtension(const RtpPacketReceived& packet) const {
+  return (use_mid_ && packet.HasExtension<RtpMid>()) ||
+         packet.HasExtension<RtpStreamId>() ||
+         packet.HasExtension<RepairedRtpStreamId>();
+}
+
 RtpPacketSinkInterface* RtpDemuxer::ResolveSink(
     const RtpPacketReceived& packet) {
   // See the BUNDLE spec for high level reference to this algorithm:
@@ -17,6 +17,9 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+
 namespace webrtc {
 
 class RtpPacketReceived;
@@ -81,6 +84,13 @@ struct RtpDemuxerCriteria {
 // In summary, the routing algorithm will always try to first match MID and RSID
 // (including through SSRC binding), match SSRC directly as needed, and use
 // payload types only if all else fails.
+//
+// Once a packet without MID, RSID or RRID header extensions has been routed to
+// the sink its SSRC is bound to, the result is cached per SSRC. Later packets
+// of that stream which don't carry any of these extensions are forwarded after
+// a single hash lookup, without re-running the algorithm above. The cache is
+// invalidated whenever sinks are added or removed, and per SSRC whenever a
+// packet updates the MID or RSID learned for it.
 class RtpDemuxer {
  public:
   // Maximum number of unique SSRC bindings allowed. This limit is to prevent
@@ -139,13 +149,20 @@ class RtpDemuxer {
 
   // Configure whether to look at the MID header extension when demuxing
   // incoming RTP packets. By default this is enabled.
-  void set_use_mid(bool use_mid) { use_mid_ = use_mid; }
+  void set_use_mid(bool use_mid) {
+    use_mid_ = use_mid;
+    cached_sink_by_ssrc_.clear();
+  }
 
  private:
   // Returns true if adding a sink with the given criteria would cause conflicts
   // with the existing criteria and should be rejected.
   bool CriteriaWouldConflict(const RtpDemuxerCriteria& criteria) const;
 
+  // Returns true if the packet carries a header extension that can change how
+  // its SSRC is routed, i.e. a MID (when MIDs are used), RSID or RRID.
+  bool HasRoutingExtension(const RtpPacketReceived& packet) const;
+
   // Runs the demux algorithm on the given packet and returns the sink that
   // should receive the packet.
   // Will record any SSRC<->ID associations along the way.
@@ -174,24 +191,29 @@ class RtpDemuxer {
   // Note: Mappings are only modified by AddSink/RemoveSink (except for
   // SSRC mapping which receives all MID, payload type, or RSID to SSRC bindings
   // discovered when demuxing packets).
-  std::map<std::string, RtpPacketSinkInterface*> sink_by_mid_;
-  std::map<uint32_t, RtpPacketSinkInterface*> sink_by_ssrc_;
+  absl::flat_hash_map<std::string, RtpPacketSinkInterface*> sink_by_mid_;
+  absl::flat_hash_map<uint32_t, RtpPacketSinkInterface*> sink_by_ssrc_;
   std::multimap<uint8_t, RtpPacketSinkInterface*> sinks_by_pt_;
-  std::map<std::pair<std::string, std::string>, RtpPacketSinkInterface*>
+  absl::flat_hash_map<std::pair<std::string, std::string>,
+                      RtpPacketSinkInterface*>
       sink_by_mid_and_rsid_;
-  std::map<std::string, RtpPacketSinkInterface*> sink_by_rsid_;
+  absl::flat_hash_map<std::string, RtpPacketSinkInterface*> sink_by_rsid_;
 
   // Tracks all the MIDs that have been identified in added criteria. Used to
   // determine if a packet should be dropped right away because the MID is
   // unknown.
-  std::set<std::string> known_mids_;
+  absl::flat_hash_set<std::string> known_mids_;
 
   // Records learned mappings of MID --> SSRC and RSID --> SSRC as packets are
   // received.
   // This is stored separately from the sink mappings because if a sink is
   // removed we want to still remember these associations.
-  std::map<uint32_t, std::string> mid_by_ssrc_;
-  std::map<uint32_t, std::string> rsid_by_ssrc_;
+  absl::flat_hash_map<uint32_t, std::string> mid_by_ssrc_;
+  absl::flat_hash_map<uint32_t, std::string> rsid_by_ssrc_;
+
+  // Sinks resolved for SSRCs whose packets carry no routing header extension.
+  // Only holds entries that agree with |sink_by_ssrc_|, see OnRtpPacket().
+  absl::flat_hash_map<uint32_t, RtpPacketSinkInterface*> cached_sink_by_ssrc_;
 
   // Adds a binding from the SSRC to the given sink. Returns true if there was
   // not already a sink bound to the SSRC or if the sink replaced a different
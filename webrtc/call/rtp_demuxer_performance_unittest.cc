@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "call/rtp_demuxer.h"
+#include "call/rtp_packet_sink_interface.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumPackets = 1000000;
+constexpr uint32_t kBaseSsrc = 0x10000;
+// Large prime stride, so that consecutive packets hit unrelated streams in the
+// same way interleaved traffic from many senders does.
+constexpr int kStreamStride = 7919;
+
+class CountingSink : public RtpPacketSinkInterface {
+ public:
+  void OnRtpPacket(const RtpPacketReceived& packet) override { ++num_packets_; }
+  int num_packets() const { return num_packets_; }
+
+ private:
+  int num_packets_ = 0;
+};
+
+// Demuxes |kNumPackets| packets spread over |num_ssrcs| streams and returns
+// the average time per packet in nanoseconds. If |bind_by_mid| is set, every
+// stream is signaled with a MID and the first packet of each stream carries
+// it; otherwise the sinks are added by SSRC.
+double MeasureDemuxTimePerPacketNs(int num_ssrcs, bool bind_by_mid) {
+  RtpHeaderExtensionMap extensions;
+  extensions.Register<RtpMid>(1);
+
+  std::vector<CountingSink> sinks(num_ssrcs);
+  std::vector<RtpPacketReceived> packets;
+  packets.reserve(num_ssrcs);
+  RtpDemuxer demuxer;
+  for (int i = 0; i < num_ssrcs; ++i) {
+    const uint32_t ssrc = kBaseSsrc + i;
+    RtpPacketReceived packet(&extensions);
+    packet.SetSsrc(ssrc);
+    RtpDemuxerCriteria criteria;
+    if (bind_by_mid) {
+      criteria.mid = std::to_string(i);
+      packet.SetExtension<RtpMid>(criteria.mid);
+    } else {
+      criteria.ssrcs.insert(ssrc);
+    }
+    EXPECT_TRUE(demuxer.AddSink(criteria, &sinks[i]));
+    // Latch the SSRC, then only send packets without MID.
+    EXPECT_TRUE(demuxer.OnRtpPacket(packet));
+    packets.emplace_back(&extensions);
+    packets.back().SetSsrc(ssrc);
+  }
+
+  const int64_t start_ns = rtc::TimeNanos();
+  int index = 0;
+  for (int i = 0; i < kNumPackets; ++i) {
+    demuxer.OnRtpPacket(packets[index]);
+    index = (index + kStreamStride) % num_ssrcs;
+  }
+  const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+
+  int delivered = 0;
+  for (CountingSink& sink : sinks) {
+    delivered += sink.num_packets();
+    demuxer.RemoveSink(&sink);
+  }
+  EXPECT_EQ(kNumPackets + num_ssrcs, delivered);
+  return static_cast<double>(elapsed_ns) / kNumPackets;
+}
+
+}  // namespace
+
+class RtpDemuxerPerformanceTest : public ::testing::TestWithParam<int> {};
+
+INSTANTIATE_TEST_SUITE_P(SsrcCount,
+                         RtpDemuxerPerformanceTest,
+                         ::testing::Values(1, 10, 100, 1000, 10000));
+
+TEST_P(RtpDemuxerPerformanceTest, DemuxBySsrc) {
+  const int num_ssrcs = GetParam();
+  rtc::StringBuilder trace;
+  trace << num_ssrcs << "_ssrcs";
+  test::PrintResult("rtp_demux_by_ssrc", "", trace.str(),
+                    MeasureDemuxTimePerPacketNs(num_ssrcs,
+                                                /*bind_by_mid=*/false),
+                    "ns_per_packet", true);
+}
+
+TEST_P(RtpDemuxerPerformanceTest, DemuxByLatchedMid) {
+  const int num_ssrcs = GetParam();
+  // Packets can't latch more SSRCs than the demuxer allows bindings for.
+  if (num_ssrcs > RtpDemuxer::kMaxSsrcBindings)
+    return;
+  rtc::StringBuilder trace;
+  trace << num_ssrcs << "_ssrcs";
+  test::PrintResult("rtp_demux_by_latched_mid", "", trace.str(),
+                    MeasureDemuxTimePerPacketNs(num_ssrcs,
+                                                /*bind_by_mid=*/true),
+                    "ns_per_packet", true);
+}
+
+}  // namespace webrtc
@@ -1202,6 +1202,51 @@ TEST_F(RtpDemuxerTest, SignaledMidShouldOverwriteSignalledSsrcPersistent) {
   EXPECT_TRUE(demuxer_.OnRtpPacket(*packet_without_mid));
 }
 
+// Packets without MID are served from the per-SSRC route cache once the SSRC
+// has been resolved. A later packet with MID must still rebind the SSRC.
+TEST_F(RtpDemuxerTest, CachedSsrcRouteUpdatedByLaterMidPacket) {
+  constexpr uint32_t ssrc = 11;
+  const std::string mid = "mid";
+
+  MockRtpPacketSink ssrc_sink;
+  AddSinkOnlySsrc(ssrc, &ssrc_sink);
+
+  MockRtpPacketSink mid_sink;
+  AddSinkOnlyMid(mid, &mid_sink);
+
+  auto first_packet = CreatePacketWithSsrc(ssrc);
+  auto second_packet = CreatePacketWithSsrc(ssrc);
+  auto packet_with_mid = CreatePacketWithSsrcMid(ssrc, mid);
+  auto packet_without_mid = CreatePacketWithSsrc(ssrc);
+
+  InSequence sequence;
+  EXPECT_CALL(ssrc_sink, OnRtpPacket(SamePacketAs(*first_packet))).Times(1);
+  EXPECT_CALL(ssrc_sink, OnRtpPacket(SamePacketAs(*second_packet))).Times(1);
+  EXPECT_CALL(mid_sink, OnRtpPacket(SamePacketAs(*packet_with_mid))).Times(1);
+  EXPECT_CALL(mid_sink, OnRtpPacket(SamePacketAs(*packet_without_mid)))
+      .Times(1);
+
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*first_packet));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*second_packet));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet_with_mid));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet_without_mid));
+}
+
+TEST_F(RtpDemuxerTest, CachedSsrcRouteDroppedWhenSinkRemoved) {
+  constexpr uint32_t ssrc = 11;
+
+  MockRtpPacketSink sink;
+  AddSinkOnlySsrc(ssrc, &sink);
+
+  auto packet = CreatePacketWithSsrc(ssrc);
+  EXPECT_CALL(sink, OnRtpPacket(_)).Times(2);
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet));
+
+  ASSERT_TRUE(RemoveSink(&sink));
+  EXPECT_FALSE(demuxer_.OnRtpPacket(*packet));
+}
+
 TEST_F(RtpDemuxerTest, RouteByPayloadTypeMultipleMatch) {
   constexpr uint32_t ssrc = 10;
   constexpr uint8_t pt1 = 30;
@@ -49,7 +49,9 @@ size_t RemoveFromMapByValue(Map* map, const Value& value) {
   size_t count = 0;
   for (auto it = map->begin(); it != map->end();) {
     if (it->second == value) {
-      it = map->erase(it);
+      // Post-increment rather than using the return value of erase(), which
+      // hash maps such as absl::flat_hash_map don't provide.
+      map->erase(it++);
       ++count;
     } else {
       ++it;
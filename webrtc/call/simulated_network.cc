@@ -148,8 +148,6 @@ absl::optional<int64_t> SimulatedNetwork::NextDeliveryTimeUs() const {
 
 void SimulatedNetwork::UpdateCapacityQueue(ConfigState state,
                                            int64_t time_now_us) {
-  bool needs_sort = false;
-
   // Catch for thread races.
   if (time_now_us < last_capacity_link_visit_us_.value_or(time_now_us))
     return;
@@ -199,7 +197,7 @@ void SimulatedNetwork::UpdateCapacityQueue(ConfigState state,
         capacity_link_.pop();
         queue_size_bytes_ -= dropped.packet.size;
         dropped.arrival_time_us = PacketDeliveryInfo::kNotReceived;
-        delay_link_.emplace_back(dropped);
+        AddToDelayLink(dropped, time_us);
       }
     }
     RTC_DCHECK(time_us >= packet.packet.send_time_us);
@@ -215,6 +213,7 @@ void SimulatedNetwork::UpdateCapacityQueue(ConfigState state,
         (!bursting_ && random_.Rand<double>() < state.prob_start_bursting)) {
       bursting_ = true;
       packet.arrival_time_us = PacketDeliveryInfo::kNotReceived;
+      AddToDelayLink(packet, time_us);
     } else {
       bursting_ = false;
       int64_t arrival_time_jitter_us = std::max(
@@ -224,33 +223,25 @@ void SimulatedNetwork::UpdateCapacityQueue(ConfigState state,
 
       // If reordering is not allowed then adjust arrival_time_jitter
       // to make sure all packets are sent in order.
-      int64_t last_arrival_time_us =
-          delay_link_.empty() ? -1 : delay_link_.back().arrival_time_us;
       if (!state.config.allow_reordering && !delay_link_.empty() &&
           packet.arrival_time_us + arrival_time_jitter_us <
-              last_arrival_time_us) {
-        arrival_time_jitter_us = last_arrival_time_us - packet.arrival_time_us;
+              last_arrival_time_us_) {
+        arrival_time_jitter_us = last_arrival_time_us_ - packet.arrival_time_us;
       }
       packet.arrival_time_us += arrival_time_jitter_us;
-      if (packet.arrival_time_us >= last_arrival_time_us) {
-        last_arrival_time_us = packet.arrival_time_us;
-      } else {
-        needs_sort = true;
-      }
+      last_arrival_time_us_ = packet.arrival_time_us;
+      AddToDelayLink(packet, packet.arrival_time_us);
     }
-    delay_link_.emplace_back(packet);
   }
   last_capacity_link_visit_us_ = time_now_us;
   // Cannot save unused capacity for later.
   pending_drain_bits_ = std::min(pending_drain_bits_, queue_size_bytes_ * 8);
+}
 
-  if (needs_sort) {
-    // Packet(s) arrived out of order, make sure list is sorted.
-    std::sort(delay_link_.begin(), delay_link_.end(),
-              [](const PacketInfo& p1, const PacketInfo& p2) {
-                return p1.arrival_time_us < p2.arrival_time_us;
-              });
-  }
+void SimulatedNetwork::AddToDelayLink(const PacketInfo& packet,
+                                      int64_t delivery_time_us) {
+  delay_link_.push_back({delivery_time_us, next_sequence_number_++, packet});
+  std::push_heap(delay_link_.begin(), delay_link_.end(), DeliversLater());
 }
 
 SimulatedNetwork::ConfigState SimulatedNetwork::GetConfigState() const {
@@ -265,15 +256,16 @@ std::vector<PacketDeliveryInfo> SimulatedNetwork::DequeueDeliverablePackets(
   std::vector<PacketDeliveryInfo> packets_to_deliver;
   // Check the extra delay queue.
   while (!delay_link_.empty() &&
-         receive_time_us >= delay_link_.front().arrival_time_us) {
-    PacketInfo packet_info = delay_link_.front();
+         receive_time_us >= delay_link_.front().delivery_time_us) {
+    std::pop_heap(delay_link_.begin(), delay_link_.end(), DeliversLater());
+    const PacketInfo& packet_info = delay_link_.back().info;
     packets_to_deliver.emplace_back(
         PacketDeliveryInfo(packet_info.packet, packet_info.arrival_time_us));
-    delay_link_.pop_front();
+    delay_link_.pop_back();
   }
 
   if (!delay_link_.empty()) {
-    next_process_time_us_ = delay_link_.front().arrival_time_us;
+    next_process_time_us_ = delay_link_.front().delivery_time_us;
   } else if (!capacity_link_.empty()) {
     next_process_time_us_ = receive_time_us + kDefaultProcessDelay.us();
   } else {
@@ -11,7 +11,6 @@
 #define CALL_SIMULATED_NETWORK_H_
 
 #include <stdint.h>
-#include <deque>
 #include <queue>
 #include <vector>
 
@@ -75,6 +74,21 @@ class SimulatedNetwork : public NetworkBehaviorInterface {
     PacketInFlightInfo packet;
     int64_t arrival_time_us;
   };
+  // Entry of the delay link. Lost packets have no arrival time, they are
+  // reported at the time they leave the capacity link.
+  struct DelayedPacket {
+    int64_t delivery_time_us;
+    // Orders packets with the same delivery time by insertion.
+    uint64_t sequence_number;
+    PacketInfo info;
+  };
+  struct DeliversLater {
+    bool operator()(const DelayedPacket& a, const DelayedPacket& b) const {
+      if (a.delivery_time_us != b.delivery_time_us)
+        return a.delivery_time_us > b.delivery_time_us;
+      return a.sequence_number > b.sequence_number;
+    }
+  };
   // Contains current configuration state.
   struct ConfigState {
     // Static link configuration.
@@ -92,6 +106,8 @@ class SimulatedNetwork : public NetworkBehaviorInterface {
   void UpdateCapacityQueue(ConfigState state, int64_t time_now_us)
       RTC_RUN_ON(&process_checker_);
   ConfigState GetConfigState() const;
+  void AddToDelayLink(const PacketInfo& packet, int64_t delivery_time_us)
+      RTC_RUN_ON(&process_checker_);
 
   rtc::CriticalSection config_lock_;
 
@@ -102,7 +118,14 @@ class SimulatedNetwork : public NetworkBehaviorInterface {
   std::queue<PacketInfo> capacity_link_ RTC_GUARDED_BY(process_checker_);
   Random random_;
 
-  std::deque<PacketInfo> delay_link_ RTC_GUARDED_BY(process_checker_);
+  // Min-heap on delivery time. Keeping the heap in a vector reuses the
+  // storage of delivered packets and avoids re-sorting the whole link when
+  // reordering is allowed.
+  std::vector<DelayedPacket> delay_link_ RTC_GUARDED_BY(process_checker_);
+  uint64_t next_sequence_number_ RTC_GUARDED_BY(process_checker_) = 0;
+  // Arrival time of the last packet added to the delay link that was not
+  // lost. Used to prevent reordering while the delay link is non-empty.
+  int64_t last_arrival_time_us_ RTC_GUARDED_BY(process_checker_) = -1;
 
   ConfigState config_state_ RTC_GUARDED_BY(config_lock_);
 
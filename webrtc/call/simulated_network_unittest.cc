@@ -144,4 +144,74 @@ TEST(SimulatedNetworkTest, CodelLimitsDelayAndDropsPacketsOnOverload) {
   }
   EXPECT_EQ(send_times_us.size(), 0u);
 }
+
+TEST(SimulatedNetworkTest, DeliversReorderedPacketsByArrivalTime) {
+  SimulatedNetwork::Config config;
+  config.queue_delay_ms = 50;
+  config.delay_standard_deviation_ms = 20;
+  config.allow_reordering = true;
+  config.loss_percent = 10;
+  SimulatedNetwork network(config);
+
+  const int kNumPackets = 1000;
+  const int64_t kSendIntervalUs = 1000;
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_TRUE(network.EnqueuePacket(
+        PacketInFlightInfo(/*size=*/1000, i * kSendIntervalUs, /*id=*/i)));
+  }
+
+  std::set<uint64_t> delivered;
+  int64_t last_receive_time_us = -1;
+  int64_t max_received_id = -1;
+  bool reordered = false;
+  int lost = 0;
+  while (network.NextDeliveryTimeUs()) {
+    for (PacketDeliveryInfo packet :
+         network.DequeueDeliverablePackets(*network.NextDeliveryTimeUs())) {
+      EXPECT_TRUE(delivered.insert(packet.packet_id).second);
+      if (packet.receive_time_us == kNotReceived) {
+        ++lost;
+        continue;
+      }
+      EXPECT_GE(packet.receive_time_us, last_receive_time_us);
+      last_receive_time_us = packet.receive_time_us;
+      const int64_t id = static_cast<int64_t>(packet.packet_id);
+      reordered |= id < max_received_id;
+      max_received_id = std::max(max_received_id, id);
+    }
+  }
+  EXPECT_EQ(delivered.size(), static_cast<size_t>(kNumPackets));
+  EXPECT_GT(lost, 0);
+  EXPECT_TRUE(reordered);
+}
+
+TEST(SimulatedNetworkTest, KeepsOrderWhenReorderingIsNotAllowed) {
+  SimulatedNetwork::Config config;
+  config.queue_delay_ms = 50;
+  config.delay_standard_deviation_ms = 20;
+  config.allow_reordering = false;
+  config.loss_percent = 10;
+  SimulatedNetwork network(config);
+
+  const int kNumPackets = 1000;
+  const int64_t kSendIntervalUs = 1000;
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_TRUE(network.EnqueuePacket(
+        PacketInFlightInfo(/*size=*/1000, i * kSendIntervalUs, /*id=*/i)));
+  }
+
+  std::set<uint64_t> delivered;
+  int64_t last_received_id = -1;
+  while (network.NextDeliveryTimeUs()) {
+    for (PacketDeliveryInfo packet :
+         network.DequeueDeliverablePackets(*network.NextDeliveryTimeUs())) {
+      delivered.insert(packet.packet_id);
+      if (packet.receive_time_us == kNotReceived)
+        continue;
+      EXPECT_GT(static_cast<int64_t>(packet.packet_id), last_received_id);
+      last_received_id = packet.packet_id;
+    }
+  }
+  EXPECT_EQ(delivered.size(), static_cast<size_t>(kNumPackets));
+}
 }  // namespace webrtc
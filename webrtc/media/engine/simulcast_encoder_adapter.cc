@@ -17,6 +17,7 @@
 #include <string>
 #include <utility>
 
+#include "absl/memory/memory.h"
 #include "api/scoped_refptr.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/video_codec_constants.h"
@@ -27,6 +28,7 @@
 #include "modules/video_coding/utility/simulcast_rate_allocator.h"
 #include "rtc_base/atomic_ops.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/event.h"
 #include "rtc_base/experiments/rate_control_settings.h"
 #include "system_wrappers/include/field_trial.h"
 #include "third_party/libyuv/include/libyuv/scale.h"
@@ -37,6 +39,9 @@ const unsigned int kDefaultMinQp = 2;
 const unsigned int kDefaultMaxQp = 56;
 // Max qp for lowest spatial resolution when doing simulcast.
 const unsigned int kLowestResMaxQp = 45;
+// Scaled buffers kept per stream in parallel encode mode. Encoders that hold
+// on to more input frames than this get freshly allocated buffers.
+const size_t kMaxScaledBuffersPerStream = 4;
 
 absl::optional<unsigned int> GetScreenshareBoostedQpValue() {
   std::string experiment_group =
@@ -127,7 +132,11 @@ SimulcastEncoderAdapter::SimulcastEncoderAdapter(VideoEncoderFactory* factory,
       encoded_complete_callback_(nullptr),
       experimental_boosted_screenshare_qp_(GetScreenshareBoostedQpValue()),
       boost_base_layer_quality_(RateControlSettings::ParseFromFieldTrials()
-                                    .Vp8BoostBaseLayerQuality()) {
+                                    .Vp8BoostBaseLayerQuality()),
+      parallel_encode_enabled_(webrtc::field_trial::IsEnabled(
+          "WebRTC-SimulcastEncoderAdapter-ParallelEncode")),
+      use_parallel_encode_(false),
+      drop_next_frame_(false) {
   RTC_DCHECK(factory_);
   encoder_info_.implementation_name = "SimulcastEncoderAdapter";
 
@@ -158,6 +167,10 @@ int SimulcastEncoderAdapter::Release() {
     stored_encoders_.push(std::move(encoder));
   }
 
+  use_parallel_encode_ = false;
+  drop_next_frame_ = false;
+  scaling_order_.clear();
+
   // It's legal to move the encoder to another queue now.
   encoder_queue_.Detach();
 
@@ -328,6 +341,30 @@ int SimulcastEncoderAdapter::InitEncode(const VideoCodec* inst,
     encoder_info_.implementation_name += ")";
   }
 
+  if (parallel_encode_enabled_ && doing_simulcast) {
+    use_parallel_encode_ = true;
+    for (const StreamInfo& stream_info : streaminfos_) {
+      const EncoderInfo info = stream_info.encoder->GetEncoderInfo();
+      if (info.is_hardware_accelerated || info.has_internal_source)
+        use_parallel_encode_ = false;
+    }
+  }
+  if (use_parallel_encode_) {
+    for (size_t i = 0; i < streaminfos_.size(); ++i)
+      scaling_order_.push_back(i);
+    std::stable_sort(scaling_order_.begin(), scaling_order_.end(),
+                     [this](size_t a, size_t b) {
+                       return streaminfos_[a].width * streaminfos_[a].height >
+                              streaminfos_[b].width * streaminfos_[b].height;
+                     });
+    // The largest stream is the most expensive one to encode; run it on the
+    // calling thread instead of idling there while the others finish.
+    for (size_t i = 1; i < scaling_order_.size(); ++i) {
+      streaminfos_[scaling_order_[i]].encode_queue =
+          absl::make_unique<rtc::TaskQueue>("SimulcastEncode");
+    }
+  }
+
   // To save memory, don't store encoders that we don't use.
   DestroyStoredEncoders();
 
@@ -367,6 +404,10 @@ int SimulcastEncoderAdapter::Encode(
     }
   }
 
+  if (use_parallel_encode_) {
+    return EncodeInParallel(input_image, send_key_frame);
+  }
+
   int src_width = input_image.width();
   int src_height = input_image.height();
   for (size_t stream_idx = 0; stream_idx < streaminfos_.size(); ++stream_idx) {
@@ -436,6 +477,144 @@ int SimulcastEncoderAdapter::Encode(
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
+int SimulcastEncoderAdapter::EncodeInParallel(const VideoFrame& input_image,
+                                              bool send_key_frame) {
+  const int src_width = input_image.width();
+  const int src_height = input_image.height();
+  const bool is_native = input_image.video_frame_buffer()->type() ==
+                         VideoFrameBuffer::Type::kNative;
+
+  // The encoders never saw the drop request for the previous frame, so drop
+  // this one for all of them. Key frames are encoded anyway, since the key
+  // frame request would otherwise be lost.
+  if (drop_next_frame_) {
+    drop_next_frame_ = false;
+    if (!send_key_frame) {
+      encoded_complete_callback_->OnDroppedFrame(
+          EncodedImageCallback::DropReason::kDroppedByEncoder);
+      return WEBRTC_VIDEO_CODEC_OK;
+    }
+  }
+
+  // Scale in a cascade, from the largest stream down, each stream from the
+  // smallest stream scaled so far. Only the first scale reads the full frame.
+  absl::optional<VideoFrame> stream_frames[kMaxSimulcastStreams];
+  rtc::scoped_refptr<I420BufferInterface> cascade_source;
+  for (size_t stream_idx : scaling_order_) {
+    StreamInfo& stream_info = streaminfos_[stream_idx];
+    // Don't encode frames in resolutions that we don't intend to send.
+    if (!stream_info.send_stream) {
+      continue;
+    }
+    if ((stream_info.width == src_width && stream_info.height == src_height) ||
+        is_native) {
+      stream_frames[stream_idx] = input_image;
+      continue;
+    }
+    if (!cascade_source) {
+      cascade_source = input_image.video_frame_buffer()->ToI420();
+    }
+    rtc::scoped_refptr<I420Buffer> dst_buffer =
+        AcquireScaledBuffer(&stream_info);
+    libyuv::I420Scale(
+        cascade_source->DataY(), cascade_source->StrideY(),
+        cascade_source->DataU(), cascade_source->StrideU(),
+        cascade_source->DataV(), cascade_source->StrideV(),
+        cascade_source->width(), cascade_source->height(),
+        dst_buffer->MutableDataY(), dst_buffer->StrideY(),
+        dst_buffer->MutableDataU(), dst_buffer->StrideU(),
+        dst_buffer->MutableDataV(), dst_buffer->StrideV(), dst_buffer->width(),
+        dst_buffer->height(), libyuv::kFilterBilinear);
+    cascade_source = dst_buffer;
+    // UpdateRect is not propagated to lower simulcast layers currently.
+    stream_frames[stream_idx] =
+        VideoFrame::Builder()
+            .set_video_frame_buffer(dst_buffer)
+            .set_timestamp_rtp(input_image.timestamp())
+            .set_rotation(webrtc::kVideoRotation_0)
+            .set_timestamp_ms(input_image.render_time_ms())
+            .build();
+  }
+
+  const std::vector<VideoFrameType> stream_frame_types(
+      1, send_key_frame ? VideoFrameType::kVideoFrameKey
+                        : VideoFrameType::kVideoFrameDelta);
+  int results[kMaxSimulcastStreams];
+  rtc::Event done[kMaxSimulcastStreams];
+  absl::optional<size_t> local_stream_idx;
+  for (size_t stream_idx = 0; stream_idx < streaminfos_.size(); ++stream_idx) {
+    if (!stream_frames[stream_idx]) {
+      continue;
+    }
+    StreamInfo& stream_info = streaminfos_[stream_idx];
+    if (send_key_frame) {
+      stream_info.key_frame_request = false;
+    }
+    stream_info.collect_encoded_images = true;
+    if (!stream_info.encode_queue) {
+      local_stream_idx = stream_idx;
+      continue;
+    }
+    stream_info.encode_queue->PostTask(
+        [&stream_info, &stream_frames, &stream_frame_types, &results, &done,
+         stream_idx] {
+          results[stream_idx] = stream_info.encoder->Encode(
+              *stream_frames[stream_idx], &stream_frame_types);
+          done[stream_idx].Set();
+        });
+  }
+  if (local_stream_idx) {
+    results[*local_stream_idx] =
+        streaminfos_[*local_stream_idx].encoder->Encode(
+            *stream_frames[*local_stream_idx], &stream_frame_types);
+  }
+
+  // Deliver in stream order, regardless of which encoder finished first.
+  int ret = WEBRTC_VIDEO_CODEC_OK;
+  for (size_t stream_idx = 0; stream_idx < streaminfos_.size(); ++stream_idx) {
+    if (!stream_frames[stream_idx]) {
+      continue;
+    }
+    StreamInfo& stream_info = streaminfos_[stream_idx];
+    if (stream_info.encode_queue) {
+      done[stream_idx].Wait(rtc::Event::kForever);
+    }
+    stream_info.collect_encoded_images = false;
+    if (results[stream_idx] != WEBRTC_VIDEO_CODEC_OK &&
+        ret == WEBRTC_VIDEO_CODEC_OK) {
+      ret = results[stream_idx];
+    }
+    for (const PendingEncodedImage& pending : stream_info.pending_images) {
+      EncodedImageCallback::Result result =
+          encoded_complete_callback_->OnEncodedImage(
+              pending.image, &pending.codec_specific_info,
+              pending.fragmentation.get());
+      if (result.drop_next_frame) {
+        drop_next_frame_ = true;
+      }
+    }
+    stream_info.pending_images.clear();
+  }
+  return ret;
+}
+
+// static
+rtc::scoped_refptr<I420Buffer> SimulcastEncoderAdapter::AcquireScaledBuffer(
+    StreamInfo* stream_info) {
+  for (const rtc::scoped_refptr<PooledI420Buffer>& buffer :
+       stream_info->scaled_buffers) {
+    if (buffer->HasOneRef()) {
+      return buffer;
+    }
+  }
+  rtc::scoped_refptr<PooledI420Buffer> buffer(
+      new PooledI420Buffer(stream_info->width, stream_info->height));
+  if (stream_info->scaled_buffers.size() < kMaxScaledBuffersPerStream) {
+    stream_info->scaled_buffers.push_back(buffer);
+  }
+  return buffer;
+}
+
 int SimulcastEncoderAdapter::RegisterEncodeCompleteCallback(
     EncodedImageCallback* callback) {
   RTC_DCHECK_CALLED_SEQUENTIALLY(&encoder_queue_);
@@ -512,6 +691,24 @@ EncodedImageCallback::Result SimulcastEncoderAdapter::OnEncodedImage(
 
   stream_image.SetSpatialIndex(stream_idx);
 
+  StreamInfo& stream_info = streaminfos_[stream_idx];
+  if (stream_info.collect_encoded_images) {
+    // Parallel encode: EncodeInParallel() delivers this once all streams are
+    // done, and handles the downstream result for the encoder. The encoder
+    // may reuse its output buffer after this call returns.
+    PendingEncodedImage pending;
+    pending.image = std::move(stream_image);
+    pending.image.Retain();
+    pending.codec_specific_info = stream_codec_specific;
+    if (fragmentation) {
+      pending.fragmentation = absl::make_unique<RTPFragmentationHeader>();
+      pending.fragmentation->CopyFrom(*fragmentation);
+    }
+    stream_info.pending_images.push_back(std::move(pending));
+    return EncodedImageCallback::Result(EncodedImageCallback::Result::OK,
+                                        encodedImage.Timestamp());
+  }
+
   return encoded_complete_callback_->OnEncodedImage(
       stream_image, &stream_codec_specific, fragmentation);
 }
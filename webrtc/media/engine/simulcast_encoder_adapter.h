@@ -19,10 +19,14 @@
 #include <vector>
 
 #include "absl/types/optional.h"
+#include "api/video/encoded_image.h"
+#include "api/video/i420_buffer.h"
 #include "api/video_codecs/sdp_video_format.h"
 #include "modules/video_coding/include/video_codec_interface.h"
 #include "rtc_base/atomic_ops.h"
+#include "rtc_base/ref_counted_object.h"
 #include "rtc_base/sequenced_task_checker.h"
+#include "rtc_base/task_queue.h"
 #include "rtc_base/system/rtc_export.h"
 
 namespace webrtc {
@@ -34,6 +38,14 @@ class VideoEncoderFactory;
 // webrtc::VideoEncoder instances with the given VideoEncoderFactory.
 // The object is created and destroyed on the worker thread, but all public
 // interfaces should be called from the encoder task queue.
+//
+// With the "WebRTC-SimulcastEncoderAdapter-ParallelEncode" field trial enabled,
+// lower layers are downscaled in a cascade, each from the next larger layer,
+// into reused buffers, and the layers are encoded concurrently on one task
+// queue per layer. Encoded images are held back until all layers of a frame
+// are done and then delivered in stream order. The mode is only used for
+// software encoders without internal source, since those deliver their output
+// from within Encode().
 class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
  public:
   explicit SimulcastEncoderAdapter(VideoEncoderFactory* factory,
@@ -63,6 +75,15 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
   EncoderInfo GetEncoderInfo() const override;
 
  private:
+  using PooledI420Buffer = rtc::RefCountedObject<I420Buffer>;
+
+  // An encoded image held back in parallel encode mode.
+  struct PendingEncodedImage {
+    EncodedImage image;
+    CodecSpecificInfo codec_specific_info;
+    std::unique_ptr<RTPFragmentationHeader> fragmentation;
+  };
+
   struct StreamInfo {
     StreamInfo(std::unique_ptr<VideoEncoder> encoder,
                std::unique_ptr<EncodedImageCallback> callback,
@@ -81,6 +102,17 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
     uint16_t height;
     bool key_frame_request;
     bool send_stream;
+    // The members below are only used in parallel encode mode.
+    // Runs Encode() for this stream; null for the stream encoded on the
+    // calling thread.
+    std::unique_ptr<rtc::TaskQueue> encode_queue;
+    // Reused destination buffers for downscaling to this stream.
+    std::vector<rtc::scoped_refptr<PooledI420Buffer>> scaled_buffers;
+    // Set while Encode() for this stream is running in parallel mode. Written
+    // on the encoder queue before the encode task is posted, and read by the
+    // encode callback on the thread running that task.
+    bool collect_encoded_images = false;
+    std::vector<PendingEncodedImage> pending_images;
   };
 
   enum class StreamResolution {
@@ -98,6 +130,12 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
 
   bool Initialized() const;
 
+  int EncodeInParallel(const VideoFrame& input_image, bool send_key_frame);
+  // Returns a buffer of the stream's resolution that isn't referenced by any
+  // frame still in flight.
+  static rtc::scoped_refptr<I420Buffer> AcquireScaledBuffer(
+      StreamInfo* stream_info);
+
   void DestroyStoredEncoders();
 
   volatile int inited_;  // Accessed atomically.
@@ -117,6 +155,15 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
 
   const absl::optional<unsigned int> experimental_boosted_screenshare_qp_;
   const bool boost_base_layer_quality_;
+  const bool parallel_encode_enabled_;
+  // True if |parallel_encode_enabled_| and the current configuration allows
+  // it.
+  bool use_parallel_encode_;
+  // Stream indices ordered by decreasing resolution, for cascaded scaling.
+  std::vector<size_t> scaling_order_;
+  // Set in parallel encode mode when a delivered image asked for the next
+  // frame to be dropped; the next frame is then dropped on all streams.
+  bool drop_next_frame_;
 };
 
 }  // namespace webrtc
@@ -0,0 +1,144 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/video/video_frame.h"
+#include "api/video_codecs/sdp_video_format.h"
+#include "api/video_codecs/video_encoder.h"
+#include "media/engine/internal_encoder_factory.h"
+#include "media/engine/simulcast_encoder_adapter.h"
+#include "modules/video_coding/include/video_codec_interface.h"
+#include "modules/video_coding/utility/simulcast_rate_allocator.h"
+#include "rtc_base/time_utils.h"
+#include "test/field_trial.h"
+#include "test/frame_generator.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumFrames = 150;
+constexpr int kFramerate = 30;
+constexpr int kWidth = 1920;
+constexpr int kHeight = 1080;
+constexpr uint32_t kTotalBitrateKbps = 8000;
+
+class DroppingEncodedImageCallback : public EncodedImageCallback {
+ public:
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info,
+                        const RTPFragmentationHeader* fragmentation) override {
+    ++num_encoded_images_;
+    return Result(Result::OK, encoded_image.Timestamp());
+  }
+
+  int num_encoded_images() const { return num_encoded_images_; }
+
+ private:
+  int num_encoded_images_ = 0;
+};
+
+void ConfigureStream(int width,
+                     int height,
+                     int max_bitrate_kbps,
+                     SimulcastStream* stream) {
+  stream->width = width;
+  stream->height = height;
+  stream->maxBitrate = max_bitrate_kbps;
+  stream->minBitrate = max_bitrate_kbps / 10;
+  stream->targetBitrate = max_bitrate_kbps * 3 / 4;
+  stream->numberOfTemporalLayers = 1;
+  stream->qpMax = 45;
+  stream->active = true;
+}
+
+VideoCodec CreateCodecSettings() {
+  VideoCodec codec;
+  codec.codecType = kVideoCodecVP8;
+  codec.plType = 120;
+  codec.startBitrate = kTotalBitrateKbps;
+  codec.minBitrate = 30;
+  codec.maxBitrate = 0;
+  codec.maxFramerate = kFramerate;
+  codec.width = kWidth;
+  codec.height = kHeight;
+  codec.numberOfSimulcastStreams = 3;
+  codec.active = true;
+  ConfigureStream(kWidth / 4, kHeight / 4, 700, &codec.simulcastStream[0]);
+  ConfigureStream(kWidth / 2, kHeight / 2, 2000, &codec.simulcastStream[1]);
+  ConfigureStream(kWidth, kHeight, 5000, &codec.simulcastStream[2]);
+  codec.VP8()->denoisingOn = true;
+  codec.VP8()->automaticResizeOn = false;
+  codec.VP8()->frameDroppingOn = false;
+  codec.VP8()->keyFrameInterval = 3000;
+  return codec;
+}
+
+// Encodes |kNumFrames| 1080p frames into three VP8 simulcast layers and
+// returns the average wall-clock time spent in Encode() per input frame, in
+// milliseconds.
+double MeasureEncodeTimePerFrameMs(bool parallel_encode) {
+  test::ScopedFieldTrials field_trials(
+      parallel_encode ? "WebRTC-SimulcastEncoderAdapter-ParallelEncode/Enabled/"
+                      : "");
+  InternalEncoderFactory factory;
+  SimulcastEncoderAdapter adapter(&factory, SdpVideoFormat("VP8"));
+  DroppingEncodedImageCallback callback;
+  adapter.RegisterEncodeCompleteCallback(&callback);
+
+  const VideoCodec codec = CreateCodecSettings();
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            adapter.InitEncode(&codec, /*number_of_cores=*/4,
+                               /*max_payload_size=*/1200));
+  SimulcastRateAllocator rate_allocator(codec);
+  adapter.SetRateAllocation(
+      rate_allocator.GetAllocation(kTotalBitrateKbps * 1000, kFramerate),
+      kFramerate);
+
+  std::unique_ptr<test::FrameGenerator> frame_generator =
+      test::FrameGenerator::CreateSquareGenerator(kWidth, kHeight,
+                                                  absl::nullopt, absl::nullopt);
+  const std::vector<VideoFrameType> frame_types(
+      3, VideoFrameType::kVideoFrameDelta);
+  int64_t total_encode_time_us = 0;
+  for (int i = 0; i < kNumFrames; ++i) {
+    VideoFrame frame = *frame_generator->NextFrame();
+    frame.set_timestamp(i * (90000 / kFramerate));
+    const int64_t start_us = rtc::TimeMicros();
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, adapter.Encode(frame, &frame_types));
+    total_encode_time_us += rtc::TimeMicros() - start_us;
+  }
+  adapter.Release();
+
+  EXPECT_GT(callback.num_encoded_images(), 0);
+  return static_cast<double>(total_encode_time_us) /
+         rtc::kNumMicrosecsPerMillisec / kNumFrames;
+}
+
+}  // namespace
+
+TEST(SimulcastEncoderAdapterPerformanceTest, SequentialEncode) {
+  test::PrintResult("simulcast_encode_time", "", "vp8_3_layers_sequential",
+                    MeasureEncodeTimePerFrameMs(/*parallel_encode=*/false),
+                    "ms_per_frame", true);
+}
+
+TEST(SimulcastEncoderAdapterPerformanceTest, ParallelEncode) {
+  test::PrintResult("simulcast_encode_time", "", "vp8_3_layers_parallel",
+                    MeasureEncodeTimePerFrameMs(/*parallel_encode=*/true),
+                    "ms_per_frame", true);
+}
+
+}  // namespace webrtc
@@ -26,6 +26,7 @@
 #include "modules/video_coding/codecs/vp8/include/vp8.h"
 #include "modules/video_coding/include/video_codec_interface.h"
 #include "modules/video_coding/utility/simulcast_test_fixture_impl.h"
+#include "test/field_trial.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 
@@ -361,7 +362,9 @@ class TestSimulcastEncoderAdapterFake : public ::testing::Test,
         adapter_(helper_->CreateMockEncoderAdapter()),
         last_encoded_image_width_(-1),
         last_encoded_image_height_(-1),
-        last_encoded_image_simulcast_index_(-1) {}
+        last_encoded_image_simulcast_index_(-1),
+        drop_request_simulcast_index_(-1),
+        num_dropped_frames_(0) {}
   virtual ~TestSimulcastEncoderAdapterFake() {
     if (adapter_) {
       adapter_->Release();
@@ -375,10 +378,19 @@ class TestSimulcastEncoderAdapterFake : public ::testing::Test,
     last_encoded_image_height_ = encoded_image._encodedHeight;
     last_encoded_image_simulcast_index_ =
         encoded_image.SpatialIndex().value_or(-1);
+    encoded_image_simulcast_indices_.push_back(
+        last_encoded_image_simulcast_index_);
 
-    return Result(Result::OK, encoded_image.Timestamp());
+    Result result(Result::OK, encoded_image.Timestamp());
+    if (last_encoded_image_simulcast_index_ == drop_request_simulcast_index_) {
+      result.drop_next_frame = true;
+      drop_request_simulcast_index_ = -1;
+    }
+    return result;
   }
 
+  void OnDroppedFrame(DropReason reason) override { ++num_dropped_frames_; }
+
   bool GetLastEncodedImageInfo(int* out_width,
                                int* out_height,
                                int* out_simulcast_index) {
@@ -477,6 +489,10 @@ class TestSimulcastEncoderAdapterFake : public ::testing::Test,
   int last_encoded_image_width_;
   int last_encoded_image_height_;
   int last_encoded_image_simulcast_index_;
+  std::vector<int> encoded_image_simulcast_indices_;
+  // The next image of this stream asks for the next frame to be dropped.
+  int drop_request_simulcast_index_;
+  int num_dropped_frames_;
   std::unique_ptr<SimulcastRateAllocator> rate_allocator_;
 };
 
@@ -1157,5 +1173,107 @@ TEST_F(TestSimulcastEncoderAdapterFake, ReportsFpsAllocation) {
               ::testing::ElementsAreArray(expected_fps_allocation));
 }
 
+TEST_F(TestSimulcastEncoderAdapterFake,
+       ParallelEncodeScalesAndDeliversInStreamOrder) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-SimulcastEncoderAdapter-ParallelEncode/Enabled/");
+  // The field trial is read on construction.
+  adapter_.reset(helper_->CreateMockEncoderAdapter());
+  SimulcastTestFixtureImpl::DefaultSettings(
+      &codec_, static_cast<const int*>(kTestTemporalLayerProfile),
+      kVideoCodecVP8);
+  codec_.numberOfSimulcastStreams = 3;
+  // High start bitrate, so all streams are enabled.
+  codec_.startBitrate = 3000;
+  EXPECT_EQ(0, adapter_->InitEncode(&codec_, 1, 1200));
+  adapter_->RegisterEncodeCompleteCallback(this);
+  std::vector<MockVideoEncoder*> encoders = helper_->factory()->encoders();
+  ASSERT_EQ(3u, encoders.size());
+
+  for (size_t i = 0; i < encoders.size(); ++i) {
+    MockVideoEncoder* encoder = encoders[i];
+    const int width = codec_.simulcastStream[i].width;
+    const int height = codec_.simulcastStream[i].height;
+    EXPECT_CALL(*encoder, Encode(_, _))
+        .Times(2)
+        .WillRepeatedly(::testing::Invoke(
+            [encoder, width, height](
+                const VideoFrame& frame,
+                const std::vector<VideoFrameType>* frame_types) {
+              EXPECT_EQ(width, frame.width());
+              EXPECT_EQ(height, frame.height());
+              encoder->SendEncodedImage(frame.width(), frame.height());
+              return WEBRTC_VIDEO_CODEC_OK;
+            }));
+  }
+
+  rtc::scoped_refptr<I420Buffer> input_buffer =
+      I420Buffer::Create(kDefaultWidth, kDefaultHeight);
+  input_buffer->InitializeData();
+  VideoFrame input_frame = VideoFrame::Builder()
+                               .set_video_frame_buffer(input_buffer)
+                               .set_timestamp_rtp(0)
+                               .set_timestamp_us(0)
+                               .set_rotation(kVideoRotation_0)
+                               .build();
+  std::vector<VideoFrameType> frame_types(3, VideoFrameType::kVideoFrameKey);
+  EXPECT_EQ(0, adapter_->Encode(input_frame, &frame_types));
+  // The second frame reuses the scaled buffers of the first.
+  EXPECT_EQ(0, adapter_->Encode(input_frame, &frame_types));
+  EXPECT_THAT(encoded_image_simulcast_indices_,
+              ::testing::ElementsAre(0, 1, 2, 0, 1, 2));
+}
+
+TEST_F(TestSimulcastEncoderAdapterFake,
+       ParallelEncodeDropsNextFrameOnAllStreamsWhenRequested) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-SimulcastEncoderAdapter-ParallelEncode/Enabled/");
+  // The field trial is read on construction.
+  adapter_.reset(helper_->CreateMockEncoderAdapter());
+  SimulcastTestFixtureImpl::DefaultSettings(
+      &codec_, static_cast<const int*>(kTestTemporalLayerProfile),
+      kVideoCodecVP8);
+  codec_.numberOfSimulcastStreams = 3;
+  // High start bitrate, so all streams are enabled.
+  codec_.startBitrate = 3000;
+  EXPECT_EQ(0, adapter_->InitEncode(&codec_, 1, 1200));
+  adapter_->RegisterEncodeCompleteCallback(this);
+  std::vector<MockVideoEncoder*> encoders = helper_->factory()->encoders();
+  ASSERT_EQ(3u, encoders.size());
+
+  // The second of three frames is dropped on all streams.
+  for (MockVideoEncoder* encoder : encoders) {
+    EXPECT_CALL(*encoder, Encode(_, _))
+        .Times(2)
+        .WillRepeatedly(::testing::Invoke(
+            [encoder](const VideoFrame& frame,
+                      const std::vector<VideoFrameType>* frame_types) {
+              encoder->SendEncodedImage(frame.width(), frame.height());
+              return WEBRTC_VIDEO_CODEC_OK;
+            }));
+  }
+
+  rtc::scoped_refptr<I420Buffer> input_buffer =
+      I420Buffer::Create(kDefaultWidth, kDefaultHeight);
+  input_buffer->InitializeData();
+  VideoFrame input_frame = VideoFrame::Builder()
+                               .set_video_frame_buffer(input_buffer)
+                               .set_timestamp_rtp(0)
+                               .set_timestamp_us(0)
+                               .set_rotation(kVideoRotation_0)
+                               .build();
+  std::vector<VideoFrameType> frame_types(3, VideoFrameType::kVideoFrameKey);
+  // Only the middle stream of the first frame asks for a drop.
+  drop_request_simulcast_index_ = 1;
+  EXPECT_EQ(0, adapter_->Encode(input_frame, &frame_types));
+  frame_types.assign(3, VideoFrameType::kVideoFrameDelta);
+  EXPECT_EQ(0, adapter_->Encode(input_frame, &frame_types));
+  EXPECT_EQ(1, num_dropped_frames_);
+  EXPECT_EQ(0, adapter_->Encode(input_frame, &frame_types));
+  EXPECT_EQ(1, num_dropped_frames_);
+  EXPECT_THAT(encoded_image_simulcast_indices_,
+              ::testing::ElementsAre(0, 1, 2, 0, 1, 2));
+}
+
 }  // namespace test
 }  // namespace webrtc
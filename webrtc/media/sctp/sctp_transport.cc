@@ -257,13 +257,7 @@ class SctpTransport::UsrSctpWrapper {
                         << "; set_df: " << rtc::ToHex(set_df);
 
     VerboseLogPacket(data, length, SCTP_DUMP_OUTBOUND);
-    // Note: We have to copy the data; the caller will delete it.
-    rtc::CopyOnWriteBuffer buf(reinterpret_cast<uint8_t*>(data), length);
-    // TODO(deadbeef): Why do we need an AsyncInvoke here? We're already on the
-    // right thread and don't need to unwind the stack.
-    transport->invoker_.AsyncInvoke<void>(
-        RTC_FROM_HERE, transport->network_thread_,
-        rtc::Bind(&SctpTransport::OnPacketFromSctpToNetwork, transport, buf));
+    transport->QueueOutboundPacket(data, length);
     return 0;
   }
 
@@ -306,13 +300,21 @@ class SctpTransport::UsrSctpWrapper {
         // A message with a new sid, but haven't seen the EOR for the
         // previous message. Deliver the previous partial message to avoid
         // merging messages from different sid's.
-        transport->invoker_.AsyncInvoke<void>(
-            RTC_FROM_HERE, transport->network_thread_,
-            rtc::Bind(&SctpTransport::OnInboundPacketFromSctpToTransport,
-                      transport, transport->partial_message_,
-                      transport->partial_params_, transport->partial_flags_));
+        transport->QueueInboundPacket(transport->partial_message_,
+                                      transport->partial_params_,
+                                      transport->partial_flags_);
+        transport->partial_message_ = rtc::CopyOnWriteBuffer();
+      }
 
-        transport->partial_message_.Clear();
+      if (transport->partial_message_.size() == 0 && (flags & MSG_EOR)) {
+        // The whole message arrived in one callback, which is the common
+        // case. Hand it over directly rather than through |partial_message_|,
+        // whose capacity may be far larger than this message.
+        transport->QueueInboundPacket(
+            rtc::CopyOnWriteBuffer(reinterpret_cast<uint8_t*>(data), length),
+            params, flags);
+        free(data);
+        return 1;
       }
 
       transport->partial_message_.AppendData(reinterpret_cast<uint8_t*>(data),
@@ -331,14 +333,11 @@ class SctpTransport::UsrSctpWrapper {
         return 1;
       }
 
-      // The ownership of the packet transfers to |invoker_|. Using
+      // The ownership of the packet transfers to the inbound queue. Using
       // CopyOnWriteBuffer is the most convenient way to do this.
-      transport->invoker_.AsyncInvoke<void>(
-          RTC_FROM_HERE, transport->network_thread_,
-          rtc::Bind(&SctpTransport::OnInboundPacketFromSctpToTransport,
-                    transport, transport->partial_message_, params, flags));
-
-      transport->partial_message_.Clear();
+      transport->QueueInboundPacket(transport->partial_message_, params,
+                                    flags);
+      transport->partial_message_ = rtc::CopyOnWriteBuffer();
     }
     return 1;
   }
@@ -904,16 +903,53 @@ sockaddr_conn SctpTransport::GetSctpSockAddr(int port) {
   return sconn;
 }
 
-void SctpTransport::OnPacketFromSctpToNetwork(
-    const rtc::CopyOnWriteBuffer& buffer) {
+void SctpTransport::QueueOutboundPacket(const void* data, size_t length) {
+  bool send_pending;
+  // Note: We have to copy the data; the caller will delete it.
+  {
+    rtc::CritScope cs(&queue_lock_);
+    send_pending = !queued_outbound_sizes_.empty();
+    queued_outbound_data_.AppendData(static_cast<const uint8_t*>(data),
+                                     length);
+    queued_outbound_sizes_.push_back(length);
+  }
+  // Even when called on the network thread, the packet is sent
+  // asynchronously. usrsctp may call this while holding its own locks, and
+  // sending may feed packets back into usrsctp.
+  if (!send_pending) {
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, network_thread_,
+        rtc::Bind(&SctpTransport::SendQueuedOutboundPackets, this));
+  }
+}
+
+void SctpTransport::SendQueuedOutboundPackets() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  rtc::Buffer data;
+  std::vector<size_t> sizes;
+  {
+    rtc::CritScope cs(&queue_lock_);
+    swap(data, queued_outbound_data_);
+    sizes.swap(queued_outbound_sizes_);
+  }
+  TRACE_EVENT1("webrtc", "SctpTransport::SendQueuedOutboundPackets",
+               "packets", sizes.size());
+  size_t offset = 0;
+  for (size_t size : sizes) {
+    OnPacketFromSctpToNetwork(data.data<char>() + offset, size);
+    offset += size;
+  }
+}
+
+void SctpTransport::OnPacketFromSctpToNetwork(const char* data,
+                                              size_t length) {
   RTC_DCHECK_RUN_ON(network_thread_);
-  if (buffer.size() > (kSctpMtu)) {
+  if (length > (kSctpMtu)) {
     RTC_LOG(LS_ERROR) << debug_name_ << "->OnPacketFromSctpToNetwork(...): "
                       << "SCTP seems to have made a packet that is bigger "
-                      << "than its official MTU: " << buffer.size()
+                      << "than its official MTU: " << length
                       << " vs max of " << kSctpMtu;
   }
-  TRACE_EVENT0("webrtc", "SctpTransport::OnPacketFromSctpToNetwork");
 
   // Don't create noise by trying to send a packet when the DTLS transport isn't
   // even writable.
@@ -922,8 +958,38 @@ void SctpTransport::OnPacketFromSctpToNetwork(
   }
 
   // Bon voyage.
-  transport_->SendPacket(buffer.data<char>(), buffer.size(),
-                         rtc::PacketOptions(), PF_NORMAL);
+  transport_->SendPacket(data, length, rtc::PacketOptions(), PF_NORMAL);
+}
+
+void SctpTransport::QueueInboundPacket(const rtc::CopyOnWriteBuffer& buffer,
+                                       const ReceiveDataParams& params,
+                                       int flags) {
+  bool delivery_pending;
+  {
+    rtc::CritScope cs(&queue_lock_);
+    delivery_pending = !queued_inbound_packets_.empty();
+    queued_inbound_packets_.push_back({buffer, params, flags});
+  }
+  if (!delivery_pending) {
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, network_thread_,
+        rtc::Bind(&SctpTransport::DeliverQueuedInboundPackets, this));
+  }
+}
+
+void SctpTransport::DeliverQueuedInboundPackets() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  std::vector<InboundPacket> packets;
+  {
+    rtc::CritScope cs(&queue_lock_);
+    packets.swap(queued_inbound_packets_);
+  }
+  TRACE_EVENT1("webrtc", "SctpTransport::DeliverQueuedInboundPackets",
+               "packets", packets.size());
+  for (const InboundPacket& packet : packets) {
+    OnInboundPacketFromSctpToTransport(packet.buffer, packet.params,
+                                       packet.flags);
+  }
 }
 
 void SctpTransport::OnInboundPacketFromSctpToTransport(
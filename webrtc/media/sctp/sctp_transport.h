@@ -20,10 +20,13 @@
 #include <vector>
 
 #include "rtc_base/async_invoker.h"
+#include "rtc_base/buffer.h"
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/critical_section.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 #include "rtc_base/thread.h"
+#include "rtc_base/thread_annotations.h"
 // For SendDataParams/ReceiveDataParams.
 #include "media/base/media_channel.h"
 #include "media/sctp/sctp_transport_internal.h"
@@ -45,18 +48,26 @@ struct SctpInboundPacket;
 //  2.  usrsctp_sendv(data)
 // [network thread returns; sctp thread then calls the following]
 //  3.  OnSctpOutboundPacket(wrapped_data)
-// [sctp thread returns having async invoked on the network thread]
-//  4.  SctpTransport::OnPacketFromSctpToNetwork(wrapped_data)
-//  5.  DtlsTransport::SendPacket(wrapped_data)
-//  6.  ... across network ... a packet is sent back ...
-//  7.  SctpTransport::OnPacketReceived(wrapped_data)
-//  8.  usrsctp_conninput(wrapped_data)
+//  4.  SctpTransport::QueueOutboundPacket(wrapped_data)
+// [sctp thread returns having async invoked on the network thread, unless a
+//  previously queued packet is still waiting to be sent]
+//  5.  SctpTransport::SendQueuedOutboundPackets()
+//  6.  DtlsTransport::SendPacket(wrapped_data)
+//  7.  ... across network ... a packet is sent back ...
+//  8.  SctpTransport::OnPacketReceived(wrapped_data)
+//  9.  usrsctp_conninput(wrapped_data)
 // [network thread returns; sctp thread then calls the following]
-//  9.  OnSctpInboundData(data)
-// [sctp thread returns having async invoked on the network thread]
-//  10. SctpTransport::OnInboundPacketFromSctpToTransport(inboundpacket)
-//  11. SctpTransport::OnDataFromSctpToTransport(data)
-//  12. SctpTransport::SignalDataReceived(data)
+//  10. OnSctpInboundData(data)
+//  11. SctpTransport::QueueInboundPacket(data)
+// [sctp thread returns having async invoked on the network thread, unless a
+//  previously queued message is still waiting to be delivered]
+//  12. SctpTransport::DeliverQueuedInboundPackets()
+//  13. SctpTransport::OnInboundPacketFromSctpToTransport(inboundpacket)
+//  14. SctpTransport::OnDataFromSctpToTransport(data)
+//  15. SctpTransport::SignalDataReceived(data)
+// All packets and messages queued between two network thread wakeups are
+// handled in one go, so a burst of sends doesn't cost a thread hop per SCTP
+// packet.
 // [from the same thread, methods registered/connected to
 //  SctpTransport are called with the recieved data]
 class SctpTransport : public SctpTransportInternal,
@@ -119,8 +130,19 @@ class SctpTransport : public SctpTransportInternal,
   void OnSendThresholdCallback();
   sockaddr_conn GetSctpSockAddr(int port);
 
-  // Called using |invoker_| to send packet on the network.
-  void OnPacketFromSctpToNetwork(const rtc::CopyOnWriteBuffer& buffer);
+  // Called by usrsctp, on any thread. Copies the packet and makes sure a
+  // SendQueuedOutboundPackets() call is pending.
+  void QueueOutboundPacket(const void* data, size_t length);
+  // Called using |invoker_| to send all queued packets on the network.
+  void SendQueuedOutboundPackets();
+  void OnPacketFromSctpToNetwork(const char* data, size_t length);
+  // Called by usrsctp, on any thread. Makes sure a
+  // DeliverQueuedInboundPackets() call is pending.
+  void QueueInboundPacket(const rtc::CopyOnWriteBuffer& buffer,
+                          const ReceiveDataParams& params,
+                          int flags);
+  // Called using |invoker_| to handle all queued messages and notifications.
+  void DeliverQueuedInboundPackets();
   // Called using |invoker_| to decide what to do with the packet.
   // The |flags| parameter is used by SCTP to distinguish notification packets
   // from other types of packets.
@@ -142,6 +164,21 @@ class SctpTransport : public SctpTransportInternal,
   // Underlying DTLS transport.
   rtc::PacketTransportInternal* transport_ = nullptr;
 
+  struct InboundPacket {
+    rtc::CopyOnWriteBuffer buffer;
+    ReceiveDataParams params;
+    int flags;
+  };
+
+  // Packets and messages from usrsctp that the network thread hasn't handled
+  // yet. The queues being non-empty means a task to drain them is pending.
+  rtc::CriticalSection queue_lock_;
+  // Outbound packets are stored back to back in |queued_outbound_data_|.
+  rtc::Buffer queued_outbound_data_ RTC_GUARDED_BY(queue_lock_);
+  std::vector<size_t> queued_outbound_sizes_ RTC_GUARDED_BY(queue_lock_);
+  std::vector<InboundPacket> queued_inbound_packets_
+      RTC_GUARDED_BY(queue_lock_);
+
   // Track the data received from usrsctp between callbacks until the EOR bit
   // arrives.
   rtc::CopyOnWriteBuffer partial_message_;
@@ -17,11 +17,13 @@
 #include "absl/algorithm/container.h"
 #include "media/sctp/sctp_transport.h"
 #include "p2p/base/fake_dtls_transport.h"
+#include "rtc_base/byte_order.h"
 #include "rtc_base/copy_on_write_buffer.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/message_queue.h"
 #include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
 #include "test/gtest.h"
 
 namespace {
@@ -65,6 +67,30 @@ class SctpFakeDataReceiver : public sigslot::has_slots<> {
   ReceiveDataParams last_params_;
 };
 
+// Counts received messages and checks that they arrive in the order they were
+// sent, given by an index in their first four bytes.
+class SctpDataCounter : public sigslot::has_slots<> {
+ public:
+  void OnDataReceived(const ReceiveDataParams& params,
+                      const rtc::CopyOnWriteBuffer& data) {
+    if (data.size() < sizeof(uint32_t) ||
+        rtc::GetBE32(data.data()) != num_messages_) {
+      ++num_out_of_order_;
+    }
+    ++num_messages_;
+    num_bytes_ += data.size();
+  }
+
+  uint32_t num_messages() const { return num_messages_; }
+  uint32_t num_out_of_order() const { return num_out_of_order_; }
+  size_t num_bytes() const { return num_bytes_; }
+
+ private:
+  uint32_t num_messages_ = 0;
+  uint32_t num_out_of_order_ = 0;
+  size_t num_bytes_ = 0;
+};
+
 class SctpTransportObserver : public sigslot::has_slots<> {
  public:
   explicit SctpTransportObserver(SctpTransport* transport) {
@@ -442,6 +468,80 @@ TEST_F(SctpTransportTest, SendDataBlocked) {
   EXPECT_EQ(SDR_BLOCK, result);
 }
 
+// Messages sent back to back are handed to the network and delivered in
+// batches, which must keep them in order.
+TEST_F(SctpTransportTest, DeliversBurstOfMessagesInOrder) {
+  SetupConnectedTransportsWithTwoStreams();
+  SctpDataCounter counter;
+  transport2()->SignalDataReceived.connect(&counter,
+                                           &SctpDataCounter::OnDataReceived);
+
+  SendDataResult result;
+  SendDataParams params;
+  params.sid = 1;
+  rtc::CopyOnWriteBuffer payload(1000);
+  for (uint32_t i = 0; i < 100; ++i) {
+    rtc::SetBE32(payload.data(), i);
+    ASSERT_TRUE(transport1()->SendData(params, payload, &result));
+  }
+
+  EXPECT_EQ_WAIT(100u, counter.num_messages(), kDefaultTimeout);
+  EXPECT_EQ(0u, counter.num_out_of_order());
+}
+
+// Tests a bulk transfer, such as a file transfer, that keeps usrsctp's send
+// buffer full, so that many packets and messages are batched per wakeup.
+TEST_F(SctpTransportTest, BulkTransferDeliversAllMessagesInOrder) {
+  const size_t kMessageSize = 16 * 1024;
+  const uint32_t kNumMessages = 1024;
+  FakeDtlsTransport fake_dtls1("fake dtls 1", 0);
+  FakeDtlsTransport fake_dtls2("fake dtls 2", 0);
+  std::unique_ptr<SctpTransport> transport1(
+      new SctpTransport(rtc::Thread::Current(), &fake_dtls1));
+  std::unique_ptr<SctpTransport> transport2(
+      new SctpTransport(rtc::Thread::Current(), &fake_dtls2));
+  SctpDataCounter counter;
+  transport2->SignalDataReceived.connect(&counter,
+                                         &SctpDataCounter::OnDataReceived);
+  transport1->OpenStream(1);
+  transport2->OpenStream(1);
+  transport1->Start(kTransport1Port, kTransport2Port);
+  transport2->Start(kTransport2Port, kTransport1Port);
+  bool asymmetric = false;
+  fake_dtls1.SetDestination(&fake_dtls2, asymmetric);
+
+  SendDataResult result;
+  SendDataParams params;
+  params.sid = 1;
+  params.type = DMT_BINARY;
+  rtc::CopyOnWriteBuffer payload(kMessageSize);
+  // Wait for the association before filling the send buffer.
+  rtc::SetBE32(payload.data(), 0);
+  ASSERT_TRUE(transport1->SendData(params, payload, &result));
+  ASSERT_EQ_WAIT(1u, counter.num_messages(), kDefaultTimeout);
+
+  const int64_t deadline_ms = rtc::TimeMillis() + kDefaultTimeout;
+  uint32_t next_message = 1;
+  while (counter.num_messages() <= kNumMessages &&
+         rtc::TimeMillis() < deadline_ms) {
+    // Send until usrsctp's send buffer is full, then let the network thread
+    // move the packets and acknowledgements.
+    while (next_message <= kNumMessages) {
+      rtc::SetBE32(payload.data(), next_message);
+      if (!transport1->SendData(params, payload, &result)) {
+        ASSERT_EQ(SDR_BLOCK, result);
+        break;
+      }
+      ++next_message;
+    }
+    rtc::Thread::Current()->ProcessMessages(0);
+  }
+
+  EXPECT_EQ(kNumMessages + 1, counter.num_messages());
+  EXPECT_EQ((kNumMessages + 1) * kMessageSize, counter.num_bytes());
+  EXPECT_EQ(0u, counter.num_out_of_order());
+}
+
 // Trying to send data for a nonexistent stream should fail.
 TEST_F(SctpTransportTest, SendDataWithNonexistentStreamFails) {
   SetupConnectedTransportsWithTwoStreams();
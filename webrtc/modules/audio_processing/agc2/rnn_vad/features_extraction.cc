@@ -27,12 +27,15 @@ const BiQuadFilter::BiQuadCoefficients kHpfConfig24k = {
 }  // namespace
 
 FeaturesExtractor::FeaturesExtractor()
+    : FeaturesExtractor(DetectOptimization()) {}
+
+FeaturesExtractor::FeaturesExtractor(Optimization optimization)
     : use_high_pass_filter_(false),
       pitch_buf_24kHz_(),
       pitch_buf_24kHz_view_(pitch_buf_24kHz_.GetBufferView()),
       lp_residual_(kBufSize24kHz),
       lp_residual_view_(lp_residual_.data(), kBufSize24kHz),
-      pitch_estimator_(),
+      pitch_estimator_(optimization),
       reference_frame_view_(pitch_buf_24kHz_.GetMostRecentValuesView()) {
   RTC_DCHECK_EQ(kBufSize24kHz, lp_residual_.size());
   hpf_.Initialize(kHpfConfig24k);
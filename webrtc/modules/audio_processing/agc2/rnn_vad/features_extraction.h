@@ -28,6 +28,7 @@ namespace rnn_vad {
 class FeaturesExtractor {
  public:
   FeaturesExtractor();
+  explicit FeaturesExtractor(Optimization optimization);
   FeaturesExtractor(const FeaturesExtractor&) = delete;
   FeaturesExtractor& operator=(const FeaturesExtractor&) = delete;
   ~FeaturesExtractor();
@@ -18,8 +18,11 @@
 namespace webrtc {
 namespace rnn_vad {
 
-PitchEstimator::PitchEstimator()
-    : pitch_buf_decimated_(kBufSize12kHz),
+PitchEstimator::PitchEstimator() : PitchEstimator(DetectOptimization()) {}
+
+PitchEstimator::PitchEstimator(Optimization optimization)
+    : vector_math_(optimization),
+      pitch_buf_decimated_(kBufSize12kHz),
       pitch_buf_decimated_view_(pitch_buf_decimated_.data(), kBufSize12kHz),
       auto_corr_(kNumInvertedLags12kHz),
       auto_corr_view_(auto_corr_.data(), kNumInvertedLags12kHz) {
@@ -43,12 +46,13 @@ PitchInfo PitchEstimator::Estimate(
   // to 24 kHz.
   pitch_candidates_inv_lags[0] *= 2;
   pitch_candidates_inv_lags[1] *= 2;
-  size_t pitch_inv_lag_48kHz =
-      RefinePitchPeriod48kHz(pitch_buf, pitch_candidates_inv_lags);
+  size_t pitch_inv_lag_48kHz = RefinePitchPeriod48kHz(
+      pitch_buf, pitch_candidates_inv_lags, vector_math_);
   // Look for stronger harmonics to find the final pitch period and its gain.
   RTC_DCHECK_LT(pitch_inv_lag_48kHz, kMaxPitch48kHz);
   last_pitch_48kHz_ = CheckLowerPitchPeriodsAndComputePitchGain(
-      pitch_buf, kMaxPitch48kHz - pitch_inv_lag_48kHz, last_pitch_48kHz_);
+      pitch_buf, kMaxPitch48kHz - pitch_inv_lag_48kHz, last_pitch_48kHz_,
+      vector_math_);
   return last_pitch_48kHz_;
 }
 
@@ -19,6 +19,7 @@
 #include "modules/audio_processing/agc2/rnn_vad/common.h"
 #include "modules/audio_processing/agc2/rnn_vad/pitch_info.h"
 #include "modules/audio_processing/agc2/rnn_vad/pitch_search_internal.h"
+#include "modules/audio_processing/agc2/rnn_vad/vector_math.h"
 
 namespace webrtc {
 namespace rnn_vad {
@@ -27,6 +28,7 @@ namespace rnn_vad {
 class PitchEstimator {
  public:
   PitchEstimator();
+  explicit PitchEstimator(Optimization optimization);
   PitchEstimator(const PitchEstimator&) = delete;
   PitchEstimator& operator=(const PitchEstimator&) = delete;
   ~PitchEstimator();
@@ -35,6 +37,7 @@ class PitchEstimator {
   PitchInfo Estimate(rtc::ArrayView<const float, kBufSize24kHz> pitch_buf);
 
  private:
+  const VectorMath vector_math_;
   PitchInfo last_pitch_48kHz_;
   AutoCorrelationCalculator auto_corr_calculator_;
   std::vector<float> pitch_buf_decimated_;
@@ -31,13 +31,14 @@ size_t GetInvertedLag(size_t lag) {
 
 float ComputeAutoCorrelationCoeff(rtc::ArrayView<const float> pitch_buf,
                                   size_t inv_lag,
-                                  size_t max_pitch_period) {
+                                  size_t max_pitch_period,
+                                  const VectorMath& vector_math) {
   RTC_DCHECK_LT(inv_lag, pitch_buf.size());
   RTC_DCHECK_LT(max_pitch_period, pitch_buf.size());
   RTC_DCHECK_LE(inv_lag, max_pitch_period);
-  // TODO(bugs.webrtc.org/9076): Maybe optimize using vectorization.
-  return std::inner_product(pitch_buf.begin() + max_pitch_period,
-                            pitch_buf.end(), pitch_buf.begin() + inv_lag, 0.f);
+  const size_t frame_size = pitch_buf.size() - max_pitch_period;
+  return vector_math.DotProduct(pitch_buf.subview(max_pitch_period),
+                                pitch_buf.subview(inv_lag, frame_size));
 }
 
 // Computes a pseudo-interpolation offset for an estimated pitch period |lag| by
@@ -69,18 +70,19 @@ int GetPitchPseudoInterpolationOffset(size_t lag,
 // output sample rate is twice as that of |lag|.
 size_t PitchPseudoInterpolationLagPitchBuf(
     size_t lag,
-    rtc::ArrayView<const float, kBufSize24kHz> pitch_buf) {
+    rtc::ArrayView<const float, kBufSize24kHz> pitch_buf,
+    const VectorMath& vector_math) {
   int offset = 0;
   // Cannot apply pseudo-interpolation at the boundaries.
   if (lag > 0 && lag < kMaxPitch24kHz) {
     offset = GetPitchPseudoInterpolationOffset(
         lag,
         ComputeAutoCorrelationCoeff(pitch_buf, GetInvertedLag(lag - 1),
-                                    kMaxPitch24kHz),
+                                    kMaxPitch24kHz, vector_math),
         ComputeAutoCorrelationCoeff(pitch_buf, GetInvertedLag(lag),
-                                    kMaxPitch24kHz),
+                                    kMaxPitch24kHz, vector_math),
         ComputeAutoCorrelationCoeff(pitch_buf, GetInvertedLag(lag + 1),
-                                    kMaxPitch24kHz));
+                                    kMaxPitch24kHz, vector_math));
   }
   return 2 * lag + offset;
 }
@@ -196,9 +198,10 @@ float ComputePitchGainThreshold(int candidate_pitch_period,
 
 void ComputeSlidingFrameSquareEnergies(
     rtc::ArrayView<const float, kBufSize24kHz> pitch_buf,
-    rtc::ArrayView<float, kMaxPitch24kHz + 1> yy_values) {
-  float yy =
-      ComputeAutoCorrelationCoeff(pitch_buf, kMaxPitch24kHz, kMaxPitch24kHz);
+    rtc::ArrayView<float, kMaxPitch24kHz + 1> yy_values,
+    const VectorMath& vector_math) {
+  float yy = ComputeAutoCorrelationCoeff(pitch_buf, kMaxPitch24kHz,
+                                         kMaxPitch24kHz, vector_math);
   yy_values[0] = yy;
   for (size_t i = 1; i < yy_values.size(); ++i) {
     RTC_DCHECK_LE(i, kMaxPitch24kHz + kFrameSize20ms24kHz);
@@ -271,7 +274,8 @@ std::array<size_t, 2> FindBestPitchPeriods(
 
 size_t RefinePitchPeriod48kHz(
     rtc::ArrayView<const float, kBufSize24kHz> pitch_buf,
-    rtc::ArrayView<const size_t, 2> inv_lags) {
+    rtc::ArrayView<const size_t, 2> inv_lags,
+    const VectorMath& vector_math) {
   // Compute the auto-correlation terms only for neighbors of the given pitch
   // candidates (similar to what is done in ComputePitchAutoCorrelation(), but
   // for a few lag values).
@@ -282,8 +286,8 @@ size_t RefinePitchPeriod48kHz(
   };
   for (size_t inv_lag = 0; inv_lag < auto_corr.size(); ++inv_lag) {
     if (is_neighbor(inv_lag, inv_lags[0]) || is_neighbor(inv_lag, inv_lags[1]))
-      auto_corr[inv_lag] =
-          ComputeAutoCorrelationCoeff(pitch_buf, inv_lag, kMaxPitch24kHz);
+      auto_corr[inv_lag] = ComputeAutoCorrelationCoeff(
+          pitch_buf, inv_lag, kMaxPitch24kHz, vector_math);
   }
   // Find best pitch at 24 kHz.
   const auto pitch_candidates_inv_lags = FindBestPitchPeriods(
@@ -297,7 +301,8 @@ size_t RefinePitchPeriod48kHz(
 PitchInfo CheckLowerPitchPeriodsAndComputePitchGain(
     rtc::ArrayView<const float, kBufSize24kHz> pitch_buf,
     int initial_pitch_period_48kHz,
-    PitchInfo prev_pitch_48kHz) {
+    PitchInfo prev_pitch_48kHz,
+    const VectorMath& vector_math) {
   RTC_DCHECK_LE(kMinPitch48kHz, initial_pitch_period_48kHz);
   RTC_DCHECK_LE(initial_pitch_period_48kHz, kMaxPitch48kHz);
   // Stores information for a refined pitch candidate.
@@ -316,8 +321,8 @@ PitchInfo CheckLowerPitchPeriodsAndComputePitchGain(
 
   // Initialize.
   std::array<float, kMaxPitch24kHz + 1> yy_values;
-  ComputeSlidingFrameSquareEnergies(pitch_buf,
-                                    {yy_values.data(), yy_values.size()});
+  ComputeSlidingFrameSquareEnergies(
+      pitch_buf, {yy_values.data(), yy_values.size()}, vector_math);
   const float xx = yy_values[0];
   // Helper lambdas.
   const auto pitch_gain = [](float xy, float yy, float xx) {
@@ -329,7 +334,8 @@ PitchInfo CheckLowerPitchPeriodsAndComputePitchGain(
   best_pitch.period_24kHz = std::min(initial_pitch_period_48kHz / 2,
                                      static_cast<int>(kMaxPitch24kHz - 1));
   best_pitch.xy = ComputeAutoCorrelationCoeff(
-      pitch_buf, GetInvertedLag(best_pitch.period_24kHz), kMaxPitch24kHz);
+      pitch_buf, GetInvertedLag(best_pitch.period_24kHz), kMaxPitch24kHz,
+      vector_math);
   best_pitch.yy = yy_values[best_pitch.period_24kHz];
   best_pitch.gain = pitch_gain(best_pitch.xy, best_pitch.yy, xx);
 
@@ -366,10 +372,11 @@ PitchInfo CheckLowerPitchPeriodsAndComputePitchGain(
     // |candidate_pitch_period| by also looking at its possible sub-harmonic
     // |candidate_pitch_secondary_period|.
     float xy_primary_period = ComputeAutoCorrelationCoeff(
-        pitch_buf, GetInvertedLag(candidate_pitch_period), kMaxPitch24kHz);
+        pitch_buf, GetInvertedLag(candidate_pitch_period), kMaxPitch24kHz,
+        vector_math);
     float xy_secondary_period = ComputeAutoCorrelationCoeff(
         pitch_buf, GetInvertedLag(candidate_pitch_secondary_period),
-        kMaxPitch24kHz);
+        kMaxPitch24kHz, vector_math);
     float xy = 0.5f * (xy_primary_period + xy_secondary_period);
     float yy = 0.5f * (yy_values[candidate_pitch_period] +
                        yy_values[candidate_pitch_secondary_period]);
@@ -393,7 +400,8 @@ PitchInfo CheckLowerPitchPeriodsAndComputePitchGain(
   final_pitch_gain = std::min(best_pitch.gain, final_pitch_gain);
   int final_pitch_period_48kHz = std::max(
       kMinPitch48kHz,
-      PitchPseudoInterpolationLagPitchBuf(best_pitch.period_24kHz, pitch_buf));
+      PitchPseudoInterpolationLagPitchBuf(best_pitch.period_24kHz, pitch_buf,
+                                          vector_math));
 
   return {final_pitch_period_48kHz, final_pitch_gain};
 }
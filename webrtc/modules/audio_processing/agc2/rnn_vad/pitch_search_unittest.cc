@@ -25,22 +25,25 @@ namespace test {
 
 // TODO(bugs.webrtc.org/9076): Remove when the issue is fixed.
 TEST(RnnVadTest, PitchSearchBitExactness) {
-  auto lp_residual_reader = CreateLpResidualAndPitchPeriodGainReader();
-  const size_t num_frames = lp_residual_reader.second;
-  std::array<float, 864> lp_residual;
-  float expected_pitch_period, expected_pitch_gain;
-  PitchEstimator pitch_estimator;
-  {
-    // TODO(bugs.webrtc.org/8948): Add when the issue is fixed.
-    // FloatingPointExceptionObserver fpe_observer;
-    for (size_t i = 0; i < num_frames; ++i) {
-      SCOPED_TRACE(i);
-      lp_residual_reader.first->ReadChunk(lp_residual);
-      lp_residual_reader.first->ReadValue(&expected_pitch_period);
-      lp_residual_reader.first->ReadValue(&expected_pitch_gain);
-      PitchInfo pitch_info = pitch_estimator.Estimate(lp_residual);
-      EXPECT_EQ(static_cast<int>(expected_pitch_period), pitch_info.period);
-      EXPECT_NEAR(expected_pitch_gain, pitch_info.gain, 1e-5f);
+  for (Optimization optimization : GetOptimizationsToTest()) {
+    SCOPED_TRACE(static_cast<int>(optimization));
+    auto lp_residual_reader = CreateLpResidualAndPitchPeriodGainReader();
+    const size_t num_frames = lp_residual_reader.second;
+    std::array<float, 864> lp_residual;
+    float expected_pitch_period, expected_pitch_gain;
+    PitchEstimator pitch_estimator(optimization);
+    {
+      // TODO(bugs.webrtc.org/8948): Add when the issue is fixed.
+      // FloatingPointExceptionObserver fpe_observer;
+      for (size_t i = 0; i < num_frames; ++i) {
+        SCOPED_TRACE(i);
+        lp_residual_reader.first->ReadChunk(lp_residual);
+        lp_residual_reader.first->ReadValue(&expected_pitch_period);
+        lp_residual_reader.first->ReadValue(&expected_pitch_gain);
+        PitchInfo pitch_info = pitch_estimator.Estimate(lp_residual);
+        EXPECT_EQ(static_cast<int>(expected_pitch_period), pitch_info.period);
+        EXPECT_NEAR(expected_pitch_gain, pitch_info.gain, 1e-5f);
+      }
     }
   }
 }
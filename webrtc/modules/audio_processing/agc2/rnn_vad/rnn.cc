@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <vector>
 
 #include "rtc_base/checks.h"
 #include "third_party/rnnoise/src/rnn_activations.h"
@@ -20,6 +21,7 @@
 
 namespace webrtc {
 namespace rnn_vad {
+namespace {
 
 using rnnoise::kWeightsScale;
 
@@ -48,23 +50,50 @@ using rnnoise::RectifiedLinearUnit;
 using rnnoise::SigmoidApproximated;
 using rnnoise::TansigApproximated;
 
+std::vector<float> GetFloatBias(rtc::ArrayView<const int8_t> bias) {
+  return std::vector<float>(bias.begin(), bias.end());
+}
+
+// Converts |weights|, stored as [input][gate][output], to float and transposes
+// them to [gate][output][input], so that the weights of every output unit are
+// contiguous.
+std::vector<float> GetTransposedFloatWeights(
+    rtc::ArrayView<const int8_t> weights,
+    size_t input_size,
+    size_t output_size,
+    size_t num_gates) {
+  RTC_DCHECK_LE(num_gates * input_size * output_size, weights.size());
+  std::vector<float> transposed(num_gates * input_size * output_size);
+  const size_t stride = num_gates * output_size;
+  for (size_t unit = 0; unit < stride; ++unit) {
+    for (size_t i = 0; i < input_size; ++i) {
+      transposed[unit * input_size + i] = weights[i * stride + unit];
+    }
+  }
+  return transposed;
+}
+
+}  // namespace
+
 FullyConnectedLayer::FullyConnectedLayer(
     const size_t input_size,
     const size_t output_size,
     const rtc::ArrayView<const int8_t> bias,
     const rtc::ArrayView<const int8_t> weights,
-    float (*const activation_function)(float))
+    float (*const activation_function)(float),
+    Optimization optimization)
     : input_size_(input_size),
       output_size_(output_size),
-      bias_(bias),
-      weights_(weights),
-      activation_function_(activation_function) {
+      bias_(GetFloatBias(bias)),
+      weights_(GetTransposedFloatWeights(weights, input_size, output_size, 1)),
+      activation_function_(activation_function),
+      vector_math_(optimization) {
   RTC_DCHECK_LE(output_size_, kFullyConnectedLayersMaxUnits)
       << "Static over-allocation of fully-connected layers output vectors is "
          "not sufficient.";
-  RTC_DCHECK_EQ(output_size_, bias_.size())
+  RTC_DCHECK_EQ(output_size_, bias.size())
       << "Mismatching output size and bias terms array size.";
-  RTC_DCHECK_EQ(input_size_ * output_size_, weights_.size())
+  RTC_DCHECK_EQ(input_size_ * output_size_, weights.size())
       << "Mismatching input-output size and weight coefficients array size.";
 }
 
@@ -75,16 +104,12 @@ rtc::ArrayView<const float> FullyConnectedLayer::GetOutput() const {
 }
 
 void FullyConnectedLayer::ComputeOutput(rtc::ArrayView<const float> input) {
-  // TODO(bugs.chromium.org/9076): Optimize using SSE/AVX fused multiply-add
-  // operations.
+  RTC_DCHECK_EQ(input_size_, input.size());
   for (size_t o = 0; o < output_size_; ++o) {
-    output_[o] = bias_[o];
-    // TODO(bugs.chromium.org/9076): Benchmark how different layouts for
-    // |weights_| change the performance across different platforms.
-    for (size_t i = 0; i < input_size_; ++i) {
-      output_[o] += input[i] * weights_[i * output_size_ + o];
-    }
-    output_[o] = (*activation_function_)(kWeightsScale * output_[o]);
+    const float weighted_input = vector_math_.DotProduct(
+        input, {&weights_[o * input_size_], input_size_});
+    output_[o] =
+        (*activation_function_)(kWeightsScale * (bias_[o] + weighted_input));
   }
 }
 
@@ -94,21 +119,26 @@ GatedRecurrentLayer::GatedRecurrentLayer(
     const rtc::ArrayView<const int8_t> bias,
     const rtc::ArrayView<const int8_t> weights,
     const rtc::ArrayView<const int8_t> recurrent_weights,
-    float (*const activation_function)(float))
+    float (*const activation_function)(float),
+    Optimization optimization)
     : input_size_(input_size),
       output_size_(output_size),
-      bias_(bias),
-      weights_(weights),
-      recurrent_weights_(recurrent_weights),
-      activation_function_(activation_function) {
+      bias_(GetFloatBias(bias)),
+      weights_(GetTransposedFloatWeights(weights, input_size, output_size, 3)),
+      recurrent_weights_(GetTransposedFloatWeights(recurrent_weights,
+                                                   output_size,
+                                                   output_size,
+                                                   3)),
+      activation_function_(activation_function),
+      vector_math_(optimization) {
   RTC_DCHECK_LE(output_size_, kRecurrentLayersMaxUnits)
       << "Static over-allocation of recurrent layers state vectors is not "
       << "sufficient.";
-  RTC_DCHECK_EQ(3 * output_size_, bias_.size())
+  RTC_DCHECK_EQ(3 * output_size_, bias.size())
       << "Mismatching output size and bias terms array size.";
-  RTC_DCHECK_EQ(3 * input_size_ * output_size_, weights_.size())
+  RTC_DCHECK_EQ(3 * input_size_ * output_size_, weights.size())
       << "Mismatching input-output size and weight coefficients array size.";
-  RTC_DCHECK_EQ(3 * input_size_ * output_size_, recurrent_weights_.size())
+  RTC_DCHECK_EQ(3 * input_size_ * output_size_, recurrent_weights.size())
       << "Mismatching input-output size and recurrent weight coefficients array"
       << " size.";
   Reset();
@@ -125,56 +155,42 @@ void GatedRecurrentLayer::Reset() {
 }
 
 void GatedRecurrentLayer::ComputeOutput(rtc::ArrayView<const float> input) {
-  // TODO(bugs.chromium.org/9076): Optimize using SSE/AVX fused multiply-add
-  // operations.
-  // Stride and offset used to read parameter arrays.
-  const size_t stride = 3 * output_size_;
-  size_t offset = 0;
+  RTC_DCHECK_EQ(input_size_, input.size());
+  // Returns the biased and weighted sum of |input| and |state| for the output
+  // unit |o| of the gate |gate|.
+  const auto weighted_sum = [this, input](size_t gate, size_t o,
+                                          rtc::ArrayView<const float> state) {
+    const size_t unit = gate * output_size_ + o;
+    return bias_[unit] +
+           vector_math_.DotProduct(
+               input, {&weights_[unit * input_size_], input_size_}) +
+           vector_math_.DotProduct(
+               state, {&recurrent_weights_[unit * output_size_], output_size_});
+  };
+  const rtc::ArrayView<const float> state(state_.data(), output_size_);
 
   // Compute update gates.
   std::array<float, kRecurrentLayersMaxUnits> update;
   for (size_t o = 0; o < output_size_; ++o) {
-    update[o] = bias_[o];
-    // TODO(bugs.chromium.org/9076): Benchmark how different layouts for
-    // |weights_| and |recurrent_weights_| change the performance across
-    // different platforms.
-    for (size_t i = 0; i < input_size_; ++i) {  // Add input.
-      update[o] += input[i] * weights_[i * stride + o];
-    }
-    for (size_t s = 0; s < output_size_; ++s) {
-      update[o] += state_[s] * recurrent_weights_[s * stride + o];
-    }  // Add state.
-    update[o] = SigmoidApproximated(kWeightsScale * update[o]);
+    update[o] = SigmoidApproximated(kWeightsScale * weighted_sum(0, o, state));
   }
 
-  // Compute reset gates.
-  offset += output_size_;
+  // Compute reset gates and apply them to the state.
   std::array<float, kRecurrentLayersMaxUnits> reset;
   for (size_t o = 0; o < output_size_; ++o) {
-    reset[o] = bias_[offset + o];
-    for (size_t i = 0; i < input_size_; ++i) {  // Add input.
-      reset[o] += input[i] * weights_[offset + i * stride + o];
-    }
-    for (size_t s = 0; s < output_size_; ++s) {  // Add state.
-      reset[o] += state_[s] * recurrent_weights_[offset + s * stride + o];
-    }
-    reset[o] = SigmoidApproximated(kWeightsScale * reset[o]);
+    reset[o] = SigmoidApproximated(kWeightsScale * weighted_sum(1, o, state));
+  }
+  std::array<float, kRecurrentLayersMaxUnits> reset_state;
+  for (size_t s = 0; s < output_size_; ++s) {
+    reset_state[s] = state_[s] * reset[s];
   }
 
   // Compute output.
-  offset += output_size_;
   std::array<float, kRecurrentLayersMaxUnits> output;
   for (size_t o = 0; o < output_size_; ++o) {
-    output[o] = bias_[offset + o];
-    for (size_t i = 0; i < input_size_; ++i) {  // Add input.
-      output[o] += input[i] * weights_[offset + i * stride + o];
-    }
-    for (size_t s = 0; s < output_size_;
-         ++s) {  // Add state through reset gates.
-      output[o] +=
-          state_[s] * recurrent_weights_[offset + s * stride + o] * reset[s];
-    }
-    output[o] = (*activation_function_)(kWeightsScale * output[o]);
+    output[o] = (*activation_function_)(
+        kWeightsScale *
+        weighted_sum(2, o, {reset_state.data(), output_size_}));
     // Update output through the update gates.
     output[o] = update[o] * state_[o] + (1.f - update[o]) * output[o];
   }
@@ -184,23 +200,28 @@ void GatedRecurrentLayer::ComputeOutput(rtc::ArrayView<const float> input) {
   std::copy(output.begin(), output.end(), state_.begin());
 }
 
-RnnBasedVad::RnnBasedVad()
+RnnBasedVad::RnnBasedVad() : RnnBasedVad(DetectOptimization()) {}
+
+RnnBasedVad::RnnBasedVad(Optimization optimization)
     : input_layer_(kInputLayerInputSize,
                    kInputLayerOutputSize,
                    kInputDenseBias,
                    kInputDenseWeights,
-                   TansigApproximated),
+                   TansigApproximated,
+                   optimization),
       hidden_layer_(kInputLayerOutputSize,
                     kHiddenLayerOutputSize,
                     kHiddenGruBias,
                     kHiddenGruWeights,
                     kHiddenGruRecurrentWeights,
-                    RectifiedLinearUnit),
+                    RectifiedLinearUnit,
+                    optimization),
       output_layer_(kHiddenLayerOutputSize,
                     kOutputLayerOutputSize,
                     kOutputDenseBias,
                     kOutputDenseWeights,
-                    SigmoidApproximated) {
+                    SigmoidApproximated,
+                    optimization) {
   // Input-output chaining size checks.
   RTC_DCHECK_EQ(input_layer_.output_size(), hidden_layer_.input_size())
       << "The input and the hidden layers sizes do not match.";
@@ -14,9 +14,11 @@
 #include <stddef.h>
 #include <sys/types.h>
 #include <array>
+#include <vector>
 
 #include "api/array_view.h"
 #include "modules/audio_processing/agc2/rnn_vad/common.h"
+#include "modules/audio_processing/agc2/rnn_vad/vector_math.h"
 
 namespace webrtc {
 namespace rnn_vad {
@@ -33,14 +35,17 @@ constexpr size_t kFullyConnectedLayersMaxUnits = 24;
 // recurrent layer.
 constexpr size_t kRecurrentLayersMaxUnits = 24;
 
-// Fully-connected layer.
+// Fully-connected layer. The quantized parameters are converted to float once
+// on construction, with the weights of each output unit stored contiguously so
+// that the output is computed with one dot product per unit.
 class FullyConnectedLayer {
  public:
   FullyConnectedLayer(const size_t input_size,
                       const size_t output_size,
                       const rtc::ArrayView<const int8_t> bias,
                       const rtc::ArrayView<const int8_t> weights,
-                      float (*const activation_function)(float));
+                      float (*const activation_function)(float),
+                      Optimization optimization);
   FullyConnectedLayer(const FullyConnectedLayer&) = delete;
   FullyConnectedLayer& operator=(const FullyConnectedLayer&) = delete;
   ~FullyConnectedLayer();
@@ -53,15 +58,18 @@ class FullyConnectedLayer {
  private:
   const size_t input_size_;
   const size_t output_size_;
-  const rtc::ArrayView<const int8_t> bias_;
-  const rtc::ArrayView<const int8_t> weights_;
+  const std::vector<float> bias_;
+  // Weights of output unit |o| are at [o * input_size_, (o + 1) * input_size_).
+  const std::vector<float> weights_;
   float (*const activation_function_)(float);
+  const VectorMath vector_math_;
   // The output vector of a recurrent layer has length equal to |output_size_|.
   // However, for efficiency, over-allocation is used.
   std::array<float, kFullyConnectedLayersMaxUnits> output_;
 };
 
-// Recurrent layer with gated recurrent units (GRUs).
+// Recurrent layer with gated recurrent units (GRUs). Like FullyConnectedLayer,
+// the weights are converted to float and stored per gate and output unit.
 class GatedRecurrentLayer {
  public:
   GatedRecurrentLayer(const size_t input_size,
@@ -69,7 +77,8 @@ class GatedRecurrentLayer {
                       const rtc::ArrayView<const int8_t> bias,
                       const rtc::ArrayView<const int8_t> weights,
                       const rtc::ArrayView<const int8_t> recurrent_weights,
-                      float (*const activation_function)(float));
+                      float (*const activation_function)(float),
+                      Optimization optimization);
   GatedRecurrentLayer(const GatedRecurrentLayer&) = delete;
   GatedRecurrentLayer& operator=(const GatedRecurrentLayer&) = delete;
   ~GatedRecurrentLayer();
@@ -83,10 +92,14 @@ class GatedRecurrentLayer {
  private:
   const size_t input_size_;
   const size_t output_size_;
-  const rtc::ArrayView<const int8_t> bias_;
-  const rtc::ArrayView<const int8_t> weights_;
-  const rtc::ArrayView<const int8_t> recurrent_weights_;
+  const std::vector<float> bias_;
+  // Weights of output unit |o| of gate |g| (update, reset and output) start
+  // at (g * output_size_ + o) * input_size_ for |weights_| and at
+  // (g * output_size_ + o) * output_size_ for |recurrent_weights_|.
+  const std::vector<float> weights_;
+  const std::vector<float> recurrent_weights_;
   float (*const activation_function_)(float);
+  const VectorMath vector_math_;
   // The state vector of a recurrent layer has length equal to |output_size_|.
   // However, to avoid dynamic allocation, over-allocation is used.
   std::array<float, kRecurrentLayersMaxUnits> state_;
@@ -96,6 +109,7 @@ class GatedRecurrentLayer {
 class RnnBasedVad {
  public:
   RnnBasedVad();
+  explicit RnnBasedVad(Optimization optimization);
   RnnBasedVad(const RnnBasedVad&) = delete;
   RnnBasedVad& operator=(const RnnBasedVad&) = delete;
   ~RnnBasedVad();
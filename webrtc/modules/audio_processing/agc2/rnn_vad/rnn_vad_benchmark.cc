@@ -0,0 +1,161 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "api/array_view.h"
+#include "common_audio/resampler/push_sinc_resampler.h"
+#include "common_audio/wav_file.h"
+#include "modules/audio_processing/agc2/rnn_vad/common.h"
+#include "modules/audio_processing/agc2/rnn_vad/features_extraction.h"
+#include "modules/audio_processing/agc2/rnn_vad/rnn.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/flags.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/numerics/samples_stats_counter.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+namespace rnn_vad {
+namespace test {
+namespace {
+
+WEBRTC_DEFINE_string(i, "", "Path to the input wav file");
+std::string InputWavFile() {
+  return static_cast<std::string>(FLAG_i);
+}
+
+WEBRTC_DEFINE_int(iterations, 10, "Number of times the input is processed");
+
+WEBRTC_DEFINE_bool(help, false, "Prints this message");
+
+const char* OptimizationName(Optimization optimization) {
+  switch (optimization) {
+    case Optimization::kNone:
+      return "none";
+    case Optimization::kSse2:
+      return "sse2";
+    case Optimization::kNeon:
+      return "neon";
+  }
+  return "";
+}
+
+void LogStats(const char* stage, SamplesStatsCounter* frame_times_us) {
+  if (frame_times_us->IsEmpty())
+    return;
+  RTC_LOG(LS_INFO) << "  " << stage
+                   << " (us/frame): mean=" << frame_times_us->GetAverage()
+                   << " p50=" << frame_times_us->GetPercentile(0.5)
+                   << " p99=" << frame_times_us->GetPercentile(0.99)
+                   << " max=" << frame_times_us->GetMax();
+}
+
+// Times feature extraction and RNN inference separately for every 10 ms frame
+// of |samples_24kHz|.
+void Benchmark(Optimization optimization,
+               rtc::ArrayView<const float> samples_24kHz,
+               int iterations) {
+  const size_t num_frames = samples_24kHz.size() / kFrameSize10ms24kHz;
+  FeaturesExtractor features_extractor(optimization);
+  RnnBasedVad rnn_vad(optimization);
+  std::array<float, kFeatureVectorSize> feature_vector;
+  SamplesStatsCounter features_us;
+  SamplesStatsCounter rnn_us;
+  int64_t total_ns = 0;
+  for (int k = 0; k < iterations; ++k) {
+    features_extractor.Reset();
+    rnn_vad.Reset();
+    for (size_t i = 0; i < num_frames; ++i) {
+      const int64_t start_ns = rtc::TimeNanos();
+      bool is_silence = features_extractor.CheckSilenceComputeFeatures(
+          {&samples_24kHz[i * kFrameSize10ms24kHz], kFrameSize10ms24kHz},
+          feature_vector);
+      const int64_t features_ns = rtc::TimeNanos();
+      rnn_vad.ComputeVadProbability(feature_vector, is_silence);
+      const int64_t end_ns = rtc::TimeNanos();
+      features_us.AddSample(static_cast<double>(features_ns - start_ns) /
+                            rtc::kNumNanosecsPerMicrosec);
+      // Silent frames skip the RNN.
+      if (!is_silence) {
+        rnn_us.AddSample(static_cast<double>(end_ns - features_ns) /
+                         rtc::kNumNanosecsPerMicrosec);
+      }
+      total_ns += end_ns - start_ns;
+    }
+  }
+  const double audio_ns =
+      static_cast<double>(iterations) * num_frames * 10 *
+      rtc::kNumNanosecsPerMillisec;
+  RTC_LOG(LS_INFO) << "optimization: " << OptimizationName(optimization);
+  LogStats("features", &features_us);
+  LogStats("rnn", &rnn_us);
+  RTC_LOG(LS_INFO) << "  speed: " << audio_ns / std::max<int64_t>(total_ns, 1)
+                   << "x real time";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  rtc::LogMessage::LogToDebug(rtc::LS_INFO);
+  rtc::FlagList::SetFlagsFromCommandLine(&argc, argv, true);
+  if (FLAG_help) {
+    rtc::FlagList::Print(nullptr, false);
+    return 0;
+  }
+
+  // Open wav input file and check properties.
+  WavReader wav_reader(InputWavFile());
+  if (wav_reader.num_channels() != 1) {
+    RTC_LOG(LS_ERROR) << "Only mono wav files are supported";
+    return 1;
+  }
+  if (wav_reader.sample_rate() % 100 != 0) {
+    RTC_LOG(LS_ERROR) << "The sample rate rate must allow 10 ms frames.";
+    return 1;
+  }
+  if (FLAG_iterations < 1) {
+    RTC_LOG(LS_ERROR) << "The number of iterations must be positive.";
+    return 1;
+  }
+
+  // Resample the whole input upfront so that only the VAD is timed.
+  const size_t frame_size_10ms =
+      rtc::CheckedDivExact(wav_reader.sample_rate(), 100);
+  std::vector<float> samples_10ms(frame_size_10ms);
+  PushSincResampler resampler(frame_size_10ms, kFrameSize10ms24kHz);
+  std::vector<float> samples_24kHz;
+  while (wav_reader.ReadSamples(frame_size_10ms, samples_10ms.data()) ==
+         frame_size_10ms) {
+    samples_24kHz.resize(samples_24kHz.size() + kFrameSize10ms24kHz);
+    resampler.Resample(samples_10ms.data(), samples_10ms.size(),
+                       &samples_24kHz[samples_24kHz.size() -
+                                      kFrameSize10ms24kHz],
+                       kFrameSize10ms24kHz);
+  }
+  RTC_LOG(LS_INFO) << "Frames: " << samples_24kHz.size() / kFrameSize10ms24kHz
+                   << ", iterations: " << FLAG_iterations;
+
+  Benchmark(Optimization::kNone, samples_24kHz, FLAG_iterations);
+  if (DetectOptimization() != Optimization::kNone)
+    Benchmark(DetectOptimization(), samples_24kHz, FLAG_iterations);
+  return 0;
+}
+
+}  // namespace test
+}  // namespace rnn_vad
+}  // namespace webrtc
+
+int main(int argc, char* argv[]) {
+  return webrtc::rnn_vad::test::main(argc, argv);
+}
@@ -46,6 +46,13 @@ void ExpectNearAbsolute(rtc::ArrayView<const float> expected,
   }
 }
 
+std::vector<Optimization> GetOptimizationsToTest() {
+  std::vector<Optimization> optimizations = {Optimization::kNone};
+  if (DetectOptimization() != Optimization::kNone)
+    optimizations.push_back(DetectOptimization());
+  return optimizations;
+}
+
 std::unique_ptr<BinaryFileReader<float>> CreatePitchSearchTestDataReader() {
   constexpr size_t cols = 1396;
   return absl::make_unique<BinaryFileReader<float>>(
@@ -41,6 +41,9 @@ void ExpectNearAbsolute(rtc::ArrayView<const float> expected,
                         rtc::ArrayView<const float> computed,
                         float tolerance);
 
+// Returns the scalar implementation and, if available, the optimized one.
+std::vector<Optimization> GetOptimizationsToTest();
+
 // Reader for binary files consisting of an arbitrary long sequence of elements
 // having type T. It is possible to read and cast to another type D at once.
 template <typename T, typename D = T>
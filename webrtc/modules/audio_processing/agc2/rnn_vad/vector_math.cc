@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/agc2/rnn_vad/vector_math.h"
+
+// Defines WEBRTC_ARCH_X86_FAMILY, used below.
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include <emmintrin.h>
+#endif
+#include <numeric>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace rnn_vad {
+namespace {
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+float DotProductSse2(const float* x, const float* y, size_t size) {
+  const size_t vector_limit = size & ~static_cast<size_t>(3);
+  __m128 accumulator = _mm_setzero_ps();
+  for (size_t i = 0; i < vector_limit; i += 4) {
+    const __m128 x_i = _mm_loadu_ps(&x[i]);
+    const __m128 y_i = _mm_loadu_ps(&y[i]);
+    accumulator = _mm_add_ps(accumulator, _mm_mul_ps(x_i, y_i));
+  }
+  // Horizontal sum of the four partial sums.
+  accumulator =
+      _mm_add_ps(accumulator, _mm_movehl_ps(accumulator, accumulator));
+  accumulator = _mm_add_ss(
+      accumulator,
+      _mm_shuffle_ps(accumulator, accumulator, _MM_SHUFFLE(1, 1, 1, 1)));
+  float dot_product = _mm_cvtss_f32(accumulator);
+  for (size_t i = vector_limit; i < size; ++i) {
+    dot_product += x[i] * y[i];
+  }
+  return dot_product;
+}
+#endif
+
+#if defined(WEBRTC_HAS_NEON)
+float DotProductNeon(const float* x, const float* y, size_t size) {
+  const size_t vector_limit = size & ~static_cast<size_t>(3);
+  float32x4_t accumulator = vdupq_n_f32(0.f);
+  for (size_t i = 0; i < vector_limit; i += 4) {
+    accumulator = vmlaq_f32(accumulator, vld1q_f32(&x[i]), vld1q_f32(&y[i]));
+  }
+  // Horizontal sum of the four partial sums.
+  float32x2_t sum =
+      vadd_f32(vget_low_f32(accumulator), vget_high_f32(accumulator));
+  sum = vpadd_f32(sum, sum);
+  float dot_product = vget_lane_f32(sum, 0);
+  for (size_t i = vector_limit; i < size; ++i) {
+    dot_product += x[i] * y[i];
+  }
+  return dot_product;
+}
+#endif
+
+}  // namespace
+
+float VectorMath::DotProduct(rtc::ArrayView<const float> x,
+                             rtc::ArrayView<const float> y) const {
+  RTC_DCHECK_EQ(x.size(), y.size());
+  switch (optimization_) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    case Optimization::kSse2:
+      return DotProductSse2(x.data(), y.data(), x.size());
+#endif
+#if defined(WEBRTC_HAS_NEON)
+    case Optimization::kNeon:
+      return DotProductNeon(x.data(), y.data(), x.size());
+#endif
+    default:
+      return std::inner_product(x.begin(), x.end(), y.begin(), 0.f);
+  }
+}
+
+}  // namespace rnn_vad
+}  // namespace webrtc
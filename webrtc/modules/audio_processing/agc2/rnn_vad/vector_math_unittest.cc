@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/agc2/rnn_vad/vector_math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace rnn_vad {
+namespace test {
+namespace {
+
+std::vector<float> CreateRandomVector(size_t size, Random* random_generator) {
+  std::vector<float> v(size);
+  for (float& x : v)
+    x = 2.f * random_generator->Rand<float>() - 1.f;
+  return v;
+}
+
+}  // namespace
+
+TEST(RnnVadTest, DotProductOfOrthogonalAndOfOnesVectors) {
+  const VectorMath vector_math(DetectOptimization());
+  const std::vector<float> a = {1.f, 0.f, 1.f, 0.f, 1.f, 0.f, 1.f};
+  const std::vector<float> b = {0.f, 1.f, 0.f, 1.f, 0.f, 1.f, 0.f};
+  EXPECT_EQ(0.f, vector_math.DotProduct(a, b));
+  const std::vector<float> ones(19, 1.f);
+  EXPECT_EQ(19.f, vector_math.DotProduct(ones, ones));
+}
+
+// Checks that the optimized dot product matches the scalar one for sizes that
+// are and are not a multiple of the SIMD width, including the pitch buffer
+// frame size.
+TEST(RnnVadTest, OptimizedDotProductMatchesScalarVersion) {
+  const VectorMath scalar(Optimization::kNone);
+  const VectorMath optimized(DetectOptimization());
+  Random random_generator(42);
+  for (size_t size : {0, 1, 3, 4, 5, 24, 42, 480}) {
+    SCOPED_TRACE(size);
+    const std::vector<float> x = CreateRandomVector(size, &random_generator);
+    const std::vector<float> y = CreateRandomVector(size, &random_generator);
+    const float expected = scalar.DotProduct(x, y);
+    EXPECT_NEAR(expected, optimized.DotProduct(x, y),
+                1e-6f * std::max(1.f, std::fabs(expected)) * size);
+  }
+}
+
+}  // namespace test
+}  // namespace rnn_vad
+}  // namespace webrtc
@@ -35,9 +35,16 @@
 
 #include "modules/audio_processing/three_band_filter_bank.h"
 
+// Defines WEBRTC_ARCH_X86_FAMILY, used below.
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include <emmintrin.h>
+#endif
 #include <cmath>
 
 #include "rtc_base/checks.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
 
 namespace webrtc {
 namespace {
@@ -55,6 +62,14 @@ const size_t kSparsity = 4;
 //   3. The computation complexity also increases linearly with |kNumCoeffs|.
 const size_t kNumCoeffs = 4;
 
+// Number of polyphase filters, which is also the period of the cosines used
+// for modulation.
+const size_t kNumFilters = kNumBands * kSparsity;
+
+// The longest delay of a polyphase filter: the prototype filter upsampled by
+// |kSparsity|, delayed by up to |kSparsity| - 1 samples.
+const size_t kMemorySize = kSparsity * kNumCoeffs - 1;
+
 // The Matlab code to generate these |kLowpassCoeffs| is:
 //
 // N = kNumBands * kSparsity * kNumCoeffs - 1;
@@ -82,51 +97,211 @@ const float kLowpassCoeffs[kNumBands * kSparsity][kNumCoeffs] = {
     {+0.00994113f, +0.14989004f, -0.01585778f, -0.00173287f},
     {+0.00425496f, +0.16547118f, -0.00496888f, -0.00047749f}};
 
-// Downsamples |in| into |out|, taking one every |kNumbands| starting from
-// |offset|. |split_length| is the |out| length. |in| has to be at least
-// |kNumBands| * |split_length| long.
-void Downsample(const float* in,
-                size_t split_length,
-                size_t offset,
-                float* out) {
-  for (size_t i = 0; i < split_length; ++i) {
-    out[i] = in[kNumBands * i + offset];
+// Filters the |kNumBands| downsampled branches of the input in |in| with the
+// polyphase filters and modulates the result into the bands of |out|, for
+// the samples in [|begin|, |end|). Each branch in |in| is |stride| long and
+// starts with |kMemorySize| samples of the previous frame.
+void AnalyzeScalar(const float* in,
+                   size_t stride,
+                   const float* dct_modulation,
+                   size_t begin,
+                   size_t end,
+                   float* const* out) {
+  for (size_t n = begin; n < end; ++n) {
+    float sum[kNumBands] = {0.f, 0.f, 0.f};
+    for (size_t i = 0; i < kNumBands; ++i) {
+      const float* x = &in[i * stride + kMemorySize + n];
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t filter = i + j * kNumBands;
+        float filtered = 0.f;
+        for (size_t k = 0; k < kNumCoeffs; ++k) {
+          filtered += kLowpassCoeffs[filter][k] * *(x - k * kSparsity - j);
+        }
+        for (size_t band = 0; band < kNumBands; ++band) {
+          sum[band] += dct_modulation[filter * kNumBands + band] * filtered;
+        }
+      }
+    }
+    for (size_t band = 0; band < kNumBands; ++band) {
+      out[band][n] = sum[band];
+    }
+  }
+}
+
+// Modulates the |kNumBands| bands of |in| into the input of each polyphase
+// filter in |out|, for the samples in [|begin|, |end|). Each filter input in
+// |out| is |stride| long and starts with |kMemorySize| samples of the previous
+// frame.
+void ModulateScalar(const float* const* in,
+                    const float* dct_modulation,
+                    size_t stride,
+                    size_t begin,
+                    size_t end,
+                    float* out) {
+  for (size_t filter = 0; filter < kNumFilters; ++filter) {
+    float* y = &out[filter * stride + kMemorySize];
+    for (size_t n = begin; n < end; ++n) {
+      float sum = 0.f;
+      for (size_t band = 0; band < kNumBands; ++band) {
+        sum += dct_modulation[filter * kNumBands + band] * in[band][n];
+      }
+      y[n] = sum;
+    }
+  }
+}
+
+// Filters the modulated input of each polyphase filter in |in|, laid out as
+// by ModulateScalar(), and sums the filters of each band into |out|, for the
+// samples in [|begin|, |end|). The bands of |out| are |split_length| long.
+void SynthesizeScalar(const float* in,
+                      size_t stride,
+                      size_t split_length,
+                      size_t begin,
+                      size_t end,
+                      float* out) {
+  for (size_t i = 0; i < kNumBands; ++i) {
+    for (size_t n = begin; n < end; ++n) {
+      float sum = 0.f;
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t filter = i + j * kNumBands;
+        const float* x = &in[filter * stride + kMemorySize + n];
+        float filtered = 0.f;
+        for (size_t k = 0; k < kNumCoeffs; ++k) {
+          filtered += kLowpassCoeffs[filter][k] * *(x - k * kSparsity - j);
+        }
+        sum += kNumBands * filtered;
+      }
+      out[i * split_length + n] = sum;
+    }
+  }
+}
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// The SSE2 versions compute four consecutive samples at a time, with the same
+// operations in the same order as the scalar versions, which handle the
+// remaining samples.
+
+void AnalyzeSse2(const float* in,
+                 size_t stride,
+                 const float* dct_modulation,
+                 size_t split_length,
+                 float* const* out) {
+  const size_t vector_limit = split_length & ~static_cast<size_t>(3);
+  for (size_t n = 0; n < vector_limit; n += 4) {
+    __m128 sum[kNumBands] = {_mm_setzero_ps(), _mm_setzero_ps(),
+                             _mm_setzero_ps()};
+    for (size_t i = 0; i < kNumBands; ++i) {
+      const float* x = &in[i * stride + kMemorySize + n];
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t filter = i + j * kNumBands;
+        __m128 filtered = _mm_setzero_ps();
+        for (size_t k = 0; k < kNumCoeffs; ++k) {
+          const __m128 coeff = _mm_set1_ps(kLowpassCoeffs[filter][k]);
+          const __m128 x_k = _mm_loadu_ps(x - k * kSparsity - j);
+          filtered = _mm_add_ps(filtered, _mm_mul_ps(coeff, x_k));
+        }
+        for (size_t band = 0; band < kNumBands; ++band) {
+          const __m128 modulation =
+              _mm_set1_ps(dct_modulation[filter * kNumBands + band]);
+          sum[band] = _mm_add_ps(sum[band], _mm_mul_ps(modulation, filtered));
+        }
+      }
+    }
+    for (size_t band = 0; band < kNumBands; ++band) {
+      _mm_storeu_ps(&out[band][n], sum[band]);
+    }
+  }
+  AnalyzeScalar(in, stride, dct_modulation, vector_limit, split_length, out);
+}
+
+void ModulateSse2(const float* const* in,
+                  const float* dct_modulation,
+                  size_t stride,
+                  size_t split_length,
+                  float* out) {
+  const size_t vector_limit = split_length & ~static_cast<size_t>(3);
+  for (size_t filter = 0; filter < kNumFilters; ++filter) {
+    float* y = &out[filter * stride + kMemorySize];
+    for (size_t n = 0; n < vector_limit; n += 4) {
+      __m128 sum = _mm_setzero_ps();
+      for (size_t band = 0; band < kNumBands; ++band) {
+        const __m128 modulation =
+            _mm_set1_ps(dct_modulation[filter * kNumBands + band]);
+        const __m128 x = _mm_loadu_ps(&in[band][n]);
+        sum = _mm_add_ps(sum, _mm_mul_ps(modulation, x));
+      }
+      _mm_storeu_ps(&y[n], sum);
+    }
+  }
+  ModulateScalar(in, dct_modulation, stride, vector_limit, split_length, out);
+}
+
+void SynthesizeSse2(const float* in,
+                    size_t stride,
+                    size_t split_length,
+                    float* out) {
+  const size_t vector_limit = split_length & ~static_cast<size_t>(3);
+  const __m128 num_bands = _mm_set1_ps(kNumBands);
+  for (size_t i = 0; i < kNumBands; ++i) {
+    for (size_t n = 0; n < vector_limit; n += 4) {
+      __m128 sum = _mm_setzero_ps();
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t filter = i + j * kNumBands;
+        const float* x = &in[filter * stride + kMemorySize + n];
+        __m128 filtered = _mm_setzero_ps();
+        for (size_t k = 0; k < kNumCoeffs; ++k) {
+          const __m128 coeff = _mm_set1_ps(kLowpassCoeffs[filter][k]);
+          const __m128 x_k = _mm_loadu_ps(x - k * kSparsity - j);
+          filtered = _mm_add_ps(filtered, _mm_mul_ps(coeff, x_k));
+        }
+        sum = _mm_add_ps(sum, _mm_mul_ps(num_bands, filtered));
+      }
+      _mm_storeu_ps(&out[i * split_length + n], sum);
+    }
   }
+  SynthesizeScalar(in, stride, split_length, vector_limit, split_length, out);
 }
+#endif
 
-// Upsamples |in| into |out|, scaling by |kNumBands| and accumulating it every
-// |kNumBands| starting from |offset|. |split_length| is the |in| length. |out|
-// has to be at least |kNumBands| * |split_length| long.
-void Upsample(const float* in, size_t split_length, size_t offset, float* out) {
-  for (size_t i = 0; i < split_length; ++i) {
-    out[kNumBands * i + offset] += kNumBands * in[i];
+// Moves the last |kMemorySize| samples of each of the |num_rows| rows of
+// |buffer| to the start of the row, for use by the next frame. Each row is
+// |stride| long.
+void UpdateMemory(size_t stride, size_t num_rows, std::vector<float>* buffer) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    float* row = &(*buffer)[i * stride];
+    std::memmove(row, row + stride - kMemorySize, kMemorySize * sizeof(*row));
   }
 }
 
 }  // namespace
 
+ThreeBandFilterBank::Optimization ThreeBandFilterBank::DetectOptimization() {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2) != 0) {
+    return Optimization::kSse2;
+  }
+#endif
+  return Optimization::kNone;
+}
+
+ThreeBandFilterBank::ThreeBandFilterBank(size_t length)
+    : ThreeBandFilterBank(length, DetectOptimization()) {}
+
 // Because the low-pass filter prototype has half bandwidth it is possible to
 // use a DCT to shift it in both directions at the same time, to the center
 // frequencies [1 / 12, 3 / 12, 5 / 12].
-ThreeBandFilterBank::ThreeBandFilterBank(size_t length)
-    : in_buffer_(rtc::CheckedDivExact(length, kNumBands)),
-      out_buffer_(in_buffer_.size()) {
-  for (size_t i = 0; i < kSparsity; ++i) {
-    for (size_t j = 0; j < kNumBands; ++j) {
-      analysis_filters_.push_back(
-          std::unique_ptr<SparseFIRFilter>(new SparseFIRFilter(
-              kLowpassCoeffs[i * kNumBands + j], kNumCoeffs, kSparsity, i)));
-      synthesis_filters_.push_back(
-          std::unique_ptr<SparseFIRFilter>(new SparseFIRFilter(
-              kLowpassCoeffs[i * kNumBands + j], kNumCoeffs, kSparsity, i)));
-    }
-  }
-  dct_modulation_.resize(kNumBands * kSparsity);
-  for (size_t i = 0; i < dct_modulation_.size(); ++i) {
-    dct_modulation_[i].resize(kNumBands);
+ThreeBandFilterBank::ThreeBandFilterBank(size_t length,
+                                         Optimization optimization)
+    : optimization_(optimization),
+      split_length_(rtc::CheckedDivExact(length, kNumBands)),
+      analysis_input_(kNumBands * (kMemorySize + split_length_)),
+      synthesis_input_(kNumFilters * (kMemorySize + split_length_)),
+      synthesis_output_(kNumBands * split_length_),
+      dct_modulation_(kNumFilters * kNumBands) {
+  for (size_t i = 0; i < kNumFilters; ++i) {
     for (size_t j = 0; j < kNumBands; ++j) {
-      dct_modulation_[i][j] =
-          2.f * cos(2.f * M_PI * i * (2.f * j + 1.f) / dct_modulation_.size());
+      dct_modulation_[i * kNumBands + j] =
+          2.f * cos(2.f * M_PI * i * (2.f * j + 1.f) / kNumFilters);
     }
   }
 }
@@ -139,22 +314,30 @@ ThreeBandFilterBank::~ThreeBandFilterBank() = default;
 //      decomposition of the low-pass prototype filter and upsampled by a factor
 //      of |kSparsity|.
 //   3. Modulating with cosines and accumulating to get the desired band.
+// Steps 2 and 3 are done together, one output sample at a time.
 void ThreeBandFilterBank::Analysis(const float* in,
                                    size_t length,
                                    float* const* out) {
-  RTC_CHECK_EQ(in_buffer_.size(), rtc::CheckedDivExact(length, kNumBands));
+  RTC_CHECK_EQ(split_length_, rtc::CheckedDivExact(length, kNumBands));
+  const size_t stride = kMemorySize + split_length_;
   for (size_t i = 0; i < kNumBands; ++i) {
-    memset(out[i], 0, in_buffer_.size() * sizeof(*out[i]));
-  }
-  for (size_t i = 0; i < kNumBands; ++i) {
-    Downsample(in, in_buffer_.size(), kNumBands - i - 1, &in_buffer_[0]);
-    for (size_t j = 0; j < kSparsity; ++j) {
-      const size_t offset = i + j * kNumBands;
-      analysis_filters_[offset]->Filter(&in_buffer_[0], in_buffer_.size(),
-                                        &out_buffer_[0]);
-      DownModulate(&out_buffer_[0], out_buffer_.size(), offset, out);
+    float* branch = &analysis_input_[i * stride + kMemorySize];
+    for (size_t n = 0; n < split_length_; ++n) {
+      branch[n] = in[kNumBands * n + kNumBands - i - 1];
     }
   }
+  switch (optimization_) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    case Optimization::kSse2:
+      AnalyzeSse2(analysis_input_.data(), stride, dct_modulation_.data(),
+                  split_length_, out);
+      break;
+#endif
+    default:
+      AnalyzeScalar(analysis_input_.data(), stride, dct_modulation_.data(), 0,
+                    split_length_, out);
+  }
+  UpdateMemory(stride, kNumBands, &analysis_input_);
 }
 
 // The synthesis can be separated in these steps:
@@ -166,48 +349,30 @@ void ThreeBandFilterBank::Analysis(const float* in,
 void ThreeBandFilterBank::Synthesis(const float* const* in,
                                     size_t split_length,
                                     float* out) {
-  RTC_CHECK_EQ(in_buffer_.size(), split_length);
-  memset(out, 0, kNumBands * in_buffer_.size() * sizeof(*out));
-  for (size_t i = 0; i < kNumBands; ++i) {
-    for (size_t j = 0; j < kSparsity; ++j) {
-      const size_t offset = i + j * kNumBands;
-      UpModulate(in, in_buffer_.size(), offset, &in_buffer_[0]);
-      synthesis_filters_[offset]->Filter(&in_buffer_[0], in_buffer_.size(),
-                                         &out_buffer_[0]);
-      Upsample(&out_buffer_[0], out_buffer_.size(), i, out);
-    }
-  }
-}
-
-// Modulates |in| by |dct_modulation_| and accumulates it in each of the
-// |kNumBands| bands of |out|. |offset| is the index in the period of the
-// cosines used for modulation. |split_length| is the length of |in| and each
-// band of |out|.
-void ThreeBandFilterBank::DownModulate(const float* in,
-                                       size_t split_length,
-                                       size_t offset,
-                                       float* const* out) {
-  for (size_t i = 0; i < kNumBands; ++i) {
-    for (size_t j = 0; j < split_length; ++j) {
-      out[i][j] += dct_modulation_[offset][i] * in[j];
-    }
+  RTC_CHECK_EQ(split_length_, split_length);
+  const size_t stride = kMemorySize + split_length_;
+  switch (optimization_) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    case Optimization::kSse2:
+      ModulateSse2(in, dct_modulation_.data(), stride, split_length_,
+                   synthesis_input_.data());
+      SynthesizeSse2(synthesis_input_.data(), stride, split_length_,
+                     synthesis_output_.data());
+      break;
+#endif
+    default:
+      ModulateScalar(in, dct_modulation_.data(), stride, 0, split_length_,
+                     synthesis_input_.data());
+      SynthesizeScalar(synthesis_input_.data(), stride, split_length_, 0,
+                       split_length_, synthesis_output_.data());
   }
-}
-
-// Modulates each of the |kNumBands| bands of |in| by |dct_modulation_| and
-// accumulates them in |out|. |out| is cleared before starting to accumulate.
-// |offset| is the index in the period of the cosines used for modulation.
-// |split_length| is the length of each band of |in| and |out|.
-void ThreeBandFilterBank::UpModulate(const float* const* in,
-                                     size_t split_length,
-                                     size_t offset,
-                                     float* out) {
-  memset(out, 0, split_length * sizeof(*out));
   for (size_t i = 0; i < kNumBands; ++i) {
-    for (size_t j = 0; j < split_length; ++j) {
-      out[j] += dct_modulation_[offset][i] * in[i][j];
+    const float* band = &synthesis_output_[i * split_length_];
+    for (size_t n = 0; n < split_length_; ++n) {
+      out[kNumBands * n + i] = band[n];
     }
   }
+  UpdateMemory(stride, kNumFilters, &synthesis_input_);
 }
 
 }  // namespace webrtc
@@ -12,11 +12,8 @@
 #define MODULES_AUDIO_PROCESSING_THREE_BAND_FILTER_BANK_H_
 
 #include <cstring>
-#include <memory>
 #include <vector>
 
-#include "common_audio/sparse_fir_filter.h"
-
 namespace webrtc {
 
 // An implementation of a 3-band FIR filter-bank with DCT modulation, similar to
@@ -34,7 +31,15 @@ namespace webrtc {
 // depending on the input signal after compensating for the delay.
 class ThreeBandFilterBank final {
  public:
+  // Implementations of the filtering and modulation. They all produce the
+  // same output, bit by bit.
+  enum class Optimization { kNone, kSse2 };
+
+  // Returns the fastest implementation that the CPU supports.
+  static Optimization DetectOptimization();
+
   explicit ThreeBandFilterBank(size_t length);
+  ThreeBandFilterBank(size_t length, Optimization optimization);
   ~ThreeBandFilterBank();
 
   // Splits |in| into 3 downsampled frequency bands in |out|.
@@ -48,20 +53,18 @@ class ThreeBandFilterBank final {
   void Synthesis(const float* const* in, size_t split_length, float* out);
 
  private:
-  void DownModulate(const float* in,
-                    size_t split_length,
-                    size_t offset,
-                    float* const* out);
-  void UpModulate(const float* const* in,
-                  size_t split_length,
-                  size_t offset,
-                  float* out);
-
-  std::vector<float> in_buffer_;
-  std::vector<float> out_buffer_;
-  std::vector<std::unique_ptr<SparseFIRFilter>> analysis_filters_;
-  std::vector<std::unique_ptr<SparseFIRFilter>> synthesis_filters_;
-  std::vector<std::vector<float>> dct_modulation_;
+  const Optimization optimization_;
+  const size_t split_length_;
+  // The downsampled input of each polyphase branch for Analysis(), and the
+  // modulated input of each polyphase filter for Synthesis(). Each row starts
+  // with the last samples of the previous frame, which the filters need as
+  // their state.
+  std::vector<float> analysis_input_;
+  std::vector<float> synthesis_input_;
+  // The output of Synthesis() for each band, before upsampling.
+  std::vector<float> synthesis_output_;
+  // Indexed by polyphase filter, then by band.
+  std::vector<float> dct_modulation_;
 };
 
 }  // namespace webrtc
@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/three_band_filter_bank.h"
+
+// Defines WEBRTC_ARCH_X86_FAMILY, used below.
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+#include <string>
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+const size_t kNumBands = 3;
+// One 10 ms channel at 48 kHz.
+const size_t kFrameLength = 480;
+const size_t kSplitLength = kFrameLength / kNumBands;
+const int kNumFrames = 100000;
+
+// Reports the time, and on x86 the cycles, that one analysis and synthesis of
+// a frame takes with |optimization|.
+void MeasureFrameCost(ThreeBandFilterBank::Optimization optimization,
+                      const std::string& trace) {
+  ThreeBandFilterBank filter_bank(kFrameLength, optimization);
+  Random random_generator(42);
+  std::vector<float> in(kFrameLength);
+  for (float& sample : in) {
+    sample = random_generator.Rand(-32768, 32767);
+  }
+  std::vector<float> bands(kFrameLength);
+  float* band_pointers[kNumBands] = {&bands[0], &bands[kSplitLength],
+                                     &bands[2 * kSplitLength]};
+  std::vector<float> out(kFrameLength);
+
+  const int64_t start_ns = rtc::TimeNanos();
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  const uint64_t start_cycles = __rdtsc();
+#endif
+  for (int i = 0; i < kNumFrames; ++i) {
+    filter_bank.Analysis(in.data(), kFrameLength, band_pointers);
+    filter_bank.Synthesis(band_pointers, kSplitLength, out.data());
+  }
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  const uint64_t elapsed_cycles = __rdtsc() - start_cycles;
+  test::PrintResult("three_band_filter_bank", "", trace,
+                    static_cast<double>(elapsed_cycles) / kNumFrames,
+                    "cycles_per_frame", false);
+#endif
+  const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+  test::PrintResult("three_band_filter_bank", "", trace,
+                    static_cast<double>(elapsed_ns) / kNumFrames,
+                    "ns_per_frame", false);
+}
+
+}  // namespace
+
+TEST(ThreeBandFilterBankPerformanceTest, Reference) {
+  MeasureFrameCost(ThreeBandFilterBank::Optimization::kNone, "reference");
+}
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+TEST(ThreeBandFilterBankPerformanceTest, Sse2) {
+  MeasureFrameCost(ThreeBandFilterBank::Optimization::kSse2, "sse2");
+}
+#endif
+
+}  // namespace webrtc
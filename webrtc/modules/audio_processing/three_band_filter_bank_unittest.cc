@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/three_band_filter_bank.h"
+
+#include <vector>
+
+#include "rtc_base/arraysize.h"
+#include "rtc_base/random.h"
+#include "rtc_base/system/arch.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+const size_t kNumBands = 3;
+const int kNumFrames = 20;
+
+// Every |kGoldenOutputStride|-th value that Process() returns for 480 samples
+// per frame, computed with the filter bank before it had optimizations.
+const size_t kGoldenOutputStride = 193;
+const float kGoldenOutput[] = {
+    -89.5355225f, 17113.748f, 11508.3867f, -1602.79443f, 3242.18433f,
+    -7052.22607f, 1762.23389f, 9909.94141f, 1538.64551f, -8434.31836f,
+    -17111.9102f, -7857.50195f, 6018.61816f, -34936.3164f, -21342.5586f,
+    -13823.2334f, 14176.7617f, 6520.66211f, -28759.3262f, -11830.1357f,
+    -10094.4277f, -1807.97791f, -7966.98145f, 19652.5527f, -5559.98926f,
+    -18985.2852f, -7004.79785f, -6733.33496f, -15123.2715f, 17852.2305f,
+    4818.48242f, -864.328125f, -1297.39453f, 22738.0977f, 6783.75586f,
+    5765.87939f, 18195.0605f, -16358.9756f, 11751.1621f, -20019.3008f,
+    5594.91016f, -12806.5098f, 275.501953f, -17602.8965f, 27846.2773f,
+    -6160.2124f, 10248.4297f, 8947.92773f, 26314.1152f, -23242.6523f,
+    -8000.5415f, -1372.4729f, -1030.59839f, -9124.16992f, -3982.59009f,
+    7691.84082f, 14279.7422f, 1962.52393f, 18485.5273f, 8476.40234f,
+    10593.3896f, -6188.95117f, -1558.68848f, 390.474121f, -20164.2012f,
+    -9083.62207f, -8035.7002f, 56.7145996f, -28542.7324f, -11794.9033f,
+    3782.87402f, -3634.84033f, -17828.8516f, -1970.8291f, 15769.5156f,
+    1127.61072f, 1080.69348f, 6086.5459f, 29035.3125f, 13750.9658f, -4985.6416f,
+    17590.2012f, -2496.39258f, -12039.0664f, -12441.9863f, -6184.48438f,
+    12425.4893f, 3773.5498f, -23277.1211f, -18411.8457f, -15310.8174f,
+    3521.52417f, -8850.58105f, 23392.0156f, -15801.3789f, -1214.55054f,
+    6689.58594f, 2726.30225f, 16799.1426f, -8401.32617f,
+};
+
+// Runs |kNumFrames| frames of noise through the analysis and synthesis of
+// |filter_bank| and returns all the bands and the reconstructed signal, one
+// frame after the other.
+std::vector<float> Process(ThreeBandFilterBank* filter_bank, size_t length) {
+  const size_t split_length = length / kNumBands;
+  Random random_generator(42);
+  std::vector<float> in(length);
+  std::vector<float> bands(kNumBands * split_length);
+  float* band_pointers[kNumBands] = {&bands[0], &bands[split_length],
+                                     &bands[2 * split_length]};
+  std::vector<float> out(length);
+  std::vector<float> result;
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    for (float& sample : in) {
+      sample = random_generator.Rand(-32768, 32767);
+    }
+    filter_bank->Analysis(in.data(), length, band_pointers);
+    filter_bank->Synthesis(band_pointers, split_length, out.data());
+    result.insert(result.end(), bands.begin(), bands.end());
+    result.insert(result.end(), out.begin(), out.end());
+  }
+  return result;
+}
+
+void ExpectGoldenOutput(ThreeBandFilterBank::Optimization optimization) {
+  ThreeBandFilterBank filter_bank(480, optimization);
+  const std::vector<float> output = Process(&filter_bank, 480);
+  ASSERT_EQ(arraysize(kGoldenOutput),
+            (output.size() + kGoldenOutputStride - 1) / kGoldenOutputStride);
+  for (size_t i = 0; i < arraysize(kGoldenOutput); ++i) {
+    SCOPED_TRACE(i);
+    EXPECT_EQ(kGoldenOutput[i], output[i * kGoldenOutputStride]);
+  }
+}
+
+}  // namespace
+
+TEST(ThreeBandFilterBankTest, ReferenceMatchesGoldenOutput) {
+  ExpectGoldenOutput(ThreeBandFilterBank::Optimization::kNone);
+}
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+TEST(ThreeBandFilterBankTest, Sse2MatchesGoldenOutput) {
+  if (WebRtc_GetCPUInfo(kSSE2) != 0) {
+    ExpectGoldenOutput(ThreeBandFilterBank::Optimization::kSse2);
+  }
+}
+#endif
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Verifies that the SSE2 implementation is bitexact to the reference one,
+// including frames whose length isn't a multiple of the vector size and
+// frames shorter than the filter memory.
+TEST(ThreeBandFilterBankTest, TestOptimizations) {
+  if (WebRtc_GetCPUInfo(kSSE2) != 0) {
+    for (size_t length : {480, 159, 33, 6}) {
+      SCOPED_TRACE(length);
+      ThreeBandFilterBank reference(length,
+                                    ThreeBandFilterBank::Optimization::kNone);
+      ThreeBandFilterBank sse2(length,
+                               ThreeBandFilterBank::Optimization::kSse2);
+      EXPECT_EQ(Process(&reference, length), Process(&sse2, length));
+    }
+  }
+}
+#endif
+
+TEST(ThreeBandFilterBankTest, DetectedOptimizationIsBitexact) {
+  ThreeBandFilterBank reference(480, ThreeBandFilterBank::Optimization::kNone);
+  ThreeBandFilterBank detected(480);
+  EXPECT_EQ(Process(&reference, 480), Process(&detected, 480));
+}
+
+}  // namespace webrtc
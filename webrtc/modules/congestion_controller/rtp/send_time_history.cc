@@ -18,6 +18,10 @@
 #include "rtc_base/logging.h"
 
 namespace webrtc {
+namespace {
+// Enough for one second of packets at moderate rates; grown on demand.
+constexpr size_t kMinHistoryCapacity = 1024;
+}  // namespace
 
 SendTimeHistory::SendTimeHistory(int64_t packet_age_limit_ms)
     : packet_age_limit_ms_(packet_age_limit_ms) {}
@@ -27,21 +31,27 @@ SendTimeHistory::~SendTimeHistory() {}
 void SendTimeHistory::AddAndRemoveOld(const PacketFeedback& packet,
                                       int64_t at_time_ms) {
   // Remove old.
-  while (!history_.empty() &&
-         at_time_ms - history_.begin()->second.creation_time_ms >
-             packet_age_limit_ms_) {
-    // TODO(sprang): Warn if erasing (too many) old items?
-    RemovePacketBytes(history_.begin()->second);
-    history_.erase(history_.begin());
+  while (history_size_ > 0) {
+    const absl::optional<PacketFeedback>& front = history_[history_begin_];
+    if (front) {
+      if (at_time_ms - front->creation_time_ms <= packet_age_limit_ms_)
+        break;
+      // TODO(sprang): Warn if erasing (too many) old items?
+      RemovePacketBytes(*front);
+    }
+    EraseFront();
   }
 
   // Add new.
   int64_t unwrapped_seq_num = seq_num_unwrapper_.Unwrap(packet.sequence_number);
-  PacketFeedback packet_copy = packet;
-  packet_copy.long_sequence_number = unwrapped_seq_num;
-  history_.insert(std::make_pair(unwrapped_seq_num, packet_copy));
+  ExtendTo(unwrapped_seq_num);
+  absl::optional<PacketFeedback>& slot = Slot(unwrapped_seq_num);
+  if (slot)
+    return;
+  slot.emplace(packet);
+  slot->long_sequence_number = unwrapped_seq_num;
   if (packet.send_time_ms >= 0) {
-    AddPacketBytes(packet_copy);
+    AddPacketBytes(*slot);
     last_send_time_ms_ = std::max(last_send_time_ms_, packet.send_time_ms);
   }
 }
@@ -58,20 +68,20 @@ void SendTimeHistory::AddUntracked(size_t packet_size, int64_t send_time_ms) {
 bool SendTimeHistory::OnSentPacket(uint16_t sequence_number,
                                    int64_t send_time_ms) {
   int64_t unwrapped_seq_num = seq_num_unwrapper_.Unwrap(sequence_number);
-  auto it = history_.find(unwrapped_seq_num);
-  if (it == history_.end())
+  PacketFeedback* packet = FindPacket(unwrapped_seq_num);
+  if (!packet)
     return false;
-  bool packet_retransmit = it->second.send_time_ms >= 0;
-  it->second.send_time_ms = send_time_ms;
+  bool packet_retransmit = packet->send_time_ms >= 0;
+  packet->send_time_ms = send_time_ms;
   last_send_time_ms_ = std::max(last_send_time_ms_, send_time_ms);
   if (!packet_retransmit)
-    AddPacketBytes(it->second);
+    AddPacketBytes(*packet);
   if (pending_untracked_size_ > 0) {
     if (send_time_ms < last_untracked_send_time_ms_)
       RTC_LOG(LS_WARNING)
           << "appending acknowledged data for out of order packet. (Diff: "
           << last_untracked_send_time_ms_ - send_time_ms << " ms.)";
-    it->second.unacknowledged_data += pending_untracked_size_;
+    packet->unacknowledged_data += pending_untracked_size_;
     pending_untracked_size_ = 0;
   }
   return true;
@@ -82,9 +92,9 @@ absl::optional<PacketFeedback> SendTimeHistory::GetPacket(
   int64_t unwrapped_seq_num =
       seq_num_unwrapper_.UnwrapWithoutUpdate(sequence_number);
   absl::optional<PacketFeedback> optional_feedback;
-  auto it = history_.find(unwrapped_seq_num);
-  if (it != history_.end())
-    optional_feedback.emplace(it->second);
+  const PacketFeedback* packet = FindPacket(unwrapped_seq_num);
+  if (packet)
+    optional_feedback.emplace(*packet);
   return optional_feedback;
 }
 
@@ -95,17 +105,20 @@ bool SendTimeHistory::GetFeedback(PacketFeedback* packet_feedback,
       seq_num_unwrapper_.Unwrap(packet_feedback->sequence_number);
   UpdateAckedSeqNum(unwrapped_seq_num);
   RTC_DCHECK_GE(*last_ack_seq_num_, 0);
-  auto it = history_.find(unwrapped_seq_num);
-  if (it == history_.end())
+  PacketFeedback* packet = FindPacket(unwrapped_seq_num);
+  if (!packet)
     return false;
 
   // Save arrival_time not to overwrite it.
   int64_t arrival_time_ms = packet_feedback->arrival_time_ms;
-  *packet_feedback = it->second;
+  *packet_feedback = *packet;
   packet_feedback->arrival_time_ms = arrival_time_ms;
 
-  if (remove)
-    history_.erase(it);
+  if (remove) {
+    Slot(unwrapped_seq_num).reset();
+    while (history_size_ > 0 && !history_[history_begin_])
+      EraseFront();
+  }
   return true;
 }
 
@@ -122,11 +135,10 @@ DataSize SendTimeHistory::GetOutstandingData(uint16_t local_net_id,
 absl::optional<int64_t> SendTimeHistory::GetFirstUnackedSendTime() const {
   if (!last_ack_seq_num_)
     return absl::nullopt;
-  auto it = history_.find(*last_ack_seq_num_);
-  if (it == history_.end() ||
-      it->second.send_time_ms == PacketFeedback::kNoSendTime)
+  const PacketFeedback* packet = FindPacket(*last_ack_seq_num_);
+  if (!packet || packet->send_time_ms == PacketFeedback::kNoSendTime)
     return absl::nullopt;
-  return it->second.send_time_ms;
+  return packet->send_time_ms;
 }
 
 void SendTimeHistory::AddPacketBytes(const PacketFeedback& packet) {
@@ -158,14 +170,88 @@ void SendTimeHistory::UpdateAckedSeqNum(int64_t acked_seq_num) {
   if (last_ack_seq_num_ && *last_ack_seq_num_ >= acked_seq_num)
     return;
 
-  auto unacked_it = history_.begin();
+  int64_t unacked_seq_num = first_seq_num_;
   if (last_ack_seq_num_)
-    unacked_it = history_.lower_bound(*last_ack_seq_num_);
+    unacked_seq_num = std::max(unacked_seq_num, *last_ack_seq_num_);
 
-  auto newly_acked_end = history_.upper_bound(acked_seq_num);
-  for (; unacked_it != newly_acked_end; ++unacked_it) {
-    RemovePacketBytes(unacked_it->second);
+  const int64_t newly_acked_end = std::min<int64_t>(
+      acked_seq_num + 1, first_seq_num_ + static_cast<int64_t>(history_size_));
+  for (; unacked_seq_num < newly_acked_end; ++unacked_seq_num) {
+    const PacketFeedback* packet = FindPacket(unacked_seq_num);
+    if (packet)
+      RemovePacketBytes(*packet);
   }
   last_ack_seq_num_.emplace(acked_seq_num);
 }
+
+PacketFeedback* SendTimeHistory::FindPacket(int64_t unwrapped_seq_num) {
+  if (unwrapped_seq_num < first_seq_num_ ||
+      unwrapped_seq_num - first_seq_num_ >=
+          static_cast<int64_t>(history_size_)) {
+    return nullptr;
+  }
+  absl::optional<PacketFeedback>& slot = Slot(unwrapped_seq_num);
+  return slot ? &*slot : nullptr;
+}
+
+const PacketFeedback* SendTimeHistory::FindPacket(
+    int64_t unwrapped_seq_num) const {
+  return const_cast<SendTimeHistory*>(this)->FindPacket(unwrapped_seq_num);
+}
+
+absl::optional<PacketFeedback>& SendTimeHistory::Slot(
+    int64_t unwrapped_seq_num) {
+  RTC_DCHECK_GE(unwrapped_seq_num, first_seq_num_);
+  RTC_DCHECK_LT(unwrapped_seq_num - first_seq_num_, history_size_);
+  const size_t offset = static_cast<size_t>(unwrapped_seq_num - first_seq_num_);
+  return history_[(history_begin_ + offset) & (history_.size() - 1)];
+}
+
+void SendTimeHistory::ExtendTo(int64_t unwrapped_seq_num) {
+  if (history_size_ == 0) {
+    Reserve(1);
+    first_seq_num_ = unwrapped_seq_num;
+    history_size_ = 1;
+  } else if (unwrapped_seq_num < first_seq_num_) {
+    // Added out of order; open up empty slots in front of the first packet.
+    const size_t added =
+        static_cast<size_t>(first_seq_num_ - unwrapped_seq_num);
+    Reserve(history_size_ + added);
+    history_begin_ = (history_begin_ - added) & (history_.size() - 1);
+    first_seq_num_ = unwrapped_seq_num;
+    history_size_ += added;
+  } else if (unwrapped_seq_num - first_seq_num_ >=
+             static_cast<int64_t>(history_size_)) {
+    const size_t size =
+        static_cast<size_t>(unwrapped_seq_num - first_seq_num_) + 1;
+    Reserve(size);
+    history_size_ = size;
+  }
+}
+
+void SendTimeHistory::Reserve(size_t size) {
+  if (size <= history_.size())
+    return;
+  size_t capacity = std::max(history_.size(), kMinHistoryCapacity);
+  while (capacity < size)
+    capacity *= 2;
+  // Slots outside of the used range are always empty, so only the used range
+  // needs to be moved over.
+  std::vector<absl::optional<PacketFeedback>> history(capacity);
+  for (size_t i = 0; i < history_size_; ++i) {
+    history[i] =
+        std::move(history_[(history_begin_ + i) & (history_.size() - 1)]);
+  }
+  history_.swap(history);
+  history_begin_ = 0;
+}
+
+void SendTimeHistory::EraseFront() {
+  RTC_DCHECK_GT(history_size_, 0);
+  history_[history_begin_].reset();
+  history_begin_ = (history_begin_ + 1) & (history_.size() - 1);
+  ++first_seq_num_;
+  --history_size_;
+}
+
 }  // namespace webrtc
@@ -13,14 +13,20 @@
 
 #include <map>
 #include <utility>
+#include <vector>
 
+#include "absl/types/optional.h"
 #include "api/units/data_size.h"
 #include "modules/include/module_common_types.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "rtc_base/constructor_magic.h"
 
 namespace webrtc {
-struct PacketFeedback;
 
+// Packets are stored in a ring buffer indexed by unwrapped transport sequence
+// number. Transport sequence numbers are assigned consecutively, so lookups
+// are constant time and the buffer stops allocating once it has grown to hold
+// |packet_age_limit_ms| worth of packets.
 class SendTimeHistory {
  public:
   explicit SendTimeHistory(int64_t packet_age_limit_ms);
@@ -54,12 +60,28 @@ class SendTimeHistory {
   void AddPacketBytes(const PacketFeedback& packet);
   void RemovePacketBytes(const PacketFeedback& packet);
   void UpdateAckedSeqNum(int64_t acked_seq_num);
+
+  // Returns the packet stored for |unwrapped_seq_num|, or null if none is.
+  PacketFeedback* FindPacket(int64_t unwrapped_seq_num);
+  const PacketFeedback* FindPacket(int64_t unwrapped_seq_num) const;
+  absl::optional<PacketFeedback>& Slot(int64_t unwrapped_seq_num);
+  // Grows the used range of the ring so that it covers |unwrapped_seq_num|.
+  void ExtendTo(int64_t unwrapped_seq_num);
+  void Reserve(size_t size);
+  void EraseFront();
+
   const int64_t packet_age_limit_ms_;
   size_t pending_untracked_size_ = 0;
   int64_t last_send_time_ms_ = -1;
   int64_t last_untracked_send_time_ms_ = -1;
   SequenceNumberUnwrapper seq_num_unwrapper_;
-  std::map<int64_t, PacketFeedback> history_;
+  // |history_| holds |history_size_| slots starting at index |history_begin_|
+  // (modulo its power of two size). The first slot is for |first_seq_num_|.
+  // Slots of packets that were never added or already removed are empty.
+  std::vector<absl::optional<PacketFeedback>> history_;
+  size_t history_begin_ = 0;
+  size_t history_size_ = 0;
+  int64_t first_seq_num_ = 0;
   absl::optional<int64_t> last_ack_seq_num_;
   std::map<RemoteAndLocalNetworkId, size_t> in_flight_bytes_;
 
@@ -222,6 +222,35 @@ TEST_F(SendTimeHistoryTest, HistorySizeWithWraparound) {
   EXPECT_TRUE(history_.GetFeedback(&packet10, false));
 }
 
+TEST_F(SendTimeHistoryTest, KeepsPacketsAddedOutOfOrderAndAfterGaps) {
+  const uint16_t kMaxSeqNo = std::numeric_limits<uint16_t>::max();
+  AddPacketWithSendTime(kMaxSeqNo, 100, 0, PacedPacketInfo());
+  // Leaves a gap before the wrapped sequence number.
+  AddPacketWithSendTime(5, 200, 1, PacedPacketInfo());
+  // Added before the first packet in the history.
+  AddPacketWithSendTime(kMaxSeqNo - 3, 300, 2, PacedPacketInfo());
+  // Grows the history well past its initial capacity.
+  for (uint16_t i = 6; i < 5000; ++i)
+    AddPacketWithSendTime(i, 10, 3, PacedPacketInfo());
+
+  PacketFeedback packet(0, static_cast<uint16_t>(kMaxSeqNo - 3));
+  EXPECT_TRUE(history_.GetFeedback(&packet, false));
+  EXPECT_EQ(300u, packet.payload_size);
+  PacketFeedback packet2(0, kMaxSeqNo);
+  EXPECT_TRUE(history_.GetFeedback(&packet2, false));
+  EXPECT_EQ(100u, packet2.payload_size);
+  PacketFeedback packet3(0, 0);
+  EXPECT_FALSE(history_.GetFeedback(&packet3, false));
+  PacketFeedback packet4(0, 5);
+  EXPECT_TRUE(history_.GetFeedback(&packet4, false));
+  EXPECT_EQ(200u, packet4.payload_size);
+  EXPECT_EQ(packet2.long_sequence_number + 6, packet4.long_sequence_number);
+  PacketFeedback packet5(0, 4999);
+  EXPECT_TRUE(history_.GetFeedback(&packet5, true));
+  EXPECT_EQ(10u, packet5.payload_size);
+  EXPECT_FALSE(history_.GetFeedback(&packet5, false));
+}
+
 TEST_F(SendTimeHistoryTest, InterlievedGetAndRemove) {
   const uint16_t kSeqNo = 1;
   const int64_t kTimestamp = 2;
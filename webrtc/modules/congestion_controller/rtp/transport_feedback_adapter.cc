@@ -39,6 +39,19 @@ PacketResult NetworkPacketFeedbackFromRtpPacketFeedback(
       DataSize::bytes(pf.unacknowledged_data);
   return feedback;
 }
+
+void AppendPacketFeedback(const PacketFeedback& rtp_feedback,
+                          TransportPacketsFeedback* msg) {
+  if (rtp_feedback.send_time_ms != PacketFeedback::kNoSendTime) {
+    msg->packet_feedbacks.push_back(
+        NetworkPacketFeedbackFromRtpPacketFeedback(rtp_feedback));
+  } else if (rtp_feedback.arrival_time_ms == PacketFeedback::kNotReceived) {
+    msg->sendless_arrival_times.push_back(Timestamp::PlusInfinity());
+  } else {
+    msg->sendless_arrival_times.push_back(
+        Timestamp::ms(rtp_feedback.arrival_time_ms));
+  }
+}
 }  // namespace
 const int64_t kNoTimestamp = -1;
 const int64_t kSendTimeHistoryWindowMs = 60000;
@@ -125,43 +138,29 @@ absl::optional<TransportPacketsFeedback>
 TransportFeedbackAdapter::ProcessTransportFeedback(
     const rtcp::TransportFeedback& feedback,
     Timestamp feedback_receive_time) {
-  DataSize prior_in_flight = GetOutstandingData();
-
-  last_packet_feedback_vector_ =
-      GetPacketFeedbackVector(feedback, feedback_receive_time);
-  {
-    rtc::CritScope cs(&observers_lock_);
-    for (auto* observer : observers_) {
-      observer->OnPacketFeedbackVector(last_packet_feedback_vector_);
-    }
-  }
-
-  std::vector<PacketFeedback> feedback_vector = last_packet_feedback_vector_;
-  if (feedback_vector.empty())
-    return absl::nullopt;
-
   TransportPacketsFeedback msg;
-  for (const PacketFeedback& rtp_feedback : feedback_vector) {
-    if (rtp_feedback.send_time_ms != PacketFeedback::kNoSendTime) {
-      auto feedback = NetworkPacketFeedbackFromRtpPacketFeedback(rtp_feedback);
-      msg.packet_feedbacks.push_back(feedback);
-    } else if (rtp_feedback.arrival_time_ms == PacketFeedback::kNotReceived) {
-      msg.sendless_arrival_times.push_back(Timestamp::PlusInfinity());
-    } else {
-      msg.sendless_arrival_times.push_back(
-          Timestamp::ms(rtp_feedback.arrival_time_ms));
-    }
-  }
   {
     rtc::CritScope cs(&lock_);
+    msg.prior_in_flight =
+        send_time_history_.GetOutstandingData(local_net_id_, remote_net_id_);
+    ProcessPacketFeedback(feedback, feedback_receive_time, &msg);
     absl::optional<int64_t> first_unacked_send_time_ms =
         send_time_history_.GetFirstUnackedSendTime();
     if (first_unacked_send_time_ms)
       msg.first_unacked_send_time = Timestamp::ms(*first_unacked_send_time_ms);
+    msg.data_in_flight =
+        send_time_history_.GetOutstandingData(local_net_id_, remote_net_id_);
   }
+  {
+    rtc::CritScope cs(&observers_lock_);
+    for (auto* observer : observers_) {
+      observer->OnPacketFeedbackVector(last_packet_feedback_vector_);
+    }
+  }
+
+  if (last_packet_feedback_vector_.empty())
+    return absl::nullopt;
   msg.feedback_time = feedback_receive_time;
-  msg.prior_in_flight = prior_in_flight;
-  msg.data_in_flight = GetOutstandingData();
   return msg;
 }
 
@@ -177,9 +176,10 @@ DataSize TransportFeedbackAdapter::GetOutstandingData() const {
   return send_time_history_.GetOutstandingData(local_net_id_, remote_net_id_);
 }
 
-std::vector<PacketFeedback> TransportFeedbackAdapter::GetPacketFeedbackVector(
+void TransportFeedbackAdapter::ProcessPacketFeedback(
     const rtcp::TransportFeedback& feedback,
-    Timestamp feedback_time) {
+    Timestamp feedback_time,
+    TransportPacketsFeedback* msg) {
   int64_t timestamp_us = feedback.GetBaseTimeUs();
 
   // Add timestamp deltas to a local time base selected on first packet arrival.
@@ -201,54 +201,55 @@ std::vector<PacketFeedback> TransportFeedbackAdapter::GetPacketFeedbackVector(
   }
   last_timestamp_us_ = timestamp_us;
 
-  std::vector<PacketFeedback> packet_feedback_vector;
+  // Clearing keeps the capacity, so steady state feedback does not allocate
+  // here.
+  last_packet_feedback_vector_.clear();
   if (feedback.GetPacketStatusCount() == 0) {
     RTC_LOG(LS_INFO) << "Empty transport feedback packet received.";
-    return packet_feedback_vector;
+    return;
   }
-  packet_feedback_vector.reserve(feedback.GetPacketStatusCount());
-  {
-    rtc::CritScope cs(&lock_);
-    size_t failed_lookups = 0;
-    int64_t offset_us = 0;
-    int64_t timestamp_ms = 0;
-    uint16_t seq_num = feedback.GetBaseSequence();
-    for (const auto& packet : feedback.GetReceivedPackets()) {
-      // Insert into the vector those unreceived packets which precede this
-      // iteration's received packet.
-      for (; seq_num != packet.sequence_number(); ++seq_num) {
-        PacketFeedback packet_feedback(PacketFeedback::kNotReceived, seq_num);
-        // Note: Element not removed from history because it might be reported
-        // as received by another feedback.
-        if (!send_time_history_.GetFeedback(&packet_feedback, false))
-          ++failed_lookups;
-        if (packet_feedback.local_net_id == local_net_id_ &&
-            packet_feedback.remote_net_id == remote_net_id_) {
-          packet_feedback_vector.push_back(packet_feedback);
-        }
-      }
-
-      // Handle this iteration's received packet.
-      offset_us += packet.delta_us();
-      timestamp_ms = current_offset_ms_ + (offset_us / 1000);
-      PacketFeedback packet_feedback(timestamp_ms, packet.sequence_number());
-      if (!send_time_history_.GetFeedback(&packet_feedback, true))
+  last_packet_feedback_vector_.reserve(feedback.GetPacketStatusCount());
+  msg->packet_feedbacks.reserve(feedback.GetPacketStatusCount());
+  size_t failed_lookups = 0;
+  int64_t offset_us = 0;
+  int64_t timestamp_ms = 0;
+  uint16_t seq_num = feedback.GetBaseSequence();
+  for (const auto& packet : feedback.GetReceivedPackets()) {
+    // Insert into the vector those unreceived packets which precede this
+    // iteration's received packet.
+    for (; seq_num != packet.sequence_number(); ++seq_num) {
+      PacketFeedback packet_feedback(PacketFeedback::kNotReceived, seq_num);
+      // Note: Element not removed from history because it might be reported
+      // as received by another feedback.
+      if (!send_time_history_.GetFeedback(&packet_feedback, false))
         ++failed_lookups;
       if (packet_feedback.local_net_id == local_net_id_ &&
           packet_feedback.remote_net_id == remote_net_id_) {
-        packet_feedback_vector.push_back(packet_feedback);
+        last_packet_feedback_vector_.push_back(packet_feedback);
+        AppendPacketFeedback(packet_feedback, msg);
       }
-
-      ++seq_num;
     }
 
-    if (failed_lookups > 0) {
-      RTC_LOG(LS_WARNING) << "Failed to lookup send time for " << failed_lookups
-                          << " packet" << (failed_lookups > 1 ? "s" : "")
-                          << ". Send time history too small?";
+    // Handle this iteration's received packet.
+    offset_us += packet.delta_us();
+    timestamp_ms = current_offset_ms_ + (offset_us / 1000);
+    PacketFeedback packet_feedback(timestamp_ms, packet.sequence_number());
+    if (!send_time_history_.GetFeedback(&packet_feedback, true))
+      ++failed_lookups;
+    if (packet_feedback.local_net_id == local_net_id_ &&
+        packet_feedback.remote_net_id == remote_net_id_) {
+      last_packet_feedback_vector_.push_back(packet_feedback);
+      AppendPacketFeedback(packet_feedback, msg);
     }
+
+    ++seq_num;
+  }
+
+  if (failed_lookups > 0) {
+    RTC_LOG(LS_WARNING) << "Failed to lookup send time for " << failed_lookups
+                        << " packet" << (failed_lookups > 1 ? "s" : "")
+                        << ". Send time history too small?";
   }
-  return packet_feedback_vector;
 }
 
 std::vector<PacketFeedback>
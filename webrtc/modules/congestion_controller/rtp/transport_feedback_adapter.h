@@ -59,9 +59,13 @@ class TransportFeedbackAdapter {
  private:
   void OnTransportFeedback(const rtcp::TransportFeedback& feedback);
 
-  std::vector<PacketFeedback> GetPacketFeedbackVector(
-      const rtcp::TransportFeedback& feedback,
-      Timestamp feedback_time);
+  // Looks up the packets reported by |feedback| in a single pass. The result is
+  // stored in |last_packet_feedback_vector_| and, for packets on the current
+  // network route, appended to |msg|.
+  void ProcessPacketFeedback(const rtcp::TransportFeedback& feedback,
+                             Timestamp feedback_time,
+                             TransportPacketsFeedback* msg)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(&lock_);
 
   rtc::CriticalSection lock_;
   SendTimeHistory send_time_history_ RTC_GUARDED_BY(&lock_);
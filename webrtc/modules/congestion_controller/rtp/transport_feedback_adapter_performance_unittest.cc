@@ -0,0 +1,168 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "api/transport/network_types.h"
+#include "modules/congestion_controller/rtp/send_time_history.h"
+#include "modules/congestion_controller/rtp/transport_feedback_adapter.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
+#include "rtc_base/network/sent_packet.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+// 1200 byte packets at 50 Mbps, i.e. about 5200 packets per second, for one
+// minute. Transport feedback arrives every 50 ms over a 20 ms one way delay.
+constexpr size_t kPacketSize = 1200;
+constexpr int64_t kSendIntervalUs = 192;
+constexpr int kNumPackets = 60 * rtc::kNumMicrosecsPerSec / kSendIntervalUs;
+constexpr int64_t kFeedbackIntervalUs = 50000;
+constexpr int64_t kOneWayDelayUs = 20000;
+constexpr int64_t kHistoryWindowMs = 60000;
+constexpr uint32_t kSsrc = 8492;
+
+int64_t SendTimeUs(int packet_index) {
+  return packet_index * kSendIntervalUs;
+}
+
+uint16_t SequenceNumber(int packet_index) {
+  return static_cast<uint16_t>(packet_index);
+}
+
+// Transport feedback reporting packets [first_packet, end_packet), received
+// once |num_packets_sent| packets have been sent.
+struct TraceFeedback {
+  int num_packets_sent;
+  int first_packet;
+  int end_packet;
+  int64_t feedback_time_us;
+  rtcp::TransportFeedback feedback;
+};
+
+std::vector<TraceFeedback> CreateTrace() {
+  std::vector<TraceFeedback> trace;
+  int first_unreported = 0;
+  for (int64_t now_us = kFeedbackIntervalUs; first_unreported < kNumPackets;
+       now_us += kFeedbackIntervalUs) {
+    const int num_sent = static_cast<int>(std::min<int64_t>(
+        kNumPackets, (now_us + kSendIntervalUs - 1) / kSendIntervalUs));
+    const int num_received = static_cast<int>(std::min<int64_t>(
+        num_sent, (now_us - kOneWayDelayUs) / kSendIntervalUs + 1));
+    if (num_received <= first_unreported)
+      continue;
+    trace.emplace_back();
+    TraceFeedback& entry = trace.back();
+    entry.num_packets_sent = num_sent;
+    entry.first_packet = first_unreported;
+    entry.end_packet = num_received;
+    entry.feedback_time_us = now_us;
+    entry.feedback.SetBase(SequenceNumber(first_unreported),
+                           SendTimeUs(first_unreported) + kOneWayDelayUs);
+    for (int i = first_unreported; i < num_received; ++i) {
+      EXPECT_TRUE(entry.feedback.AddReceivedPacket(
+          SequenceNumber(i), SendTimeUs(i) + kOneWayDelayUs));
+    }
+    first_unreported = num_received;
+  }
+  return trace;
+}
+
+double PacketsPerSecond(int64_t elapsed_ns) {
+  return static_cast<double>(kNumPackets) * rtc::kNumNanosecsPerSec /
+         std::max<int64_t>(elapsed_ns, 1);
+}
+
+// Adds each packet of the trace to a SendTimeHistory and looks it up again
+// when it is reported, and returns the achieved rate in packets per second.
+double MeasureSendTimeHistory(const std::vector<TraceFeedback>& trace) {
+  SendTimeHistory history(kHistoryWindowMs);
+  int num_found = 0;
+  auto lookup = [&](const TraceFeedback& entry) {
+    for (int i = entry.first_packet; i < entry.end_packet; ++i) {
+      PacketFeedback packet((SendTimeUs(i) + kOneWayDelayUs) / 1000,
+                            SequenceNumber(i));
+      if (history.GetFeedback(&packet, /*remove=*/true))
+        ++num_found;
+    }
+  };
+
+  const int64_t start_ns = rtc::TimeNanos();
+  auto next = trace.begin();
+  for (int i = 0; i < kNumPackets; ++i) {
+    for (; next != trace.end() && next->num_packets_sent == i; ++next)
+      lookup(*next);
+    const int64_t send_time_ms = SendTimeUs(i) / 1000;
+    history.AddAndRemoveOld(PacketFeedback(send_time_ms, SequenceNumber(i),
+                                           kPacketSize, 0, 0,
+                                           PacedPacketInfo()),
+                            send_time_ms);
+    history.OnSentPacket(SequenceNumber(i), send_time_ms);
+  }
+  for (; next != trace.end(); ++next)
+    lookup(*next);
+  const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+
+  EXPECT_EQ(kNumPackets, num_found);
+  return PacketsPerSecond(elapsed_ns);
+}
+
+// Sends each packet of the trace through a TransportFeedbackAdapter and
+// processes the feedback, and returns the achieved rate in packets per second.
+double MeasureTransportFeedbackAdapter(
+    const std::vector<TraceFeedback>& trace) {
+  TransportFeedbackAdapter adapter;
+  size_t num_reported = 0;
+  auto process = [&](const TraceFeedback& entry) {
+    absl::optional<TransportPacketsFeedback> msg =
+        adapter.ProcessTransportFeedback(
+            entry.feedback, Timestamp::us(entry.feedback_time_us));
+    if (msg)
+      num_reported += msg->packet_feedbacks.size();
+  };
+
+  const int64_t start_ns = rtc::TimeNanos();
+  auto next = trace.begin();
+  for (int i = 0; i < kNumPackets; ++i) {
+    for (; next != trace.end() && next->num_packets_sent == i; ++next)
+      process(*next);
+    adapter.AddPacket(kSsrc, SequenceNumber(i), kPacketSize, PacedPacketInfo(),
+                      Timestamp::us(SendTimeUs(i)));
+    adapter.ProcessSentPacket(
+        rtc::SentPacket(SequenceNumber(i), SendTimeUs(i) / 1000));
+  }
+  for (; next != trace.end(); ++next)
+    process(*next);
+  const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+
+  EXPECT_EQ(static_cast<size_t>(kNumPackets), num_reported);
+  return PacketsPerSecond(elapsed_ns);
+}
+
+}  // namespace
+
+TEST(TransportFeedbackAdapterPerformanceTest, SendTimeHistoryAddAndLookup) {
+  test::PrintResult("send_time_history", "", "50_mbps",
+                    MeasureSendTimeHistory(CreateTrace()),
+                    "packets_per_second", true);
+}
+
+TEST(TransportFeedbackAdapterPerformanceTest, ProcessTransportFeedback) {
+  test::PrintResult("transport_feedback_adapter", "", "50_mbps",
+                    MeasureTransportFeedbackAdapter(CreateTrace()),
+                    "packets_per_second", true);
+}
+
+}  // namespace webrtc
@@ -162,6 +162,49 @@ TEST_F(TransportFeedbackAdapterTest, AdaptsFeedbackAndPopulatesSendTimes) {
   ComparePacketFeedbackVectors(packets, adapter_->GetTransportFeedbackVector());
 }
 
+TEST_F(TransportFeedbackAdapterTest, HandlesHighRateFeedbackAcrossWraparound) {
+  // 50 Mbps of 1200 byte packets with feedback every 50 ms. Enough feedback
+  // is sent for the transport sequence number to wrap.
+  const int kPacketsPerFeedback = 260;
+  const int kNumFeedbacks = 300;
+  const int64_t kPacketIntervalUs = 192;
+  const int64_t kPropagationDelayUs = 30000;
+  uint16_t seq_num = 0;
+  int64_t expected_long_seq_num = 0;
+  for (int i = 0; i < kNumFeedbacks; ++i) {
+    rtcp::TransportFeedback feedback;
+    for (int j = 0; j < kPacketsPerFeedback; ++j) {
+      const int64_t send_time_us = clock_.TimeInMicroseconds();
+      const int64_t arrival_time_us = send_time_us + kPropagationDelayUs;
+      OnSentPacket(PacketFeedback(arrival_time_us / 1000, send_time_us / 1000,
+                                  seq_num, 1200, kPacingInfo0));
+      if (j == 0)
+        feedback.SetBase(seq_num, arrival_time_us);
+      // Every tenth packet is lost.
+      if (j % 10 != 5)
+        EXPECT_TRUE(feedback.AddReceivedPacket(seq_num, arrival_time_us));
+      ++seq_num;
+      clock_.AdvanceTimeMicroseconds(kPacketIntervalUs);
+    }
+
+    absl::optional<TransportPacketsFeedback> msg =
+        adapter_->ProcessTransportFeedback(
+            feedback, Timestamp::ms(clock_.TimeInMilliseconds()));
+    ASSERT_TRUE(msg);
+    ASSERT_EQ(static_cast<size_t>(kPacketsPerFeedback),
+              msg->packet_feedbacks.size());
+    EXPECT_EQ(static_cast<size_t>(kPacketsPerFeedback / 10),
+              msg->LostWithSendInfo().size());
+    EXPECT_TRUE(msg->sendless_arrival_times.empty());
+    EXPECT_EQ(expected_long_seq_num,
+              msg->packet_feedbacks.front().sent_packet.sequence_number);
+    EXPECT_EQ(DataSize::Zero(), msg->data_in_flight);
+    EXPECT_EQ(static_cast<size_t>(kPacketsPerFeedback),
+              adapter_->GetTransportFeedbackVector().size());
+    expected_long_seq_num += kPacketsPerFeedback;
+  }
+}
+
 TEST_F(TransportFeedbackAdapterTest, FeedbackVectorReportsUnreceived) {
   std::vector<PacketFeedback> sent_packets = {
       PacketFeedback(100, 220, 0, 1500, kPacingInfo0),
@@ -0,0 +1,241 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "modules/congestion_controller/test/log_replay.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "logging/rtc_event_log/rtc_event_processor.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/network/sent_packet.h"
+
+namespace webrtc {
+namespace {
+// Used when the log has no loss based update before the first packet.
+constexpr DataRate kDefaultStartRate = DataRate::KilobitsPerSec<300>();
+constexpr TimeDelta kCongestedQueueDelay = TimeDelta::Millis<50>();
+constexpr TimeDelta kAckedRateWindow = TimeDelta::Seconds<1>();
+}  // namespace
+
+LogBasedNetworkControllerReplay::LogBasedNetworkControllerReplay(
+    NetworkControllerFactoryInterface* factory)
+    : factory_(factory), process_interval_(factory->GetProcessInterval()) {
+  RTC_DCHECK(process_interval_.IsFinite());
+  RTC_DCHECK(process_interval_ > TimeDelta::Zero());
+}
+
+LogBasedNetworkControllerReplay::~LogBasedNetworkControllerReplay() = default;
+
+void LogBasedNetworkControllerReplay::ProcessEventsInLog(
+    const ParsedRtcEventLog& parsed_log) {
+  RtcEventProcessor processor;
+  processor.AddEvents(parsed_log.bwe_loss_updates(),
+                      [this](const LoggedBweLossBasedUpdate& update) {
+                        OnLoggedTargetRate(update);
+                      });
+  for (const auto& stream : parsed_log.outgoing_rtp_packets_by_ssrc()) {
+    processor.AddEvents(stream.outgoing_packets,
+                        [this](const LoggedRtpPacketOutgoing& packet) {
+                          OnPacketSent(packet);
+                        });
+  }
+  processor.AddEvents(
+      parsed_log.transport_feedbacks(kIncomingPacket),
+      [this](const LoggedRtcpPacketTransportFeedback& feedback) {
+        OnFeedback(feedback);
+      });
+  processor.AddEvents(parsed_log.receiver_reports(kIncomingPacket),
+                      [this](const LoggedRtcpPacketReceiverReport& report) {
+                        OnReceiverReport(report);
+                      });
+  processor.ProcessEventsInOrder();
+}
+
+void LogBasedNetworkControllerReplay::OnPacketSent(
+    const LoggedRtpPacketOutgoing& packet) {
+  ProcessUntil(Timestamp::us(packet.log_time_us()));
+  const RTPHeader& header = packet.rtp.header;
+  rtc::SentPacket sent_packet;
+  sent_packet.send_time_ms = packet.log_time_ms();
+  sent_packet.info.packet_size_bytes = packet.rtp.total_length;
+  if (header.extension.hasTransportSequenceNumber) {
+    sent_packet.packet_id = header.extension.transportSequenceNumber;
+    sent_packet.info.included_in_feedback = true;
+    transport_feedback_.AddPacket(header.ssrc,
+                                  header.extension.transportSequenceNumber,
+                                  packet.rtp.total_length, PacedPacketInfo(),
+                                  current_time_);
+  } else {
+    sent_packet.info.included_in_allocation = true;
+  }
+  absl::optional<SentPacket> msg =
+      transport_feedback_.ProcessSentPacket(sent_packet);
+  if (msg)
+    HandleStateUpdate(controller_->OnSentPacket(*msg));
+}
+
+void LogBasedNetworkControllerReplay::OnFeedback(
+    const LoggedRtcpPacketTransportFeedback& feedback) {
+  ProcessUntil(Timestamp::us(feedback.log_time_us()));
+  absl::optional<TransportPacketsFeedback> msg =
+      transport_feedback_.ProcessTransportFeedback(feedback.transport_feedback,
+                                                   current_time_);
+  if (!msg)
+    return;
+  UpdateAckedRate(*msg);
+  HandleStateUpdate(controller_->OnTransportPacketsFeedback(*msg));
+}
+
+void LogBasedNetworkControllerReplay::OnReceiverReport(
+    const LoggedRtcpPacketReceiverReport& report) {
+  ProcessUntil(Timestamp::us(report.log_time_us()));
+  // Same accounting as RtpTransportControllerSend.
+  int64_t total_packets_lost_delta = 0;
+  int64_t total_packets_delta = 0;
+  for (const rtcp::ReportBlock& report_block : report.rr.report_blocks()) {
+    auto it = last_report_blocks_.find(report_block.source_ssrc());
+    if (it != last_report_blocks_.end()) {
+      total_packets_delta += report_block.extended_high_seq_num() -
+                             it->second.extended_high_seq_num();
+      total_packets_lost_delta += report_block.cumulative_lost_signed() -
+                                  it->second.cumulative_lost_signed();
+    }
+    last_report_blocks_[report_block.source_ssrc()] = report_block;
+  }
+  if (total_packets_delta == 0)
+    return;
+  int64_t packets_received_delta =
+      total_packets_delta - total_packets_lost_delta;
+  if (packets_received_delta < 1)
+    return;
+  TransportLossReport msg;
+  msg.packets_lost_delta = total_packets_lost_delta;
+  msg.packets_received_delta = packets_received_delta;
+  msg.receive_time = current_time_;
+  msg.start_time = last_report_block_time_;
+  msg.end_time = current_time_;
+  HandleStateUpdate(controller_->OnTransportLossReport(msg));
+  last_report_block_time_ = current_time_;
+}
+
+void LogBasedNetworkControllerReplay::OnLoggedTargetRate(
+    const LoggedBweLossBasedUpdate& update) {
+  // Before the first packet, the logged rate only sets the start rate.
+  if (controller_)
+    ProcessUntil(Timestamp::us(update.log_time_us()));
+  logged_target_rate_ = DataRate::bps(update.bitrate_bps);
+}
+
+LogReplaySummary LogBasedNetworkControllerReplay::GetSummary() const {
+  LogReplaySummary summary;
+  if (!controller_)
+    return summary;
+  summary.duration = current_time_ - start_time_;
+  if (sampled_time_ > TimeDelta::Zero()) {
+    const double sampled_seconds = sampled_time_.seconds<double>();
+    summary.mean_target_rate =
+        DataRate::bps(target_rate_sum_bps_ / sampled_seconds);
+    summary.estimated_loss_ratio = estimated_loss_sum_ / sampled_seconds;
+  }
+  if (rate_error_time_ > TimeDelta::Zero())
+    summary.rate_error = rate_error_sum_ / rate_error_time_.seconds<double>();
+  if (congested_time_ > TimeDelta::Zero())
+    summary.delay_overshoot = overshoot_time_ / congested_time_;
+  if (packets_with_feedback_ > 0) {
+    summary.loss_ratio =
+        static_cast<double>(lost_packets_) / packets_with_feedback_;
+  }
+  return summary;
+}
+
+void LogBasedNetworkControllerReplay::ProcessUntil(Timestamp to_time) {
+  if (!controller_) {
+    start_time_ = to_time;
+    last_process_ = to_time;
+    last_report_block_time_ = to_time;
+    NetworkControllerConfig config;
+    config.constraints.at_time = to_time;
+    config.constraints.starting_rate =
+        logged_target_rate_.value_or(kDefaultStartRate);
+    config.stream_based_config.at_time = to_time;
+    controller_ = factory_->Create(config);
+    NetworkAvailability msg;
+    msg.at_time = to_time;
+    msg.network_available = true;
+    HandleStateUpdate(controller_->OnNetworkAvailability(msg));
+  }
+  // Events from different lists can share a timestamp, but time never moves
+  // backwards.
+  RTC_DCHECK(to_time >= current_time_);
+  while (to_time - last_process_ >= process_interval_) {
+    last_process_ += process_interval_;
+    ProcessInterval msg;
+    msg.at_time = last_process_;
+    HandleStateUpdate(controller_->OnProcessInterval(msg));
+    Sample(process_interval_);
+  }
+  current_time_ = to_time;
+}
+
+void LogBasedNetworkControllerReplay::HandleStateUpdate(
+    const NetworkControlUpdate& update) {
+  if (update.target_rate) {
+    target_rate_ = update.target_rate->target_rate;
+    estimated_loss_ratio_ =
+        update.target_rate->network_estimate.loss_rate_ratio;
+  }
+}
+
+void LogBasedNetworkControllerReplay::UpdateAckedRate(
+    const TransportPacketsFeedback& feedback) {
+  for (const PacketResult& packet : feedback.packet_feedbacks) {
+    ++packets_with_feedback_;
+    if (packet.receive_time.IsInfinite()) {
+      ++lost_packets_;
+      continue;
+    }
+    // The send and receive clocks have an unknown offset, so the queuing delay
+    // is measured against the smallest one way delay seen so far.
+    const TimeDelta one_way_delay =
+        packet.receive_time - packet.sent_packet.send_time;
+    min_one_way_delay_ = std::min(min_one_way_delay_, one_way_delay);
+    queue_delay_ = one_way_delay - min_one_way_delay_;
+    acked_packets_.emplace_back(feedback.feedback_time,
+                                packet.sent_packet.size);
+    acked_in_window_ += packet.sent_packet.size;
+  }
+}
+
+void LogBasedNetworkControllerReplay::Sample(TimeDelta interval) {
+  while (!acked_packets_.empty() &&
+         last_process_ - acked_packets_.front().first > kAckedRateWindow) {
+    acked_in_window_ -= acked_packets_.front().second;
+    acked_packets_.pop_front();
+  }
+  const DataRate acked_rate = acked_in_window_ / kAckedRateWindow;
+  const double seconds = interval.seconds<double>();
+
+  sampled_time_ += interval;
+  target_rate_sum_bps_ += target_rate_.bps<double>() * seconds;
+  estimated_loss_sum_ += estimated_loss_ratio_ * seconds;
+  if (logged_target_rate_ && *logged_target_rate_ > DataRate::Zero()) {
+    rate_error_time_ += interval;
+    rate_error_sum_ += std::abs(target_rate_.bps<double>() -
+                                logged_target_rate_->bps<double>()) /
+                       logged_target_rate_->bps<double>() * seconds;
+  }
+  if (queue_delay_ > kCongestedQueueDelay) {
+    congested_time_ += interval;
+    if (target_rate_ > acked_rate)
+      overshoot_time_ += interval;
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef MODULES_CONGESTION_CONTROLLER_TEST_LOG_REPLAY_H_
+#define MODULES_CONGESTION_CONTROLLER_TEST_LOG_REPLAY_H_
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "api/transport/network_control.h"
+#include "api/units/data_rate.h"
+#include "api/units/data_size.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "logging/rtc_event_log/logged_events.h"
+#include "logging/rtc_event_log/rtc_event_log_parser.h"
+#include "modules/congestion_controller/rtp/transport_feedback_adapter.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/report_block.h"
+
+namespace webrtc {
+
+// Summary of how a network controller behaved when replayed over a log. The
+// replay is open loop: the logged traffic does not react to the replayed
+// controller, so the metrics compare the controller's target rate with what
+// the logged network delivered and with the target of the logging endpoint.
+struct LogReplaySummary {
+  TimeDelta duration = TimeDelta::Zero();
+  DataRate mean_target_rate = DataRate::Zero();
+  // Mean absolute difference between the replayed and the logged target rate,
+  // relative to the logged target rate. Unset if the log has no loss based
+  // bandwidth estimate updates.
+  absl::optional<double> rate_error;
+  // Fraction of the congested time, i.e. time with a queuing delay above
+  // 50 ms, during which the target rate exceeded the rate acknowledged by
+  // transport feedback over the last second.
+  double delay_overshoot = 0;
+  // Fraction of the packets reported in transport feedback that were lost.
+  double loss_ratio = 0;
+  // Mean of the loss rate estimated by the controller.
+  double estimated_loss_ratio = 0;
+};
+
+// Feeds the outgoing packets, incoming transport feedback and receiver reports
+// of an RTC event log into a network controller, advancing simulated time
+// with the log timestamps. This runs as fast as the controller allows.
+class LogBasedNetworkControllerReplay {
+ public:
+  explicit LogBasedNetworkControllerReplay(
+      NetworkControllerFactoryInterface* factory);
+  ~LogBasedNetworkControllerReplay();
+
+  // Replays all relevant events of |parsed_log| in timestamp order.
+  void ProcessEventsInLog(const ParsedRtcEventLog& parsed_log);
+
+  void OnPacketSent(const LoggedRtpPacketOutgoing& packet);
+  void OnFeedback(const LoggedRtcpPacketTransportFeedback& feedback);
+  void OnReceiverReport(const LoggedRtcpPacketReceiverReport& report);
+  void OnLoggedTargetRate(const LoggedBweLossBasedUpdate& update);
+
+  LogReplaySummary GetSummary() const;
+
+ private:
+  void ProcessUntil(Timestamp to_time);
+  void HandleStateUpdate(const NetworkControlUpdate& update);
+  void UpdateAckedRate(const TransportPacketsFeedback& feedback);
+  void Sample(TimeDelta interval);
+
+  NetworkControllerFactoryInterface* const factory_;
+  const TimeDelta process_interval_;
+  std::unique_ptr<NetworkControllerInterface> controller_;
+  TransportFeedbackAdapter transport_feedback_;
+
+  Timestamp start_time_ = Timestamp::MinusInfinity();
+  Timestamp current_time_ = Timestamp::MinusInfinity();
+  Timestamp last_process_ = Timestamp::MinusInfinity();
+
+  absl::optional<DataRate> logged_target_rate_;
+  DataRate target_rate_ = DataRate::Zero();
+  double estimated_loss_ratio_ = 0;
+
+  std::map<uint32_t, rtcp::ReportBlock> last_report_blocks_;
+  Timestamp last_report_block_time_ = Timestamp::MinusInfinity();
+
+  // Packets received within the last second, by feedback time.
+  std::deque<std::pair<Timestamp, DataSize>> acked_packets_;
+  DataSize acked_in_window_ = DataSize::Zero();
+  TimeDelta min_one_way_delay_ = TimeDelta::PlusInfinity();
+  TimeDelta queue_delay_ = TimeDelta::Zero();
+  size_t packets_with_feedback_ = 0;
+  size_t lost_packets_ = 0;
+
+  // Time weighted sums, updated every process interval.
+  TimeDelta sampled_time_ = TimeDelta::Zero();
+  double target_rate_sum_bps_ = 0;
+  double estimated_loss_sum_ = 0;
+  TimeDelta rate_error_time_ = TimeDelta::Zero();
+  double rate_error_sum_ = 0;
+  TimeDelta congested_time_ = TimeDelta::Zero();
+  TimeDelta overshoot_time_ = TimeDelta::Zero();
+};
+}  // namespace webrtc
+
+#endif  // MODULES_CONGESTION_CONTROLLER_TEST_LOG_REPLAY_H_
@@ -0,0 +1,225 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/transport/goog_cc_factory.h"
+#include "logging/rtc_event_log/rtc_event_log.h"
+#include "logging/rtc_event_log/rtc_event_log_parser.h"
+#include "modules/congestion_controller/bbr/bbr_factory.h"
+#include "modules/congestion_controller/pcc/pcc_factory.h"
+#include "modules/congestion_controller/test/log_replay.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/flags.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/string_encode.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/thread_annotations.h"
+#include "system_wrappers/include/cpu_info.h"
+
+namespace {
+
+WEBRTC_DEFINE_string(controllers,
+                     "goog_cc,bbr,pcc",
+                     "Comma separated list of network controllers to replay. "
+                     "Supported: goog_cc, goog_cc_feedback, bbr, pcc.");
+WEBRTC_DEFINE_int(threads,
+                  0,
+                  "Number of logs replayed in parallel. Zero uses one thread "
+                  "per core.");
+WEBRTC_DEFINE_string(output,
+                     "",
+                     "Write the CSV summary to this file instead of stdout.");
+WEBRTC_DEFINE_bool(help, false, "Prints this message.");
+
+struct ReplayResult {
+  std::string controller;
+  webrtc::LogReplaySummary summary;
+};
+
+struct LogResult {
+  bool parsed = false;
+  std::vector<ReplayResult> replays;
+};
+
+std::unique_ptr<webrtc::NetworkControllerFactoryInterface> CreateFactory(
+    const std::string& name,
+    webrtc::RtcEventLog* event_log) {
+  if (name == "goog_cc")
+    return absl::make_unique<webrtc::GoogCcNetworkControllerFactory>(event_log);
+  if (name == "goog_cc_feedback") {
+    return absl::make_unique<webrtc::GoogCcFeedbackNetworkControllerFactory>(
+        event_log);
+  }
+  if (name == "bbr")
+    return absl::make_unique<webrtc::BbrNetworkControllerFactory>();
+  if (name == "pcc")
+    return absl::make_unique<webrtc::PccNetworkControllerFactory>();
+  return nullptr;
+}
+
+// Logs are handed out one at a time to the worker threads. Every worker parses
+// its log once and replays it through all controllers, so the number of logs
+// that are in memory at the same time is bounded by the number of threads.
+class ReplayWorkQueue {
+ public:
+  ReplayWorkQueue(std::vector<std::string> log_files,
+                  std::vector<std::string> controllers)
+      : log_files_(std::move(log_files)),
+        controllers_(std::move(controllers)),
+        results_(log_files_.size()) {}
+
+  static void RunWorker(void* obj) {
+    static_cast<ReplayWorkQueue*>(obj)->Run();
+  }
+
+  const std::vector<std::string>& log_files() const { return log_files_; }
+  // Must not be called while workers are running.
+  const std::vector<LogResult>& results() const { return results_; }
+
+ private:
+  void Run() {
+    for (size_t index = NextLog(); index < log_files_.size();
+         index = NextLog()) {
+      Replay(log_files_[index], &results_[index]);
+    }
+  }
+
+  size_t NextLog() {
+    rtc::CritScope cs(&crit_);
+    return next_log_++;
+  }
+
+  void Replay(const std::string& log_file, LogResult* result) {
+    webrtc::ParsedRtcEventLog parsed_log;
+    if (!parsed_log.ParseFile(log_file)) {
+      std::cerr << "Error while parsing input file: " << log_file << std::endl;
+      return;
+    }
+    result->parsed = true;
+    for (const std::string& controller : controllers_) {
+      std::unique_ptr<webrtc::RtcEventLog> event_log =
+          webrtc::RtcEventLog::CreateNull();
+      std::unique_ptr<webrtc::NetworkControllerFactoryInterface> factory =
+          CreateFactory(controller, event_log.get());
+      RTC_CHECK(factory);
+      webrtc::LogBasedNetworkControllerReplay replay(factory.get());
+      replay.ProcessEventsInLog(parsed_log);
+      result->replays.push_back({controller, replay.GetSummary()});
+    }
+  }
+
+  const std::vector<std::string> log_files_;
+  const std::vector<std::string> controllers_;
+  // Each element is written by the one worker that replays the log.
+  std::vector<LogResult> results_;
+  rtc::CriticalSection crit_;
+  size_t next_log_ RTC_GUARDED_BY(crit_) = 0;
+};
+
+void PrintCsv(const ReplayWorkQueue& queue, FILE* output) {
+  fprintf(output,
+          "log,controller,duration_s,mean_target_kbps,rate_error,"
+          "delay_overshoot,loss_ratio,estimated_loss_ratio\n");
+  for (size_t i = 0; i < queue.log_files().size(); ++i) {
+    for (const ReplayResult& replay : queue.results()[i].replays) {
+      const webrtc::LogReplaySummary& summary = replay.summary;
+      rtc::StringBuilder line;
+      line << queue.log_files()[i] << "," << replay.controller << ","
+           << summary.duration.seconds<double>() << ","
+           << summary.mean_target_rate.kbps<double>() << ",";
+      // Left empty if the log has no target rate to compare with.
+      if (summary.rate_error)
+        line << *summary.rate_error;
+      line << "," << summary.delay_overshoot << "," << summary.loss_ratio
+           << "," << summary.estimated_loss_ratio;
+      fprintf(output, "%s\n", line.str().c_str());
+    }
+  }
+}
+
+}  // namespace
+
+// Replays the outgoing packets and incoming feedback of RTC event logs through
+// network controllers under simulated time, and summarizes how each of them
+// would have set the target rate.
+int main(int argc, char* argv[]) {
+  std::string program_name = argv[0];
+  std::string usage =
+      "Tool for comparing network controllers over recorded RtcEventLog "
+      "files.\n"
+      "Run " +
+      program_name +
+      " --help for usage.\n"
+      "Example usage:\n" +
+      program_name + " --controllers=goog_cc,bbr --output=out.csv *.rel\n";
+  if (rtc::FlagList::SetFlagsFromCommandLine(&argc, argv, true) || FLAG_help ||
+      argc < 2) {
+    std::cout << usage;
+    if (FLAG_help) {
+      rtc::FlagList::Print(nullptr, false);
+      return 0;
+    }
+    return 1;
+  }
+
+  std::vector<std::string> controllers;
+  rtc::split(FLAG_controllers, ',', &controllers);
+  for (const std::string& controller : controllers) {
+    if (!CreateFactory(controller, nullptr)) {
+      std::cerr << "Unknown controller: " << controller << std::endl;
+      return 1;
+    }
+  }
+
+  ReplayWorkQueue queue(std::vector<std::string>(argv + 1, argv + argc),
+                        controllers);
+  int num_threads =
+      FLAG_threads > 0
+          ? FLAG_threads
+          : static_cast<int>(webrtc::CpuInfo::DetectNumberOfCores());
+  num_threads =
+      std::min(num_threads, static_cast<int>(queue.log_files().size()));
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(absl::make_unique<rtc::PlatformThread>(
+        &ReplayWorkQueue::RunWorker, &queue, "LogReplay"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Stop();
+
+  FILE* output = stdout;
+  if (strlen(FLAG_output) > 0) {
+    output = fopen(FLAG_output, "w");
+    if (!output) {
+      std::cerr << "Error while opening output file: " << FLAG_output
+                << std::endl;
+      return -1;
+    }
+  }
+  PrintCsv(queue, output);
+  if (output != stdout)
+    fclose(output);
+
+  int failed_logs = 0;
+  for (const LogResult& result : queue.results())
+    failed_logs += result.parsed ? 0 : 1;
+  return failed_logs > 0 ? -1 : 0;
+}
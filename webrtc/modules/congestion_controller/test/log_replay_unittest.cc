@@ -0,0 +1,185 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "modules/congestion_controller/test/log_replay.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/transport/goog_cc_factory.h"
+#include "api/transport/network_control.h"
+#include "logging/rtc_event_log/rtc_event_log.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+constexpr int64_t kSendIntervalUs = 10000;
+constexpr int64_t kFeedbackIntervalUs = 50000;
+constexpr int64_t kOneWayDelayUs = 20000;
+constexpr size_t kPacketSize = 1200;
+
+struct SentPacket {
+  int64_t send_time_us;
+  uint16_t sequence_number;
+};
+
+// Always targets |target_rate|, so that the replay metrics are known exactly.
+class FixedRateNetworkController : public NetworkControllerInterface {
+ public:
+  explicit FixedRateNetworkController(DataRate target_rate)
+      : target_rate_(target_rate) {}
+
+  NetworkControlUpdate OnNetworkAvailability(NetworkAvailability msg) override {
+    return {};
+  }
+  NetworkControlUpdate OnNetworkRouteChange(NetworkRouteChange msg) override {
+    return {};
+  }
+  NetworkControlUpdate OnProcessInterval(ProcessInterval msg) override {
+    NetworkControlUpdate update;
+    update.target_rate = TargetTransferRate();
+    update.target_rate->at_time = msg.at_time;
+    update.target_rate->target_rate = target_rate_;
+    return update;
+  }
+  NetworkControlUpdate OnRemoteBitrateReport(RemoteBitrateReport msg) override {
+    return {};
+  }
+  NetworkControlUpdate OnRoundTripTimeUpdate(RoundTripTimeUpdate msg) override {
+    return {};
+  }
+  NetworkControlUpdate OnSentPacket(webrtc::SentPacket msg) override {
+    return {};
+  }
+  NetworkControlUpdate OnStreamsConfig(StreamsConfig msg) override {
+    return {};
+  }
+  NetworkControlUpdate OnTargetRateConstraints(
+      TargetRateConstraints msg) override {
+    return {};
+  }
+  NetworkControlUpdate OnTransportLossReport(TransportLossReport msg) override {
+    return {};
+  }
+  NetworkControlUpdate OnTransportPacketsFeedback(
+      TransportPacketsFeedback msg) override {
+    return {};
+  }
+
+ private:
+  const DataRate target_rate_;
+};
+
+class FixedRateNetworkControllerFactory
+    : public NetworkControllerFactoryInterface {
+ public:
+  explicit FixedRateNetworkControllerFactory(DataRate target_rate)
+      : target_rate_(target_rate) {}
+
+  std::unique_ptr<NetworkControllerInterface> Create(
+      NetworkControllerConfig config) override {
+    return absl::make_unique<FixedRateNetworkController>(target_rate_);
+  }
+  TimeDelta GetProcessInterval() const override { return TimeDelta::ms(25); }
+
+ private:
+  const DataRate target_rate_;
+};
+
+// Sends 1200 byte packets every 10 ms, i.e. 960 kbps, over a link with a
+// constant 20 ms delay that drops every |drop_interval|:th packet. Transport
+// feedback is received every 50 ms.
+void ReplayConstantTraffic(LogBasedNetworkControllerReplay* replay,
+                           int64_t duration_us,
+                           int drop_interval) {
+  std::vector<SentPacket> unreported;
+  uint16_t sequence_number = 0;
+  int64_t next_feedback_us = kFeedbackIntervalUs;
+  for (int64_t now_us = 0; now_us < duration_us; now_us += kSendIntervalUs) {
+    if (now_us >= next_feedback_us) {
+      next_feedback_us += kFeedbackIntervalUs;
+      rtcp::TransportFeedback feedback;
+      feedback.SetBase(unreported.front().sequence_number,
+                       unreported.front().send_time_us + kOneWayDelayUs);
+      size_t reported = 0;
+      for (size_t i = 0; i < unreported.size(); ++i) {
+        const SentPacket& packet = unreported[i];
+        if (drop_interval > 0 && packet.sequence_number % drop_interval == 0)
+          continue;
+        if (packet.send_time_us + kOneWayDelayUs > now_us)
+          break;
+        EXPECT_TRUE(feedback.AddReceivedPacket(
+            packet.sequence_number, packet.send_time_us + kOneWayDelayUs));
+        reported = i + 1;
+      }
+      if (reported > 0) {
+        replay->OnFeedback(LoggedRtcpPacketTransportFeedback(now_us, feedback));
+        unreported.erase(unreported.begin(), unreported.begin() + reported);
+      }
+    }
+    RTPHeader header;
+    header.ssrc = 1;
+    header.sequenceNumber = sequence_number;
+    header.extension.hasTransportSequenceNumber = true;
+    header.extension.transportSequenceNumber = sequence_number;
+    replay->OnPacketSent(
+        LoggedRtpPacketOutgoing(now_us, header, 12, kPacketSize));
+    unreported.push_back({now_us, sequence_number});
+    ++sequence_number;
+  }
+}
+}  // namespace
+
+TEST(LogBasedNetworkControllerReplayTest, ReportsTargetRateWithoutLoss) {
+  std::unique_ptr<RtcEventLog> event_log = RtcEventLog::CreateNull();
+  GoogCcNetworkControllerFactory factory(event_log.get());
+  LogBasedNetworkControllerReplay replay(&factory);
+  ReplayConstantTraffic(&replay, 10000000, 0);
+
+  LogReplaySummary summary = replay.GetSummary();
+  EXPECT_NEAR(summary.duration.seconds<double>(), 10.0, 0.1);
+  EXPECT_GT(summary.mean_target_rate, DataRate::Zero());
+  EXPECT_EQ(summary.loss_ratio, 0.0);
+  EXPECT_EQ(summary.delay_overshoot, 0.0);
+  // Nothing to compare with without a logged target rate.
+  EXPECT_FALSE(summary.rate_error);
+}
+
+TEST(LogBasedNetworkControllerReplayTest, ComparesWithLoggedTargetRate) {
+  FixedRateNetworkControllerFactory factory(DataRate::kbps(360));
+  LogBasedNetworkControllerReplay replay(&factory);
+  replay.OnLoggedTargetRate(LoggedBweLossBasedUpdate(0, 300000, 0, 0));
+  ReplayConstantTraffic(&replay, 5000000, 0);
+  // The replayed target is 20% above the logged one for the first 5 seconds,
+  // and 40% below it for the next 5 seconds.
+  replay.OnLoggedTargetRate(LoggedBweLossBasedUpdate(5000000, 600000, 0, 0));
+  replay.OnLoggedTargetRate(LoggedBweLossBasedUpdate(10000000, 600000, 0, 0));
+
+  LogReplaySummary summary = replay.GetSummary();
+  EXPECT_EQ(summary.duration, TimeDelta::seconds(10));
+  EXPECT_EQ(summary.mean_target_rate, DataRate::kbps(360));
+  ASSERT_TRUE(summary.rate_error);
+  EXPECT_NEAR(*summary.rate_error, 0.3, 1e-9);
+}
+
+TEST(LogBasedNetworkControllerReplayTest, ReportsLossFromTransportFeedback) {
+  std::unique_ptr<RtcEventLog> event_log = RtcEventLog::CreateNull();
+  GoogCcNetworkControllerFactory factory(event_log.get());
+  LogBasedNetworkControllerReplay replay(&factory);
+  ReplayConstantTraffic(&replay, 10000000, 10);
+
+  LogReplaySummary summary = replay.GetSummary();
+  EXPECT_NEAR(summary.loss_ratio, 0.1, 0.01);
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -221,8 +221,32 @@ void PacedSender::InsertPacket(RtpPacketSender::Priority priority,
   rtc::CritScope cs(&critsect_);
   RTC_DCHECK(pacing_bitrate_kbps_ > 0)
       << "SetPacingRate must be called before InsertPacket.";
+  EnqueuePacket(priority, ssrc, sequence_number, capture_time_ms,
+                TimeMilliseconds(), bytes, retransmission);
+}
 
+void PacedSender::InsertPackets(
+    RtpPacketSender::Priority priority,
+    uint32_t ssrc,
+    int64_t capture_time_ms,
+    rtc::ArrayView<const RtpPacketSender::BatchedPacket> packets) {
+  rtc::CritScope cs(&critsect_);
+  RTC_DCHECK(pacing_bitrate_kbps_ > 0)
+      << "SetPacingRate must be called before InsertPackets.";
   int64_t now_ms = TimeMilliseconds();
+  for (const RtpPacketSender::BatchedPacket& packet : packets) {
+    EnqueuePacket(priority, ssrc, packet.sequence_number, capture_time_ms,
+                  now_ms, packet.bytes, /*retransmission=*/false);
+  }
+}
+
+void PacedSender::EnqueuePacket(RtpPacketSender::Priority priority,
+                                uint32_t ssrc,
+                                uint16_t sequence_number,
+                                int64_t capture_time_ms,
+                                int64_t now_ms,
+                                size_t bytes,
+                                bool retransmission) {
   prober_.OnIncomingPacket(bytes);
 
   if (capture_time_ms < 0)
@@ -17,6 +17,7 @@
 #include <memory>
 
 #include "absl/types/optional.h"
+#include "api/array_view.h"
 #include "api/transport/field_trial_based_config.h"
 #include "api/transport/network_types.h"
 #include "api/transport/webrtc_key_value_config.h"
@@ -112,6 +113,12 @@ class PacedSender : public Pacer {
                     int64_t capture_time_ms,
                     size_t bytes,
                     bool retransmission) override;
+  // Queues the packets of a frame under a single lock.
+  void InsertPackets(
+      RtpPacketSender::Priority priority,
+      uint32_t ssrc,
+      int64_t capture_time_ms,
+      rtc::ArrayView<const RtpPacketSender::BatchedPacket> packets) override;
 
   // Currently audio traffic is not accounted by pacer and passed through.
   // With the introduction of audio BWE audio traffic will be accounted for
@@ -155,6 +162,14 @@ class PacedSender : public Pacer {
               RtcEventLog* event_log,
               const WebRtcKeyValueConfig& field_trials);
 
+  void EnqueuePacket(RtpPacketSender::Priority priority,
+                     uint32_t ssrc,
+                     uint16_t sequence_number,
+                     int64_t capture_time_ms,
+                     int64_t now_ms,
+                     size_t bytes,
+                     bool retransmission)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
   int64_t UpdateTimeAndGetElapsedMs(int64_t now_us)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critsect_);
   bool ShouldSendKeepalive(int64_t at_time_us) const
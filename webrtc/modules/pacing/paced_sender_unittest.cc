@@ -21,6 +21,7 @@
 
 using testing::_;
 using testing::Field;
+using testing::InSequence;
 using testing::Return;
 
 namespace {
@@ -341,6 +342,28 @@ TEST_F(PacedSenderTest, QueuePacket) {
   EXPECT_EQ(1u, send_bucket_->QueueSizePackets());
 }
 
+TEST_F(PacedSenderTest, InsertPacketsQueuesFrameInOrder) {
+  const uint32_t kSsrc = 12345;
+  const RtpPacketSender::BatchedPacket kPackets[] = {
+      {1000, 250}, {1001, 250}, {1002, 100}};
+  const int64_t capture_time_ms = clock_.TimeInMilliseconds();
+  send_bucket_->InsertPackets(PacedSender::kNormalPriority, kSsrc,
+                              capture_time_ms, kPackets);
+  EXPECT_EQ(3u, send_bucket_->QueueSizePackets());
+  EXPECT_EQ(600, send_bucket_->QueueSizeBytes());
+
+  {
+    InSequence in_sequence;
+    for (const auto& packet : kPackets) {
+      EXPECT_CALL(callback_, TimeToSendPacket(kSsrc, packet.sequence_number,
+                                              capture_time_ms, false, _))
+          .WillOnce(Return(true));
+    }
+  }
+  send_bucket_->Process();
+  EXPECT_EQ(0u, send_bucket_->QueueSizePackets());
+}
+
 TEST_F(PacedSenderTest, PaceQueuedPackets) {
   uint32_t ssrc = 12345;
   uint16_t sequence_number = 1234;
@@ -24,7 +24,6 @@
 #include "rtc_base/experiments/field_trial_parser.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/numerics/safe_minmax.h"
-#include "system_wrappers/include/field_trial.h"
 
 namespace webrtc {
 constexpr TimeDelta kDefaultRtt = TimeDelta::Millis<200>();
@@ -32,9 +31,7 @@ constexpr double kDefaultBackoffFactor = 0.85;
 
 const char kBweBackOffFactorExperiment[] = "WebRTC-BweBackOffFactor";
 
-double ReadBackoffFactor() {
-  std::string experiment_string =
-      webrtc::field_trial::FindFullName(kBweBackOffFactorExperiment);
+double ReadBackoffFactor(const std::string& experiment_string) {
   double backoff_factor;
   int parsed_values =
       sscanf(experiment_string.c_str(), "Enabled-%lf", &backoff_factor);
@@ -52,7 +49,45 @@ double ReadBackoffFactor() {
   return kDefaultBackoffFactor;
 }
 
+struct AimdRateControl::FieldTrialSettings {
+  double beta = kDefaultBackoffFactor;
+  bool in_experiment = false;
+  bool smoothing_experiment = false;
+  FieldTrialOptional<TimeDelta> initial_backoff_interval{
+      "initial_backoff_interval"};
+  FieldTrialParameter<DataRate> low_throughput_threshold{"low_throughput",
+                                                         DataRate::Zero()};
+};
+
+AimdRateControl::FieldTrialSettings AimdRateControl::ParseFieldTrialSettings(
+    const FieldTrialSnapshot& trials) {
+  FieldTrialSettings settings;
+  if (trials.IsEnabled(kBweBackOffFactorExperiment)) {
+    settings.beta =
+        ReadBackoffFactor(trials.FindFullName(kBweBackOffFactorExperiment));
+  }
+  settings.in_experiment = !AdaptiveThresholdExperimentIsDisabled();
+  settings.smoothing_experiment =
+      trials.IsEnabled("WebRTC-Audio-BandwidthSmoothing");
+  // E.g
+  // WebRTC-BweAimdRateControlConfig/initial_backoff_interval:100ms,
+  // low_throughput:50kbps/
+  ParseFieldTrial({&settings.initial_backoff_interval,
+                   &settings.low_throughput_threshold},
+                  trials.FindFullName("WebRTC-BweAimdRateControlConfig"));
+  return settings;
+}
+
+AimdRateControl::FieldTrialSettings AimdRateControl::GetFieldTrialSettings() {
+  static CachedFieldTrialParser<FieldTrialSettings>* const parser =
+      new CachedFieldTrialParser<FieldTrialSettings>(&ParseFieldTrialSettings);
+  return parser->Get();
+}
+
 AimdRateControl::AimdRateControl()
+    : AimdRateControl(GetFieldTrialSettings()) {}
+
+AimdRateControl::AimdRateControl(const FieldTrialSettings& settings)
     : min_configured_bitrate_(congestion_controller::GetMinBitrate()),
       max_configured_bitrate_(DataRate::kbps(30000)),
       current_bitrate_(max_configured_bitrate_),
@@ -63,20 +98,12 @@ AimdRateControl::AimdRateControl()
       time_last_bitrate_decrease_(Timestamp::MinusInfinity()),
       time_first_throughput_estimate_(Timestamp::MinusInfinity()),
       bitrate_is_initialized_(false),
-      beta_(webrtc::field_trial::IsEnabled(kBweBackOffFactorExperiment)
-                ? ReadBackoffFactor()
-                : kDefaultBackoffFactor),
+      beta_(settings.beta),
       rtt_(kDefaultRtt),
-      in_experiment_(!AdaptiveThresholdExperimentIsDisabled()),
-      smoothing_experiment_(
-          webrtc::field_trial::IsEnabled("WebRTC-Audio-BandwidthSmoothing")),
-      initial_backoff_interval_("initial_backoff_interval"),
-      low_throughput_threshold_("low_throughput", DataRate::Zero()) {
-  // E.g
-  // WebRTC-BweAimdRateControlConfig/initial_backoff_interval:100ms,
-  // low_throughput:50kbps/
-  ParseFieldTrial({&initial_backoff_interval_, &low_throughput_threshold_},
-                  field_trial::FindFullName("WebRTC-BweAimdRateControlConfig"));
+      in_experiment_(settings.in_experiment),
+      smoothing_experiment_(settings.smoothing_experiment),
+      initial_backoff_interval_(settings.initial_backoff_interval),
+      low_throughput_threshold_(settings.low_throughput_threshold) {
   if (initial_backoff_interval_) {
     RTC_LOG(LS_INFO) << "Using aimd rate control with initial back-off interval"
                      << " " << ToString(*initial_backoff_interval_) << ".";
@@ -19,6 +19,7 @@
 #include "modules/congestion_controller/goog_cc/link_capacity_estimator.h"
 #include "modules/remote_bitrate_estimator/include/bwe_defines.h"
 #include "rtc_base/experiments/field_trial_parser.h"
+#include "rtc_base/experiments/field_trial_snapshot.h"
 
 namespace webrtc {
 // A rate control implementation based on additive increases of
@@ -82,6 +83,13 @@ class AimdRateControl {
   void UpdateChangePeriod(Timestamp at_time);
   void ChangeState(const RateControlInput& input, Timestamp at_time);
 
+  // Parsed once per field trial string, see CachedFieldTrialParser.
+  struct FieldTrialSettings;
+  static FieldTrialSettings GetFieldTrialSettings();
+  static FieldTrialSettings ParseFieldTrialSettings(
+      const FieldTrialSnapshot& trials);
+  explicit AimdRateControl(const FieldTrialSettings& settings);
+
   DataRate min_configured_bitrate_;
   DataRate max_configured_bitrate_;
   DataRate current_bitrate_;
@@ -18,8 +18,8 @@
 #include "modules/remote_bitrate_estimator/include/bwe_defines.h"
 #include "modules/remote_bitrate_estimator/test/bwe_test_logging.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/experiments/field_trial_snapshot.h"
 #include "rtc_base/numerics/safe_minmax.h"
-#include "system_wrappers/include/field_trial.h"
 
 namespace webrtc {
 
@@ -33,28 +33,60 @@ const double kMaxAdaptOffsetMs = 15.0;
 const double kOverUsingTimeThreshold = 10;
 const int kMaxNumDeltas = 60;
 
-bool AdaptiveThresholdExperimentIsDisabled() {
-  std::string experiment_string =
-      webrtc::field_trial::FindFullName(kAdaptiveThresholdExperiment);
+namespace {
+struct AdaptiveThresholdSettings {
+  bool disabled = false;
+  bool has_constants = false;
+  double k_up = 0.0;
+  double k_down = 0.0;
+};
+
+bool ExperimentIsDisabled(const std::string& experiment_string) {
   const size_t kMinExperimentLength = kDisabledPrefixLength;
   if (experiment_string.length() < kMinExperimentLength)
     return false;
-  return experiment_string.substr(0, kDisabledPrefixLength) == kDisabledPrefix;
+  return experiment_string.compare(0, kDisabledPrefixLength,
+                                   kDisabledPrefix) == 0;
 }
 
 // Gets thresholds from the experiment name following the format
 // "WebRTC-AdaptiveBweThreshold/Enabled-0.5,0.002/".
-bool ReadExperimentConstants(double* k_up, double* k_down) {
-  std::string experiment_string =
-      webrtc::field_trial::FindFullName(kAdaptiveThresholdExperiment);
+bool ReadExperimentConstants(const std::string& experiment_string,
+                             double* k_up,
+                             double* k_down) {
   const size_t kMinExperimentLength = kEnabledPrefixLength + 3;
   if (experiment_string.length() < kMinExperimentLength ||
-      experiment_string.substr(0, kEnabledPrefixLength) != kEnabledPrefix)
+      experiment_string.compare(0, kEnabledPrefixLength, kEnabledPrefix) != 0)
     return false;
-  return sscanf(experiment_string.substr(kEnabledPrefixLength + 1).c_str(),
+  return sscanf(experiment_string.c_str() + kEnabledPrefixLength + 1,
                 "%lf,%lf", k_up, k_down) == 2;
 }
 
+AdaptiveThresholdSettings ParseAdaptiveThresholdSettings(
+    const FieldTrialSnapshot& trials) {
+  const std::string experiment_string =
+      trials.FindFullName(kAdaptiveThresholdExperiment);
+  AdaptiveThresholdSettings settings;
+  settings.disabled = ExperimentIsDisabled(experiment_string);
+  settings.has_constants = ReadExperimentConstants(
+      experiment_string, &settings.k_up, &settings.k_down);
+  return settings;
+}
+
+// Detectors are created per stream, so the field trial is only parsed when
+// the field trial string changes.
+AdaptiveThresholdSettings GetAdaptiveThresholdSettings() {
+  static CachedFieldTrialParser<AdaptiveThresholdSettings>* const parser =
+      new CachedFieldTrialParser<AdaptiveThresholdSettings>(
+          &ParseAdaptiveThresholdSettings);
+  return parser->Get();
+}
+}  // namespace
+
+bool AdaptiveThresholdExperimentIsDisabled() {
+  return GetAdaptiveThresholdSettings().disabled;
+}
+
 OveruseDetector::OveruseDetector()
     // Experiment is on by default, but can be disabled with finch by setting
     // the field trial string to "WebRTC-AdaptiveBweThreshold/Disabled/".
@@ -68,7 +100,7 @@ OveruseDetector::OveruseDetector()
       time_over_using_(-1),
       overuse_counter_(0),
       hypothesis_(BandwidthUsage::kBwNormal) {
-  if (!AdaptiveThresholdExperimentIsDisabled())
+  if (in_experiment_)
     InitializeExperiment();
 }
 
@@ -146,12 +178,11 @@ void OveruseDetector::UpdateThreshold(double modified_offset, int64_t now_ms) {
 
 void OveruseDetector::InitializeExperiment() {
   RTC_DCHECK(in_experiment_);
-  double k_up = 0.0;
-  double k_down = 0.0;
   overusing_time_threshold_ = kOverUsingTimeThreshold;
-  if (ReadExperimentConstants(&k_up, &k_down)) {
-    k_up_ = k_up;
-    k_down_ = k_down;
+  const AdaptiveThresholdSettings settings = GetAdaptiveThresholdSettings();
+  if (settings.has_constants) {
+    k_up_ = settings.k_up;
+    k_down_ = settings.k_down;
   }
 }
 }  // namespace webrtc
@@ -10,9 +10,15 @@
 
 #include "modules/remote_bitrate_estimator/remote_bitrate_estimator_single_stream.h"
 
+#include <memory>
+#include <vector>
+
 #include "modules/remote_bitrate_estimator/remote_bitrate_estimator_unittest_helper.h"
 #include "rtc_base/constructor_magic.h"
+#include "rtc_base/time_utils.h"
+#include "test/field_trial.h"
 #include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
 
 namespace webrtc {
 
@@ -71,4 +77,34 @@ TEST_F(RemoteBitrateEstimatorSingleTest, CapacityDropThirtyStreamsWrap) {
 TEST_F(RemoteBitrateEstimatorSingleTest, TestTimestampGrouping) {
   TestTimestampGroupingTestHelper();
 }
+
+// Measures the time to set up the estimators of 10000 receive streams, which
+// read their field trials when created.
+TEST(RemoteBitrateEstimatorSingleStreamTest, DISABLED_CreateReceiveStreams) {
+  const int kNumStreams = 10000;
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-AdaptiveBweThreshold/Enabled-0.0087,0.039/"
+      "WebRTC-Audio-BandwidthSmoothing/Disabled/"
+      "WebRTC-Bwe-AlrLimitedBackoff/Enabled/"
+      "WebRTC-BweAimdRateControlConfig/initial_backoff_interval:200ms/"
+      "WebRTC-BweBackOffFactor/Enabled-0.85/"
+      "WebRTC-Video-BalancedDegradation/Disabled/"
+      "WebRTC-VideoRateControl/trust_vp8:true,trust_vp9:true/");
+  SimulatedClock clock(0);
+  std::vector<std::unique_ptr<RemoteBitrateEstimatorSingleStream>> streams;
+  streams.reserve(kNumStreams);
+  const int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kNumStreams; ++i) {
+    streams.emplace_back(new RemoteBitrateEstimatorSingleStream(
+        /*observer=*/nullptr, &clock));
+    RTPHeader header;
+    header.ssrc = i;
+    // Creates the overuse detector of the stream.
+    streams.back()->IncomingPacket(clock.TimeInMilliseconds(), 1200, header);
+  }
+  const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+  test::PrintResult("create_receive_stream", "", "single_stream_estimator",
+                    static_cast<double>(elapsed_us) / kNumStreams, "us",
+                    false);
+}
 }  // namespace webrtc
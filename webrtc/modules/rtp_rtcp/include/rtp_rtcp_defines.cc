@@ -41,6 +41,17 @@ bool IsLegalRsidName(absl::string_view name) {
           absl::c_all_of(name, isalnum));
 }
 
+void RtpPacketSender::InsertPackets(
+    Priority priority,
+    uint32_t ssrc,
+    int64_t capture_time_ms,
+    rtc::ArrayView<const BatchedPacket> packets) {
+  for (const BatchedPacket& packet : packets) {
+    InsertPacket(priority, ssrc, packet.sequence_number, capture_time_ms,
+                 packet.bytes, /*retransmission=*/false);
+  }
+}
+
 StreamDataCounters::StreamDataCounters() : first_packet_time_ms(-1) {}
 
 PacketFeedback::PacketFeedback(int64_t arrival_time_ms,
@@ -17,6 +17,7 @@
 
 #include "absl/strings/string_view.h"
 #include "absl/types/variant.h"
+#include "api/array_view.h"
 #include "api/audio_codecs/audio_format.h"
 #include "api/rtp_headers.h"
 #include "api/transport/network_types.h"
@@ -355,6 +356,17 @@ class RtpPacketSender {
                             size_t bytes,
                             bool retransmission) = 0;
 
+  struct BatchedPacket {
+    uint16_t sequence_number;
+    size_t bytes;
+  };
+  // Same as InsertPacket() for each of |packets|, which are non-retransmitted
+  // packets of one frame. Implementations may queue them all at once.
+  virtual void InsertPackets(Priority priority,
+                             uint32_t ssrc,
+                             int64_t capture_time_ms,
+                             rtc::ArrayView<const BatchedPacket> packets);
+
   // Currently audio traffic is not accounted by pacer and passed through.
   // With the introduction of audio BWE audio traffic will be accounted for
   // the pacer budget calculation. The audio traffic still will be injected
@@ -11,8 +11,10 @@
 #include "modules/rtp_rtcp/source/receive_statistics_impl.h"
 
 #include <math.h>
+#include <string.h>
 #include <cstdlib>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -27,6 +29,8 @@ namespace webrtc {
 
 const int64_t kStatisticsTimeoutMs = 8000;
 const int64_t kStatisticsProcessIntervalMs = 1000;
+// Enough for a few streams before the table has to grow.
+const size_t kInitialStatisticianTableCapacity = 16;
 
 StreamStatistician::~StreamStatistician() {}
 
@@ -44,16 +48,24 @@ StreamStatisticianImpl::StreamStatisticianImpl(
       max_reordering_threshold_(max_reordering_threshold),
       enable_retransmit_detection_(enable_retransmit_detection),
       jitter_q4_(0),
-      cumulative_loss_(0),
       last_receive_time_ms_(0),
       last_received_timestamp_(0),
       received_seq_first_(0),
       received_seq_max_(-1),
+      baseline_changes_(0),
+      baseline_seq_max_(-1),
+      baseline_inorder_packets_(0),
+      rtcp_snapshot_version_(0),
+      cumulative_loss_(0),
       last_report_inorder_packets_(0),
       last_report_old_packets_(0),
       last_report_seq_max_(-1),
+      report_baseline_changes_(0),
       rtcp_callback_(rtcp_callback),
-      rtp_callback_(rtp_callback) {}
+      rtp_callback_(rtp_callback) {
+  rtc::CritScope cs(&stream_lock_);
+  PublishRtcpSnapshot();
+}
 
 StreamStatisticianImpl::~StreamStatisticianImpl() = default;
 
@@ -76,9 +88,10 @@ bool StreamStatisticianImpl::UpdateOutOfOrder(const RtpPacketReceived& packet,
     if (packet.SequenceNumber() == expected_sequence_number) {
       // Ignore sequence number gap caused by stream restart for next packet
       // loss calculation.
-      last_report_seq_max_ = sequence_number;
-      last_report_inorder_packets_ = receive_counters_.transmitted.packets -
-                                     receive_counters_.retransmitted.packets;
+      ++baseline_changes_;
+      baseline_seq_max_ = sequence_number;
+      baseline_inorder_packets_ = receive_counters_.transmitted.packets -
+                                  receive_counters_.retransmitted.packets;
       // As final part of stream restart consider |packet| is not out of order.
       return false;
     }
@@ -104,6 +117,13 @@ bool StreamStatisticianImpl::UpdateOutOfOrder(const RtpPacketReceived& packet,
 StreamDataCounters StreamStatisticianImpl::UpdateCounters(
     const RtpPacketReceived& packet) {
   rtc::CritScope cs(&stream_lock_);
+  UpdateReceiveState(packet);
+  PublishRtcpSnapshot();
+  return receive_counters_;
+}
+
+void StreamStatisticianImpl::UpdateReceiveState(
+    const RtpPacketReceived& packet) {
   RTC_DCHECK_EQ(ssrc_, packet.Ssrc());
   int64_t now_ms = clock_->TimeInMilliseconds();
 
@@ -114,10 +134,11 @@ StreamDataCounters StreamStatisticianImpl::UpdateCounters(
       seq_unwrapper_.UnwrapWithoutUpdate(packet.SequenceNumber());
   if (!ReceivedRtpPacket()) {
     received_seq_first_ = sequence_number;
-    last_report_seq_max_ = sequence_number - 1;
+    ++baseline_changes_;
+    baseline_seq_max_ = sequence_number - 1;
     receive_counters_.first_packet_time_ms = now_ms;
   } else if (UpdateOutOfOrder(packet, sequence_number, now_ms)) {
-    return receive_counters_;
+    return;
   }
   // In order packet.
   received_seq_max_ = sequence_number;
@@ -132,7 +153,55 @@ StreamDataCounters StreamStatisticianImpl::UpdateCounters(
   }
   last_received_timestamp_ = packet.Timestamp();
   last_receive_time_ms_ = now_ms;
-  return receive_counters_;
+}
+
+void StreamStatisticianImpl::PublishRtcpSnapshot() {
+  RtcpSnapshot snapshot;
+  snapshot.received_seq_first = received_seq_first_;
+  snapshot.received_seq_max = received_seq_max_;
+  snapshot.last_receive_time_ms = last_receive_time_ms_;
+  snapshot.inorder_packets = receive_counters_.transmitted.packets -
+                             receive_counters_.retransmitted.packets;
+  snapshot.retransmitted_packets = receive_counters_.retransmitted.packets;
+  snapshot.jitter_q4 = jitter_q4_;
+  snapshot.baseline_changes = baseline_changes_;
+  snapshot.baseline_seq_max = baseline_seq_max_;
+  snapshot.baseline_inorder_packets = baseline_inorder_packets_;
+  uint64_t words[kRtcpSnapshotWords] = {};
+  memcpy(words, &snapshot, sizeof(snapshot));
+
+  // |stream_lock_| makes this the only writer.
+  const uint32_t version =
+      rtcp_snapshot_version_.load(std::memory_order_relaxed);
+  rtcp_snapshot_version_.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < kRtcpSnapshotWords; ++i)
+    rtcp_snapshot_words_[i].store(words[i], std::memory_order_relaxed);
+  rtcp_snapshot_version_.store(version + 2, std::memory_order_release);
+}
+
+StreamStatisticianImpl::RtcpSnapshot StreamStatisticianImpl::ReadRtcpSnapshot()
+    const {
+  uint64_t words[kRtcpSnapshotWords];
+  while (true) {
+    const uint32_t version =
+        rtcp_snapshot_version_.load(std::memory_order_acquire);
+    if (version & 1) {
+      // A write is in progress. The writer holds |stream_lock_| until it is
+      // done, so wait for it there rather than spin, which could starve a
+      // writer of lower priority.
+      rtc::CritScope cs(&stream_lock_);
+      continue;
+    }
+    for (size_t i = 0; i < kRtcpSnapshotWords; ++i)
+      words[i] = rtcp_snapshot_words_[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (rtcp_snapshot_version_.load(std::memory_order_relaxed) == version)
+      break;
+  }
+  RtcpSnapshot snapshot;
+  memcpy(&snapshot, words, sizeof(snapshot));
+  return snapshot;
 }
 
 void StreamStatisticianImpl::UpdateJitter(const RtpPacketReceived& packet,
@@ -182,10 +251,12 @@ void StreamStatisticianImpl::EnableRetransmitDetection(bool enable) {
 bool StreamStatisticianImpl::GetStatistics(RtcpStatistics* statistics,
                                            bool reset) {
   {
-    rtc::CritScope cs(&stream_lock_);
-    if (!ReceivedRtpPacket()) {
+    rtc::CritScope cs(&report_lock_);
+    const RtcpSnapshot snapshot = ReadRtcpSnapshot();
+    if (snapshot.received_seq_max < 0) {
       return false;
     }
+    UpdateReportBaseline(snapshot);
 
     if (!reset) {
       if (last_report_inorder_packets_ == 0) {
@@ -197,7 +268,7 @@ bool StreamStatisticianImpl::GetStatistics(RtcpStatistics* statistics,
       return true;
     }
 
-    *statistics = CalculateRtcpStatistics();
+    *statistics = CalculateRtcpStatistics(snapshot);
   }
 
   if (rtcp_callback_)
@@ -208,17 +279,18 @@ bool StreamStatisticianImpl::GetStatistics(RtcpStatistics* statistics,
 bool StreamStatisticianImpl::GetActiveStatisticsAndReset(
     RtcpStatistics* statistics) {
   {
-    rtc::CritScope cs(&stream_lock_);
-    if (clock_->TimeInMilliseconds() - last_receive_time_ms_ >=
+    rtc::CritScope cs(&report_lock_);
+    const RtcpSnapshot snapshot = ReadRtcpSnapshot();
+    if (clock_->TimeInMilliseconds() - snapshot.last_receive_time_ms >=
         kStatisticsTimeoutMs) {
       // Not active.
       return false;
     }
-    if (!ReceivedRtpPacket()) {
+    if (snapshot.received_seq_max < 0) {
       return false;
     }
-
-    *statistics = CalculateRtcpStatistics();
+    UpdateReportBaseline(snapshot);
+    *statistics = CalculateRtcpStatistics(snapshot);
   }
 
   if (rtcp_callback_)
@@ -226,17 +298,26 @@ bool StreamStatisticianImpl::GetActiveStatisticsAndReset(
   return true;
 }
 
-RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics() {
+void StreamStatisticianImpl::UpdateReportBaseline(
+    const RtcpSnapshot& snapshot) {
+  if (snapshot.baseline_changes == report_baseline_changes_)
+    return;
+  report_baseline_changes_ = snapshot.baseline_changes;
+  last_report_seq_max_ = snapshot.baseline_seq_max;
+  last_report_inorder_packets_ = snapshot.baseline_inorder_packets;
+}
+
+RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics(
+    const RtcpSnapshot& snapshot) {
   RtcpStatistics stats;
   // Calculate fraction lost.
-  int64_t exp_since_last = received_seq_max_ - last_report_seq_max_;
+  int64_t exp_since_last = snapshot.received_seq_max - last_report_seq_max_;
   RTC_DCHECK_GE(exp_since_last, 0);
 
   // Number of received RTP packets since last report, counts all packets but
   // not re-transmissions.
-  uint32_t rec_since_last = (receive_counters_.transmitted.packets -
-                             receive_counters_.retransmitted.packets) -
-                            last_report_inorder_packets_;
+  uint32_t rec_since_last =
+      snapshot.inorder_packets - last_report_inorder_packets_;
 
   // With NACK we don't know the expected retransmissions during the last
   // second. We know how many "old" packets we have received. We just count
@@ -248,7 +329,7 @@ RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics() {
   // re-transmitted. We use RTT to decide if a packet is re-ordered or
   // re-transmitted.
   uint32_t retransmitted_packets =
-      receive_counters_.retransmitted.packets - last_report_old_packets_;
+      snapshot.retransmitted_packets - last_report_old_packets_;
   rec_since_last += retransmitted_packets;
 
   int32_t missing = 0;
@@ -267,24 +348,23 @@ RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics() {
   cumulative_loss_ += missing;
   stats.packets_lost = cumulative_loss_;
   stats.extended_highest_sequence_number =
-      static_cast<uint32_t>(received_seq_max_);
+      static_cast<uint32_t>(snapshot.received_seq_max);
   // Note: internal jitter value is in Q4 and needs to be scaled by 1/16.
-  stats.jitter = jitter_q4_ >> 4;
+  stats.jitter = snapshot.jitter_q4 >> 4;
 
   // Store this report.
   last_reported_statistics_ = stats;
 
   // Only for report blocks in RTCP SR and RR.
-  last_report_inorder_packets_ = receive_counters_.transmitted.packets -
-                                 receive_counters_.retransmitted.packets;
-  last_report_old_packets_ = receive_counters_.retransmitted.packets;
-  last_report_seq_max_ = received_seq_max_;
+  last_report_inorder_packets_ = snapshot.inorder_packets;
+  last_report_old_packets_ = snapshot.retransmitted_packets;
+  last_report_seq_max_ = snapshot.received_seq_max;
   BWE_TEST_LOGGING_PLOT_WITH_SSRC(1, "cumulative_loss_pkts",
                                   clock_->TimeInMilliseconds(),
                                   cumulative_loss_, ssrc_);
   BWE_TEST_LOGGING_PLOT_WITH_SSRC(
       1, "received_seq_max_pkts", clock_->TimeInMilliseconds(),
-      (received_seq_max_ - received_seq_first_), ssrc_);
+      (snapshot.received_seq_max - snapshot.received_seq_first), ssrc_);
 
   return stats;
 }
@@ -349,6 +429,45 @@ std::unique_ptr<ReceiveStatistics> ReceiveStatistics::Create(
                                                   rtp_callback);
 }
 
+ReceiveStatisticsImpl::StatisticianTable::StatisticianTable(size_t capacity)
+    : capacity_(capacity), slots_(new Slot[capacity]) {
+  // Index() masks the hash with |capacity_| - 1.
+  RTC_DCHECK_EQ(capacity_ & (capacity_ - 1), 0);
+}
+
+size_t ReceiveStatisticsImpl::StatisticianTable::Index(uint32_t ssrc) const {
+  const uint32_t hash = ssrc * 0x9E3779B1u;
+  return (hash ^ (hash >> 16)) & (capacity_ - 1);
+}
+
+StreamStatisticianImpl* ReceiveStatisticsImpl::StatisticianTable::Find(
+    uint32_t ssrc) const {
+  // The table is at most half full, so there is always an empty slot to stop
+  // at.
+  for (size_t i = Index(ssrc);; i = (i + 1) & (capacity_ - 1)) {
+    StreamStatisticianImpl* statistician =
+        slots_[i].statistician.load(std::memory_order_acquire);
+    if (!statistician)
+      return nullptr;
+    if (slots_[i].ssrc == ssrc)
+      return statistician;
+  }
+}
+
+bool ReceiveStatisticsImpl::StatisticianTable::Insert(
+    uint32_t ssrc,
+    StreamStatisticianImpl* statistician) {
+  if (2 * (size_ + 1) > capacity_)
+    return false;
+  size_t i = Index(ssrc);
+  while (slots_[i].statistician.load(std::memory_order_relaxed))
+    i = (i + 1) & (capacity_ - 1);
+  slots_[i].ssrc = ssrc;
+  slots_[i].statistician.store(statistician, std::memory_order_release);
+  ++size_;
+  return true;
+}
+
 ReceiveStatisticsImpl::ReceiveStatisticsImpl(
     Clock* clock,
     RtcpStatisticsCallback* rtcp_callback,
@@ -357,69 +476,87 @@ ReceiveStatisticsImpl::ReceiveStatisticsImpl(
       last_returned_ssrc_(0),
       max_reordering_threshold_(kDefaultMaxReorderingThreshold),
       rtcp_stats_callback_(rtcp_callback),
-      rtp_stats_callback_(rtp_callback) {}
+      rtp_stats_callback_(rtp_callback) {
+  tables_.push_back(
+      absl::make_unique<StatisticianTable>(kInitialStatisticianTableCapacity));
+  table_.store(tables_.back().get(), std::memory_order_release);
+}
 
 ReceiveStatisticsImpl::~ReceiveStatisticsImpl() {
-  while (!statisticians_.empty()) {
-    delete statisticians_.begin()->second;
-    statisticians_.erase(statisticians_.begin());
+  table_.load(std::memory_order_acquire)
+      ->ForEach([](uint32_t ssrc, StreamStatisticianImpl* statistician) {
+        delete statistician;
+      });
+}
+
+StreamStatisticianImpl* ReceiveStatisticsImpl::GetOrCreateStatistician(
+    uint32_t ssrc) {
+  StreamStatisticianImpl* impl =
+      table_.load(std::memory_order_acquire)->Find(ssrc);
+  if (impl)
+    return impl;
+  rtc::CritScope cs(&receive_statistics_lock_);
+  // Another thread may have added it since the lookup above.
+  impl = table_.load(std::memory_order_relaxed)->Find(ssrc);
+  if (!impl) {
+    impl = new StreamStatisticianImpl(
+        ssrc, clock_, /* enable_retransmit_detection = */ false,
+        max_reordering_threshold_, rtcp_stats_callback_, rtp_stats_callback_);
+    AddStatistician(ssrc, impl);
   }
+  return impl;
+}
+
+void ReceiveStatisticsImpl::AddStatistician(
+    uint32_t ssrc,
+    StreamStatisticianImpl* statistician) {
+  StatisticianTable* table = table_.load(std::memory_order_relaxed);
+  if (table->Insert(ssrc, statistician))
+    return;
+  auto grown = absl::make_unique<StatisticianTable>(2 * table->capacity());
+  table->ForEach(
+      [&grown](uint32_t existing_ssrc, StreamStatisticianImpl* existing) {
+        grown->Insert(existing_ssrc, existing);
+      });
+  RTC_CHECK(grown->Insert(ssrc, statistician));
+  table_.store(grown.get(), std::memory_order_release);
+  tables_.push_back(std::move(grown));
 }
 
 void ReceiveStatisticsImpl::OnRtpPacket(const RtpPacketReceived& packet) {
-  StreamStatisticianImpl* impl;
-  {
-    rtc::CritScope cs(&receive_statistics_lock_);
-    auto it = statisticians_.find(packet.Ssrc());
-    if (it != statisticians_.end()) {
-      impl = it->second;
-    } else {
-      impl = new StreamStatisticianImpl(
-          packet.Ssrc(), clock_, /* enable_retransmit_detection = */ false,
-          max_reordering_threshold_, rtcp_stats_callback_, rtp_stats_callback_);
-      statisticians_[packet.Ssrc()] = impl;
-    }
-  }
   // StreamStatisticianImpl instance is created once and only destroyed when
   // this whole ReceiveStatisticsImpl is destroyed. StreamStatisticianImpl has
   // it's own locking so don't hold receive_statistics_lock_ (potential
   // deadlock).
-  impl->OnRtpPacket(packet);
+  GetOrCreateStatistician(packet.Ssrc())->OnRtpPacket(packet);
 }
 
 void ReceiveStatisticsImpl::FecPacketReceived(const RtpPacketReceived& packet) {
-  StreamStatisticianImpl* impl;
-  {
-    rtc::CritScope cs(&receive_statistics_lock_);
-    auto it = statisticians_.find(packet.Ssrc());
-    // Ignore FEC if it is the first packet.
-    if (it == statisticians_.end())
-      return;
-    impl = it->second;
-  }
+  StreamStatisticianImpl* impl =
+      table_.load(std::memory_order_acquire)->Find(packet.Ssrc());
+  // Ignore FEC if it is the first packet.
+  if (!impl)
+    return;
   impl->FecPacketReceived(packet);
 }
 
 StreamStatistician* ReceiveStatisticsImpl::GetStatistician(
     uint32_t ssrc) const {
-  rtc::CritScope cs(&receive_statistics_lock_);
-  auto it = statisticians_.find(ssrc);
-  if (it == statisticians_.end())
-    return NULL;
-  return it->second;
+  return table_.load(std::memory_order_acquire)->Find(ssrc);
 }
 
 void ReceiveStatisticsImpl::SetMaxReorderingThreshold(
     int max_reordering_threshold) {
-  std::map<uint32_t, StreamStatisticianImpl*> statisticians;
   {
     rtc::CritScope cs(&receive_statistics_lock_);
     max_reordering_threshold_ = max_reordering_threshold;
-    statisticians = statisticians_;
-  }
-  for (auto& statistician : statisticians) {
-    statistician.second->SetMaxReorderingThreshold(max_reordering_threshold);
   }
+  // Statisticians added from now on already use the new threshold.
+  table_.load(std::memory_order_acquire)
+      ->ForEach([max_reordering_threshold](
+                    uint32_t ssrc, StreamStatisticianImpl* statistician) {
+        statistician->SetMaxReorderingThreshold(max_reordering_threshold);
+      });
 }
 
 void ReceiveStatisticsImpl::EnableRetransmitDetection(uint32_t ssrc,
@@ -427,25 +564,28 @@ void ReceiveStatisticsImpl::EnableRetransmitDetection(uint32_t ssrc,
   StreamStatisticianImpl* impl;
   {
     rtc::CritScope cs(&receive_statistics_lock_);
-    StreamStatisticianImpl*& impl_ref = statisticians_[ssrc];
-    if (impl_ref == nullptr) {  // new element
-      impl_ref = new StreamStatisticianImpl(
-          ssrc, clock_, enable, max_reordering_threshold_, rtcp_stats_callback_,
-          rtp_stats_callback_);
+    impl = table_.load(std::memory_order_relaxed)->Find(ssrc);
+    if (impl == nullptr) {  // new element
+      AddStatistician(ssrc, new StreamStatisticianImpl(
+                                ssrc, clock_, enable, max_reordering_threshold_,
+                                rtcp_stats_callback_, rtp_stats_callback_));
       return;
     }
-    impl = impl_ref;
   }
   impl->EnableRetransmitDetection(enable);
 }
 
 std::vector<rtcp::ReportBlock> ReceiveStatisticsImpl::RtcpReportBlocks(
     size_t max_blocks) {
-  std::map<uint32_t, StreamStatisticianImpl*> statisticians;
-  {
-    rtc::CritScope cs(&receive_statistics_lock_);
-    statisticians = statisticians_;
-  }
+  // Collected without a lock, so report generation doesn't block the receive
+  // path. Ordered by SSRC to send reports for the streams in turn.
+  std::vector<std::pair<uint32_t, StreamStatisticianImpl*>> statisticians;
+  table_.load(std::memory_order_acquire)
+      ->ForEach([&statisticians](uint32_t ssrc,
+                                 StreamStatisticianImpl* statistician) {
+        statisticians.emplace_back(ssrc, statistician);
+      });
+  std::sort(statisticians.begin(), statisticians.end());
   std::vector<rtcp::ReportBlock> result;
   result.reserve(std::min(max_blocks, statisticians.size()));
   auto add_report_block = [&result](uint32_t media_ssrc,
@@ -467,7 +607,12 @@ std::vector<rtcp::ReportBlock> ReceiveStatisticsImpl::RtcpReportBlocks(
     block.SetJitter(stats.jitter);
   };
 
-  const auto start_it = statisticians.upper_bound(last_returned_ssrc_);
+  const auto start_it = std::upper_bound(
+      statisticians.begin(), statisticians.end(), last_returned_ssrc_,
+      [](uint32_t ssrc,
+         const std::pair<uint32_t, StreamStatisticianImpl*>& statistician) {
+        return ssrc < statistician.first;
+      });
   for (auto it = start_it;
        result.size() < max_blocks && it != statisticians.end(); ++it)
     add_report_block(it->first, it->second);
@@ -14,7 +14,8 @@
 #include "modules/rtp_rtcp/include/receive_statistics.h"
 
 #include <algorithm>
-#include <map>
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "absl/types/optional.h"
@@ -53,11 +54,41 @@ class StreamStatisticianImpl : public StreamStatistician,
   void EnableRetransmitDetection(bool enable);
 
  private:
+  // Receive state that RTCP statistics are computed from. The receive path
+  // publishes it after every packet, and report generation reads it without
+  // taking |stream_lock_|, so that it never blocks packet reception.
+  struct RtcpSnapshot {
+    int64_t received_seq_first = 0;
+    int64_t received_seq_max = -1;
+    int64_t last_receive_time_ms = 0;
+    uint32_t inorder_packets = 0;
+    uint32_t retransmitted_packets = 0;
+    uint32_t jitter_q4 = 0;
+    // Highest sequence number and in-order packet count that the next report
+    // should count from. Set by the first packet and by stream restarts, which
+    // are counted by |baseline_changes|.
+    uint32_t baseline_changes = 0;
+    int64_t baseline_seq_max = 0;
+    uint32_t baseline_inorder_packets = 0;
+  };
+  static constexpr size_t kRtcpSnapshotWords =
+      (sizeof(RtcpSnapshot) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
   bool IsRetransmitOfOldPacket(const RtpPacketReceived& packet,
                                int64_t now_ms) const
       RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_);
-  RtcpStatistics CalculateRtcpStatistics()
-      RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_);
+  // Writes the current receive state to |rtcp_snapshot_words_|. Readers retry
+  // while |rtcp_snapshot_version_| is odd or changes during their read.
+  void PublishRtcpSnapshot() RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_);
+  // Must be called with |report_lock_| held, so that reports are always
+  // calculated from snapshots in the order they were published.
+  RtcpSnapshot ReadRtcpSnapshot() const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(report_lock_);
+  // Takes over the baseline of |snapshot| if it changed since the last call.
+  void UpdateReportBaseline(const RtcpSnapshot& snapshot)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(report_lock_);
+  RtcpStatistics CalculateRtcpStatistics(const RtcpSnapshot& snapshot)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(report_lock_);
   void UpdateJitter(const RtpPacketReceived& packet, int64_t receive_time_ms)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_);
   // Updates StreamStatistician for out of order packets.
@@ -68,6 +99,8 @@ class StreamStatisticianImpl : public StreamStatistician,
       RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_);
   // Updates StreamStatistician for incoming packets.
   StreamDataCounters UpdateCounters(const RtpPacketReceived& packet);
+  void UpdateReceiveState(const RtpPacketReceived& packet)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_);
   // Checks if this StreamStatistician received any rtp packets.
   bool ReceivedRtpPacket() const RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_) {
     return received_seq_max_ >= 0;
@@ -83,7 +116,6 @@ class StreamStatisticianImpl : public StreamStatistician,
 
   // Stats on received RTP packets.
   uint32_t jitter_q4_ RTC_GUARDED_BY(&stream_lock_);
-  uint32_t cumulative_loss_ RTC_GUARDED_BY(&stream_lock_);
 
   int64_t last_receive_time_ms_ RTC_GUARDED_BY(&stream_lock_);
   uint32_t last_received_timestamp_ RTC_GUARDED_BY(&stream_lock_);
@@ -98,13 +130,26 @@ class StreamStatisticianImpl : public StreamStatistician,
   // Current counter values.
   StreamDataCounters receive_counters_ RTC_GUARDED_BY(&stream_lock_);
 
-  // Counter values when we sent the last report.
-  uint32_t last_report_inorder_packets_ RTC_GUARDED_BY(&stream_lock_);
-  uint32_t last_report_old_packets_ RTC_GUARDED_BY(&stream_lock_);
-  int64_t last_report_seq_max_ RTC_GUARDED_BY(&stream_lock_);
-  RtcpStatistics last_reported_statistics_ RTC_GUARDED_BY(&stream_lock_);
+  uint32_t baseline_changes_ RTC_GUARDED_BY(&stream_lock_);
+  int64_t baseline_seq_max_ RTC_GUARDED_BY(&stream_lock_);
+  uint32_t baseline_inorder_packets_ RTC_GUARDED_BY(&stream_lock_);
 
-  // stream_lock_ shouldn't be held when calling callbacks.
+  std::atomic<uint32_t> rtcp_snapshot_version_;
+  std::atomic<uint64_t> rtcp_snapshot_words_[kRtcpSnapshotWords];
+
+  // Guards the report state, and is never taken by the receive path.
+  rtc::CriticalSection report_lock_;
+  uint32_t cumulative_loss_ RTC_GUARDED_BY(&report_lock_);
+  // Counter values when we sent the last report.
+  uint32_t last_report_inorder_packets_ RTC_GUARDED_BY(&report_lock_);
+  uint32_t last_report_old_packets_ RTC_GUARDED_BY(&report_lock_);
+  int64_t last_report_seq_max_ RTC_GUARDED_BY(&report_lock_);
+  RtcpStatistics last_reported_statistics_ RTC_GUARDED_BY(&report_lock_);
+  // Value of RtcpSnapshot::baseline_changes when the baseline was last taken
+  // over into the report state.
+  uint32_t report_baseline_changes_ RTC_GUARDED_BY(&report_lock_);
+
+  // stream_lock_ and report_lock_ shouldn't be held when calling callbacks.
   RtcpStatisticsCallback* const rtcp_callback_;
   StreamDataCountersCallback* const rtp_callback_;
 };
@@ -130,12 +175,55 @@ class ReceiveStatisticsImpl : public ReceiveStatistics {
   void EnableRetransmitDetection(uint32_t ssrc, bool enable) override;
 
  private:
+  // Open addressing hash table from SSRC to statistician. Slots are filled
+  // once and never cleared, so lookups and iteration don't need a lock.
+  // Inserts are serialized by |receive_statistics_lock_|.
+  class StatisticianTable {
+   public:
+    explicit StatisticianTable(size_t capacity);
+
+    size_t capacity() const { return capacity_; }
+    StreamStatisticianImpl* Find(uint32_t ssrc) const;
+    // Returns false, without inserting, if the table is half full.
+    bool Insert(uint32_t ssrc, StreamStatisticianImpl* statistician);
+    template <typename Callback>
+    void ForEach(Callback callback) const {
+      for (size_t i = 0; i < capacity_; ++i) {
+        StreamStatisticianImpl* statistician =
+            slots_[i].statistician.load(std::memory_order_acquire);
+        if (statistician)
+          callback(slots_[i].ssrc, statistician);
+      }
+    }
+
+   private:
+    struct Slot {
+      uint32_t ssrc = 0;
+      // Stored after |ssrc|, so a non-null value means that |ssrc| is set.
+      std::atomic<StreamStatisticianImpl*> statistician{nullptr};
+    };
+
+    size_t Index(uint32_t ssrc) const;
+
+    const size_t capacity_;
+    size_t size_ = 0;
+    const std::unique_ptr<Slot[]> slots_;
+  };
+
+  StreamStatisticianImpl* GetOrCreateStatistician(uint32_t ssrc);
+  void AddStatistician(uint32_t ssrc, StreamStatisticianImpl* statistician)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(receive_statistics_lock_);
+
   Clock* const clock_;
   rtc::CriticalSection receive_statistics_lock_;
   uint32_t last_returned_ssrc_;
   int max_reordering_threshold_ RTC_GUARDED_BY(receive_statistics_lock_);
-  std::map<uint32_t, StreamStatisticianImpl*> statisticians_
+  // A full table is replaced by one of twice the capacity. Replaced tables are
+  // kept, since lookups may still be reading them, which at most doubles the
+  // memory of the current one.
+  std::vector<std::unique_ptr<StatisticianTable>> tables_
       RTC_GUARDED_BY(receive_statistics_lock_);
+  std::atomic<StatisticianTable*> table_;
 
   RtcpStatisticsCallback* const rtcp_stats_callback_;
   StreamDataCountersCallback* const rtp_stats_callback_;
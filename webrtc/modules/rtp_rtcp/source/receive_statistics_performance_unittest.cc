@@ -0,0 +1,173 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "modules/rtp_rtcp/include/receive_statistics.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumIngestThreads = 4;
+constexpr int kStreamsPerThread = 256;
+constexpr int kPacketsPerStream = 2000;
+constexpr size_t kPayloadSize = 1000;
+constexpr int kVideoFrequency = 90000;
+constexpr size_t kMaxReportBlocks = 31;
+// Far more often than any RTCP sender, to stress the report path.
+constexpr int kReportIntervalMs = 1;
+
+// Feeds |kPacketsPerStream| packets to each of its own |kStreamsPerThread|
+// streams, interleaving the streams like an SFU receiving from many senders.
+class IngestWorker {
+ public:
+  IngestWorker(ReceiveStatistics* statistics, uint32_t first_ssrc)
+      : statistics_(statistics), first_ssrc_(first_ssrc) {
+    for (int i = 0; i < kStreamsPerThread; ++i) {
+      RtpPacketReceived packet;
+      packet.SetSsrc(first_ssrc_ + i);
+      packet.SetSequenceNumber(0);
+      packet.SetTimestamp(0);
+      packet.SetPayloadSize(kPayloadSize);
+      packet.set_payload_type_frequency(kVideoFrequency);
+      packets_.push_back(packet);
+    }
+  }
+
+  static void Run(void* obj) { static_cast<IngestWorker*>(obj)->Ingest(); }
+
+ private:
+  void Ingest() {
+    for (int seq = 0; seq < kPacketsPerStream; ++seq) {
+      const int64_t now_ms = rtc::TimeMillis();
+      for (RtpPacketReceived& packet : packets_) {
+        packet.SetSequenceNumber(seq);
+        packet.SetTimestamp(seq * 3000);
+        packet.set_arrival_time_ms(now_ms);
+        statistics_->OnRtpPacket(packet);
+      }
+    }
+  }
+
+  ReceiveStatistics* const statistics_;
+  const uint32_t first_ssrc_;
+  std::vector<RtpPacketReceived> packets_;
+};
+
+// Generates report blocks every |kReportIntervalMs| until |done| is set.
+class ReportWorker {
+ public:
+  ReportWorker(ReceiveStatistics* statistics, rtc::Event* done)
+      : statistics_(statistics), done_(done) {}
+
+  static void Run(void* obj) { static_cast<ReportWorker*>(obj)->Report(); }
+
+  size_t num_report_blocks() const { return num_report_blocks_; }
+
+ private:
+  void Report() {
+    do {
+      num_report_blocks_ +=
+          statistics_->RtcpReportBlocks(kMaxReportBlocks).size();
+    } while (!done_->Wait(kReportIntervalMs));
+  }
+
+  ReceiveStatistics* const statistics_;
+  rtc::Event* const done_;
+  size_t num_report_blocks_ = 0;
+};
+
+struct IngestionResult {
+  double packets_per_second = 0;
+  double report_blocks_per_second = 0;
+};
+
+// Receives on |kNumIngestThreads| threads in parallel, optionally with another
+// thread generating RTCP report blocks, and returns the aggregate rates.
+IngestionResult MeasureIngestion(bool concurrent_reports) {
+  std::unique_ptr<ReceiveStatistics> statistics =
+      ReceiveStatistics::Create(Clock::GetRealTimeClock(), nullptr, nullptr);
+  std::vector<std::unique_ptr<IngestWorker>> workers;
+  for (int i = 0; i < kNumIngestThreads; ++i) {
+    workers.push_back(absl::make_unique<IngestWorker>(
+        statistics.get(), i * kStreamsPerThread));
+  }
+  rtc::Event done;
+  ReportWorker reporter(statistics.get(), &done);
+  rtc::PlatformThread report_thread(&ReportWorker::Run, &reporter,
+                                    "ReportWorker");
+
+  const int64_t start_ns = rtc::TimeNanos();
+  if (concurrent_reports)
+    report_thread.Start();
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (auto& worker : workers) {
+    threads.push_back(absl::make_unique<rtc::PlatformThread>(
+        &IngestWorker::Run, worker.get(), "IngestWorker"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Stop();
+  const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+  done.Set();
+  if (concurrent_reports)
+    report_thread.Stop();
+
+  for (uint32_t ssrc = 0; ssrc < kNumIngestThreads * kStreamsPerThread;
+       ++ssrc) {
+    StreamStatistician* statistician = statistics->GetStatistician(ssrc);
+    if (!statistician) {
+      ADD_FAILURE() << "No statistician for ssrc " << ssrc;
+      continue;
+    }
+    StreamDataCounters counters;
+    statistician->GetReceiveStreamDataCounters(&counters);
+    EXPECT_EQ(kPacketsPerStream,
+              static_cast<int>(counters.transmitted.packets));
+  }
+
+  const double elapsed_s =
+      static_cast<double>(std::max<int64_t>(elapsed_ns, 1)) /
+      rtc::kNumNanosecsPerSec;
+  IngestionResult result;
+  result.packets_per_second =
+      kNumIngestThreads * kStreamsPerThread * kPacketsPerStream / elapsed_s;
+  result.report_blocks_per_second = reporter.num_report_blocks() / elapsed_s;
+  return result;
+}
+
+}  // namespace
+
+TEST(ReceiveStatisticsPerformanceTest, MultiThreadedIngestion) {
+  IngestionResult result = MeasureIngestion(/*concurrent_reports=*/false);
+  test::PrintResult("receive_statistics_ingestion", "", "no_reports",
+                    result.packets_per_second, "packets_per_second", true);
+}
+
+TEST(ReceiveStatisticsPerformanceTest, MultiThreadedIngestionWithReports) {
+  IngestionResult result = MeasureIngestion(/*concurrent_reports=*/true);
+  test::PrintResult("receive_statistics_ingestion", "", "concurrent_reports",
+                    result.packets_per_second, "packets_per_second", true);
+  test::PrintResult("receive_statistics_report_blocks", "",
+                    "concurrent_reports", result.report_blocks_per_second,
+                    "report_blocks_per_second", false);
+}
+
+}  // namespace webrtc
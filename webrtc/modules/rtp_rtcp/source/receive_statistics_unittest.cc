@@ -8,11 +8,15 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <atomic>
 #include <memory>
+#include <set>
 #include <vector>
 
 #include "modules/rtp_rtcp/include/receive_statistics.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
 #include "rtc_base/random.h"
 #include "system_wrappers/include/clock.h"
 #include "test/gmock.h"
@@ -172,6 +176,33 @@ TEST_F(ReceiveStatisticsTest,
               UnorderedElementsAre(kSsrc1, kSsrc2, kSsrc3, kSsrc4));
 }
 
+TEST_F(ReceiveStatisticsTest, HandlesManySsrcs) {
+  const uint32_t kNumSsrcs = 1000;
+  const uint32_t kSsrcStep = 7919;
+  for (uint32_t i = 0; i < kNumSsrcs; ++i) {
+    receive_statistics_->OnRtpPacket(
+        CreateRtpPacket(i * kSsrcStep, kPacketSize1));
+  }
+  for (uint32_t i = 0; i < kNumSsrcs; ++i) {
+    StreamStatistician* statistician =
+        receive_statistics_->GetStatistician(i * kSsrcStep);
+    ASSERT_TRUE(statistician);
+    StreamDataCounters counters;
+    statistician->GetReceiveStreamDataCounters(&counters);
+    EXPECT_EQ(1u, counters.transmitted.packets);
+  }
+  EXPECT_FALSE(receive_statistics_->GetStatistician(1));
+
+  std::set<uint32_t> observed_ssrcs;
+  for (uint32_t i = 0; i < kNumSsrcs; i += 31) {
+    for (const rtcp::ReportBlock& block :
+         receive_statistics_->RtcpReportBlocks(31)) {
+      observed_ssrcs.insert(block.source_ssrc());
+    }
+  }
+  EXPECT_EQ(kNumSsrcs, observed_ssrcs.size());
+}
+
 TEST_F(ReceiveStatisticsTest, ActiveStatisticians) {
   receive_statistics_->OnRtpPacket(packet1_);
   IncrementSequenceNumber(&packet1_);
@@ -632,5 +663,103 @@ TEST_F(ReceiveStatisticsTest, RtpCallbacksFecFirst) {
   callback.Matches(2, kSsrc1, expected);
 }
 
+// Generates reports for |kSsrc1| every millisecond until |done| is set,
+// checking that every report moves forward and that the lossless stream shows
+// no loss.
+class ConcurrentReporter {
+ public:
+  ConcurrentReporter(ReceiveStatistics* statistics,
+                     bool use_report_blocks,
+                     rtc::Event* done)
+      : statistics_(statistics),
+        use_report_blocks_(use_report_blocks),
+        done_(done) {}
+
+  static void Run(void* obj) { static_cast<ConcurrentReporter*>(obj)->Loop(); }
+
+  int num_reports() const { return num_reports_.load(); }
+  int num_errors() const { return num_errors_; }
+
+ private:
+  void Loop() {
+    uint32_t last_highest_sequence_number = 0;
+    do {
+      uint32_t highest_sequence_number;
+      uint32_t packets_lost;
+      uint8_t fraction_lost;
+      if (use_report_blocks_) {
+        std::vector<rtcp::ReportBlock> blocks =
+            statistics_->RtcpReportBlocks(1);
+        if (blocks.empty())
+          continue;
+        highest_sequence_number = blocks[0].extended_high_seq_num();
+        packets_lost = blocks[0].cumulative_lost();
+        fraction_lost = blocks[0].fraction_lost();
+      } else {
+        StreamStatistician* statistician = statistics_->GetStatistician(kSsrc1);
+        RtcpStatistics statistics;
+        if (!statistician || !statistician->GetStatistics(&statistics, true))
+          continue;
+        highest_sequence_number = statistics.extended_highest_sequence_number;
+        packets_lost = statistics.packets_lost;
+        fraction_lost = statistics.fraction_lost;
+      }
+      if (highest_sequence_number < last_highest_sequence_number ||
+          packets_lost != 0 || fraction_lost != 0) {
+        ++num_errors_;
+      }
+      last_highest_sequence_number = highest_sequence_number;
+      ++num_reports_;
+    } while (!done_->Wait(1));
+  }
+
+  ReceiveStatistics* const statistics_;
+  const bool use_report_blocks_;
+  rtc::Event* const done_;
+  std::atomic<int> num_reports_{0};
+  int num_errors_ = 0;
+};
+
+TEST_F(ReceiveStatisticsTest, ConcurrentReportsDontMoveBaselineBackwards) {
+  const int kMinPackets = 100000;
+  const int kMinReports = 50;
+  rtc::Event done(/*manual_reset=*/true, /*initially_signaled=*/false);
+  ConcurrentReporter block_reporter(receive_statistics_.get(),
+                                    /*use_report_blocks=*/true, &done);
+  ConcurrentReporter stats_reporter(receive_statistics_.get(),
+                                    /*use_report_blocks=*/false, &done);
+  rtc::PlatformThread block_thread(&ConcurrentReporter::Run, &block_reporter,
+                                   "BlockReporter");
+  rtc::PlatformThread stats_thread(&ConcurrentReporter::Run, &stats_reporter,
+                                   "StatsReporter");
+  block_thread.Start();
+  stats_thread.Start();
+
+  // Keep receiving until both reporters have raced with the ingestion.
+  packet1_.SetSequenceNumber(0);
+  int num_packets = 0;
+  while (num_packets < kMinPackets ||
+         block_reporter.num_reports() < kMinReports ||
+         stats_reporter.num_reports() < kMinReports) {
+    receive_statistics_->OnRtpPacket(packet1_);
+    IncrementSequenceNumber(&packet1_);
+    ++num_packets;
+  }
+  done.Set();
+  block_thread.Stop();
+  stats_thread.Stop();
+
+  EXPECT_EQ(0, block_reporter.num_errors());
+  EXPECT_EQ(0, stats_reporter.num_errors());
+
+  RtcpStatistics statistics;
+  ASSERT_TRUE(receive_statistics_->GetStatistician(kSsrc1)->GetStatistics(
+      &statistics, true));
+  EXPECT_EQ(static_cast<uint32_t>(num_packets - 1),
+            statistics.extended_highest_sequence_number);
+  EXPECT_EQ(0, statistics.packets_lost);
+  EXPECT_EQ(0u, statistics.fraction_lost);
+}
+
 }  // namespace
 }  // namespace webrtc
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet_parser.h"
+
+#include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/receiver_report.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/sender_report.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace webrtc {
+namespace rtcp {
+namespace {
+// Same layouts as in sender_report.cc and receiver_report.cc.
+constexpr size_t kSenderReportBaseLength = 24;
+constexpr size_t kReceiverReportBaseLength = 4;
+
+void ParseReportBlocks(uint32_t sender_ssrc,
+                       const uint8_t* next_block,
+                       uint8_t count,
+                       CompoundPacketVisitor* visitor) {
+  ReportBlock report_block;
+  for (uint8_t i = 0; i < count; ++i) {
+    bool block_parsed = report_block.Parse(next_block, ReportBlock::kLength);
+    RTC_DCHECK(block_parsed);
+    visitor->OnReportBlock(sender_ssrc, report_block);
+    next_block += ReportBlock::kLength;
+  }
+}
+
+void ParseSenderReport(const CommonHeader& packet,
+                       CompoundPacketVisitor* visitor) {
+  if (packet.payload_size_bytes() <
+      kSenderReportBaseLength + packet.count() * ReportBlock::kLength) {
+    RTC_LOG(LS_WARNING) << "Packet is too small to contain all the data.";
+    visitor->OnSkippedPacket();
+    return;
+  }
+  const uint8_t* const payload = packet.payload();
+  SenderInfo sender_info;
+  sender_info.sender_ssrc = ByteReader<uint32_t>::ReadBigEndian(&payload[0]);
+  sender_info.ntp.Set(ByteReader<uint32_t>::ReadBigEndian(&payload[4]),
+                      ByteReader<uint32_t>::ReadBigEndian(&payload[8]));
+  sender_info.rtp_timestamp = ByteReader<uint32_t>::ReadBigEndian(&payload[12]);
+  sender_info.packet_count = ByteReader<uint32_t>::ReadBigEndian(&payload[16]);
+  sender_info.octet_count = ByteReader<uint32_t>::ReadBigEndian(&payload[20]);
+  visitor->OnSenderReport(sender_info);
+  ParseReportBlocks(sender_info.sender_ssrc,
+                    payload + kSenderReportBaseLength, packet.count(),
+                    visitor);
+}
+
+void ParseReceiverReport(const CommonHeader& packet,
+                         CompoundPacketVisitor* visitor) {
+  if (packet.payload_size_bytes() <
+      kReceiverReportBaseLength + packet.count() * ReportBlock::kLength) {
+    RTC_LOG(LS_WARNING) << "Packet is too small to contain all the data.";
+    visitor->OnSkippedPacket();
+    return;
+  }
+  const uint32_t sender_ssrc =
+      ByteReader<uint32_t>::ReadBigEndian(packet.payload());
+  visitor->OnReceiverReport(sender_ssrc);
+  ParseReportBlocks(sender_ssrc, packet.payload() + kReceiverReportBaseLength,
+                    packet.count(), visitor);
+}
+
+}  // namespace
+
+bool ParseCompoundPacket(rtc::ArrayView<const uint8_t> packet,
+                         CompoundPacketVisitor* visitor) {
+  const uint8_t* const packet_begin = packet.data();
+  const uint8_t* const packet_end = packet.data() + packet.size();
+  CommonHeader rtcp_block;
+  for (const uint8_t* next_block = packet_begin; next_block != packet_end;
+       next_block = rtcp_block.NextPacket()) {
+    if (!rtcp_block.Parse(next_block, packet_end - next_block)) {
+      if (next_block == packet_begin)
+        return false;
+      visitor->OnSkippedPacket();
+      break;
+    }
+    switch (rtcp_block.type()) {
+      case SenderReport::kPacketType:
+        ParseSenderReport(rtcp_block, visitor);
+        break;
+      case ReceiverReport::kPacketType:
+        ParseReceiverReport(rtcp_block, visitor);
+        break;
+      default:
+        visitor->OnPacket(rtcp_block);
+        break;
+    }
+  }
+  return !packet.empty();
+}
+
+}  // namespace rtcp
+}  // namespace webrtc
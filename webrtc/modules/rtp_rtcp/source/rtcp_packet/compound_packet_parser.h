@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_RTCP_PACKET_COMPOUND_PACKET_PARSER_H_
+#define MODULES_RTP_RTCP_SOURCE_RTCP_PACKET_COMPOUND_PACKET_PARSER_H_
+
+#include <stdint.h>
+
+#include "api/array_view.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/common_header.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/report_block.h"
+#include "system_wrappers/include/ntp_time.h"
+
+namespace webrtc {
+namespace rtcp {
+
+// Sender information of a sender report (RFC 3550 section 6.4.1).
+struct SenderInfo {
+  uint32_t sender_ssrc = 0;
+  NtpTime ntp;
+  uint32_t rtp_timestamp = 0;
+  uint32_t packet_count = 0;
+  uint32_t octet_count = 0;
+};
+
+// Receives the contents of a compound packet from ParseCompoundPacket().
+// Sender and receiver reports are read in place and handed over one report
+// block at a time, so parsing them allocates nothing. Every other packet is
+// handed over with its header, to be parsed by the matching RtcpPacket class.
+class CompoundPacketVisitor {
+ public:
+  virtual ~CompoundPacketVisitor() = default;
+
+  // Each report is followed by OnReportBlock() for each of its blocks.
+  virtual void OnSenderReport(const SenderInfo& sender_info) {}
+  virtual void OnReceiverReport(uint32_t sender_ssrc) {}
+  virtual void OnReportBlock(uint32_t sender_ssrc,
+                             const ReportBlock& report_block) {}
+  // Called for every packet that isn't a sender or receiver report.
+  virtual void OnPacket(const CommonHeader& packet) {}
+  // Called for a report that is too small for its report blocks, and for
+  // trailing data that doesn't start with a valid header.
+  virtual void OnSkippedPacket() {}
+};
+
+// Parses |packet| one block at a time and passes the contents to |visitor|.
+// Returns false, without calling |visitor|, if |packet| doesn't start with a
+// valid header.
+bool ParseCompoundPacket(rtc::ArrayView<const uint8_t> packet,
+                         CompoundPacketVisitor* visitor);
+
+}  // namespace rtcp
+}  // namespace webrtc
+#endif  // MODULES_RTP_RTCP_SOURCE_RTCP_PACKET_COMPOUND_PACKET_PARSER_H_
@@ -0,0 +1,154 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet_parser.h"
+
+#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/fir.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/receiver_report.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/sender_report.h"
+#include "rtc_base/buffer.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+using ::testing::_;
+using ::testing::AllOf;
+using ::testing::Field;
+using ::testing::InSequence;
+using ::testing::Property;
+using webrtc::rtcp::CommonHeader;
+using webrtc::rtcp::CompoundPacket;
+using webrtc::rtcp::CompoundPacketVisitor;
+using webrtc::rtcp::Fir;
+using webrtc::rtcp::ParseCompoundPacket;
+using webrtc::rtcp::ReceiverReport;
+using webrtc::rtcp::ReportBlock;
+using webrtc::rtcp::SenderInfo;
+using webrtc::rtcp::SenderReport;
+
+namespace webrtc {
+namespace {
+const uint32_t kSenderSsrc = 0x12345678;
+const uint32_t kRemoteSsrc = 0x23456789;
+const NtpTime kNtp(0x11121418, 0x22242628);
+const uint32_t kRtpTimestamp = 0x33343536;
+const uint32_t kPacketCount = 0x44454647;
+const uint32_t kOctetCount = 0x55565758;
+
+class MockCompoundPacketVisitor : public CompoundPacketVisitor {
+ public:
+  MOCK_METHOD1(OnSenderReport, void(const SenderInfo&));
+  MOCK_METHOD1(OnReceiverReport, void(uint32_t));
+  MOCK_METHOD2(OnReportBlock, void(uint32_t, const ReportBlock&));
+  MOCK_METHOD1(OnPacket, void(const CommonHeader&));
+  MOCK_METHOD0(OnSkippedPacket, void());
+};
+
+ReportBlock CreateReportBlock(uint32_t media_ssrc) {
+  ReportBlock block;
+  block.SetMediaSsrc(media_ssrc);
+  block.SetFractionLost(55);
+  block.SetExtHighestSeqNum(0x10203);
+  return block;
+}
+}  // namespace
+
+TEST(RtcpCompoundPacketParserTest, ParsesReportsInPlace) {
+  SenderReport sr;
+  sr.SetSenderSsrc(kSenderSsrc);
+  sr.SetNtp(kNtp);
+  sr.SetRtpTimestamp(kRtpTimestamp);
+  sr.SetPacketCount(kPacketCount);
+  sr.SetOctetCount(kOctetCount);
+  EXPECT_TRUE(sr.AddReportBlock(CreateReportBlock(kRemoteSsrc)));
+  ReceiverReport rr;
+  rr.SetSenderSsrc(kSenderSsrc);
+  EXPECT_TRUE(rr.AddReportBlock(CreateReportBlock(kRemoteSsrc + 1)));
+  EXPECT_TRUE(rr.AddReportBlock(CreateReportBlock(kRemoteSsrc + 2)));
+  Fir fir;
+  fir.SetSenderSsrc(kSenderSsrc);
+  fir.AddRequestTo(kRemoteSsrc, 13);
+  CompoundPacket compound;
+  compound.Append(&sr);
+  compound.Append(&rr);
+  compound.Append(&fir);
+  rtc::Buffer packet = compound.Build();
+
+  MockCompoundPacketVisitor visitor;
+  InSequence s;
+  EXPECT_CALL(visitor,
+              OnSenderReport(AllOf(
+                  Field(&SenderInfo::sender_ssrc, kSenderSsrc),
+                  Field(&SenderInfo::ntp, kNtp),
+                  Field(&SenderInfo::rtp_timestamp, kRtpTimestamp),
+                  Field(&SenderInfo::packet_count, kPacketCount),
+                  Field(&SenderInfo::octet_count, kOctetCount))));
+  EXPECT_CALL(visitor,
+              OnReportBlock(kSenderSsrc,
+                            AllOf(Property(&ReportBlock::source_ssrc,
+                                           kRemoteSsrc),
+                                  Property(&ReportBlock::fraction_lost, 55),
+                                  Property(&ReportBlock::extended_high_seq_num,
+                                           0x10203u))));
+  EXPECT_CALL(visitor, OnReceiverReport(kSenderSsrc));
+  EXPECT_CALL(visitor,
+              OnReportBlock(kSenderSsrc, Property(&ReportBlock::source_ssrc,
+                                                  kRemoteSsrc + 1)));
+  EXPECT_CALL(visitor,
+              OnReportBlock(kSenderSsrc, Property(&ReportBlock::source_ssrc,
+                                                  kRemoteSsrc + 2)));
+  EXPECT_CALL(visitor,
+              OnPacket(Property(&CommonHeader::type, Fir::kPacketType)));
+  EXPECT_CALL(visitor, OnSkippedPacket()).Times(0);
+
+  EXPECT_TRUE(ParseCompoundPacket(packet, &visitor));
+}
+
+TEST(RtcpCompoundPacketParserTest, SkipsTooSmallReport) {
+  ReceiverReport rr;
+  rr.SetSenderSsrc(kSenderSsrc);
+  EXPECT_TRUE(rr.AddReportBlock(CreateReportBlock(kRemoteSsrc)));
+  rtc::Buffer packet = rr.Build();
+  // Claim one more report block than the packet holds.
+  packet[0] += 1;
+
+  MockCompoundPacketVisitor visitor;
+  EXPECT_CALL(visitor, OnReceiverReport(_)).Times(0);
+  EXPECT_CALL(visitor, OnReportBlock(_, _)).Times(0);
+  EXPECT_CALL(visitor, OnSkippedPacket());
+
+  EXPECT_TRUE(ParseCompoundPacket(packet, &visitor));
+}
+
+TEST(RtcpCompoundPacketParserTest, SkipsInvalidTrailingData) {
+  ReceiverReport rr;
+  rr.SetSenderSsrc(kSenderSsrc);
+  rtc::Buffer packet = rr.Build();
+  const uint8_t kGarbage[] = {0x00, 0x01, 0x02};
+  packet.AppendData(kGarbage);
+
+  MockCompoundPacketVisitor visitor;
+  EXPECT_CALL(visitor, OnReceiverReport(kSenderSsrc));
+  EXPECT_CALL(visitor, OnSkippedPacket());
+
+  EXPECT_TRUE(ParseCompoundPacket(packet, &visitor));
+}
+
+TEST(RtcpCompoundPacketParserTest, FailsOnInvalidFirstHeader) {
+  const uint8_t kGarbage[] = {0x00, 0x01, 0x02, 0x03};
+
+  MockCompoundPacketVisitor visitor;
+  EXPECT_CALL(visitor, OnSkippedPacket()).Times(0);
+
+  EXPECT_FALSE(ParseCompoundPacket(kGarbage, &visitor));
+  EXPECT_FALSE(ParseCompoundPacket(rtc::ArrayView<const uint8_t>(), &visitor));
+}
+
+}  // namespace webrtc
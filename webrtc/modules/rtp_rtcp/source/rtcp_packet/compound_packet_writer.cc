@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet_writer.h"
+
+#include <string.h>
+
+#include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/receiver_report.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/sdes.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/sender_report.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace webrtc {
+namespace rtcp {
+namespace {
+constexpr size_t kHeaderLength = 4;
+// Sender SSRC followed by the sender info, see sender_report.cc.
+constexpr size_t kSenderReportBaseLength = 24;
+// Sender SSRC, see receiver_report.cc.
+constexpr size_t kReceiverReportBaseLength = 4;
+constexpr uint8_t kSdesCnameTag = 1;
+}  // namespace
+
+CompoundPacketWriter::CompoundPacketWriter(
+    rtc::ArrayView<uint8_t> buffer,
+    RtcpPacket::PacketReadyCallback callback)
+    : buffer_(buffer), callback_(callback) {
+  RTC_DCHECK(callback_);
+}
+
+CompoundPacketWriter::~CompoundPacketWriter() = default;
+
+bool CompoundPacketWriter::AddSenderReport(
+    uint32_t sender_ssrc,
+    NtpTime ntp,
+    uint32_t rtp_timestamp,
+    uint32_t packet_count,
+    uint32_t octet_count,
+    rtc::ArrayView<const ReportBlock> report_blocks) {
+  if (report_blocks.size() > SenderReport::kMaxNumberOfReportBlocks) {
+    RTC_LOG(LS_WARNING) << "Too many report blocks (" << report_blocks.size()
+                        << ") for sender report.";
+    return Fail();
+  }
+  const size_t length = kHeaderLength + kSenderReportBaseLength +
+                        report_blocks.size() * ReportBlock::kLength;
+  if (!Reserve(length))
+    return Fail();
+
+  WriteHeader(report_blocks.size(), SenderReport::kPacketType, length);
+  uint8_t* const payload = &buffer_[index_];
+  ByteWriter<uint32_t>::WriteBigEndian(&payload[0], sender_ssrc);
+  ByteWriter<uint32_t>::WriteBigEndian(&payload[4], ntp.seconds());
+  ByteWriter<uint32_t>::WriteBigEndian(&payload[8], ntp.fractions());
+  ByteWriter<uint32_t>::WriteBigEndian(&payload[12], rtp_timestamp);
+  ByteWriter<uint32_t>::WriteBigEndian(&payload[16], packet_count);
+  ByteWriter<uint32_t>::WriteBigEndian(&payload[20], octet_count);
+  index_ += kSenderReportBaseLength;
+  WriteReportBlocks(report_blocks);
+  return true;
+}
+
+bool CompoundPacketWriter::AddReceiverReport(
+    uint32_t sender_ssrc,
+    rtc::ArrayView<const ReportBlock> report_blocks) {
+  if (report_blocks.size() > ReceiverReport::kMaxNumberOfReportBlocks) {
+    RTC_LOG(LS_WARNING) << "Too many report blocks (" << report_blocks.size()
+                        << ") for receiver report.";
+    return Fail();
+  }
+  const size_t length = kHeaderLength + kReceiverReportBaseLength +
+                        report_blocks.size() * ReportBlock::kLength;
+  if (!Reserve(length))
+    return Fail();
+
+  WriteHeader(report_blocks.size(), ReceiverReport::kPacketType, length);
+  ByteWriter<uint32_t>::WriteBigEndian(&buffer_[index_], sender_ssrc);
+  index_ += kReceiverReportBaseLength;
+  WriteReportBlocks(report_blocks);
+  return true;
+}
+
+bool CompoundPacketWriter::AddSdesCname(uint32_t ssrc,
+                                        absl::string_view cname) {
+  RTC_DCHECK_LE(cname.size(), 0xffu);
+  // SSRC | CNAME=1 | length | cname | null octets up to a 32-bit boundary,
+  // at least one. Same layout as Sdes::Create().
+  const size_t item_length = 4 + 1 + 1 + cname.size();
+  const size_t padding_length = 4 - item_length % 4;
+  const size_t length = kHeaderLength + item_length + padding_length;
+  if (!Reserve(length))
+    return Fail();
+
+  WriteHeader(/*count_or_format=*/1, Sdes::kPacketType, length);
+  uint8_t* const chunk = &buffer_[index_];
+  ByteWriter<uint32_t>::WriteBigEndian(&chunk[0], ssrc);
+  chunk[4] = kSdesCnameTag;
+  chunk[5] = static_cast<uint8_t>(cname.size());
+  memcpy(&chunk[6], cname.data(), cname.size());
+  memset(&chunk[item_length], 0, padding_length);
+  index_ += item_length + padding_length;
+  return true;
+}
+
+bool CompoundPacketWriter::Append(const RtcpPacket& packet) {
+  if (!packet.Create(buffer_.data(), &index_, buffer_.size(), callback_))
+    return Fail();
+  return true;
+}
+
+void CompoundPacketWriter::Flush() {
+  if (index_ == 0)
+    return;
+  callback_(rtc::ArrayView<const uint8_t>(buffer_.data(), index_));
+  index_ = 0;
+}
+
+bool CompoundPacketWriter::Reserve(size_t length) {
+  if (length > buffer_.size())
+    return false;
+  if (index_ + length > buffer_.size())
+    Flush();
+  return true;
+}
+
+bool CompoundPacketWriter::Fail() {
+  ++num_failed_packets_;
+  return false;
+}
+
+void CompoundPacketWriter::WriteHeader(uint8_t count_or_format,
+                                       uint8_t packet_type,
+                                       size_t length_bytes) {
+  RTC_DCHECK_LE(count_or_format, 0x1f);
+  RTC_DCHECK_EQ(length_bytes % 4, 0);
+  // Length in 32-bit words minus one, i.e. without the common header.
+  const size_t length = length_bytes / 4 - 1;
+  RTC_DCHECK_LE(length, 0xffffU);
+  constexpr uint8_t kVersionBits = 2 << 6;
+  buffer_[index_ + 0] = kVersionBits | count_or_format;
+  buffer_[index_ + 1] = packet_type;
+  ByteWriter<uint16_t>::WriteBigEndian(&buffer_[index_ + 2], length);
+  index_ += kHeaderLength;
+}
+
+void CompoundPacketWriter::WriteReportBlocks(
+    rtc::ArrayView<const ReportBlock> report_blocks) {
+  for (const ReportBlock& block : report_blocks) {
+    block.Create(&buffer_[index_]);
+    index_ += ReportBlock::kLength;
+  }
+}
+
+}  // namespace rtcp
+}  // namespace webrtc
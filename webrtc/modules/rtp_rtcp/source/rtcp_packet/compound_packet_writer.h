@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_RTCP_PACKET_COMPOUND_PACKET_WRITER_H_
+#define MODULES_RTP_RTCP_SOURCE_RTCP_PACKET_COMPOUND_PACKET_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "absl/strings/string_view.h"
+#include "api/array_view.h"
+#include "modules/rtp_rtcp/source/rtcp_packet.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/report_block.h"
+#include "rtc_base/constructor_magic.h"
+#include "system_wrappers/include/ntp_time.h"
+
+namespace webrtc {
+namespace rtcp {
+
+// Serializes a compound RTCP packet straight into a caller-provided buffer.
+// Sender reports, receiver reports and single-chunk SDES are written without
+// building an RtcpPacket; any other RtcpPacket can be appended as before.
+// When the next packet doesn't fit, the packets written so far are passed to
+// |callback| and the buffer is reused, just like RtcpPacket::Build() does.
+//
+//  Example:
+//  uint8_t buffer[IP_PACKET_SIZE];
+//  CompoundPacketWriter writer(buffer, send_callback);
+//  writer.AddReceiverReport(sender_ssrc, report_blocks);
+//  writer.AddSdesCname(sender_ssrc, cname);
+//  writer.Append(remb);
+//  writer.Flush();
+class CompoundPacketWriter {
+ public:
+  // |callback| must outlive the writer.
+  CompoundPacketWriter(rtc::ArrayView<uint8_t> buffer,
+                       RtcpPacket::PacketReadyCallback callback);
+  ~CompoundPacketWriter();
+
+  // Each Add or Append method returns false, and writes nothing, if the packet
+  // is invalid or doesn't fit even in an empty buffer.
+  bool AddSenderReport(uint32_t sender_ssrc,
+                       NtpTime ntp,
+                       uint32_t rtp_timestamp,
+                       uint32_t packet_count,
+                       uint32_t octet_count,
+                       rtc::ArrayView<const ReportBlock> report_blocks);
+  bool AddReceiverReport(uint32_t sender_ssrc,
+                         rtc::ArrayView<const ReportBlock> report_blocks);
+  bool AddSdesCname(uint32_t ssrc, absl::string_view cname);
+  bool Append(const RtcpPacket& packet);
+
+  // Passes the packets written since the last callback, if any, to the
+  // callback.
+  void Flush();
+
+  // Number of bytes written since the last callback. They are at the start
+  // of the buffer.
+  size_t size() const { return index_; }
+
+  // Number of packets that an Add or Append method failed to write.
+  size_t num_failed_packets() const { return num_failed_packets_; }
+
+ private:
+  // Makes room for |length| more bytes, passing the packets written so far to
+  // the callback if needed.
+  bool Reserve(size_t length);
+  // Counts a packet that couldn't be written, and returns false.
+  bool Fail();
+  void WriteHeader(uint8_t count_or_format,
+                   uint8_t packet_type,
+                   size_t length_bytes);
+  void WriteReportBlocks(rtc::ArrayView<const ReportBlock> report_blocks);
+
+  const rtc::ArrayView<uint8_t> buffer_;
+  const RtcpPacket::PacketReadyCallback callback_;
+  size_t index_ = 0;
+  size_t num_failed_packets_ = 0;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(CompoundPacketWriter);
+};
+
+}  // namespace rtcp
+}  // namespace webrtc
+#endif  // MODULES_RTP_RTCP_SOURCE_RTCP_PACKET_COMPOUND_PACKET_WRITER_H_
@@ -0,0 +1,204 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet_writer.h"
+
+#include <vector>
+
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/fir.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/receiver_report.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/sdes.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/sender_report.h"
+#include "rtc_base/buffer.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+#include "test/rtcp_packet_parser.h"
+
+using ::testing::_;
+using ::testing::ElementsAreArray;
+using ::testing::MockFunction;
+using webrtc::rtcp::CompoundPacketWriter;
+using webrtc::rtcp::Fir;
+using webrtc::rtcp::ReceiverReport;
+using webrtc::rtcp::ReportBlock;
+using webrtc::rtcp::Sdes;
+using webrtc::rtcp::SenderReport;
+using webrtc::test::RtcpPacketParser;
+
+namespace webrtc {
+namespace {
+const uint32_t kSenderSsrc = 0x12345678;
+const uint32_t kRemoteSsrc = 0x23456789;
+const NtpTime kNtp(0x11121418, 0x22242628);
+const uint32_t kRtpTimestamp = 0x33343536;
+const uint32_t kPacketCount = 0x44454647;
+const uint32_t kOctetCount = 0x55565758;
+const char kCname[] = "alice@host";
+
+std::vector<ReportBlock> CreateReportBlocks(size_t num_blocks) {
+  std::vector<ReportBlock> blocks(num_blocks);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    blocks[i].SetMediaSsrc(kRemoteSsrc + i);
+    blocks[i].SetFractionLost(i);
+    blocks[i].SetExtHighestSeqNum(1000 + i);
+  }
+  return blocks;
+}
+
+// Collects everything passed to it into one buffer.
+class PacketCollector {
+ public:
+  void operator()(rtc::ArrayView<const uint8_t> packet) {
+    ++num_packets_;
+    buffer_.AppendData(packet);
+  }
+
+  int num_packets() const { return num_packets_; }
+  const rtc::Buffer& buffer() const { return buffer_; }
+
+ private:
+  int num_packets_ = 0;
+  rtc::Buffer buffer_;
+};
+}  // namespace
+
+TEST(RtcpCompoundPacketWriterTest, SenderReportMatchesSenderReportClass) {
+  const std::vector<ReportBlock> blocks = CreateReportBlocks(3);
+  SenderReport sr;
+  sr.SetSenderSsrc(kSenderSsrc);
+  sr.SetNtp(kNtp);
+  sr.SetRtpTimestamp(kRtpTimestamp);
+  sr.SetPacketCount(kPacketCount);
+  sr.SetOctetCount(kOctetCount);
+  EXPECT_TRUE(sr.SetReportBlocks(blocks));
+  rtc::Buffer expected = sr.Build();
+
+  uint8_t buffer[IP_PACKET_SIZE];
+  PacketCollector collector;
+  CompoundPacketWriter writer(buffer, collector);
+  EXPECT_TRUE(writer.AddSenderReport(kSenderSsrc, kNtp, kRtpTimestamp,
+                                     kPacketCount, kOctetCount, blocks));
+  writer.Flush();
+
+  EXPECT_EQ(1, collector.num_packets());
+  EXPECT_THAT(collector.buffer(), ElementsAreArray(expected));
+}
+
+TEST(RtcpCompoundPacketWriterTest, ReceiverReportMatchesReceiverReportClass) {
+  const std::vector<ReportBlock> blocks = CreateReportBlocks(2);
+  ReceiverReport rr;
+  rr.SetSenderSsrc(kSenderSsrc);
+  EXPECT_TRUE(rr.SetReportBlocks(blocks));
+  rtc::Buffer expected = rr.Build();
+
+  uint8_t buffer[IP_PACKET_SIZE];
+  PacketCollector collector;
+  CompoundPacketWriter writer(buffer, collector);
+  EXPECT_TRUE(writer.AddReceiverReport(kSenderSsrc, blocks));
+  writer.Flush();
+
+  EXPECT_THAT(collector.buffer(), ElementsAreArray(expected));
+}
+
+TEST(RtcpCompoundPacketWriterTest, SdesCnameMatchesSdesClass) {
+  // Covers every amount of padding.
+  for (const char* cname : {"a", "ab", "abc", "abcd", kCname}) {
+    Sdes sdes;
+    EXPECT_TRUE(sdes.AddCName(kSenderSsrc, cname));
+    rtc::Buffer expected = sdes.Build();
+
+    uint8_t buffer[IP_PACKET_SIZE];
+    PacketCollector collector;
+    CompoundPacketWriter writer(buffer, collector);
+    EXPECT_TRUE(writer.AddSdesCname(kSenderSsrc, cname));
+    writer.Flush();
+
+    EXPECT_THAT(collector.buffer(), ElementsAreArray(expected)) << cname;
+  }
+}
+
+TEST(RtcpCompoundPacketWriterTest, WritesCompoundPacket) {
+  Fir fir;
+  fir.SetSenderSsrc(kSenderSsrc);
+  fir.AddRequestTo(kRemoteSsrc, 13);
+
+  uint8_t buffer[IP_PACKET_SIZE];
+  PacketCollector collector;
+  CompoundPacketWriter writer(buffer, collector);
+  EXPECT_TRUE(writer.AddReceiverReport(kSenderSsrc, CreateReportBlocks(1)));
+  EXPECT_TRUE(writer.AddSdesCname(kSenderSsrc, kCname));
+  EXPECT_TRUE(writer.Append(fir));
+  EXPECT_EQ(0, collector.num_packets());
+  EXPECT_EQ(32u + 24u + 20u, writer.size());
+  writer.Flush();
+  EXPECT_EQ(0u, writer.size());
+
+  EXPECT_EQ(1, collector.num_packets());
+  RtcpPacketParser parser;
+  EXPECT_TRUE(parser.Parse(collector.buffer().data(),
+                           collector.buffer().size()));
+  EXPECT_EQ(1, parser.receiver_report()->num_packets());
+  EXPECT_EQ(kSenderSsrc, parser.receiver_report()->sender_ssrc());
+  EXPECT_EQ(1u, parser.receiver_report()->report_blocks().size());
+  EXPECT_EQ(1, parser.sdes()->num_packets());
+  ASSERT_EQ(1u, parser.sdes()->chunks().size());
+  EXPECT_EQ(kCname, parser.sdes()->chunks()[0].cname);
+  EXPECT_EQ(1, parser.fir()->num_packets());
+}
+
+TEST(RtcpCompoundPacketWriterTest, PassesFullBufferToCallback) {
+  // Room for a receiver report with one block, but not for the SDES too.
+  const size_t kRrLength = 4 + 4 + ReportBlock::kLength;
+  uint8_t buffer[kRrLength + 8];
+  MockFunction<void(rtc::ArrayView<const uint8_t>)> callback;
+  auto callback_function = callback.AsStdFunction();
+  CompoundPacketWriter writer(buffer, callback_function);
+
+  EXPECT_CALL(callback, Call(_)).Times(0);
+  EXPECT_TRUE(writer.AddReceiverReport(kSenderSsrc, CreateReportBlocks(1)));
+  ::testing::Mock::VerifyAndClearExpectations(&callback);
+
+  EXPECT_CALL(callback, Call(_))
+      .WillOnce([&](rtc::ArrayView<const uint8_t> packet) {
+        EXPECT_EQ(kRrLength, packet.size());
+      });
+  EXPECT_TRUE(writer.AddSdesCname(kSenderSsrc, kCname));
+  EXPECT_EQ(24u, writer.size());
+}
+
+TEST(RtcpCompoundPacketWriterTest, FailsWhenPacketDoesNotFitInBuffer) {
+  uint8_t buffer[20];
+  MockFunction<void(rtc::ArrayView<const uint8_t>)> callback;
+  auto callback_function = callback.AsStdFunction();
+  CompoundPacketWriter writer(buffer, callback_function);
+
+  EXPECT_CALL(callback, Call(_)).Times(0);
+  EXPECT_FALSE(writer.AddReceiverReport(kSenderSsrc, CreateReportBlocks(1)));
+  EXPECT_EQ(0u, writer.size());
+  EXPECT_EQ(1u, writer.num_failed_packets());
+}
+
+TEST(RtcpCompoundPacketWriterTest, FailsWithTooManyReportBlocks) {
+  uint8_t buffer[IP_PACKET_SIZE];
+  MockFunction<void(rtc::ArrayView<const uint8_t>)> callback;
+  auto callback_function = callback.AsStdFunction();
+  CompoundPacketWriter writer(buffer, callback_function);
+  const std::vector<ReportBlock> blocks =
+      CreateReportBlocks(ReceiverReport::kMaxNumberOfReportBlocks + 1);
+
+  EXPECT_FALSE(writer.AddReceiverReport(kSenderSsrc, blocks));
+  EXPECT_FALSE(writer.AddSenderReport(kSenderSsrc, kNtp, kRtpTimestamp,
+                                      kPacketCount, kOctetCount, blocks));
+  EXPECT_EQ(0u, writer.size());
+  EXPECT_EQ(2u, writer.num_failed_packets());
+}
+
+}  // namespace webrtc
@@ -0,0 +1,234 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/common_header.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet_parser.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet_writer.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/receiver_report.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/sdes.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/sender_report.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/tmmb_item.h"
+#include "modules/rtp_rtcp/source/rtcp_receiver.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gtest.h"
+#include "test/testsupport/file_utils.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+// Seed corpus of the rtcp_receiver_fuzzer, i.e. a mix of every packet type
+// RTCPReceiver handles, including malformed ones.
+constexpr char kCorpusDir[] = "../test/fuzzers/corpora/rtcp-corpus/";
+constexpr int kCorpusSize = 67;
+constexpr int kNumParseIterations = 20000;
+constexpr int kNumBuildIterations = 500000;
+constexpr int kNumReportBlocks = 4;
+constexpr uint32_t kSenderSsrc = 0x12345678;
+constexpr char kCname[] = "benchmark@host";
+constexpr int kRtcpIntervalMs = 1000;
+
+std::vector<rtc::Buffer> ReadCorpus() {
+  std::vector<rtc::Buffer> corpus;
+  for (int i = 0; i < kCorpusSize; ++i) {
+    const std::string path =
+        test::ResourcePath(kCorpusDir + std::to_string(i), "rtcp");
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+      ADD_FAILURE() << "Failed to open " << path;
+      continue;
+    }
+    rtc::Buffer packet(test::GetFileSize(path));
+    if (fread(packet.data(), 1, packet.size(), file) != packet.size())
+      ADD_FAILURE() << "Failed to read " << path;
+    fclose(file);
+    corpus.push_back(std::move(packet));
+  }
+  return corpus;
+}
+
+double PerSecond(int64_t count, int64_t elapsed_ns) {
+  return static_cast<double>(count) * rtc::kNumNanosecsPerSec /
+         std::max<int64_t>(elapsed_ns, 1);
+}
+
+// What RTCPReceiver used to do for every packet: materialize each report
+// with its report blocks before handling it.
+size_t ParseWithPacketClasses(const rtc::Buffer& packet) {
+  size_t num_report_blocks = 0;
+  const uint8_t* const packet_end = packet.data() + packet.size();
+  rtcp::CommonHeader rtcp_block;
+  for (const uint8_t* next_block = packet.data(); next_block != packet_end;
+       next_block = rtcp_block.NextPacket()) {
+    if (!rtcp_block.Parse(next_block, packet_end - next_block))
+      break;
+    if (rtcp_block.type() == rtcp::SenderReport::kPacketType) {
+      rtcp::SenderReport sender_report;
+      if (sender_report.Parse(rtcp_block))
+        num_report_blocks += sender_report.report_blocks().size();
+    } else if (rtcp_block.type() == rtcp::ReceiverReport::kPacketType) {
+      rtcp::ReceiverReport receiver_report;
+      if (receiver_report.Parse(rtcp_block))
+        num_report_blocks += receiver_report.report_blocks().size();
+    }
+  }
+  return num_report_blocks;
+}
+
+class ReportBlockCounter : public rtcp::CompoundPacketVisitor {
+ public:
+  void OnReportBlock(uint32_t sender_ssrc,
+                     const rtcp::ReportBlock& report_block) override {
+    ++num_report_blocks_;
+  }
+
+  size_t num_report_blocks() const { return num_report_blocks_; }
+
+ private:
+  size_t num_report_blocks_ = 0;
+};
+
+class NullModuleRtpRtcp : public RTCPReceiver::ModuleRtpRtcp {
+ public:
+  void SetTmmbn(std::vector<rtcp::TmmbItem>) override {}
+  void OnRequestSendReport() override {}
+  void OnReceivedNack(const std::vector<uint16_t>&) override {}
+  void OnReceivedRtcpReportBlocks(const ReportBlockList&) override {}
+};
+
+std::vector<rtcp::ReportBlock> CreateReportBlocks() {
+  std::vector<rtcp::ReportBlock> report_blocks(kNumReportBlocks);
+  for (int i = 0; i < kNumReportBlocks; ++i) {
+    report_blocks[i].SetMediaSsrc(kSenderSsrc + 1 + i);
+    report_blocks[i].SetExtHighestSeqNum(1000 * i);
+  }
+  return report_blocks;
+}
+
+}  // namespace
+
+TEST(RtcpPacketPerformanceTest, ParseCorpus) {
+  const std::vector<rtc::Buffer> corpus = ReadCorpus();
+  ASSERT_FALSE(corpus.empty());
+
+  size_t legacy_blocks = 0;
+  int64_t start_ns = rtc::TimeNanos();
+  for (int i = 0; i < kNumParseIterations; ++i) {
+    for (const rtc::Buffer& packet : corpus)
+      legacy_blocks += ParseWithPacketClasses(packet);
+  }
+  const int64_t legacy_ns = rtc::TimeNanos() - start_ns;
+
+  ReportBlockCounter counter;
+  start_ns = rtc::TimeNanos();
+  for (int i = 0; i < kNumParseIterations; ++i) {
+    for (const rtc::Buffer& packet : corpus)
+      rtcp::ParseCompoundPacket(packet, &counter);
+  }
+  const int64_t visitor_ns = rtc::TimeNanos() - start_ns;
+
+  // The corpus holds malformed reports, which both parsers drop.
+  EXPECT_EQ(legacy_blocks, counter.num_report_blocks());
+
+  const int64_t num_packets =
+      static_cast<int64_t>(kNumParseIterations) * corpus.size();
+  test::PrintResult("rtcp_parse", "", "packet_classes",
+                    PerSecond(num_packets, legacy_ns), "packets_per_second",
+                    true);
+  test::PrintResult("rtcp_parse", "", "visitor",
+                    PerSecond(num_packets, visitor_ns), "packets_per_second",
+                    true);
+}
+
+TEST(RtcpPacketPerformanceTest, BuildSenderReport) {
+  const std::vector<rtcp::ReportBlock> report_blocks = CreateReportBlocks();
+  const NtpTime ntp(0x11121418, 0x22242628);
+  size_t legacy_bytes = 0;
+  auto count_legacy = [&](rtc::ArrayView<const uint8_t> packet) {
+    legacy_bytes += packet.size();
+  };
+
+  // What RTCPSender used to do: heap-allocate each packet and build them
+  // through a CompoundPacket.
+  int64_t start_ns = rtc::TimeNanos();
+  for (int i = 0; i < kNumBuildIterations; ++i) {
+    auto sender_report = absl::make_unique<rtcp::SenderReport>();
+    sender_report->SetSenderSsrc(kSenderSsrc);
+    sender_report->SetNtp(ntp);
+    sender_report->SetRtpTimestamp(i);
+    sender_report->SetPacketCount(i);
+    sender_report->SetOctetCount(i);
+    sender_report->SetReportBlocks(report_blocks);
+    auto sdes = absl::make_unique<rtcp::Sdes>();
+    sdes->AddCName(kSenderSsrc, kCname);
+    rtcp::CompoundPacket compound;
+    compound.Append(sender_report.get());
+    compound.Append(sdes.get());
+    compound.Build(IP_PACKET_SIZE, count_legacy);
+  }
+  const int64_t legacy_ns = rtc::TimeNanos() - start_ns;
+
+  size_t writer_bytes = 0;
+  auto count_writer = [&](rtc::ArrayView<const uint8_t> packet) {
+    writer_bytes += packet.size();
+  };
+  uint8_t buffer[IP_PACKET_SIZE];
+  start_ns = rtc::TimeNanos();
+  for (int i = 0; i < kNumBuildIterations; ++i) {
+    rtcp::CompoundPacketWriter writer(buffer, count_writer);
+    writer.AddSenderReport(kSenderSsrc, ntp, i, i, i, report_blocks);
+    writer.AddSdesCname(kSenderSsrc, kCname);
+    writer.Flush();
+  }
+  const int64_t writer_ns = rtc::TimeNanos() - start_ns;
+
+  EXPECT_EQ(legacy_bytes, writer_bytes);
+  test::PrintResult("rtcp_build", "", "packet_classes",
+                    PerSecond(kNumBuildIterations, legacy_ns),
+                    "packets_per_second", true);
+  test::PrintResult("rtcp_build", "", "writer",
+                    PerSecond(kNumBuildIterations, writer_ns),
+                    "packets_per_second", true);
+}
+
+TEST(RtcpPacketPerformanceTest, ReceiveCorpus) {
+  const std::vector<rtc::Buffer> corpus = ReadCorpus();
+  ASSERT_FALSE(corpus.empty());
+  NullModuleRtpRtcp rtp_rtcp_module;
+  SimulatedClock clock(1234);
+  RTCPReceiver receiver(&clock, false, nullptr, nullptr, nullptr, nullptr,
+                        nullptr, kRtcpIntervalMs, &rtp_rtcp_module);
+
+  const int64_t start_ns = rtc::TimeNanos();
+  for (int i = 0; i < kNumParseIterations; ++i) {
+    for (const rtc::Buffer& packet : corpus)
+      receiver.IncomingPacket(packet.data(), packet.size());
+  }
+  const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+
+  test::PrintResult(
+      "rtcp_receive", "", "fuzzer_corpus",
+      PerSecond(static_cast<int64_t>(kNumParseIterations) * corpus.size(),
+                elapsed_ns),
+      "packets_per_second", true);
+}
+
+}  // namespace webrtc
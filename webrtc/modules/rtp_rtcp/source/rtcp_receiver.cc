@@ -24,16 +24,15 @@
 #include "modules/rtp_rtcp/source/rtcp_packet/bye.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/common_header.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/compound_packet.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet_parser.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/extended_reports.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/fir.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/loss_notification.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/nack.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/pli.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/rapid_resync_request.h"
-#include "modules/rtp_rtcp/source/rtcp_packet/receiver_report.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/remb.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/sdes.h"
-#include "modules/rtp_rtcp/source/rtcp_packet/sender_report.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/tmmbn.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/tmmbr.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
@@ -108,6 +107,39 @@ struct RTCPReceiver::RrtrInformation {
   uint32_t local_receive_mid_ntp_time;
 };
 
+// Passes the blocks of a compound packet to the RTCPReceiver handlers.
+class RTCPReceiver::CompoundPacketHandler
+    : public rtcp::CompoundPacketVisitor {
+ public:
+  CompoundPacketHandler(RTCPReceiver* receiver,
+                        PacketInformation* packet_information)
+      : receiver_(receiver), packet_information_(packet_information) {}
+
+  void OnSenderReport(const rtcp::SenderInfo& sender_info) override
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(receiver_->rtcp_receiver_lock_) {
+    receiver_->HandleSenderReport(sender_info, packet_information_);
+  }
+  void OnReceiverReport(uint32_t sender_ssrc) override
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(receiver_->rtcp_receiver_lock_) {
+    receiver_->HandleReceiverReport(sender_ssrc, packet_information_);
+  }
+  void OnReportBlock(uint32_t sender_ssrc,
+                     const ReportBlock& report_block) override
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(receiver_->rtcp_receiver_lock_) {
+    receiver_->HandleReportBlock(report_block, packet_information_,
+                                 sender_ssrc);
+  }
+  void OnPacket(const CommonHeader& rtcp_block) override
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(receiver_->rtcp_receiver_lock_) {
+    receiver_->HandlePacket(rtcp_block, packet_information_);
+  }
+  void OnSkippedPacket() override { ++receiver_->num_skipped_packets_; }
+
+ private:
+  RTCPReceiver* const receiver_;
+  PacketInformation* const packet_information_;
+};
+
 struct RTCPReceiver::ReportBlockWithRtt {
   RTCPReportBlock report_block;
 
@@ -314,84 +346,18 @@ bool RTCPReceiver::ParseCompoundPacket(const uint8_t* packet_begin,
                                        PacketInformation* packet_information) {
   rtc::CritScope lock(&rtcp_receiver_lock_);
 
-  CommonHeader rtcp_block;
-  for (const uint8_t* next_block = packet_begin; next_block != packet_end;
-       next_block = rtcp_block.NextPacket()) {
-    ptrdiff_t remaining_blocks_size = packet_end - next_block;
-    RTC_DCHECK_GT(remaining_blocks_size, 0);
-    if (!rtcp_block.Parse(next_block, remaining_blocks_size)) {
-      if (next_block == packet_begin) {
-        // Failed to parse 1st header, nothing was extracted from this packet.
-        RTC_LOG(LS_WARNING) << "Incoming invalid RTCP packet";
-        return false;
-      }
-      ++num_skipped_packets_;
-      break;
-    }
-
-    if (packet_type_counter_.first_packet_time_ms == -1)
-      packet_type_counter_.first_packet_time_ms = clock_->TimeInMilliseconds();
-
-    switch (rtcp_block.type()) {
-      case rtcp::SenderReport::kPacketType:
-        HandleSenderReport(rtcp_block, packet_information);
-        break;
-      case rtcp::ReceiverReport::kPacketType:
-        HandleReceiverReport(rtcp_block, packet_information);
-        break;
-      case rtcp::Sdes::kPacketType:
-        HandleSdes(rtcp_block, packet_information);
-        break;
-      case rtcp::ExtendedReports::kPacketType:
-        HandleXr(rtcp_block, packet_information);
-        break;
-      case rtcp::Bye::kPacketType:
-        HandleBye(rtcp_block);
-        break;
-      case rtcp::Rtpfb::kPacketType:
-        switch (rtcp_block.fmt()) {
-          case rtcp::Nack::kFeedbackMessageType:
-            HandleNack(rtcp_block, packet_information);
-            break;
-          case rtcp::Tmmbr::kFeedbackMessageType:
-            HandleTmmbr(rtcp_block, packet_information);
-            break;
-          case rtcp::Tmmbn::kFeedbackMessageType:
-            HandleTmmbn(rtcp_block, packet_information);
-            break;
-          case rtcp::RapidResyncRequest::kFeedbackMessageType:
-            HandleSrReq(rtcp_block, packet_information);
-            break;
-          case rtcp::TransportFeedback::kFeedbackMessageType:
-            HandleTransportFeedback(rtcp_block, packet_information);
-            break;
-          default:
-            ++num_skipped_packets_;
-            break;
-        }
-        break;
-      case rtcp::Psfb::kPacketType:
-        switch (rtcp_block.fmt()) {
-          case rtcp::Pli::kFeedbackMessageType:
-            HandlePli(rtcp_block, packet_information);
-            break;
-          case rtcp::Fir::kFeedbackMessageType:
-            HandleFir(rtcp_block, packet_information);
-            break;
-          case rtcp::Psfb::kAfbMessageType:
-            HandlePsfbApp(rtcp_block, packet_information);
-            break;
-          default:
-            ++num_skipped_packets_;
-            break;
-        }
-        break;
-      default:
-        ++num_skipped_packets_;
-        break;
-    }
+  CompoundPacketHandler handler(this, packet_information);
+  if (!rtcp::ParseCompoundPacket(
+          rtc::MakeArrayView(packet_begin, packet_end - packet_begin),
+          &handler)) {
+    // Failed to parse 1st header, nothing was extracted from this packet.
+    RTC_LOG(LS_WARNING) << "Incoming invalid RTCP packet";
+    return false;
   }
 
+  if (packet_type_counter_.first_packet_time_ms == -1)
+    packet_type_counter_.first_packet_time_ms = clock_->TimeInMilliseconds();
+
   if (packet_type_counter_observer_) {
     packet_type_counter_observer_->RtcpPacketTypesCounterUpdated(
         main_ssrc_, packet_type_counter_);
@@ -411,15 +377,65 @@ bool RTCPReceiver::ParseCompoundPacket(const uint8_t* packet_begin,
   return true;
 }
 
-void RTCPReceiver::HandleSenderReport(const CommonHeader& rtcp_block,
-                                      PacketInformation* packet_information) {
-  rtcp::SenderReport sender_report;
-  if (!sender_report.Parse(rtcp_block)) {
-    ++num_skipped_packets_;
-    return;
+void RTCPReceiver::HandlePacket(const CommonHeader& rtcp_block,
+                                PacketInformation* packet_information) {
+  switch (rtcp_block.type()) {
+    case rtcp::Sdes::kPacketType:
+      HandleSdes(rtcp_block, packet_information);
+      break;
+    case rtcp::ExtendedReports::kPacketType:
+      HandleXr(rtcp_block, packet_information);
+      break;
+    case rtcp::Bye::kPacketType:
+      HandleBye(rtcp_block);
+      break;
+    case rtcp::Rtpfb::kPacketType:
+      switch (rtcp_block.fmt()) {
+        case rtcp::Nack::kFeedbackMessageType:
+          HandleNack(rtcp_block, packet_information);
+          break;
+        case rtcp::Tmmbr::kFeedbackMessageType:
+          HandleTmmbr(rtcp_block, packet_information);
+          break;
+        case rtcp::Tmmbn::kFeedbackMessageType:
+          HandleTmmbn(rtcp_block, packet_information);
+          break;
+        case rtcp::RapidResyncRequest::kFeedbackMessageType:
+          HandleSrReq(rtcp_block, packet_information);
+          break;
+        case rtcp::TransportFeedback::kFeedbackMessageType:
+          HandleTransportFeedback(rtcp_block, packet_information);
+          break;
+        default:
+          ++num_skipped_packets_;
+          break;
+      }
+      break;
+    case rtcp::Psfb::kPacketType:
+      switch (rtcp_block.fmt()) {
+        case rtcp::Pli::kFeedbackMessageType:
+          HandlePli(rtcp_block, packet_information);
+          break;
+        case rtcp::Fir::kFeedbackMessageType:
+          HandleFir(rtcp_block, packet_information);
+          break;
+        case rtcp::Psfb::kAfbMessageType:
+          HandlePsfbApp(rtcp_block, packet_information);
+          break;
+        default:
+          ++num_skipped_packets_;
+          break;
+      }
+      break;
+    default:
+      ++num_skipped_packets_;
+      break;
   }
+}
 
-  const uint32_t remote_ssrc = sender_report.sender_ssrc();
+void RTCPReceiver::HandleSenderReport(const rtcp::SenderInfo& sender_info,
+                                      PacketInformation* packet_information) {
+  const uint32_t remote_ssrc = sender_info.sender_ssrc;
 
   packet_information->remote_ssrc = remote_ssrc;
 
@@ -430,37 +446,25 @@ void RTCPReceiver::HandleSenderReport(const CommonHeader& rtcp_block,
     // Only signal that we have received a SR when we accept one.
     packet_information->packet_type_flags |= kRtcpSr;
 
-    remote_sender_ntp_time_ = sender_report.ntp();
-    remote_sender_rtp_time_ = sender_report.rtp_timestamp();
+    remote_sender_ntp_time_ = sender_info.ntp;
+    remote_sender_rtp_time_ = sender_info.rtp_timestamp;
     last_received_sr_ntp_ = TimeMicrosToNtp(clock_->TimeInMicroseconds());
   } else {
     // We will only store the send report from one source, but
     // we will store all the receive blocks.
     packet_information->packet_type_flags |= kRtcpRr;
   }
-
-  for (const rtcp::ReportBlock& report_block : sender_report.report_blocks())
-    HandleReportBlock(report_block, packet_information, remote_ssrc);
+  // The report blocks follow through HandleReportBlock().
 }
 
-void RTCPReceiver::HandleReceiverReport(const CommonHeader& rtcp_block,
+void RTCPReceiver::HandleReceiverReport(uint32_t remote_ssrc,
                                         PacketInformation* packet_information) {
-  rtcp::ReceiverReport receiver_report;
-  if (!receiver_report.Parse(rtcp_block)) {
-    ++num_skipped_packets_;
-    return;
-  }
-
-  const uint32_t remote_ssrc = receiver_report.sender_ssrc();
-
   packet_information->remote_ssrc = remote_ssrc;
 
   UpdateTmmbrRemoteIsAlive(remote_ssrc);
 
   packet_information->packet_type_flags |= kRtcpRr;
-
-  for (const ReportBlock& report_block : receiver_report.report_blocks())
-    HandleReportBlock(report_block, packet_information, remote_ssrc);
+  // The report blocks follow through HandleReportBlock().
 }
 
 void RTCPReceiver::HandleReportBlock(const ReportBlock& report_block,
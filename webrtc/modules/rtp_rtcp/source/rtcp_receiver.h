@@ -31,6 +31,7 @@ namespace rtcp {
 class CommonHeader;
 class ReportBlock;
 class Rrtr;
+struct SenderInfo;
 class TargetBitrate;
 class TmmbItem;
 }  // namespace rtcp
@@ -115,6 +116,7 @@ class RTCPReceiver {
   RtcpStatisticsCallback* GetRtcpStatisticsCallback();
 
  private:
+  class CompoundPacketHandler;
   struct PacketInformation;
   struct TmmbrInformation;
   struct RrtrInformation;
@@ -140,11 +142,16 @@ class RTCPReceiver {
   TmmbrInformation* GetTmmbrInformation(uint32_t remote_ssrc)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(rtcp_receiver_lock_);
 
-  void HandleSenderReport(const rtcp::CommonHeader& rtcp_block,
+  // Handles every packet type but sender and receiver reports.
+  void HandlePacket(const rtcp::CommonHeader& rtcp_block,
+                    PacketInformation* packet_information)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(rtcp_receiver_lock_);
+
+  void HandleSenderReport(const rtcp::SenderInfo& sender_info,
                           PacketInformation* packet_information)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(rtcp_receiver_lock_);
 
-  void HandleReceiverReport(const rtcp::CommonHeader& rtcp_block,
+  void HandleReceiverReport(uint32_t remote_ssrc,
                             PacketInformation* packet_information)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(rtcp_receiver_lock_);
 
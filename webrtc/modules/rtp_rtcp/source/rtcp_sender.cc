@@ -20,24 +20,21 @@
 #include "logging/rtc_event_log/rtc_event_log.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/app.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/bye.h"
-#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/extended_reports.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/fir.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/loss_notification.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/nack.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/pli.h"
-#include "modules/rtp_rtcp/source/rtcp_packet/receiver_report.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/remb.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/sdes.h"
-#include "modules/rtp_rtcp/source/rtcp_packet/sender_report.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/tmmbn.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/tmmbr.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
 #include "modules/rtp_rtcp/source/rtp_rtcp_impl.h"
 #include "modules/rtp_rtcp/source/time_util.h"
 #include "modules/rtp_rtcp/source/tmmbr_help.h"
+#include "rtc_base/buffer.h"
 #include "rtc_base/checks.h"
-#include "rtc_base/constructor_magic.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/numerics/safe_conversions.h"
 #include "rtc_base/trace_event.h"
@@ -65,36 +62,6 @@ RTCPSender::FeedbackState::FeedbackState(FeedbackState&&) = default;
 
 RTCPSender::FeedbackState::~FeedbackState() = default;
 
-class PacketContainer : public rtcp::CompoundPacket {
- public:
-  PacketContainer(Transport* transport, RtcEventLog* event_log)
-      : transport_(transport), event_log_(event_log) {}
-  ~PacketContainer() override {
-    for (RtcpPacket* packet : appended_packets_)
-      delete packet;
-  }
-
-  size_t SendPackets(size_t max_payload_length) {
-    size_t bytes_sent = 0;
-    Build(max_payload_length, [&](rtc::ArrayView<const uint8_t> packet) {
-      if (transport_->SendRtcp(packet.data(), packet.size())) {
-        bytes_sent += packet.size();
-        if (event_log_) {
-          event_log_->Log(
-              absl::make_unique<RtcEventRtcpPacketOutgoing>(packet));
-        }
-      }
-    });
-    return bytes_sent;
-  }
-
- private:
-  Transport* transport_;
-  RtcEventLog* const event_log_;
-
-  RTC_DISALLOW_IMPLICIT_CONSTRUCTORS(PacketContainer);
-};
-
 class RTCPSender::RtcpContext {
  public:
   RtcpContext(const FeedbackState& feedback_state,
@@ -433,7 +400,8 @@ bool RTCPSender::TimeToSendRTCPReport(bool sendKeyframeBeforeRTP) const {
   return false;
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildSR(const RtcpContext& ctx) {
+bool RTCPSender::BuildSR(const RtcpContext& ctx,
+                         rtcp::CompoundPacketWriter* writer) {
   // Timestamp shouldn't be estimated before first media frame.
   RTC_DCHECK_GE(last_frame_capture_time_ms_, 0);
   // The timestamp of this RTCP packet should be estimated as the timestamp of
@@ -452,69 +420,68 @@ std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildSR(const RtcpContext& ctx) {
       timestamp_offset_ + last_rtp_timestamp_ +
       ((ctx.now_us_ + 500) / 1000 - last_frame_capture_time_ms_) * rtp_rate;
 
-  rtcp::SenderReport* report = new rtcp::SenderReport();
-  report->SetSenderSsrc(ssrc_);
-  report->SetNtp(TimeMicrosToNtp(ctx.now_us_));
-  report->SetRtpTimestamp(rtp_timestamp);
-  report->SetPacketCount(ctx.feedback_state_.packets_sent);
-  report->SetOctetCount(ctx.feedback_state_.media_bytes_sent);
-  report->SetReportBlocks(CreateReportBlocks(ctx.feedback_state_));
-
-  return std::unique_ptr<rtcp::RtcpPacket>(report);
+  return writer->AddSenderReport(
+      ssrc_, TimeMicrosToNtp(ctx.now_us_), rtp_timestamp,
+      ctx.feedback_state_.packets_sent, ctx.feedback_state_.media_bytes_sent,
+      CreateReportBlocks(ctx.feedback_state_));
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildSDES(
-    const RtcpContext& ctx) {
+bool RTCPSender::BuildSDES(const RtcpContext& ctx,
+                           rtcp::CompoundPacketWriter* writer) {
   size_t length_cname = cname_.length();
   RTC_CHECK_LT(length_cname, RTCP_CNAME_SIZE);
 
-  rtcp::Sdes* sdes = new rtcp::Sdes();
-  sdes->AddCName(ssrc_, cname_);
+  if (csrc_cnames_.empty()) {
+    return writer->AddSdesCname(ssrc_, cname_);
+  }
+
+  rtcp::Sdes sdes;
+  sdes.AddCName(ssrc_, cname_);
 
   for (const auto& it : csrc_cnames_)
-    RTC_CHECK(sdes->AddCName(it.first, it.second));
+    RTC_CHECK(sdes.AddCName(it.first, it.second));
 
-  return std::unique_ptr<rtcp::RtcpPacket>(sdes);
+  return writer->Append(sdes);
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildRR(const RtcpContext& ctx) {
-  rtcp::ReceiverReport* report = new rtcp::ReceiverReport();
-  report->SetSenderSsrc(ssrc_);
-  report->SetReportBlocks(CreateReportBlocks(ctx.feedback_state_));
-
-  return std::unique_ptr<rtcp::RtcpPacket>(report);
+bool RTCPSender::BuildRR(const RtcpContext& ctx,
+                         rtcp::CompoundPacketWriter* writer) {
+  return writer->AddReceiverReport(ssrc_,
+                                   CreateReportBlocks(ctx.feedback_state_));
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildPLI(const RtcpContext& ctx) {
-  rtcp::Pli* pli = new rtcp::Pli();
-  pli->SetSenderSsrc(ssrc_);
-  pli->SetMediaSsrc(remote_ssrc_);
+bool RTCPSender::BuildPLI(const RtcpContext& ctx,
+                          rtcp::CompoundPacketWriter* writer) {
+  rtcp::Pli pli;
+  pli.SetSenderSsrc(ssrc_);
+  pli.SetMediaSsrc(remote_ssrc_);
 
   ++packet_type_counter_.pli_packets;
 
-  return std::unique_ptr<rtcp::RtcpPacket>(pli);
+  return writer->Append(pli);
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildFIR(const RtcpContext& ctx) {
+bool RTCPSender::BuildFIR(const RtcpContext& ctx,
+                          rtcp::CompoundPacketWriter* writer) {
   ++sequence_number_fir_;
 
-  rtcp::Fir* fir = new rtcp::Fir();
-  fir->SetSenderSsrc(ssrc_);
-  fir->AddRequestTo(remote_ssrc_, sequence_number_fir_);
+  rtcp::Fir fir;
+  fir.SetSenderSsrc(ssrc_);
+  fir.AddRequestTo(remote_ssrc_, sequence_number_fir_);
 
   ++packet_type_counter_.fir_packets;
 
-  return std::unique_ptr<rtcp::RtcpPacket>(fir);
+  return writer->Append(fir);
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildREMB(
-    const RtcpContext& ctx) {
-  rtcp::Remb* remb = new rtcp::Remb();
-  remb->SetSenderSsrc(ssrc_);
-  remb->SetBitrateBps(remb_bitrate_);
-  remb->SetSsrcs(remb_ssrcs_);
+bool RTCPSender::BuildREMB(const RtcpContext& ctx,
+                           rtcp::CompoundPacketWriter* writer) {
+  rtcp::Remb remb;
+  remb.SetSenderSsrc(ssrc_);
+  remb.SetBitrateBps(remb_bitrate_);
+  remb.SetSsrcs(remb_ssrcs_);
 
-  return std::unique_ptr<rtcp::RtcpPacket>(remb);
+  return writer->Append(remb);
 }
 
 void RTCPSender::SetTargetBitrate(unsigned int target_bitrate) {
@@ -522,10 +489,10 @@ void RTCPSender::SetTargetBitrate(unsigned int target_bitrate) {
   tmmbr_send_bps_ = target_bitrate;
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildTMMBR(
-    const RtcpContext& ctx) {
+bool RTCPSender::BuildTMMBR(const RtcpContext& ctx,
+                            rtcp::CompoundPacketWriter* writer) {
   if (ctx.feedback_state_.module == nullptr)
-    return nullptr;
+    return false;
   // Before sending the TMMBR check the received TMMBN, only an owner is
   // allowed to raise the bitrate:
   // * If the sender is an owner of the TMMBN -> send TMMBR
@@ -545,7 +512,7 @@ std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildTMMBR(
       if (candidate.bitrate_bps() == tmmbr_send_bps_ &&
           candidate.packet_overhead() == packet_oh_send_) {
         // Do not send the same tuple.
-        return nullptr;
+        return false;
       }
     }
     if (!tmmbr_owner) {
@@ -559,65 +526,66 @@ std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildTMMBR(
       tmmbr_owner = TMMBRHelp::IsOwner(bounding, ssrc_);
       if (!tmmbr_owner) {
         // Did not enter bounding set, no meaning to send this request.
-        return nullptr;
+        return false;
       }
     }
   }
 
   if (!tmmbr_send_bps_)
-    return nullptr;
+    return false;
 
-  rtcp::Tmmbr* tmmbr = new rtcp::Tmmbr();
-  tmmbr->SetSenderSsrc(ssrc_);
+  rtcp::Tmmbr tmmbr;
+  tmmbr.SetSenderSsrc(ssrc_);
   rtcp::TmmbItem request;
   request.set_ssrc(remote_ssrc_);
   request.set_bitrate_bps(tmmbr_send_bps_);
   request.set_packet_overhead(packet_oh_send_);
-  tmmbr->AddTmmbr(request);
+  tmmbr.AddTmmbr(request);
 
-  return std::unique_ptr<rtcp::RtcpPacket>(tmmbr);
+  return writer->Append(tmmbr);
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildTMMBN(
-    const RtcpContext& ctx) {
-  rtcp::Tmmbn* tmmbn = new rtcp::Tmmbn();
-  tmmbn->SetSenderSsrc(ssrc_);
+bool RTCPSender::BuildTMMBN(const RtcpContext& ctx,
+                            rtcp::CompoundPacketWriter* writer) {
+  rtcp::Tmmbn tmmbn;
+  tmmbn.SetSenderSsrc(ssrc_);
   for (const rtcp::TmmbItem& tmmbr : tmmbn_to_send_) {
     if (tmmbr.bitrate_bps() > 0) {
-      tmmbn->AddTmmbr(tmmbr);
+      tmmbn.AddTmmbr(tmmbr);
     }
   }
 
-  return std::unique_ptr<rtcp::RtcpPacket>(tmmbn);
+  return writer->Append(tmmbn);
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildAPP(const RtcpContext& ctx) {
-  rtcp::App* app = new rtcp::App();
-  app->SetSsrc(ssrc_);
-  app->SetSubType(app_sub_type_);
-  app->SetName(app_name_);
-  app->SetData(app_data_.get(), app_length_);
+bool RTCPSender::BuildAPP(const RtcpContext& ctx,
+                          rtcp::CompoundPacketWriter* writer) {
+  rtcp::App app;
+  app.SetSsrc(ssrc_);
+  app.SetSubType(app_sub_type_);
+  app.SetName(app_name_);
+  app.SetData(app_data_.get(), app_length_);
 
-  return std::unique_ptr<rtcp::RtcpPacket>(app);
+  return writer->Append(app);
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildLossNotification(
-    const RtcpContext& ctx) {
-  auto loss_notification = absl::make_unique<rtcp::LossNotification>(
+bool RTCPSender::BuildLossNotification(const RtcpContext& ctx,
+                                       rtcp::CompoundPacketWriter* writer) {
+  rtcp::LossNotification loss_notification(
       loss_notification_state_.last_decoded_seq_num,
       loss_notification_state_.last_received_seq_num,
       loss_notification_state_.decodability_flag);
-  loss_notification->SetSenderSsrc(ssrc_);
-  loss_notification->SetMediaSsrc(remote_ssrc_);
-  return std::move(loss_notification);
+  loss_notification.SetSenderSsrc(ssrc_);
+  loss_notification.SetMediaSsrc(remote_ssrc_);
+  return writer->Append(loss_notification);
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildNACK(
-    const RtcpContext& ctx) {
-  rtcp::Nack* nack = new rtcp::Nack();
-  nack->SetSenderSsrc(ssrc_);
-  nack->SetMediaSsrc(remote_ssrc_);
-  nack->SetPacketIds(ctx.nack_list_, ctx.nack_size_);
+bool RTCPSender::BuildNACK(const RtcpContext& ctx,
+                           rtcp::CompoundPacketWriter* writer) {
+  rtcp::Nack nack;
+  nack.SetSenderSsrc(ssrc_);
+  nack.SetMediaSsrc(remote_ssrc_);
+  nack.SetPacketIds(ctx.nack_list_, ctx.nack_size_);
 
   // Report stats.
   for (int idx = 0; idx < ctx.nack_size_; ++idx) {
@@ -628,30 +596,31 @@ std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildNACK(
 
   ++packet_type_counter_.nack_packets;
 
-  return std::unique_ptr<rtcp::RtcpPacket>(nack);
+  return writer->Append(nack);
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildBYE(const RtcpContext& ctx) {
-  rtcp::Bye* bye = new rtcp::Bye();
-  bye->SetSenderSsrc(ssrc_);
-  bye->SetCsrcs(csrcs_);
+bool RTCPSender::BuildBYE(const RtcpContext& ctx,
+                          rtcp::CompoundPacketWriter* writer) {
+  rtcp::Bye bye;
+  bye.SetSenderSsrc(ssrc_);
+  bye.SetCsrcs(csrcs_);
 
-  return std::unique_ptr<rtcp::RtcpPacket>(bye);
+  return writer->Append(bye);
 }
 
-std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildExtendedReports(
-    const RtcpContext& ctx) {
-  std::unique_ptr<rtcp::ExtendedReports> xr(new rtcp::ExtendedReports());
-  xr->SetSenderSsrc(ssrc_);
+bool RTCPSender::BuildExtendedReports(const RtcpContext& ctx,
+                                      rtcp::CompoundPacketWriter* writer) {
+  rtcp::ExtendedReports xr;
+  xr.SetSenderSsrc(ssrc_);
 
   if (!sending_ && xr_send_receiver_reference_time_enabled_) {
     rtcp::Rrtr rrtr;
     rrtr.SetNtp(TimeMicrosToNtp(ctx.now_us_));
-    xr->SetRrtr(rrtr);
+    xr.SetRrtr(rrtr);
   }
 
   for (const rtcp::ReceiveTimeInfo& rti : ctx.feedback_state_.last_xr_rtis) {
-    xr->AddDlrrItem(rti);
+    xr.AddDlrrItem(rti);
   }
 
   if (send_video_bitrate_allocation_) {
@@ -666,11 +635,11 @@ std::unique_ptr<rtcp::RtcpPacket> RTCPSender::BuildExtendedReports(
       }
     }
 
-    xr->SetTargetBitrate(target_bitrate);
+    xr.SetTargetBitrate(target_bitrate);
     send_video_bitrate_allocation_ = false;
   }
 
-  return std::move(xr);
+  return writer->Append(xr);
 }
 
 int32_t RTCPSender::SendRTCP(const FeedbackState& feedback_state,
@@ -687,8 +656,15 @@ int32_t RTCPSender::SendCompoundRTCP(
     const std::set<RTCPPacketType>& packet_types,
     int32_t nack_size,
     const uint16_t* nack_list) {
-  PacketContainer container(transport_, event_log_);
-  size_t max_packet_size;
+  // Packets are written straight into |buffer| while holding the lock, and
+  // sent once it is released. If they don't all fit into one compound packet,
+  // the earlier ones are copied to |full_packets|, which is rarely needed.
+  uint8_t buffer[IP_PACKET_SIZE];
+  size_t packet_size = 0;
+  std::vector<rtc::Buffer> full_packets;
+  auto on_buffer_full = [&](rtc::ArrayView<const uint8_t> packet) {
+    full_packets.emplace_back(packet.data(), packet.size());
+  };
 
   {
     rtc::CritScope lock(&critical_section_rtcp_sender_);
@@ -725,7 +701,10 @@ int32_t RTCPSender::SendCompoundRTCP(
 
     PrepareReport(feedback_state);
 
-    std::unique_ptr<rtcp::RtcpPacket> packet_bye;
+    RTC_DCHECK_LE(max_packet_size_, IP_PACKET_SIZE);
+    rtcp::CompoundPacketWriter writer(
+        rtc::ArrayView<uint8_t>(buffer, max_packet_size_), on_buffer_full);
+    bool send_bye = false;
 
     auto it = report_flags_.begin();
     while (it != report_flags_.end()) {
@@ -738,23 +717,19 @@ int32_t RTCPSender::SendCompoundRTCP(
         ++it;
       }
 
-      BuilderFunc func = builder_it->second;
-      std::unique_ptr<rtcp::RtcpPacket> packet = (this->*func)(context);
-      if (packet.get() == nullptr)
-        return -1;
-      // If there is a BYE, don't append now - save it and append it
-      // at the end later.
+      // If there is a BYE, don't write it now - write it at the end.
       if (builder_it->first == kRtcpBye) {
-        packet_bye = std::move(packet);
-      } else {
-        container.Append(packet.release());
+        send_bye = true;
+        continue;
       }
+      BuilderFunc func = builder_it->second;
+      if (!BuildPacket(func, context, &writer))
+        return -1;
     }
 
-    // Append the BYE now at the end
-    if (packet_bye) {
-      container.Append(packet_bye.release());
-    }
+    // Write the BYE now at the end
+    if (send_bye && !BuildPacket(&RTCPSender::BuildBYE, context, &writer))
+      return -1;
 
     if (packet_type_counter_observer_ != nullptr) {
       packet_type_counter_observer_->RtcpPacketTypesCounterUpdated(
@@ -762,13 +737,39 @@ int32_t RTCPSender::SendCompoundRTCP(
     }
 
     RTC_DCHECK(AllVolatileFlagsConsumed());
-    max_packet_size = max_packet_size_;
+    packet_size = writer.size();
   }
 
-  size_t bytes_sent = container.SendPackets(max_packet_size);
+  size_t bytes_sent = 0;
+  auto send_packet = [&](rtc::ArrayView<const uint8_t> packet) {
+    if (transport_->SendRtcp(packet.data(), packet.size())) {
+      bytes_sent += packet.size();
+      if (event_log_)
+        event_log_->Log(absl::make_unique<RtcEventRtcpPacketOutgoing>(packet));
+    }
+  };
+  for (const rtc::Buffer& packet : full_packets)
+    send_packet(packet);
+  if (packet_size > 0)
+    send_packet(rtc::ArrayView<const uint8_t>(buffer, packet_size));
   return bytes_sent == 0 ? -1 : 0;
 }
 
+bool RTCPSender::BuildPacket(BuilderFunc func,
+                             const RtcpContext& context,
+                             rtcp::CompoundPacketWriter* writer) {
+  const size_t num_failed_packets = writer->num_failed_packets();
+  if ((this->*func)(context, writer))
+    return true;
+  // A builder that has nothing to send fails the whole compound packet. A
+  // packet that doesn't fit even in an empty buffer is skipped instead, and
+  // the packets before and after it are still sent.
+  if (writer->num_failed_packets() == num_failed_packets)
+    return false;
+  RTC_LOG(LS_WARNING) << "Failed to write an RTCP packet, skipping it.";
+  return true;
+}
+
 void RTCPSender::PrepareReport(const FeedbackState& feedback_state) {
   bool generate_report;
   if (IsFlagPresent(kRtcpSr) || IsFlagPresent(kRtcpRr)) {
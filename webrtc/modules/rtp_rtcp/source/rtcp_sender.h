@@ -26,6 +26,7 @@
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/rtcp_nack_stats.h"
 #include "modules/rtp_rtcp/source/rtcp_packet.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet_writer.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/dlrr.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/report_block.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/tmmb_item.h"
@@ -157,33 +158,38 @@ class RTCPSender {
       const FeedbackState& feedback_state)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
 
-  std::unique_ptr<rtcp::RtcpPacket> BuildSR(const RtcpContext& context)
+  // Each builder writes its packet to |writer|, and is run by BuildPacket().
+  // Returning false aborts the whole compound packet, unless it's because
+  // |writer| failed to write the packet.
+  bool BuildSR(const RtcpContext& context, rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildRR(const RtcpContext& context)
+  bool BuildRR(const RtcpContext& context, rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildSDES(const RtcpContext& context)
+  bool BuildSDES(const RtcpContext& context, rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildPLI(const RtcpContext& context)
+  bool BuildPLI(const RtcpContext& context, rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildREMB(const RtcpContext& context)
+  bool BuildREMB(const RtcpContext& context, rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildTMMBR(const RtcpContext& context)
+  bool BuildTMMBR(const RtcpContext& context,
+                  rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildTMMBN(const RtcpContext& context)
+  bool BuildTMMBN(const RtcpContext& context,
+                  rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildAPP(const RtcpContext& context)
+  bool BuildAPP(const RtcpContext& context, rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildLossNotification(
-      const RtcpContext& context)
+  bool BuildLossNotification(const RtcpContext& context,
+                             rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildExtendedReports(
-      const RtcpContext& context)
+  bool BuildExtendedReports(const RtcpContext& context,
+                            rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildBYE(const RtcpContext& context)
+  bool BuildBYE(const RtcpContext& context, rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildFIR(const RtcpContext& context)
+  bool BuildFIR(const RtcpContext& context, rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
-  std::unique_ptr<rtcp::RtcpPacket> BuildNACK(const RtcpContext& context)
+  bool BuildNACK(const RtcpContext& context, rtcp::CompoundPacketWriter* writer)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
 
  private:
@@ -294,8 +300,14 @@ class RTCPSender {
   std::set<ReportFlag> report_flags_
       RTC_GUARDED_BY(critical_section_rtcp_sender_);
 
-  typedef std::unique_ptr<rtcp::RtcpPacket> (RTCPSender::*BuilderFunc)(
-      const RtcpContext&);
+  typedef bool (RTCPSender::*BuilderFunc)(const RtcpContext&,
+                                          rtcp::CompoundPacketWriter*);
+  // Runs |func|. Returns false if the compound packet should be aborted, and
+  // true if the packet was written or skipped because it didn't fit.
+  bool BuildPacket(BuilderFunc func,
+                   const RtcpContext& context,
+                   rtcp::CompoundPacketWriter* writer)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(critical_section_rtcp_sender_);
   // Map from RTCPPacketType to builder.
   std::map<uint32_t, BuilderFunc> builders_;
 
@@ -334,6 +334,17 @@ TEST_F(RtcpSenderTest, SendEmptyApp) {
   EXPECT_EQ(0U, parser()->app()->data_size());
 }
 
+TEST_F(RtcpSenderTest, SkipsPacketThatDoesNotFitAndSendsTheRest) {
+  const uint8_t kData[200] = {0};
+  EXPECT_EQ(0, rtcp_sender_->SetApplicationSpecificData(30, 0x6E616D65, kData,
+                                                        sizeof(kData)));
+  rtcp_sender_->SetRTCPStatus(RtcpMode::kCompound);
+  rtcp_sender_->SetMaxRtpPacketSize(100);
+  EXPECT_EQ(0, rtcp_sender_->SendRTCP(feedback_state(), kRtcpApp));
+  EXPECT_EQ(1, parser()->receiver_report()->num_packets());
+  EXPECT_EQ(0, parser()->app()->num_packets());
+}
+
 TEST_F(RtcpSenderTest, SetInvalidApplicationSpecificData) {
   const uint8_t kData[] = {'t', 'e', 's', 't', 'd', 'a', 't'};
   const uint16_t kInvalidDataLength = sizeof(kData) / sizeof(kData[0]);
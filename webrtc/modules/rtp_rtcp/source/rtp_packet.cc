@@ -97,17 +97,6 @@ bool RtpPacket::Parse(rtc::CopyOnWriteBuffer buffer) {
   return true;
 }
 
-std::vector<uint32_t> RtpPacket::Csrcs() const {
-  size_t num_csrc = data()[0] & 0x0F;
-  RTC_DCHECK_GE(capacity(), kFixedHeaderSize + num_csrc * 4);
-  std::vector<uint32_t> csrcs(num_csrc);
-  for (size_t i = 0; i < num_csrc; ++i) {
-    csrcs[i] =
-        ByteReader<uint32_t>::ReadBigEndian(&data()[kFixedHeaderSize + i * 4]);
-  }
-  return csrcs;
-}
-
 void RtpPacket::CopyHeaderFrom(const RtpPacket& packet) {
   RTC_DCHECK_GE(capacity(), packet.headers_size());
 
@@ -117,6 +106,8 @@ void RtpPacket::CopyHeaderFrom(const RtpPacket& packet) {
   timestamp_ = packet.timestamp_;
   ssrc_ = packet.ssrc_;
   payload_offset_ = packet.payload_offset_;
+  num_csrcs_ = packet.num_csrcs_;
+  csrcs_ = packet.csrcs_;
   extensions_ = packet.extensions_;
   extension_entries_ = packet.extension_entries_;
   extensions_size_ = packet.extensions_size_;
@@ -163,10 +154,12 @@ void RtpPacket::SetCsrcs(rtc::ArrayView<const uint32_t> csrcs) {
   RTC_DCHECK_LE(csrcs.size(), 0x0fu);
   RTC_DCHECK_LE(kFixedHeaderSize + 4 * csrcs.size(), capacity());
   payload_offset_ = kFixedHeaderSize + 4 * csrcs.size();
-  WriteAt(0, (data()[0] & 0xF0) | rtc::dchecked_cast<uint8_t>(csrcs.size()));
+  num_csrcs_ = rtc::dchecked_cast<uint8_t>(csrcs.size());
+  WriteAt(0, (data()[0] & 0xF0) | num_csrcs_);
   size_t offset = kFixedHeaderSize;
-  for (uint32_t csrc : csrcs) {
-    ByteWriter<uint32_t>::WriteBigEndian(WriteAt(offset), csrc);
+  for (size_t i = 0; i < csrcs.size(); ++i) {
+    csrcs_[i] = csrcs[i];
+    ByteWriter<uint32_t>::WriteBigEndian(WriteAt(offset), csrcs[i]);
     offset += 4;
   }
   buffer_.SetSize(payload_offset_);
@@ -385,6 +378,7 @@ void RtpPacket::Clear() {
   payload_offset_ = kFixedHeaderSize;
   payload_size_ = 0;
   padding_size_ = 0;
+  num_csrcs_ = 0;
   extensions_size_ = 0;
   extension_entries_.clear();
 
@@ -414,6 +408,11 @@ bool RtpPacket::ParseBuffer(const uint8_t* buffer, size_t size) {
     return false;
   }
   payload_offset_ = kFixedHeaderSize + number_of_crcs * 4;
+  num_csrcs_ = number_of_crcs;
+  for (size_t i = 0; i < number_of_crcs; ++i) {
+    csrcs_[i] =
+        ByteReader<uint32_t>::ReadBigEndian(&buffer[kFixedHeaderSize + i * 4]);
+  }
 
   if (has_padding) {
     padding_size_ = buffer[size - 1];
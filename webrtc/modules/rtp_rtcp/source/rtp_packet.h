@@ -10,10 +10,13 @@
 #ifndef MODULES_RTP_RTCP_SOURCE_RTP_PACKET_H_
 #define MODULES_RTP_RTCP_SOURCE_RTP_PACKET_H_
 
+#include <array>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
 #include "api/array_view.h"
+#include "common_types.h"  // NOLINT(build/include)
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "rtc_base/copy_on_write_buffer.h"
@@ -43,7 +46,9 @@ class RtpPacket {
   bool Parse(const uint8_t* buffer, size_t size);
   bool Parse(rtc::ArrayView<const uint8_t> packet);
 
-  // Parse and move given buffer into Packet.
+  // Parse and move given buffer into Packet. The packet shares the underlying
+  // storage of |packet| instead of copying it, so this is the preferred
+  // overload on the receive path.
   bool Parse(rtc::CopyOnWriteBuffer packet);
 
   // Maps extensions id to their types.
@@ -55,7 +60,11 @@ class RtpPacket {
   uint16_t SequenceNumber() const { return sequence_number_; }
   uint32_t Timestamp() const { return timestamp_; }
   uint32_t Ssrc() const { return ssrc_; }
-  std::vector<uint32_t> Csrcs() const;
+  // Returned view is valid until the packet is modified, parsed again or
+  // destroyed.
+  rtc::ArrayView<const uint32_t> Csrcs() const {
+    return rtc::MakeArrayView(csrcs_.data(), num_csrcs_);
+  }
 
   size_t headers_size() const { return payload_offset_; }
 
@@ -176,9 +185,17 @@ class RtpPacket {
   uint32_t ssrc_;
   size_t payload_offset_;  // Match header size with csrcs and extensions.
   size_t payload_size_;
+  // Host byte order copy of the csrc list, kept so that Csrcs() doesn't need
+  // to allocate.
+  uint8_t num_csrcs_;
+  std::array<uint32_t, kRtpCsrcSize> csrcs_;
 
   ExtensionManager extensions_;
-  std::vector<ExtensionInfo> extension_entries_;
+  // A single packet can't carry more distinct extensions than the extension
+  // map is able to register, so entries are normally stored inline and parsing
+  // a packet doesn't allocate.
+  absl::InlinedVector<ExtensionInfo, kRtpExtensionNumberOfExtensions>
+      extension_entries_;
   size_t extensions_size_ = 0;  // Unaligned.
   rtc::CopyOnWriteBuffer buffer_;
 };
@@ -0,0 +1,127 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "call/rtp_demuxer.h"
+#include "call/rtp_packet_sink_interface.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumStreams = 16;
+constexpr int kNumPackets = 500000;
+constexpr size_t kPayloadSize = 1000;
+constexpr uint8_t kPayloadType = 96;
+constexpr uint32_t kBaseSsrc = 0x1000;
+constexpr uint32_t kCsrcs[] = {0x11111111, 0x22222222, 0x33333333};
+constexpr char kMid[] = "video";
+
+class CountingSink : public RtpPacketSinkInterface {
+ public:
+  void OnRtpPacket(const RtpPacketReceived& packet) override {
+    ++num_packets_;
+    csrc_sum_ += packet.Csrcs().size();
+  }
+
+  int num_packets() const { return num_packets_; }
+
+ private:
+  int num_packets_ = 0;
+  size_t csrc_sum_ = 0;
+};
+
+RtpHeaderExtensionMap CreateExtensionMap() {
+  RtpHeaderExtensionMap extensions;
+  extensions.Register<TransmissionOffset>(1);
+  extensions.Register<AbsoluteSendTime>(2);
+  extensions.Register<TransportSequenceNumber>(3);
+  extensions.Register<AudioLevel>(4);
+  extensions.Register<RtpMid>(5);
+  return extensions;
+}
+
+std::vector<rtc::CopyOnWriteBuffer> CreatePackets(
+    const RtpHeaderExtensionMap& extensions) {
+  std::vector<rtc::CopyOnWriteBuffer> packets;
+  for (int i = 0; i < kNumStreams; ++i) {
+    RtpPacketToSend packet(&extensions);
+    packet.SetPayloadType(kPayloadType);
+    packet.SetSequenceNumber(i);
+    packet.SetTimestamp(i * 3000);
+    packet.SetSsrc(kBaseSsrc + i);
+    packet.SetCsrcs(kCsrcs);
+    packet.SetExtension<TransmissionOffset>(i);
+    packet.SetExtension<AbsoluteSendTime>(i);
+    packet.SetExtension<TransportSequenceNumber>(i);
+    packet.SetExtension<AudioLevel>(true, 10);
+    packet.SetExtension<RtpMid>(kMid);
+    packet.AllocatePayload(kPayloadSize);
+    packets.push_back(packet.Buffer());
+  }
+  return packets;
+}
+
+// Parses and demuxes |kNumPackets| packets and returns the achieved rate in
+// packets per second. When |copy_buffer| is set the packets are parsed through
+// the copying Parse() overload, otherwise the receive buffer is shared.
+double MeasureParseAndDemux(bool copy_buffer) {
+  const RtpHeaderExtensionMap extensions = CreateExtensionMap();
+  const std::vector<rtc::CopyOnWriteBuffer> packets = CreatePackets(extensions);
+
+  CountingSink sink;
+  RtpDemuxerCriteria criteria;
+  criteria.mid = kMid;
+  RtpDemuxer demuxer;
+  EXPECT_TRUE(demuxer.AddSink(criteria, &sink));
+
+  const int64_t start_ns = rtc::TimeNanos();
+  for (int i = 0; i < kNumPackets; ++i) {
+    const rtc::CopyOnWriteBuffer& buffer = packets[i % kNumStreams];
+    RtpPacketReceived packet(&extensions);
+    bool parsed = copy_buffer ? packet.Parse(buffer.cdata(), buffer.size())
+                              : packet.Parse(buffer);
+    if (!parsed || !demuxer.OnRtpPacket(packet)) {
+      ADD_FAILURE() << "Failed to parse or demux packet " << i;
+      break;
+    }
+  }
+  const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+
+  EXPECT_EQ(kNumPackets, sink.num_packets());
+  return static_cast<double>(kNumPackets) * rtc::kNumNanosecsPerSec /
+         std::max<int64_t>(elapsed_ns, 1);
+}
+
+}  // namespace
+
+TEST(RtpPacketPerformanceTest, ParseAndDemuxSharedBuffer) {
+  test::PrintResult("rtp_parse_and_demux", "", "shared_buffer",
+                    MeasureParseAndDemux(/*copy_buffer=*/false),
+                    "packets_per_second", true);
+}
+
+TEST(RtpPacketPerformanceTest, ParseAndDemuxCopiedBuffer) {
+  test::PrintResult("rtp_parse_and_demux", "", "copied_buffer",
+                    MeasureParseAndDemux(/*copy_buffer=*/true),
+                    "packets_per_second", true);
+}
+
+}  // namespace webrtc
@@ -655,6 +655,25 @@ TEST(RtpPacketTest, ParseWithAllFeatures) {
   EXPECT_TRUE(packet.GetExtension<TransmissionOffset>(&time_offset));
 }
 
+TEST(RtpPacketTest, ParseResetsCsrcs) {
+  RtpPacketReceived packet;
+  EXPECT_TRUE(packet.Parse(kPacket, sizeof(kPacket)));
+  EXPECT_THAT(packet.Csrcs(), ElementsAreArray(kCsrcs));
+
+  EXPECT_TRUE(packet.Parse(kMinimumPacket, sizeof(kMinimumPacket)));
+  EXPECT_THAT(packet.Csrcs(), IsEmpty());
+}
+
+TEST(RtpPacketTest, CopyHeaderKeepsCsrcs) {
+  RtpPacketToSend packet(nullptr);
+  packet.SetCsrcs(kCsrcs);
+  EXPECT_THAT(packet.Csrcs(), ElementsAreArray(kCsrcs));
+
+  RtpPacketToSend copy(nullptr);
+  copy.CopyHeaderFrom(packet);
+  EXPECT_THAT(copy.Csrcs(), ElementsAreArray(kCsrcs));
+}
+
 TEST(RtpPacketTest, ParseTwoByteHeaderExtension) {
   RtpPacketToSend::ExtensionManager extensions;
   extensions.Register(kRtpExtensionTransmissionTimeOffset, kTwoByteExtensionId);
@@ -744,6 +744,45 @@ bool RTPSender::SendToNetwork(std::unique_ptr<RtpPacketToSend> packet,
   return sent;
 }
 
+size_t RTPSender::SendPacketsToNetwork(
+    std::vector<std::unique_ptr<RtpPacketToSend>> packets,
+    StorageType storage,
+    RtpPacketSender::Priority priority) {
+  size_t total_size = 0;
+  if (packets.empty())
+    return total_size;
+  if (!paced_sender_) {
+    for (auto& packet : packets) {
+      const size_t packet_size = packet->size();
+      if (SendToNetwork(std::move(packet), storage, priority))
+        total_size += packet_size;
+    }
+    return total_size;
+  }
+
+  const uint32_t ssrc = packets.front()->Ssrc();
+  RTC_DCHECK(ssrc != FlexfecSsrc());
+  // Correct offset between implementations of millisecond time stamps in
+  // TickTime and Clock.
+  const int64_t corrected_time_ms =
+      packets.front()->capture_time_ms() + clock_delta_ms_;
+  std::vector<RtpPacketSender::BatchedPacket> batch;
+  batch.reserve(packets.size());
+  for (auto& packet : packets) {
+    RTC_DCHECK_EQ(packet->Ssrc(), ssrc);
+    RTC_DCHECK_EQ(packet->capture_time_ms() + clock_delta_ms_,
+                  corrected_time_ms);
+    batch.push_back(
+        {packet->SequenceNumber(), send_side_bwe_with_overhead_
+                                       ? packet->size()
+                                       : packet->payload_size()});
+    total_size += packet->size();
+    packet_history_.PutRtpPacket(std::move(packet), storage, absl::nullopt);
+  }
+  paced_sender_->InsertPackets(priority, ssrc, corrected_time_ms, batch);
+  return total_size;
+}
+
 void RTPSender::RecomputeMaxSendDelay() {
   max_delay_it_ = send_delays_.begin();
   for (auto it = send_delays_.begin(); it != send_delays_.end(); ++it) {
@@ -1038,8 +1077,7 @@ static void CopyHeaderAndExtensionsToRtxPacket(const RtpPacketToSend& packet,
   // Set the variable fields in the packet header:
   // * CSRCs - must be set before header extensions.
   // * Header extensions - replace Rid header with RepairedRid header.
-  const std::vector<uint32_t> csrcs = packet.Csrcs();
-  rtx_packet->SetCsrcs(csrcs);
+  rtx_packet->SetCsrcs(packet.Csrcs());
   for (int extension = kRtpExtensionNone + 1;
        extension < kRtpExtensionNumberOfExtensions; ++extension) {
     RTPExtensionType source_extension =
@@ -157,6 +157,13 @@ class RTPSender {
   bool SendToNetwork(std::unique_ptr<RtpPacketToSend> packet,
                      StorageType storage,
                      RtpPacketSender::Priority priority);
+  // Same as SendToNetwork() for each of the packets of a frame, but with a
+  // pacer they are stored and queued as one batch. Returns the total size of
+  // the packets that were sent or queued.
+  size_t SendPacketsToNetwork(
+      std::vector<std::unique_ptr<RtpPacketToSend>> packets,
+      StorageType storage,
+      RtpPacketSender::Priority priority);
 
   // Called on update of RTP statistics.
   void RegisterRtpStatisticsCallback(StreamDataCountersCallback* callback);
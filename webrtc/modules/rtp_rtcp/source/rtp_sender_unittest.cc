@@ -260,7 +260,7 @@ TEST_P(RtpSenderTestWithoutPacer, AllocatePacketSetCsrc) {
 
   ASSERT_TRUE(packet);
   EXPECT_EQ(rtp_sender_->SSRC(), packet->Ssrc());
-  EXPECT_EQ(csrcs, packet->Csrcs());
+  EXPECT_THAT(packet->Csrcs(), ElementsAreArray(csrcs));
 }
 
 TEST_P(RtpSenderTestWithoutPacer, AllocatePacketReserveExtensions) {
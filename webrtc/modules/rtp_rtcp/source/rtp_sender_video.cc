@@ -344,6 +344,83 @@ void RTPSenderVideo::SendVideoPacketWithFlexfec(
   }
 }
 
+bool RTPSenderVideo::SendVideoPacketBatch(
+    RtpPacketizer* packetizer,
+    const RtpPacketizer::PayloadSizeLimits& limits,
+    std::unique_ptr<RtpPacketToSend> single_packet,
+    std::unique_ptr<RtpPacketToSend> first_packet,
+    const RtpPacketToSend& middle_packet,
+    std::unique_ptr<RtpPacketToSend> last_packet,
+    StorageType storage,
+    const absl::optional<PlayoutDelay>& playout_delay,
+    bool first_frame,
+    size_t* packetized_payload_size) {
+  const size_t num_packets = packetizer->NumPackets();
+  std::vector<std::unique_ptr<RtpPacketToSend>> packets;
+  packets.reserve(num_packets);
+  size_t frame_size = 0;
+  for (size_t i = 0; i < num_packets; ++i) {
+    std::unique_ptr<RtpPacketToSend> packet;
+    int expected_payload_capacity;
+    // Choose right packet template:
+    if (num_packets == 1) {
+      packet = std::move(single_packet);
+      expected_payload_capacity =
+          limits.max_payload_len - limits.single_packet_reduction_len;
+    } else if (i == 0) {
+      packet = std::move(first_packet);
+      expected_payload_capacity =
+          limits.max_payload_len - limits.first_packet_reduction_len;
+    } else if (i == num_packets - 1) {
+      packet = std::move(last_packet);
+      expected_payload_capacity =
+          limits.max_payload_len - limits.last_packet_reduction_len;
+    } else {
+      packet = absl::make_unique<RtpPacketToSend>(middle_packet);
+      expected_payload_capacity = limits.max_payload_len;
+    }
+
+    if (!packetizer->NextPacket(packet.get()))
+      return false;
+    RTC_DCHECK_LE(packet->payload_size(), expected_payload_capacity);
+    if (!rtp_sender_->AssignSequenceNumber(packet.get()))
+      return false;
+    *packetized_payload_size += packet->payload_size();
+    frame_size += packet->size();
+
+    if (i == 0) {
+      playout_delay_oracle_->OnSentPacket(packet->SequenceNumber(),
+                                          playout_delay);
+    }
+    // Put packetization finish timestamp into extension.
+    if (packet->HasExtension<VideoTimingExtension>())
+      packet->set_packetization_finish_time_ms(clock_->TimeInMilliseconds());
+
+    packets.push_back(std::move(packet));
+  }
+
+  const uint16_t first_seq_num = packets.front()->SequenceNumber();
+  const uint16_t last_seq_num = packets.back()->SequenceNumber();
+  const size_t sent_size = LogAndSendToNetwork(std::move(packets), storage,
+                                               RtpPacketSender::kLowPriority);
+  if (sent_size < frame_size) {
+    RTC_LOG(LS_WARNING) << "Failed to send some of video packets "
+                        << first_seq_num << " to " << last_seq_num;
+  }
+  if (sent_size > 0) {
+    rtc::CritScope cs(&stats_crit_);
+    video_bitrate_.Update(sent_size, clock_->TimeInMilliseconds());
+  }
+
+  if (first_frame) {
+    RTC_LOG(LS_INFO)
+        << "Sent first RTP packet of the first video frame (pre-pacer)";
+    RTC_LOG(LS_INFO)
+        << "Sent last RTP packet of the first video frame (pre-pacer)";
+  }
+  return true;
+}
+
 bool RTPSenderVideo::LogAndSendToNetwork(
     std::unique_ptr<RtpPacketToSend> packet,
     StorageType storage,
@@ -362,6 +439,24 @@ bool RTPSenderVideo::LogAndSendToNetwork(
   return rtp_sender_->SendToNetwork(std::move(packet), storage, priority);
 }
 
+size_t RTPSenderVideo::LogAndSendToNetwork(
+    std::vector<std::unique_ptr<RtpPacketToSend>> packets,
+    StorageType storage,
+    RtpPacketSender::Priority priority) {
+#if BWE_TEST_LOGGING_COMPILE_TIME_ENABLE
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  uint32_t ssrc = packets.front()->Ssrc();
+  BWE_TEST_LOGGING_PLOT_WITH_SSRC(1, "VideoTotBitrate_kbps", now_ms,
+                                  rtp_sender_->ActualSendBitrateKbit(), ssrc);
+  BWE_TEST_LOGGING_PLOT_WITH_SSRC(1, "VideoFecBitrate_kbps", now_ms,
+                                  FecOverheadRate() / 1000, ssrc);
+  BWE_TEST_LOGGING_PLOT_WITH_SSRC(1, "VideoNackBitrate_kbps", now_ms,
+                                  rtp_sender_->NackOverheadRate() / 1000, ssrc);
+#endif
+  return rtp_sender_->SendPacketsToNetwork(std::move(packets), storage,
+                                           priority);
+}
+
 void RTPSenderVideo::SetUlpfecConfig(int red_payload_type,
                                      int ulpfec_payload_type) {
   // Sanity check. Per the definition of UlpfecConfig (see config.h),
@@ -639,72 +734,80 @@ bool RTPSenderVideo::SendVideo(VideoFrameType frame_type,
     return false;
 
   bool first_frame = first_frame_sent_();
-  for (size_t i = 0; i < num_packets; ++i) {
-    std::unique_ptr<RtpPacketToSend> packet;
-    int expected_payload_capacity;
-    // Choose right packet template:
-    if (num_packets == 1) {
-      packet = std::move(single_packet);
-      expected_payload_capacity =
-          limits.max_payload_len - limits.single_packet_reduction_len;
-    } else if (i == 0) {
-      packet = std::move(first_packet);
-      expected_payload_capacity =
-          limits.max_payload_len - limits.first_packet_reduction_len;
-    } else if (i == num_packets - 1) {
-      packet = std::move(last_packet);
-      expected_payload_capacity =
-          limits.max_payload_len - limits.last_packet_reduction_len;
-    } else {
-      packet = absl::make_unique<RtpPacketToSend>(*middle_packet);
-      expected_payload_capacity = limits.max_payload_len;
-    }
-
-    if (!packetizer->NextPacket(packet.get()))
-      return false;
-    RTC_DCHECK_LE(packet->payload_size(), expected_payload_capacity);
-    if (!rtp_sender_->AssignSequenceNumber(packet.get()))
+  if (!flexfec_enabled() && !red_enabled) {
+    if (!SendVideoPacketBatch(packetizer.get(), limits,
+                              std::move(single_packet), std::move(first_packet),
+                              *middle_packet, std::move(last_packet), storage,
+                              playout_delay, first_frame,
+                              &packetized_payload_size)) {
       return false;
-    packetized_payload_size += packet->payload_size();
-
-    if (i == 0) {
-      playout_delay_oracle_->OnSentPacket(packet->SequenceNumber(),
-                                          playout_delay);
-    }
-    // No FEC protection for upper temporal layers, if used.
-    bool protect_packet = temporal_id == 0 || temporal_id == kNoTemporalIdx;
-
-    // Put packetization finish timestamp into extension.
-    if (packet->HasExtension<VideoTimingExtension>()) {
-      packet->set_packetization_finish_time_ms(clock_->TimeInMilliseconds());
-      // TODO(ilnik): Due to webrtc:7859, packets with timing extensions are not
-      // protected by FEC. It reduces FEC efficiency a bit. When FEC is moved
-      // below the pacer, it can be re-enabled for these packets.
-      // NOTE: Any RTP stream processor in the network, modifying 'network'
-      // timestamps in the timing frames extension have to be an end-point for
-      // FEC, otherwise recovered by FEC packets will be corrupted.
-      protect_packet = false;
     }
+  } else {
+    for (size_t i = 0; i < num_packets; ++i) {
+      std::unique_ptr<RtpPacketToSend> packet;
+      int expected_payload_capacity;
+      // Choose right packet template:
+      if (num_packets == 1) {
+        packet = std::move(single_packet);
+        expected_payload_capacity =
+            limits.max_payload_len - limits.single_packet_reduction_len;
+      } else if (i == 0) {
+        packet = std::move(first_packet);
+        expected_payload_capacity =
+            limits.max_payload_len - limits.first_packet_reduction_len;
+      } else if (i == num_packets - 1) {
+        packet = std::move(last_packet);
+        expected_payload_capacity =
+            limits.max_payload_len - limits.last_packet_reduction_len;
+      } else {
+        packet = absl::make_unique<RtpPacketToSend>(*middle_packet);
+        expected_payload_capacity = limits.max_payload_len;
+      }
 
-    if (flexfec_enabled()) {
-      // TODO(brandtr): Remove the FlexFEC code path when FlexfecSender
-      // is wired up to PacedSender instead.
-      SendVideoPacketWithFlexfec(std::move(packet), storage, protect_packet);
-    } else if (red_enabled) {
-      SendVideoPacketAsRedMaybeWithUlpfec(std::move(packet), storage,
-                                          protect_packet);
-    } else {
-      SendVideoPacket(std::move(packet), storage);
-    }
+      if (!packetizer->NextPacket(packet.get()))
+        return false;
+      RTC_DCHECK_LE(packet->payload_size(), expected_payload_capacity);
+      if (!rtp_sender_->AssignSequenceNumber(packet.get()))
+        return false;
+      packetized_payload_size += packet->payload_size();
 
-    if (first_frame) {
       if (i == 0) {
-        RTC_LOG(LS_INFO)
-            << "Sent first RTP packet of the first video frame (pre-pacer)";
+        playout_delay_oracle_->OnSentPacket(packet->SequenceNumber(),
+                                            playout_delay);
+      }
+      // No FEC protection for upper temporal layers, if used.
+      bool protect_packet = temporal_id == 0 || temporal_id == kNoTemporalIdx;
+
+      // Put packetization finish timestamp into extension.
+      if (packet->HasExtension<VideoTimingExtension>()) {
+        packet->set_packetization_finish_time_ms(clock_->TimeInMilliseconds());
+        // TODO(ilnik): Due to webrtc:7859, packets with timing extensions are
+        // not protected by FEC. It reduces FEC efficiency a bit. When FEC is
+        // moved below the pacer, it can be re-enabled for these packets.
+        // NOTE: Any RTP stream processor in the network, modifying 'network'
+        // timestamps in the timing frames extension have to be an end-point
+        // for FEC, otherwise recovered by FEC packets will be corrupted.
+        protect_packet = false;
       }
-      if (i == num_packets - 1) {
-        RTC_LOG(LS_INFO)
-            << "Sent last RTP packet of the first video frame (pre-pacer)";
+
+      if (flexfec_enabled()) {
+        // TODO(brandtr): Remove the FlexFEC code path when FlexfecSender
+        // is wired up to PacedSender instead.
+        SendVideoPacketWithFlexfec(std::move(packet), storage, protect_packet);
+      } else {
+        SendVideoPacketAsRedMaybeWithUlpfec(std::move(packet), storage,
+                                            protect_packet);
+      }
+
+      if (first_frame) {
+        if (i == 0) {
+          RTC_LOG(LS_INFO)
+              << "Sent first RTP packet of the first video frame (pre-pacer)";
+        }
+        if (i == num_packets - 1) {
+          RTC_LOG(LS_INFO)
+              << "Sent last RTP packet of the first video frame (pre-pacer)";
+        }
       }
     }
   }
@@ -13,12 +13,14 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "modules/rtp_rtcp/include/flexfec_sender.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/playout_delay_oracle.h"
+#include "modules/rtp_rtcp/source/rtp_format.h"
 #include "modules/rtp_rtcp/source/rtp_rtcp_config.h"
 #include "modules/rtp_rtcp/source/rtp_sender.h"
 #include "modules/rtp_rtcp/source/ulpfec_generator.h"
@@ -31,7 +33,6 @@
 namespace webrtc {
 
 class FrameEncryptorInterface;
-class RtpPacketizer;
 class RtpPacketToSend;
 
 // kConditionallyRetransmitHigherLayers allows retransmission of video frames
@@ -127,9 +128,27 @@ class RTPSenderVideo {
                                   StorageType media_packet_storage,
                                   bool protect_media_packet);
 
+  // Packetizes a frame that needs no FEC and hands all of its packets to the
+  // RTP sender at once, so that they are queued with the pacer as one batch.
+  bool SendVideoPacketBatch(RtpPacketizer* packetizer,
+                            const RtpPacketizer::PayloadSizeLimits& limits,
+                            std::unique_ptr<RtpPacketToSend> single_packet,
+                            std::unique_ptr<RtpPacketToSend> first_packet,
+                            const RtpPacketToSend& middle_packet,
+                            std::unique_ptr<RtpPacketToSend> last_packet,
+                            StorageType storage,
+                            const absl::optional<PlayoutDelay>& playout_delay,
+                            bool first_frame,
+                            size_t* packetized_payload_size);
+
   bool LogAndSendToNetwork(std::unique_ptr<RtpPacketToSend> packet,
                            StorageType storage,
                            RtpPacketSender::Priority priority);
+  // Returns the total size of the packets that were sent or queued.
+  size_t LogAndSendToNetwork(
+      std::vector<std::unique_ptr<RtpPacketToSend>> packets,
+      StorageType storage,
+      RtpPacketSender::Priority priority);
 
   bool red_enabled() const RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_) {
     return red_payload_type_ >= 0;
@@ -0,0 +1,141 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "api/call/transport.h"
+#include "api/transport/field_trial_based_config.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/playout_delay_oracle.h"
+#include "modules/rtp_rtcp/source/rtp_sender.h"
+#include "modules/rtp_rtcp/source/rtp_sender_video.h"
+#include "rtc_base/rate_limiter.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumFrames = 200;
+// A large key frame, as produced at high resolutions and bitrates.
+constexpr size_t kFrameSize = 500000;
+constexpr int kFrameIntervalMs = 33;
+constexpr int kPayloadType = 96;
+constexpr uint32_t kSsrc = 725242;
+// Enough to hold every packet of one frame.
+constexpr uint16_t kNumPacketsToStore = 600;
+constexpr int64_t kExpectedRetransmissionTimeMs = 125;
+
+class CountingTransport : public Transport {
+ public:
+  bool SendRtp(const uint8_t* data,
+               size_t len,
+               const PacketOptions& options) override {
+    ++num_packets_;
+    return true;
+  }
+  bool SendRtcp(const uint8_t* data, size_t len) override { return false; }
+
+  int num_packets() const { return num_packets_; }
+
+ private:
+  int num_packets_ = 0;
+};
+
+// Accepts packets like a pacer, but never asks for them to be sent.
+class CountingPacer : public RtpPacketSender {
+ public:
+  void InsertPacket(Priority priority,
+                    uint32_t ssrc,
+                    uint16_t sequence_number,
+                    int64_t capture_time_ms,
+                    size_t bytes,
+                    bool retransmission) override {
+    ++num_packets_;
+  }
+  void InsertPackets(Priority priority,
+                     uint32_t ssrc,
+                     int64_t capture_time_ms,
+                     rtc::ArrayView<const BatchedPacket> packets) override {
+    num_packets_ += packets.size();
+  }
+
+  int num_packets() const { return num_packets_; }
+
+ private:
+  int num_packets_ = 0;
+};
+
+// Packetizes |kNumFrames| VP8 key frames of |kFrameSize| bytes and returns the
+// achieved rate in packets per second. With |paced| set, packets are stored in
+// the packet history and handed to a pacer, otherwise they are sent directly.
+double MeasureSendVideo(bool paced) {
+  FieldTrialBasedConfig field_trials;
+  SimulatedClock clock(123456789);
+  RateLimiter retransmission_rate_limiter(&clock, 1000);
+  CountingTransport transport;
+  CountingPacer pacer;
+  RTPSender rtp_sender(false, &clock, &transport, paced ? &pacer : nullptr,
+                       absl::nullopt, nullptr, nullptr, nullptr, nullptr,
+                       nullptr, nullptr, &retransmission_rate_limiter, nullptr,
+                       false, nullptr, false, false, field_trials);
+  rtp_sender.SetSSRC(kSsrc);
+  rtp_sender.SetStorePacketsStatus(true, kNumPacketsToStore);
+  PlayoutDelayOracle playout_delay_oracle;
+  RTPSenderVideo rtp_sender_video(&clock, &rtp_sender, nullptr,
+                                  &playout_delay_oracle, nullptr, false,
+                                  field_trials);
+  rtp_sender_video.RegisterPayloadType(kPayloadType, "VP8");
+
+  const std::vector<uint8_t> frame(kFrameSize, 0xAB);
+  RTPVideoHeader video_header;
+  video_header.codec = kVideoCodecVP8;
+  auto& vp8_header =
+      video_header.video_type_header.emplace<RTPVideoHeaderVP8>();
+  vp8_header.InitRTPVideoHeaderVP8();
+
+  const int64_t start_ns = rtc::TimeNanos();
+  for (int i = 0; i < kNumFrames; ++i) {
+    if (!rtp_sender_video.SendVideo(
+            VideoFrameType::kVideoFrameKey, kPayloadType,
+            i * kFrameIntervalMs * 90, clock.TimeInMilliseconds(), frame.data(),
+            frame.size(), nullptr, &video_header,
+            kExpectedRetransmissionTimeMs)) {
+      ADD_FAILURE() << "Failed to send frame " << i;
+      break;
+    }
+    clock.AdvanceTimeMilliseconds(kFrameIntervalMs);
+  }
+  const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+
+  const int num_packets = paced ? pacer.num_packets() : transport.num_packets();
+  EXPECT_GT(num_packets, kNumFrames * static_cast<int>(kFrameSize / 1500));
+  return static_cast<double>(num_packets) * rtc::kNumNanosecsPerSec /
+         std::max<int64_t>(elapsed_ns, 1);
+}
+
+}  // namespace
+
+TEST(RtpSenderVideoPerformanceTest, PacketizeLargeKeyFramesPaced) {
+  test::PrintResult("rtp_sender_video_packetization", "", "paced",
+                    MeasureSendVideo(/*paced=*/true), "packets_per_second",
+                    true);
+}
+
+TEST(RtpSenderVideoPerformanceTest, PacketizeLargeKeyFramesUnpaced) {
+  test::PrintResult("rtp_sender_video_packetization", "", "unpaced",
+                    MeasureSendVideo(/*paced=*/false), "packets_per_second",
+                    true);
+}
+
+}  // namespace webrtc
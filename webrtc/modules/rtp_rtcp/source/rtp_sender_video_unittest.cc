@@ -77,17 +77,27 @@ class LoopbackTransportTest : public webrtc::Transport {
   bool SendRtp(const uint8_t* data,
                size_t len,
                const PacketOptions& options) override {
+    if (fail_every_other_packet_ && (++num_send_calls_ % 2) == 0)
+      return false;
     sent_packets_.push_back(RtpPacketReceived(&receivers_extensions_));
     EXPECT_TRUE(sent_packets_.back().Parse(data, len));
+    bytes_sent_ += len;
     return true;
   }
   bool SendRtcp(const uint8_t* data, size_t len) override { return false; }
   const RtpPacketReceived& last_sent_packet() { return sent_packets_.back(); }
   int packets_sent() { return sent_packets_.size(); }
+  size_t bytes_sent() const { return bytes_sent_; }
+  void set_fail_every_other_packet(bool fail) {
+    fail_every_other_packet_ = fail;
+  }
 
  private:
   RtpHeaderExtensionMap receivers_extensions_;
   std::vector<RtpPacketReceived> sent_packets_;
+  size_t bytes_sent_ = 0;
+  bool fail_every_other_packet_ = false;
+  int num_send_calls_ = 0;
 };
 
 }  // namespace
@@ -198,6 +208,29 @@ TEST_P(RtpSenderVideoTest, KeyFrameHasCVO) {
   EXPECT_EQ(kVideoRotation_0, rotation);
 }
 
+TEST_P(RtpSenderVideoTest, VideoBitrateCountsOnlySentPackets) {
+  uint8_t kFrame[4 * kMaxPacketLength] = {};
+  RTPVideoHeader hdr;
+  rtp_sender_video_.SendVideo(VideoFrameType::kVideoFrameKey, kPayload,
+                              kTimestamp, 0, kFrame, sizeof(kFrame), nullptr,
+                              &hdr, kDefaultExpectedRetransmissionTimeMs);
+  const int packets_per_frame = transport_.packets_sent();
+  ASSERT_GT(packets_per_frame, 2);
+
+  fake_clock_.AdvanceTimeMilliseconds(99);
+  transport_.set_fail_every_other_packet(true);
+  rtp_sender_video_.SendVideo(VideoFrameType::kVideoFrameDelta, kPayload,
+                              kTimestamp + 9000, 0, kFrame, sizeof(kFrame),
+                              nullptr, &hdr,
+                              kDefaultExpectedRetransmissionTimeMs);
+  ASSERT_GT(transport_.packets_sent(), packets_per_frame);
+  ASSERT_LT(transport_.packets_sent(), 2 * packets_per_frame);
+
+  // Both frames fall within a 100 ms window.
+  EXPECT_NEAR(transport_.bytes_sent() * 8000 / 100,
+              rtp_sender_video_.VideoBitrateSent(), 1);
+}
+
 TEST_P(RtpSenderVideoTest, TimingFrameHasPacketizationTimstampSet) {
   uint8_t kFrame[kMaxPacketLength];
   const int64_t kPacketizationTimeMs = 100;
@@ -27,8 +27,10 @@ extern "C" {
 #include "modules/video_coding/codecs/h264/h264_color_space.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/critical_section.h"
+#include "rtc_base/experiments/field_trial_parser.h"
 #include "rtc_base/keep_ref_until_done.h"
 #include "rtc_base/logging.h"
+#include "system_wrappers/include/field_trial.h"
 #include "system_wrappers/include/metrics.h"
 
 namespace webrtc {
@@ -41,6 +43,11 @@ const size_t kYPlaneIndex = 0;
 const size_t kUPlaneIndex = 1;
 const size_t kVPlaneIndex = 2;
 
+const char kFrameThreadingFieldTrial[] = "WebRTC-H264DecoderFrameThreading";
+// Frames are normally delivered within |max_frame_delay_| + 1 Decode calls.
+// Bound the bookkeeping in case FFmpeg silently drops frames.
+const size_t kMaxPendingFrames = 32;
+
 // Used by histograms. Values of entries should not be changed.
 enum H264DecoderImplEvent {
   kH264DecoderEventInit = 0,
@@ -48,6 +55,13 @@ enum H264DecoderImplEvent {
   kH264DecoderEventMax = 16,
 };
 
+int GetMaxFrameDelay() {
+  FieldTrialParameter<int> max_delay_frames("max_delay_frames", 0);
+  ParseFieldTrial({&max_delay_frames},
+                  field_trial::FindFullName(kFrameThreadingFieldTrial));
+  return std::max(0, max_delay_frames.Get());
+}
+
 }  // namespace
 
 int H264DecoderImpl::AVGetBuffer2(
@@ -95,8 +109,11 @@ int H264DecoderImpl::AVGetBuffer2(
   // http://crbug.com/390941. Our pool is set up to zero-initialize new buffers.
   // TODO(nisse): Delete that feature from the video pool, instead add
   // an explicit call to InitializeData here.
-  rtc::scoped_refptr<I420Buffer> frame_buffer =
-      decoder->pool_.CreateBuffer(width, height);
+  rtc::scoped_refptr<I420Buffer> frame_buffer;
+  {
+    rtc::CritScope lock(&decoder->pool_crit_);
+    frame_buffer = decoder->pool_.CreateBuffer(width, height);
+  }
 
   int y_size = width * height;
   int uv_size = frame_buffer->ChromaWidth() * frame_buffer->ChromaHeight();
@@ -142,11 +159,12 @@ void H264DecoderImpl::AVFreeBuffer2(void* opaque, uint8_t* data) {
   delete video_frame;
 }
 
-H264DecoderImpl::H264DecoderImpl() : pool_(true),
-                                     decoded_image_callback_(nullptr),
-                                     has_reported_init_(false),
-                                     has_reported_error_(false) {
-}
+H264DecoderImpl::H264DecoderImpl()
+    : pool_(true),
+      decoded_image_callback_(nullptr),
+      max_frame_delay_(GetMaxFrameDelay()),
+      has_reported_init_(false),
+      has_reported_error_(false) {}
 
 H264DecoderImpl::~H264DecoderImpl() {
   Release();
@@ -182,10 +200,22 @@ int32_t H264DecoderImpl::InitDecode(const VideoCodec* codec_settings,
   av_context_->extradata = nullptr;
   av_context_->extradata_size = 0;
 
-  // If this is ever increased, look at |av_context_->thread_safe_callbacks| and
-  // make it possible to disable the thread checker in the frame buffer pool.
-  av_context_->thread_count = 1;
-  av_context_->thread_type = FF_THREAD_SLICE;
+  int num_threads = 1;
+  if (codec_settings) {
+    num_threads = NumberOfThreads(codec_settings->width,
+                                  codec_settings->height, number_of_cores);
+  }
+  if (num_threads > 1 && max_frame_delay_ > 0) {
+    // Frame threading delays the output by |thread_count - 1| frames.
+    av_context_->thread_count = std::min(num_threads, max_frame_delay_ + 1);
+    av_context_->thread_type = FF_THREAD_FRAME;
+    // |AVGetBuffer2| may then be called directly from the worker threads,
+    // |pool_| is protected by |pool_crit_|.
+    av_context_->thread_safe_callbacks = 1;
+  } else {
+    av_context_->thread_count = num_threads;
+    av_context_->thread_type = FF_THREAD_SLICE;
+  }
 
   // Function used by FFmpeg to get buffers to store decoded frames in.
   av_context_->get_buffer2 = AVGetBuffer2;
@@ -217,6 +247,7 @@ int32_t H264DecoderImpl::InitDecode(const VideoCodec* codec_settings,
 int32_t H264DecoderImpl::Release() {
   av_context_.reset();
   av_frame_.reset();
+  pending_frames_.clear();
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
@@ -260,8 +291,9 @@ int32_t H264DecoderImpl::Decode(const EncodedImage& input_image,
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
   packet.size = static_cast<int>(input_image.size());
-  int64_t frame_timestamp_us = input_image.ntp_time_ms_ * 1000;  // ms -> μs
-  av_context_->reordered_opaque = frame_timestamp_us;
+  // The RTP timestamp identifies the input frame when the decoded frame is
+  // returned, see |DeliverDecodedFrame|.
+  av_context_->reordered_opaque = input_image.Timestamp();
 
   int result = avcodec_send_packet(av_context_.get(), &packet);
   if (result < 0) {
@@ -270,16 +302,57 @@ int32_t H264DecoderImpl::Decode(const EncodedImage& input_image,
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
 
-  result = avcodec_receive_frame(av_context_.get(), av_frame_.get());
-  if (result < 0) {
-    RTC_LOG(LS_ERROR) << "avcodec_receive_frame error: " << result;
-    ReportError();
-    return WEBRTC_VIDEO_CODEC_ERROR;
+  PendingFrameInfo frame_info;
+  frame_info.rtp_timestamp = input_image.Timestamp();
+  // Pass on color space from input frame if explicitly specified.
+  frame_info.color_space = input_image.ColorSpace();
+  // TODO(sakal): Maybe it is possible to get QP directly from FFmpeg.
+  h264_bitstream_parser_.ParseBitstream(input_image.data(), input_image.size());
+  int qp_int;
+  if (h264_bitstream_parser_.GetLastSliceQp(&qp_int)) {
+    frame_info.qp.emplace(qp_int);
   }
+  if (pending_frames_.size() >= kMaxPendingFrames)
+    pending_frames_.pop_front();
+  pending_frames_.push_back(frame_info);
+
+  // Without frame threading every packet produces a frame. With frame
+  // threading, FFmpeg returns the frames of earlier packets once they are done
+  // and EAGAIN until then.
+  const bool frame_threading =
+      av_context_->active_thread_type == FF_THREAD_FRAME;
+  int num_decoded_frames = 0;
+  while (true) {
+    result = avcodec_receive_frame(av_context_.get(), av_frame_.get());
+    if (result == AVERROR(EAGAIN) &&
+        (frame_threading || num_decoded_frames > 0)) {
+      break;
+    }
+    if (result < 0) {
+      RTC_LOG(LS_ERROR) << "avcodec_receive_frame error: " << result;
+      ReportError();
+      return WEBRTC_VIDEO_CODEC_ERROR;
+    }
+    DeliverDecodedFrame();
+    ++num_decoded_frames;
+  }
+  return WEBRTC_VIDEO_CODEC_OK;
+}
 
-  // We don't expect reordering. Decoded frame tamestamp should match
-  // the input one.
-  RTC_DCHECK_EQ(av_frame_->reordered_opaque, frame_timestamp_us);
+void H264DecoderImpl::DeliverDecodedFrame() {
+  // Frames are returned in decode order, drop the information about input
+  // frames that FFmpeg discarded.
+  const uint32_t rtp_timestamp =
+      static_cast<uint32_t>(av_frame_->reordered_opaque);
+  PendingFrameInfo frame_info = {rtp_timestamp, absl::nullopt, absl::nullopt};
+  while (!pending_frames_.empty()) {
+    const PendingFrameInfo front = pending_frames_.front();
+    pending_frames_.pop_front();
+    if (front.rtp_timestamp == rtp_timestamp) {
+      frame_info = front;
+      break;
+    }
+  }
 
   // Obtain the |video_frame| containing the decoded image.
   VideoFrame* input_frame =
@@ -291,26 +364,18 @@ int32_t H264DecoderImpl::Decode(const EncodedImage& input_image,
   RTC_CHECK_EQ(av_frame_->data[kUPlaneIndex], i420_buffer->DataU());
   RTC_CHECK_EQ(av_frame_->data[kVPlaneIndex], i420_buffer->DataV());
 
-  // Pass on color space from input frame if explicitly specified.
   const ColorSpace& color_space =
-      input_image.ColorSpace() ? *input_image.ColorSpace()
-                               : ExtractH264ColorSpace(av_context_.get());
+      frame_info.color_space ? *frame_info.color_space
+                             : ExtractH264ColorSpace(av_context_.get());
   VideoFrame decoded_frame =
       VideoFrame::Builder()
           .set_video_frame_buffer(input_frame->video_frame_buffer())
           .set_timestamp_us(input_frame->timestamp_us())
-          .set_timestamp_rtp(input_image.Timestamp())
+          .set_timestamp_rtp(frame_info.rtp_timestamp)
           .set_rotation(input_frame->rotation())
           .set_color_space(color_space)
           .build();
-
-  absl::optional<uint8_t> qp;
-  // TODO(sakal): Maybe it is possible to get QP directly from FFmpeg.
-  h264_bitstream_parser_.ParseBitstream(input_image.data(), input_image.size());
-  int qp_int;
-  if (h264_bitstream_parser_.GetLastSliceQp(&qp_int)) {
-    qp.emplace(qp_int);
-  }
+  const absl::optional<uint8_t>& qp = frame_info.qp;
 
   // The decoded image may be larger than what is supposed to be visible, see
   // |AVGetBuffer2|'s use of |avcodec_align_dimensions|. This crops the image
@@ -340,14 +405,29 @@ int32_t H264DecoderImpl::Decode(const EncodedImage& input_image,
   // Stop referencing it, possibly freeing |input_frame|.
   av_frame_unref(av_frame_.get());
   input_frame = nullptr;
-
-  return WEBRTC_VIDEO_CODEC_OK;
 }
 
 const char* H264DecoderImpl::ImplementationName() const {
   return "FFmpeg";
 }
 
+// static
+int H264DecoderImpl::NumberOfThreads(int width,
+                                     int height,
+                                     int number_of_cores) {
+  // Decoding is considerably cheaper than encoding, only use several threads
+  // for HD and above and leave cores for the rest of the receive pipeline.
+  if (width * height >= 3840 * 2160 && number_of_cores >= 8) {
+    return 8;
+  } else if (width * height >= 1920 * 1080 && number_of_cores >= 4) {
+    return 4;
+  } else if (width * height > 640 * 480 && number_of_cores >= 2) {
+    return 2;
+  }
+  // 1 thread for VGA or less.
+  return 1;
+}
+
 bool H264DecoderImpl::IsInitialized() const {
   return av_context_ != nullptr;
 }
@@ -362,12 +442,12 @@ void H264DecoderImpl::ReportInit() {
 }
 
 void H264DecoderImpl::ReportError() {
-  if (has_reported_error_)
+  // May be called from FFmpeg's worker threads, see |AVGetBuffer2|.
+  if (has_reported_error_.exchange(true))
     return;
   RTC_HISTOGRAM_ENUMERATION("WebRTC.Video.H264DecoderImpl.Event",
                             kH264DecoderEventError,
                             kH264DecoderEventMax);
-  has_reported_error_ = true;
 }
 
 }  // namespace webrtc
@@ -12,6 +12,8 @@
 #ifndef MODULES_VIDEO_CODING_CODECS_H264_H264_DECODER_IMPL_H_
 #define MODULES_VIDEO_CODING_CODECS_H264_H264_DECODER_IMPL_H_
 
+#include <atomic>
+#include <deque>
 #include <memory>
 
 #include "modules/video_coding/codecs/h264/include/h264.h"
@@ -34,8 +36,12 @@ extern "C" {
 #include "third_party/ffmpeg/libavcodec/avcodec.h"
 }  // extern "C"
 
+#include "absl/types/optional.h"
+#include "api/video/color_space.h"
 #include "common_video/h264/h264_bitstream_parser.h"
 #include "common_video/include/i420_buffer_pool.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/thread_annotations.h"
 
 namespace webrtc {
 
@@ -46,6 +52,12 @@ struct AVFrameDeleter {
   void operator()(AVFrame* ptr) const { av_frame_free(&ptr); }
 };
 
+// Decoding uses FFmpeg's slice threading with a thread count chosen from the
+// resolution and |number_of_cores|. Frame threading scales better but delays
+// every output frame by up to |thread_count - 1| frames; it is only used when
+// the "WebRTC-H264DecoderFrameThreading" field trial allows a non-zero delay,
+// e.g. "WebRTC-H264DecoderFrameThreading/max_delay_frames:2/", and then with at
+// most |max_delay_frames + 1| threads.
 class H264DecoderImpl : public H264Decoder {
  public:
   H264DecoderImpl();
@@ -68,7 +80,19 @@ class H264DecoderImpl : public H264Decoder {
 
   const char* ImplementationName() const override;
 
+  // Returns the number of decoding threads to use for a stream of the given
+  // resolution.
+  static int NumberOfThreads(int width, int height, int number_of_cores);
+
  private:
+  // Per input frame information that is needed when the corresponding output
+  // frame is delivered, which may be several |Decode| calls later.
+  struct PendingFrameInfo {
+    uint32_t rtp_timestamp;
+    absl::optional<ColorSpace> color_space;
+    absl::optional<uint8_t> qp;
+  };
+
   // Called by FFmpeg when it needs a frame buffer to store decoded frames in.
   // The |VideoFrame| returned by FFmpeg at |Decode| originate from here. Their
   // buffers are reference counted and freed by FFmpeg using |AVFreeBuffer2|.
@@ -80,18 +104,29 @@ class H264DecoderImpl : public H264Decoder {
 
   bool IsInitialized() const;
 
+  // Delivers |av_frame_| to |decoded_image_callback_|.
+  void DeliverDecodedFrame();
+
   // Reports statistics with histograms.
   void ReportInit();
   void ReportError();
 
-  I420BufferPool pool_;
+  // With frame threading FFmpeg calls |AVGetBuffer2| from its worker threads.
+  rtc::CriticalSection pool_crit_;
+  I420BufferPool pool_ RTC_GUARDED_BY(pool_crit_);
   std::unique_ptr<AVCodecContext, AVCodecContextDeleter> av_context_;
   std::unique_ptr<AVFrame, AVFrameDeleter> av_frame_;
 
   DecodedImageCallback* decoded_image_callback_;
 
+  // Upper bound for the number of frames by which frame threading may delay
+  // the output. Zero disables frame threading.
+  const int max_frame_delay_;
+  // Frames sent to FFmpeg that have not been delivered yet, in decode order.
+  std::deque<PendingFrameInfo> pending_frames_;
+
   bool has_reported_init_;
-  bool has_reported_error_;
+  std::atomic<bool> has_reported_error_;
 
   webrtc::H264BitstreamParser h264_bitstream_parser_;
 };
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ *
+ */
+
+#include "modules/video_coding/codecs/h264/h264_encode_time_guard.h"
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+
+namespace {
+
+// Number of consecutive frames above the encode time budget before a layer is
+// given more threads. Reconfiguring the thread count produces a key frame.
+const int kFramesOverBudgetBeforeAddingThreads = 30;
+// Number of consecutive frames below half of the budget before threads are
+// removed again. Longer than the above, so the count doesn't oscillate.
+const int kFramesUnderBudgetBeforeRemovingThreads = 300;
+
+}  // namespace
+
+H264EncodeTimeGuard::H264EncodeTimeGuard(int initial_num_threads,
+                                         int max_num_threads)
+    : min_num_threads_(std::min(initial_num_threads, max_num_threads)),
+      max_num_threads_(max_num_threads),
+      num_threads_(min_num_threads_),
+      encode_start_us_(-1),
+      frames_over_budget_(0),
+      frames_under_budget_(0) {
+  RTC_DCHECK_GE(min_num_threads_, 1);
+}
+
+void H264EncodeTimeGuard::OnEncodeStart() {
+  encode_start_us_ = rtc::TimeMicros();
+}
+
+bool H264EncodeTimeGuard::OnEncodeEnd(int64_t budget_us) {
+  RTC_DCHECK_GE(encode_start_us_, 0);
+  const int64_t encode_time_us = rtc::TimeMicros() - encode_start_us_;
+  encode_start_us_ = -1;
+
+  if (encode_time_us > budget_us) {
+    frames_under_budget_ = 0;
+    if (num_threads_ >= max_num_threads_ ||
+        ++frames_over_budget_ < kFramesOverBudgetBeforeAddingThreads) {
+      return false;
+    }
+    frames_over_budget_ = 0;
+    num_threads_ = std::min(max_num_threads_, 2 * num_threads_);
+    return true;
+  }
+
+  frames_over_budget_ = 0;
+  if (2 * encode_time_us >= budget_us) {
+    frames_under_budget_ = 0;
+    return false;
+  }
+  if (num_threads_ <= min_num_threads_ ||
+      ++frames_under_budget_ < kFramesUnderBudgetBeforeRemovingThreads) {
+    return false;
+  }
+  frames_under_budget_ = 0;
+  num_threads_ = std::max(min_num_threads_, num_threads_ / 2);
+  return true;
+}
+
+}  // namespace webrtc
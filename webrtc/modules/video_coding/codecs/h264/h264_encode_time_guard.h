@@ -0,0 +1,46 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ *
+ */
+
+#ifndef MODULES_VIDEO_CODING_CODECS_H264_H264_ENCODE_TIME_GUARD_H_
+#define MODULES_VIDEO_CODING_CODECS_H264_H264_ENCODE_TIME_GUARD_H_
+
+#include <stdint.h>
+
+namespace webrtc {
+
+// Adapts the number of encoder threads of one H264 layer to its encode time.
+// The thread count is doubled, up to |max_num_threads|, when the encode time
+// stays above the budget, and halved again, down to |initial_num_threads|,
+// when it stays below half of the budget.
+class H264EncodeTimeGuard {
+ public:
+  H264EncodeTimeGuard(int initial_num_threads, int max_num_threads);
+
+  int num_threads() const { return num_threads_; }
+
+  // Call around each encode of the layer. OnEncodeEnd() returns true if
+  // num_threads() changed, and the encoder needs to be reconfigured.
+  void OnEncodeStart();
+  bool OnEncodeEnd(int64_t budget_us);
+
+ private:
+  const int min_num_threads_;
+  const int max_num_threads_;
+  int num_threads_;
+  int64_t encode_start_us_;
+  // Number of consecutive frames above the budget, or below half of it.
+  int frames_over_budget_;
+  int frames_under_budget_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_VIDEO_CODING_CODECS_H264_H264_ENCODE_TIME_GUARD_H_
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ *
+ */
+
+#include "modules/video_coding/codecs/h264/h264_encode_time_guard.h"
+
+#include "rtc_base/fake_clock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+const int64_t kBudgetUs = 33000;
+const int kFramesBeforeAddingThreads = 30;
+const int kFramesBeforeRemovingThreads = 300;
+
+// Encodes |num_frames| frames that each take |encode_time_us| on |clock|.
+// Returns the number of frames after which the thread count changed.
+int EncodeFrames(rtc::ScopedFakeClock* clock,
+                 H264EncodeTimeGuard* guard,
+                 int num_frames,
+                 int64_t encode_time_us) {
+  int num_changes = 0;
+  for (int i = 0; i < num_frames; ++i) {
+    guard->OnEncodeStart();
+    clock->AdvanceTimeMicros(encode_time_us);
+    if (guard->OnEncodeEnd(kBudgetUs))
+      ++num_changes;
+  }
+  return num_changes;
+}
+
+}  // namespace
+
+TEST(H264EncodeTimeGuardTest, AddsThreadsWhenEncodeTimeStaysOverBudget) {
+  rtc::ScopedFakeClock clock;
+  H264EncodeTimeGuard guard(/*initial_num_threads=*/1,
+                            /*max_num_threads=*/4);
+  EXPECT_EQ(0, EncodeFrames(&clock, &guard, kFramesBeforeAddingThreads - 1,
+                            2 * kBudgetUs));
+  EXPECT_EQ(1, guard.num_threads());
+  EXPECT_EQ(1, EncodeFrames(&clock, &guard, 1, 2 * kBudgetUs));
+  EXPECT_EQ(2, guard.num_threads());
+  EXPECT_EQ(1, EncodeFrames(&clock, &guard, kFramesBeforeAddingThreads,
+                            2 * kBudgetUs));
+  EXPECT_EQ(4, guard.num_threads());
+  // Capped by |max_num_threads|.
+  EXPECT_EQ(0, EncodeFrames(&clock, &guard, 10 * kFramesBeforeAddingThreads,
+                            2 * kBudgetUs));
+  EXPECT_EQ(4, guard.num_threads());
+}
+
+TEST(H264EncodeTimeGuardTest, FramesWithinBudgetResetTheCount) {
+  rtc::ScopedFakeClock clock;
+  H264EncodeTimeGuard guard(/*initial_num_threads=*/1,
+                            /*max_num_threads=*/4);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(0, EncodeFrames(&clock, &guard, kFramesBeforeAddingThreads - 1,
+                              2 * kBudgetUs));
+    EXPECT_EQ(0, EncodeFrames(&clock, &guard, 1, kBudgetUs));
+  }
+  EXPECT_EQ(1, guard.num_threads());
+}
+
+TEST(H264EncodeTimeGuardTest, RemovesThreadsWhenEncodeTimeDrops) {
+  rtc::ScopedFakeClock clock;
+  H264EncodeTimeGuard guard(/*initial_num_threads=*/1,
+                            /*max_num_threads=*/4);
+  EncodeFrames(&clock, &guard, 2 * kFramesBeforeAddingThreads, 2 * kBudgetUs);
+  ASSERT_EQ(4, guard.num_threads());
+
+  // Encode time between half the budget and the budget is left alone.
+  EXPECT_EQ(0, EncodeFrames(&clock, &guard, 2 * kFramesBeforeRemovingThreads,
+                            3 * kBudgetUs / 4));
+  EXPECT_EQ(4, guard.num_threads());
+
+  EXPECT_EQ(0, EncodeFrames(&clock, &guard, kFramesBeforeRemovingThreads - 1,
+                            kBudgetUs / 4));
+  EXPECT_EQ(4, guard.num_threads());
+  EXPECT_EQ(1, EncodeFrames(&clock, &guard, 1, kBudgetUs / 4));
+  EXPECT_EQ(2, guard.num_threads());
+  EXPECT_EQ(1, EncodeFrames(&clock, &guard, kFramesBeforeRemovingThreads,
+                            kBudgetUs / 4));
+  EXPECT_EQ(1, guard.num_threads());
+  // Never below the initial thread count.
+  EXPECT_EQ(0, EncodeFrames(&clock, &guard, 2 * kFramesBeforeRemovingThreads,
+                            kBudgetUs / 4));
+  EXPECT_EQ(1, guard.num_threads());
+}
+
+TEST(H264EncodeTimeGuardTest, InitialThreadCountIsCappedByMax) {
+  rtc::ScopedFakeClock clock;
+  H264EncodeTimeGuard guard(/*initial_num_threads=*/8,
+                            /*max_num_threads=*/2);
+  EXPECT_EQ(2, guard.num_threads());
+  EXPECT_EQ(0, EncodeFrames(&clock, &guard, 2 * kFramesBeforeRemovingThreads,
+                            kBudgetUs / 4));
+  EXPECT_EQ(2, guard.num_threads());
+}
+
+}  // namespace webrtc
@@ -11,6 +11,7 @@
 
 #include "modules/video_coding/codecs/h264/h264_encoder_impl.h"
 
+#include <algorithm>
 #include <limits>
 #include <string>
 
@@ -24,8 +25,10 @@
 #include "modules/video_coding/utility/simulcast_rate_allocator.h"
 #include "modules/video_coding/utility/simulcast_utility.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/experiments/field_trial_parser.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/time_utils.h"
+#include "system_wrappers/include/field_trial.h"
 #include "system_wrappers/include/metrics.h"
 #include "third_party/libyuv/include/libyuv/convert.h"
 #include "third_party/libyuv/include/libyuv/scale.h"
@@ -40,6 +43,8 @@ const bool kOpenH264EncoderDetailedLogging = false;
 static const int kLowH264QpThreshold = 24;
 static const int kHighH264QpThreshold = 37;
 
+const char kThreadingFieldTrial[] = "WebRTC-H264EncoderThreading";
+
 // Used by histograms. Values of entries should not be changed.
 enum H264EncoderImplEvent {
   kH264EncoderEventInit = 0,
@@ -47,21 +52,19 @@ enum H264EncoderImplEvent {
   kH264EncoderEventMax = 16,
 };
 
+// TODO(hbos): In Chromium, multiple threads do not work with sandbox on Mac,
+// see crbug.com/583348. Multi-threading is therefore only used when enabled
+// with |kThreadingFieldTrial|.
 int NumberOfThreads(int width, int height, int number_of_cores) {
-  // TODO(hbos): In Chromium, multiple threads do not work with sandbox on Mac,
-  // see crbug.com/583348. Until further investigated, only use one thread.
-  //  if (width * height >= 1920 * 1080 && number_of_cores > 8) {
-  //    return 8;  // 8 threads for 1080p on high perf machines.
-  //  } else if (width * height > 1280 * 960 && number_of_cores >= 6) {
-  //    return 3;  // 3 threads for 1080p.
-  //  } else if (width * height > 640 * 480 && number_of_cores >= 3) {
-  //    return 2;  // 2 threads for qHD/HD.
-  //  } else {
-  //    return 1;  // 1 thread for VGA or less.
-  //  }
-  // TODO(sprang): Also check sSliceArgument.uiSliceNum om GetEncoderPrams(),
-  //               before enabling multithreading here.
-  return 1;
+  if (width * height >= 1920 * 1080 && number_of_cores > 8) {
+    return 8;  // 8 threads for 1080p on high perf machines.
+  } else if (width * height > 1280 * 960 && number_of_cores >= 6) {
+    return 3;  // 3 threads for 1080p.
+  } else if (width * height > 640 * 480 && number_of_cores >= 3) {
+    return 2;  // 2 threads for qHD/HD.
+  } else {
+    return 1;  // 1 thread for VGA or less.
+  }
 }
 
 VideoFrameType ConvertToVideoFrameType(EVideoFrameType type) {
@@ -164,6 +167,9 @@ H264EncoderImpl::H264EncoderImpl(const cricket::VideoCodec& codec)
       max_payload_size_(0),
       number_of_cores_(0),
       encoded_image_callback_(nullptr),
+      multithreading_enabled_(false),
+      max_threads_(8),
+      max_encode_time_ms_(0),
       has_reported_init_(false),
       has_reported_error_(false),
       num_temporal_layers_(1),
@@ -175,6 +181,15 @@ H264EncoderImpl::H264EncoderImpl(const cricket::VideoCodec& codec)
       packetization_mode_string == "1") {
     packetization_mode_ = H264PacketizationMode::NonInterleaved;
   }
+  FieldTrialFlag enabled("Enabled");
+  FieldTrialParameter<int> max_threads("max_threads", max_threads_);
+  FieldTrialParameter<int> max_encode_time_ms("max_encode_time_ms",
+                                              max_encode_time_ms_);
+  ParseFieldTrial({&enabled, &max_threads, &max_encode_time_ms},
+                  field_trial::FindFullName(kThreadingFieldTrial));
+  multithreading_enabled_ = enabled.Get();
+  max_threads_ = std::max(1, max_threads.Get());
+  max_encode_time_ms_ = std::max(0, max_encode_time_ms.Get());
   downscaled_buffers_.reserve(kMaxSimulcastStreams - 1);
   encoded_images_.reserve(kMaxSimulcastStreams);
   encoders_.reserve(kMaxSimulcastStreams);
@@ -264,6 +279,16 @@ int32_t H264EncoderImpl::InitEncode(const VideoCodec* inst,
     configurations_[i].max_frame_rate = static_cast<float>(codec_.maxFramerate);
     configurations_[i].frame_dropping_on = codec_.H264()->frameDroppingOn;
     configurations_[i].key_frame_interval = codec_.H264()->keyFrameInterval;
+    configurations_[i].num_threads = 1;
+    configurations_[i].encode_time_guard.reset();
+    if (multithreading_enabled_) {
+      configurations_[i].encode_time_guard.emplace(
+          NumberOfThreads(configurations_[i].width, configurations_[i].height,
+                          number_of_cores),
+          std::max(1, std::min(max_threads_, number_of_cores)));
+      configurations_[i].num_threads =
+          configurations_[i].encode_time_guard->num_threads();
+    }
 
     // Create downscaled image buffers.
     if (i > 0) {
@@ -479,6 +504,8 @@ int32_t H264EncoderImpl::Encode(
     memset(&info, 0, sizeof(SFrameBSInfo));
 
     // Encode!
+    if (configurations_[i].encode_time_guard)
+      configurations_[i].encode_time_guard->OnEncodeStart();
     int enc_ret = encoders_[i]->EncodeFrame(&pictures_[i], &info);
     if (enc_ret != 0) {
       RTC_LOG(LS_ERROR)
@@ -487,6 +514,7 @@ int32_t H264EncoderImpl::Encode(
       ReportError();
       return WEBRTC_VIDEO_CODEC_ERROR;
     }
+    const bool num_threads_changed = UpdateEncodeTimeGuard(i);
 
     encoded_images_[i]._encodedWidth = configurations_[i].width;
     encoded_images_[i]._encodedHeight = configurations_[i].height;
@@ -540,6 +568,11 @@ int32_t H264EncoderImpl::Encode(
       encoded_image_callback_->OnEncodedImage(encoded_images_[i],
                                               &codec_specific, &frag_header);
     }
+
+    // Reconfiguring frees the bitstream buffers |info| points to, so wait
+    // until the image has been fragmented and delivered.
+    if (num_threads_changed)
+      ReconfigureThreads(i);
   }
   return WEBRTC_VIDEO_CODEC_OK;
 }
@@ -574,12 +607,11 @@ SEncParamExt H264EncoderImpl::CreateEncoderParams(size_t i) const {
   // |keyFrameInterval| - number of frames
   encoder_params.uiIntraPeriod = configurations_[i].key_frame_interval;
   encoder_params.uiMaxNalSize = 0;
-  // Threading model: use auto.
+  // Threading model:
   //  0: auto (dynamic imp. internal encoder)
   //  1: single thread (default value)
   // >1: number of threads
-  encoder_params.iMultipleThreadIdc = NumberOfThreads(
-      encoder_params.iPicWidth, encoder_params.iPicHeight, number_of_cores_);
+  encoder_params.iMultipleThreadIdc = configurations_[i].num_threads;
   // The base spatial layer 0 is the only one we use.
   encoder_params.sSpatialLayers[0].iVideoWidth = encoder_params.iPicWidth;
   encoder_params.sSpatialLayers[0].iVideoHeight = encoder_params.iPicHeight;
@@ -618,6 +650,33 @@ SEncParamExt H264EncoderImpl::CreateEncoderParams(size_t i) const {
   return encoder_params;
 }
 
+bool H264EncoderImpl::UpdateEncodeTimeGuard(size_t i) {
+  LayerConfig& config = configurations_[i];
+  if (!config.encode_time_guard)
+    return false;
+
+  const int64_t budget_us =
+      max_encode_time_ms_ > 0
+          ? max_encode_time_ms_ * rtc::kNumMicrosecsPerMillisec
+          : static_cast<int64_t>(rtc::kNumMicrosecsPerSec /
+                                 std::max(config.max_frame_rate, 1.0f));
+  if (!config.encode_time_guard->OnEncodeEnd(budget_us))
+    return false;
+  config.num_threads = config.encode_time_guard->num_threads();
+  RTC_LOG(LS_INFO) << "Encode time budget of layer " << config.simulcast_idx
+                   << " is " << budget_us << " us, using "
+                   << config.num_threads << " threads.";
+  return true;
+}
+
+void H264EncoderImpl::ReconfigureThreads(size_t i) {
+  SEncParamExt encoder_params = CreateEncoderParams(i);
+  if (encoders_[i]->SetOption(ENCODER_OPTION_SVC_ENCODE_PARAM_EXT,
+                              &encoder_params) != 0) {
+    RTC_LOG(LS_WARNING) << "Failed to reconfigure OpenH264 thread count.";
+  }
+}
+
 void H264EncoderImpl::ReportInit() {
   if (has_reported_init_)
     return;
@@ -15,8 +15,10 @@
 #include <memory>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "api/video/i420_buffer.h"
 #include "common_video/h264/h264_bitstream_parser.h"
+#include "modules/video_coding/codecs/h264/h264_encode_time_guard.h"
 #include "modules/video_coding/codecs/h264/include/h264.h"
 #include "modules/video_coding/utility/quality_scaler.h"
 
@@ -39,6 +41,9 @@ class H264EncoderImpl : public H264Encoder {
     uint32_t max_bps = 0;
     bool frame_dropping_on = false;
     int key_frame_interval = 0;
+    int num_threads = 1;
+    // Set when multi-threading is enabled.
+    absl::optional<H264EncodeTimeGuard> encode_time_guard;
 
     void SetStreamState(bool send_stream);
   };
@@ -54,6 +59,12 @@ class H264EncoderImpl : public H264Encoder {
   // - maxFramerate
   // - width
   // - height
+  // Multi-threaded encoding is enabled with the field trial
+  // "WebRTC-H264EncoderThreading/Enabled/". The thread count then follows the
+  // resolution and is limited by "max_threads" and |number_of_cores|. A layer
+  // whose encode time keeps exceeding "max_encode_time_ms" (default: the frame
+  // interval) is reconfigured with more threads, up to that limit, and with
+  // fewer threads again once its encode time stays below half of it.
   int32_t InitEncode(const VideoCodec* codec_settings,
                      int32_t number_of_cores,
                      size_t max_payload_size) override;
@@ -78,6 +89,11 @@ class H264EncoderImpl : public H264Encoder {
 
  private:
   SEncParamExt CreateEncoderParams(size_t i) const;
+  // Returns true if the encode time guard of layer |i| changed its thread
+  // count. The encoder is then reconfigured with ReconfigureThreads(), which
+  // invalidates the output of the last EncodeFrame() call.
+  bool UpdateEncodeTimeGuard(size_t i);
+  void ReconfigureThreads(size_t i);
 
   webrtc::H264BitstreamParser h264_bitstream_parser_;
   // Reports statistics with histograms.
@@ -96,6 +112,10 @@ class H264EncoderImpl : public H264Encoder {
   int32_t number_of_cores_;
   EncodedImageCallback* encoded_image_callback_;
 
+  bool multithreading_enabled_;
+  int max_threads_;
+  int max_encode_time_ms_;
+
   bool has_reported_init_;
   bool has_reported_error_;
 
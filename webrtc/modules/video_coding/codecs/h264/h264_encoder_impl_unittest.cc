@@ -11,6 +11,7 @@
 
 #include "modules/video_coding/codecs/h264/h264_encoder_impl.h"
 
+#include "test/field_trial.h"
 #include "test/gtest.h"
 
 namespace webrtc {
@@ -78,6 +79,23 @@ TEST(H264EncoderImplTest, CanInitializeWithRemovedParameter) {
             encoder.PacketizationModeForTesting());
 }
 
+TEST(H264EncoderImplTest, CanInitializeWithMultipleThreads) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-H264EncoderThreading/Enabled,max_threads:4/");
+  for (const char* packetization_mode : {"0", "1"}) {
+    cricket::VideoCodec codec("H264");
+    codec.SetParam(cricket::kH264FmtpPacketizationMode, packetization_mode);
+    H264EncoderImpl encoder(codec);
+    VideoCodec codec_settings;
+    SetDefaultSettings(&codec_settings);
+    codec_settings.width = 1920;
+    codec_settings.height = 1080;
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              encoder.InitEncode(&codec_settings, /*number_of_cores=*/8,
+                                 kMaxPayloadSize));
+  }
+}
+
 }  // anonymous namespace
 
 }  // namespace webrtc
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/video/video_frame.h"
+#include "api/video_codecs/video_codec.h"
+#include "media/base/codec.h"
+#include "media/base/media_constants.h"
+#include "modules/video_coding/codecs/h264/include/h264.h"
+#include "modules/video_coding/include/video_codec_interface.h"
+#include "modules/video_coding/include/video_error_codes.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/time_utils.h"
+#include "test/field_trial.h"
+#include "test/frame_generator.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumFrames = 150;
+constexpr int kFramerate = 30;
+constexpr int kNumCores = 8;
+
+struct Resolution {
+  int width;
+  int height;
+  int bitrate_kbps;
+};
+
+class CountingEncodedImageCallback : public EncodedImageCallback {
+ public:
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info,
+                        const RTPFragmentationHeader* fragmentation) override {
+    ++num_encoded_images_;
+    return Result(Result::OK, encoded_image.Timestamp());
+  }
+
+  int num_encoded_images() const { return num_encoded_images_; }
+
+ private:
+  int num_encoded_images_ = 0;
+};
+
+struct EncodeTimes {
+  double average_ms = 0;
+  double max_ms = 0;
+};
+
+// Encodes |kNumFrames| frames from a square generator at |resolution| and
+// returns the average and worst wall-clock time spent in Encode().
+EncodeTimes MeasureEncodeTimes(const Resolution& resolution,
+                               bool multithreading) {
+  test::ScopedFieldTrials field_trials(
+      multithreading ? "WebRTC-H264EncoderThreading/Enabled/" : "");
+  std::unique_ptr<H264Encoder> encoder =
+      H264Encoder::Create(cricket::VideoCodec(cricket::kH264CodecName));
+  CountingEncodedImageCallback callback;
+  encoder->RegisterEncodeCompleteCallback(&callback);
+
+  VideoCodec codec_settings;
+  codec_settings.codecType = kVideoCodecH264;
+  codec_settings.width = resolution.width;
+  codec_settings.height = resolution.height;
+  codec_settings.maxFramerate = kFramerate;
+  codec_settings.startBitrate = resolution.bitrate_kbps;
+  codec_settings.maxBitrate = 2 * resolution.bitrate_kbps;
+  codec_settings.H264()->frameDroppingOn = false;
+  codec_settings.H264()->keyFrameInterval = 3000;
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            encoder->InitEncode(&codec_settings, kNumCores,
+                                /*max_payload_size=*/1200));
+
+  std::unique_ptr<test::FrameGenerator> frame_generator =
+      test::FrameGenerator::CreateSquareGenerator(
+          resolution.width, resolution.height, absl::nullopt, absl::nullopt);
+  EncodeTimes times;
+  int64_t total_encode_time_us = 0;
+  int64_t max_encode_time_us = 0;
+  for (int i = 0; i < kNumFrames; ++i) {
+    VideoFrame frame = *frame_generator->NextFrame();
+    frame.set_timestamp(i * (90000 / kFramerate));
+    const int64_t start_us = rtc::TimeMicros();
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder->Encode(frame, nullptr));
+    const int64_t encode_time_us = rtc::TimeMicros() - start_us;
+    total_encode_time_us += encode_time_us;
+    max_encode_time_us = std::max(max_encode_time_us, encode_time_us);
+  }
+  encoder->Release();
+
+  EXPECT_GT(callback.num_encoded_images(), 0);
+  times.average_ms = static_cast<double>(total_encode_time_us) /
+                     rtc::kNumMicrosecsPerMillisec / kNumFrames;
+  times.max_ms =
+      static_cast<double>(max_encode_time_us) / rtc::kNumMicrosecsPerMillisec;
+  return times;
+}
+
+void PrintEncodeTimes(const Resolution& resolution, bool multithreading) {
+  const EncodeTimes times = MeasureEncodeTimes(resolution, multithreading);
+  rtc::StringBuilder trace;
+  trace << resolution.width << "x" << resolution.height << "_"
+        << (multithreading ? "multi_thread" : "single_thread");
+  test::PrintResult("h264_encode_time_avg", "", trace.str(), times.average_ms,
+                    "ms", true);
+  test::PrintResult("h264_encode_time_max", "", trace.str(), times.max_ms,
+                    "ms", false);
+}
+
+}  // namespace
+
+class H264EncoderPerformanceTest : public ::testing::TestWithParam<Resolution> {
+};
+
+INSTANTIATE_TEST_SUITE_P(Resolutions,
+                         H264EncoderPerformanceTest,
+                         ::testing::Values(Resolution{640, 360, 800},
+                                           Resolution{1280, 720, 2000},
+                                           Resolution{1920, 1080, 4000}));
+
+TEST_P(H264EncoderPerformanceTest, SingleThread) {
+  PrintEncodeTimes(GetParam(), /*multithreading=*/false);
+}
+
+TEST_P(H264EncoderPerformanceTest, MultiThread) {
+  PrintEncodeTimes(GetParam(), /*multithreading=*/true);
+}
+
+}  // namespace webrtc
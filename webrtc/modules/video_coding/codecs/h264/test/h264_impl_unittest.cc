@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include <memory>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "api/video/color_space.h"
@@ -26,6 +27,7 @@
 #include "modules/video_coding/codecs/test/video_codec_unittest.h"
 #include "modules/video_coding/include/video_codec_interface.h"
 #include "modules/video_coding/include/video_error_codes.h"
+#include "test/field_trial.h"
 #include "test/gtest.h"
 #include "test/video_codec_settings.h"
 
@@ -46,6 +48,23 @@ class TestH264Impl : public VideoCodecUnitTest {
   }
 };
 
+class TestH264ImplFrameThreading : public TestH264Impl {
+ public:
+  TestH264ImplFrameThreading()
+      : field_trials_("WebRTC-H264DecoderFrameThreading/max_delay_frames:1/") {}
+
+ protected:
+  void ModifyCodecSettings(VideoCodec* codec_settings) override {
+    TestH264Impl::ModifyCodecSettings(codec_settings);
+    // Large enough for the decoder to use two threads.
+    codec_settings->width = 1280;
+    codec_settings->height = 720;
+  }
+
+ private:
+  test::ScopedFieldTrials field_trials_;
+};
+
 #ifdef WEBRTC_USE_H264
 #define MAYBE_EncodeDecode EncodeDecode
 #define MAYBE_DecodedQpEqualsEncodedQp DecodedQpEqualsEncodedQp
@@ -53,6 +72,8 @@ class TestH264Impl : public VideoCodecUnitTest {
   EncodedColorSpaceEqualsInputColorSpace
 #define MAYBE_DecodedColorSpaceEqualsEncodedColorSpace \
   DecodedColorSpaceEqualsEncodedColorSpace
+#define MAYBE_FrameThreadedDecodeIsDelayedByOneFrame \
+  FrameThreadedDecodeIsDelayedByOneFrame
 #else
 #define MAYBE_EncodeDecode DISABLED_EncodeDecode
 #define MAYBE_DecodedQpEqualsEncodedQp DISABLED_DecodedQpEqualsEncodedQp
@@ -60,6 +81,8 @@ class TestH264Impl : public VideoCodecUnitTest {
   DISABLED_EncodedColorSpaceEqualsInputColorSpace
 #define MAYBE_DecodedColorSpaceEqualsEncodedColorSpace \
   DISABLED_DecodedColorSpaceEqualsEncodedColorSpace
+#define MAYBE_FrameThreadedDecodeIsDelayedByOneFrame \
+  DISABLED_FrameThreadedDecodeIsDelayedByOneFrame
 #endif
 
 TEST_F(TestH264Impl, MAYBE_EncodeDecode) {
@@ -149,4 +172,37 @@ TEST_F(TestH264Impl, MAYBE_DecodedColorSpaceEqualsEncodedColorSpace) {
   EXPECT_EQ(color_space, *decoded_frame->color_space());
 }
 
+TEST_F(TestH264ImplFrameThreading,
+       MAYBE_FrameThreadedDecodeIsDelayedByOneFrame) {
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            decoder_->InitDecode(&codec_settings_, 4 /* number of cores */));
+  std::vector<EncodedImage> encoded_frames;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              encoder_->Encode(*NextInputFrame(), nullptr));
+    EncodedImage encoded_frame;
+    CodecSpecificInfo codec_specific_info;
+    ASSERT_TRUE(WaitForEncodedFrame(&encoded_frame, &codec_specific_info));
+    encoded_frames.push_back(encoded_frame);
+  }
+  // First frame should be a key frame.
+  encoded_frames[0]._frameType = VideoFrameType::kVideoFrameKey;
+
+  // Frame threading with two threads returns nothing for the first frame.
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            decoder_->Decode(encoded_frames[0], false, nullptr, 0));
+  std::unique_ptr<VideoFrame> decoded_frame;
+  absl::optional<uint8_t> decoded_qp;
+  for (size_t i = 1; i < encoded_frames.size(); ++i) {
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              decoder_->Decode(encoded_frames[i], false, nullptr, 0));
+    ASSERT_TRUE(WaitForDecodedFrame(&decoded_frame, &decoded_qp));
+    ASSERT_TRUE(decoded_frame);
+    // The decoded frame belongs to the previous input frame.
+    EXPECT_EQ(encoded_frames[i - 1].Timestamp(), decoded_frame->timestamp());
+    ASSERT_TRUE(decoded_qp);
+    EXPECT_EQ(encoded_frames[i - 1].qp_, *decoded_qp);
+  }
+}
+
 }  // namespace webrtc
@@ -588,22 +588,28 @@ void VideoCodecTestFixtureImpl::VerifyVideoStatistic(
   }
 }
 
-void VideoCodecTestFixtureImpl::CreateEncoderAndDecoder() {
+// static
+SdpVideoFormat VideoCodecTestFixtureImpl::CreateSdpVideoFormat(
+    const Config& config) {
   SdpVideoFormat::Parameters params;
-  if (config_.codec_settings.codecType == kVideoCodecH264) {
+  if (config.codec_settings.codecType == kVideoCodecH264) {
     const char* packetization_mode =
-        config_.h264_codec_settings.packetization_mode ==
+        config.h264_codec_settings.packetization_mode ==
                 H264PacketizationMode::NonInterleaved
             ? "1"
             : "0";
     params = {{cricket::kH264FmtpProfileLevelId,
                *H264::ProfileLevelIdToString(H264::ProfileLevelId(
-                   config_.h264_codec_settings.profile, H264::kLevel3_1))},
+                   config.h264_codec_settings.profile, H264::kLevel3_1))},
               {cricket::kH264FmtpPacketizationMode, packetization_mode}};
   } else {
     params = {};
   }
-  SdpVideoFormat format(config_.codec_name, params);
+  return SdpVideoFormat(config.codec_name, params);
+}
+
+void VideoCodecTestFixtureImpl::CreateEncoderAndDecoder() {
+  const SdpVideoFormat format = CreateSdpVideoFormat(config_);
 
   encoder_ = encoder_factory_->CreateVideoEncoder(format);
   EXPECT_TRUE(encoder_) << "Encoder not successfully created.";
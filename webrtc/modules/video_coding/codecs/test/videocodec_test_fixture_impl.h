@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "api/test/videocodec_test_fixture.h"
+#include "api/video_codecs/sdp_video_format.h"
 #include "api/video_codecs/video_decoder_factory.h"
 #include "api/video_codecs/video_encoder_factory.h"
 #include "common_video/h264/h264_common.h"
@@ -56,6 +57,9 @@ class VideoCodecTestFixtureImpl : public VideoCodecTestFixture {
 
   VideoCodecTestStats& GetStats() override;
 
+  // Returns the format used to create the encoder and decoders for |config|.
+  static SdpVideoFormat CreateSdpVideoFormat(const Config& config);
+
  private:
   class CpuProcessTime;
 
@@ -18,6 +18,7 @@
 #include "media/engine/internal_decoder_factory.h"
 #include "media/engine/internal_encoder_factory.h"
 #include "media/engine/simulcast_encoder_adapter.h"
+#include "modules/video_coding/codecs/test/videocodec_throughput_test_impl.h"
 #include "modules/video_coding/utility/vp8_header_parser.h"
 #include "modules/video_coding/utility/vp9_uncompressed_header_parser.h"
 #include "test/gtest.h"
@@ -430,6 +431,31 @@ TEST(VideoCodecTestLibvpx, MAYBE_SvcVP9) {
   fixture->RunTest(rate_profiles, &rc_thresholds, &quality_thresholds, nullptr);
 }
 
+// Runs several independent VP8 pipelines in parallel and reports aggregate
+// throughput, latency percentiles and CPU time per pixel.
+class VideoCodecTestLibvpxThroughput : public ::testing::TestWithParam<size_t> {
+};
+
+INSTANTIATE_TEST_SUITE_P(NumPipelines,
+                         VideoCodecTestLibvpxThroughput,
+                         ::testing::Values(1, 2, 4));
+
+TEST_P(VideoCodecTestLibvpxThroughput, ParallelPipelinesVP8) {
+  auto config = CreateConfig();
+  config.num_frames = kNumFramesShort;
+  config.test_name = "vp8_cif_throughput";
+  config.SetCodecSettings(cricket::kVp8CodecName, 1, 1, 1, true, false, false,
+                          kCifWidth, kCifHeight);
+  VideoCodecThroughputTestImpl throughput_test(config, GetParam());
+
+  const VideoCodecThroughputTestImpl::Results results =
+      throughput_test.Run({500, 30, 0});
+
+  EXPECT_LE(results.num_decoded_frames, GetParam() * kNumFramesShort);
+  EXPECT_GT(results.aggregate_fps, 0.0);
+  EXPECT_GT(results.cpu_time_per_pixel_ns, 0.0);
+}
+
 TEST(VideoCodecTestLibvpx, DISABLED_MultiresVP8RdPerf) {
   auto config = CreateConfig();
   config.filename = "FourPeople_1280x720_30";
@@ -8,12 +8,14 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <string>
 #include <vector>
 
 #include "absl/memory/memory.h"
 #include "api/test/create_videocodec_test_fixture.h"
 #include "media/base/media_constants.h"
 #include "modules/video_coding/codecs/test/videocodec_test_fixture_impl.h"
+#include "test/field_trial.h"
 #include "test/gtest.h"
 #include "test/testsupport/file_utils.h"
 
@@ -25,6 +27,8 @@ namespace {
 const int kCifWidth = 352;
 const int kCifHeight = 288;
 const int kNumFrames = 100;
+const int kHdWidth = 1280;
+const int kHdHeight = 720;
 
 VideoCodecTestFixture::Config CreateConfig() {
   VideoCodecTestFixture::Config config;
@@ -83,5 +87,38 @@ TEST(VideoCodecTestOpenH264, SingleNalUnit) {
                    &bs_thresholds);
 }
 
+// Measures decode speed at 720p with the decoder using all available cores.
+// The parameter is the number of frames frame threading may delay the output
+// by, 0 means slice threading only. With frame threading the reported
+// per-frame decode time includes that delay.
+class VideoCodecTestOpenH264DecodeThroughput
+    : public ::testing::TestWithParam<int> {};
+
+INSTANTIATE_TEST_SUITE_P(MaxDelayFrames,
+                         VideoCodecTestOpenH264DecodeThroughput,
+                         ::testing::Values(0, 1, 3));
+
+TEST_P(VideoCodecTestOpenH264DecodeThroughput, ConferenceMotionHd) {
+  const std::string max_delay_frames = std::to_string(GetParam());
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-H264DecoderFrameThreading/max_delay_frames:" + max_delay_frames +
+      "/");
+  auto config = CreateConfig();
+  config.filename = "ConferenceMotion_1280_720_50";
+  config.filepath = ResourcePath(config.filename, "yuv");
+  config.test_name = "openh264_decode_max_delay_" + max_delay_frames;
+  config.use_single_core = false;
+  config.SetCodecSettings(cricket::kH264CodecName, 1, 1, 1, false, true, false,
+                          kHdWidth, kHdHeight);
+  auto fixture = CreateVideoCodecTestFixture(config);
+
+  std::vector<RateProfile> rate_profiles = {{2000, 30, 0}};
+
+  // Threading must not change the decoded output.
+  std::vector<QualityThresholds> quality_thresholds = {{33, 31, 0.88, 0.85}};
+
+  fixture->RunTest(rate_profiles, nullptr, &quality_thresholds, nullptr);
+}
+
 }  // namespace test
 }  // namespace webrtc
@@ -0,0 +1,207 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/codecs/test/videocodec_throughput_test_impl.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "api/video_codecs/sdp_video_format.h"
+#include "api/video_codecs/video_decoder.h"
+#include "api/video_codecs/video_encoder.h"
+#include "media/engine/internal_decoder_factory.h"
+#include "media/engine/internal_encoder_factory.h"
+#include "modules/video_coding/codecs/test/videocodec_test_fixture_impl.h"
+#include "modules/video_coding/codecs/test/videocodec_test_stats_impl.h"
+#include "modules/video_coding/codecs/test/videoprocessor.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/event.h"
+#include "rtc_base/numerics/samples_stats_counter.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/task_queue_for_test.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+#include "test/testsupport/frame_reader.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace test {
+
+struct VideoCodecThroughputTestImpl::Pipeline {
+  explicit Pipeline(size_t index)
+      : name("Throughput TQ " + std::to_string(index)),
+        task_queue(name) {}
+
+  const std::string name;
+  TaskQueueForTest task_queue;
+  // Accessed on |task_queue| only while |processor| exists.
+  std::unique_ptr<VideoEncoder> encoder;
+  VideoProcessor::VideoDecoderList decoders;
+  std::unique_ptr<FrameReader> frame_reader;
+  VideoCodecTestStatsImpl stats;
+  VideoProcessor::IvfFileWriterMap encoded_frame_writers;
+  std::unique_ptr<VideoProcessor> processor;
+};
+
+VideoCodecThroughputTestImpl::VideoCodecThroughputTestImpl(
+    VideoCodecTestFixture::Config config,
+    size_t num_pipelines)
+    : VideoCodecThroughputTestImpl(
+          config,
+          num_pipelines,
+          absl::make_unique<InternalDecoderFactory>(),
+          absl::make_unique<InternalEncoderFactory>()) {}
+
+VideoCodecThroughputTestImpl::VideoCodecThroughputTestImpl(
+    VideoCodecTestFixture::Config config,
+    size_t num_pipelines,
+    std::unique_ptr<VideoDecoderFactory> decoder_factory,
+    std::unique_ptr<VideoEncoderFactory> encoder_factory)
+    : config_(config),
+      num_pipelines_(num_pipelines),
+      encoder_factory_(std::move(encoder_factory)),
+      decoder_factory_(std::move(decoder_factory)) {
+  RTC_CHECK_GT(num_pipelines_, 0);
+  // Quality metrics would dominate the CPU usage.
+  config_.measure_cpu = true;
+  config_.encode_in_real_time = false;
+}
+
+VideoCodecThroughputTestImpl::~VideoCodecThroughputTestImpl() = default;
+
+std::unique_ptr<VideoCodecThroughputTestImpl::Pipeline>
+VideoCodecThroughputTestImpl::CreatePipeline(size_t index,
+                                             const RateProfile& rate_profile) {
+  auto pipeline = absl::make_unique<Pipeline>(index);
+  pipeline->frame_reader = absl::make_unique<YuvFrameReaderImpl>(
+      config_.filepath, config_.codec_settings.width,
+      config_.codec_settings.height);
+  EXPECT_TRUE(pipeline->frame_reader->Init());
+
+  Pipeline* p = pipeline.get();
+  p->task_queue.SendTask([this, p, &rate_profile] {
+    const SdpVideoFormat format =
+        VideoCodecTestFixtureImpl::CreateSdpVideoFormat(config_);
+    p->encoder = encoder_factory_->CreateVideoEncoder(format);
+    RTC_CHECK(p->encoder) << "Encoder not successfully created.";
+    const size_t num_simulcast_or_spatial_layers = std::max(
+        config_.NumberOfSimulcastStreams(), config_.NumberOfSpatialLayers());
+    for (size_t i = 0; i < num_simulcast_or_spatial_layers; ++i) {
+      p->decoders.push_back(decoder_factory_->CreateVideoDecoder(format));
+      RTC_CHECK(p->decoders.back()) << "Decoder not successfully created.";
+    }
+    p->processor = absl::make_unique<VideoProcessor>(
+        p->encoder.get(), &p->decoders, p->frame_reader.get(), config_,
+        &p->stats, &p->encoded_frame_writers,
+        /*decoded_frame_writers=*/nullptr);
+    p->processor->SetRates(rate_profile.target_kbps, rate_profile.input_fps);
+  });
+  return pipeline;
+}
+
+VideoCodecThroughputTestImpl::Results VideoCodecThroughputTestImpl::Run(
+    const RateProfile& rate_profile) {
+  config_.codec_settings.minBitrate = 0;
+  config_.codec_settings.startBitrate =
+      static_cast<unsigned int>(rate_profile.target_kbps);
+  config_.codec_settings.maxFramerate =
+      static_cast<uint32_t>(rate_profile.input_fps);
+
+  std::vector<std::unique_ptr<Pipeline>> pipelines;
+  for (size_t i = 0; i < num_pipelines_; ++i)
+    pipelines.push_back(CreatePipeline(i, rate_profile));
+
+  // Frames are posted round-robin so that all pipelines start together. The
+  // software codecs deliver their output synchronously, so a pipeline is done
+  // once its task queue has run all posted tasks.
+  std::vector<rtc::Event> done(num_pipelines_);
+  const int64_t start_cpu_ns = rtc::GetProcessCpuTimeNanos();
+  const int64_t start_ns = rtc::TimeNanos();
+  for (size_t frame_num = 0; frame_num < config_.num_frames; ++frame_num) {
+    for (auto& pipeline : pipelines) {
+      Pipeline* p = pipeline.get();
+      p->task_queue.PostTask([p] { p->processor->ProcessFrame(); });
+    }
+  }
+  for (size_t i = 0; i < num_pipelines_; ++i) {
+    rtc::Event* event = &done[i];
+    pipelines[i]->task_queue.PostTask([event] { event->Set(); });
+  }
+  for (rtc::Event& event : done)
+    event.Wait(rtc::Event::kForever);
+  const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+  const int64_t cpu_time_ns = rtc::GetProcessCpuTimeNanos() - start_cpu_ns;
+
+  Results results;
+  SamplesStatsCounter latency_ms;
+  for (auto& pipeline : pipelines) {
+    Pipeline* p = pipeline.get();
+    p->task_queue.SendTask([p] {
+      p->processor.reset();
+      // The VideoProcessor must be destroyed before the codecs.
+      p->decoders.clear();
+      p->encoder.reset();
+    });
+    p->frame_reader->Close();
+    for (const auto& frame_stat : p->stats.GetFrameStatistics()) {
+      if (!frame_stat.decoding_successful)
+        continue;
+      ++results.num_decoded_frames;
+      latency_ms.AddSample(
+          static_cast<double>(frame_stat.encode_time_us +
+                              frame_stat.decode_time_us) /
+          rtc::kNumMicrosecsPerMillisec);
+    }
+  }
+
+  const double num_input_pixels = static_cast<double>(num_pipelines_) *
+                                  config_.num_frames *
+                                  config_.codec_settings.width *
+                                  config_.codec_settings.height;
+  results.aggregate_fps = static_cast<double>(results.num_decoded_frames) *
+                          rtc::kNumNanosecsPerSec /
+                          std::max<int64_t>(elapsed_ns, 1);
+  results.cpu_time_per_pixel_ns =
+      num_input_pixels > 0 ? cpu_time_ns / num_input_pixels : 0.0;
+  if (!latency_ms.IsEmpty()) {
+    results.latency_p50_ms = latency_ms.GetPercentile(0.5);
+    results.latency_p90_ms = latency_ms.GetPercentile(0.9);
+    results.latency_p99_ms = latency_ms.GetPercentile(0.99);
+  }
+  EXPECT_GT(results.num_decoded_frames, 0u);
+
+  PrintResults(results);
+  return results;
+}
+
+void VideoCodecThroughputTestImpl::PrintResults(const Results& results) const {
+  char modifier_buf[64];
+  rtc::SimpleStringBuilder modifier(modifier_buf);
+  modifier << "_" << num_pipelines_ << "_pipelines";
+  const std::string test_name =
+      config_.test_name.empty() ? config_.CodecName() : config_.test_name;
+
+  PrintResult("aggregate_fps", modifier.str(), test_name,
+              results.aggregate_fps, "fps", /*important=*/true);
+  PrintResult("frame_latency_p50", modifier.str(), test_name,
+              results.latency_p50_ms, "ms", /*important=*/false);
+  PrintResult("frame_latency_p90", modifier.str(), test_name,
+              results.latency_p90_ms, "ms", /*important=*/false);
+  PrintResult("frame_latency_p99", modifier.str(), test_name,
+              results.latency_p99_ms, "ms", /*important=*/true);
+  PrintResult("cpu_time_per_pixel", modifier.str(), test_name,
+              results.cpu_time_per_pixel_ns, "ns", /*important=*/true);
+}
+
+}  // namespace test
+}  // namespace webrtc
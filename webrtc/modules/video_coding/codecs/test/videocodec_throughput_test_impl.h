@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_VIDEO_CODING_CODECS_TEST_VIDEOCODEC_THROUGHPUT_TEST_IMPL_H_
+#define MODULES_VIDEO_CODING_CODECS_TEST_VIDEOCODEC_THROUGHPUT_TEST_IMPL_H_
+
+#include <memory>
+#include <vector>
+
+#include "api/test/videocodec_test_fixture.h"
+#include "api/video_codecs/video_decoder_factory.h"
+#include "api/video_codecs/video_encoder_factory.h"
+
+namespace webrtc {
+namespace test {
+
+// Throughput benchmark built on VideoProcessor. It runs |num_pipelines|
+// independent encode/decode pipelines concurrently, each with its own task
+// queue, codecs and YuvFrameReader on |config.filepath|, and feeds them frames
+// as fast as they can be processed. This tells how many concurrent streams a
+// machine sustains. Use |config.use_single_core| to give each pipeline one
+// core, otherwise every codec is initialized with all cores.
+//
+// Quality metrics are not computed. Results are reported through
+// test::PrintResult and are written as JSON when the test binary runs with
+// --isolated_script_test_perf_output.
+class VideoCodecThroughputTestImpl {
+ public:
+  struct Results {
+    // Number of decoded frames summed over all pipelines and layers.
+    size_t num_decoded_frames = 0;
+    // |num_decoded_frames| divided by the wall-clock run time.
+    double aggregate_fps = 0.0;
+    // Encode plus decode time of a frame, over all frames of all pipelines.
+    double latency_p50_ms = 0.0;
+    double latency_p90_ms = 0.0;
+    double latency_p99_ms = 0.0;
+    // Process CPU time divided by the number of processed input pixels.
+    double cpu_time_per_pixel_ns = 0.0;
+  };
+
+  VideoCodecThroughputTestImpl(VideoCodecTestFixture::Config config,
+                               size_t num_pipelines);
+  VideoCodecThroughputTestImpl(
+      VideoCodecTestFixture::Config config,
+      size_t num_pipelines,
+      std::unique_ptr<VideoDecoderFactory> decoder_factory,
+      std::unique_ptr<VideoEncoderFactory> encoder_factory);
+  ~VideoCodecThroughputTestImpl();
+
+  // Processes |config.num_frames| frames in every pipeline at the rates of
+  // |rate_profile|, then reports and returns the results.
+  Results Run(const RateProfile& rate_profile);
+
+ private:
+  struct Pipeline;
+
+  std::unique_ptr<Pipeline> CreatePipeline(size_t index,
+                                           const RateProfile& rate_profile);
+  void PrintResults(const Results& results) const;
+
+  VideoCodecTestFixture::Config config_;
+  const size_t num_pipelines_;
+  const std::unique_ptr<VideoEncoderFactory> encoder_factory_;
+  const std::unique_ptr<VideoDecoderFactory> decoder_factory_;
+};
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // MODULES_VIDEO_CODING_CODECS_TEST_VIDEOCODEC_THROUGHPUT_TEST_IMPL_H_
@@ -17,6 +17,7 @@
 #include <memory>
 #include <set>
 
+#include "absl/memory/memory.h"
 #include "rtc_base/byte_buffer.h"
 #include "rtc_base/byte_order.h"
 #include "rtc_base/checks.h"
@@ -69,9 +70,12 @@ const uint32_t UDP_HEADER_SIZE = 8;
 // TODO(?): Make JINGLE_HEADER_SIZE transparent to this code?
 const uint32_t JINGLE_HEADER_SIZE = 64;  // when relay framing is in use
 
-// Default size for receive and send buffer.
-const uint32_t DEFAULT_RCV_BUF_SIZE = 60 * 1024;
-const uint32_t DEFAULT_SND_BUF_SIZE = 90 * 1024;
+// Default size for receive and send buffer. The receive buffer is large enough
+// for ~40 Mbps at 100 ms RTT, and needs window scaling.
+const uint32_t DEFAULT_RCV_BUF_SIZE = 512 * 1024;
+const uint32_t DEFAULT_SND_BUF_SIZE = 768 * 1024;
+// Receive buffer size for peers that don't support window scaling.
+const uint32_t LEGACY_RCV_BUF_SIZE = 60 * 1024;
 
 //////////////////////////////////////////////////////////////////////
 // Global Constants and Functions
@@ -113,6 +117,14 @@ const uint32_t DEF_ACK_DELAY = 100;  // 100 milliseconds
 
 const uint8_t FLAG_CTL = 0x02;
 const uint8_t FLAG_RST = 0x04;
+// The payload of this ack is SACK blocks, i.e. pairs of left and right edges
+// of data received out of order. Only sent if both sides support SACK.
+const uint8_t FLAG_SACK = 0x08;
+
+const uint32_t SACK_BLOCK_SIZE = 8;
+const uint32_t MAX_SACK_BLOCKS = 4;
+// Limits the burst of retransmissions when SACKs reveal many holes at once.
+const uint32_t MAX_RETRANSMITS_PER_ACK = 2;
 
 const uint8_t CTL_CONNECT = 0;
 
@@ -121,6 +133,7 @@ const uint8_t TCP_OPT_EOL = 0;        // End of list.
 const uint8_t TCP_OPT_NOOP = 1;       // No-op.
 const uint8_t TCP_OPT_MSS = 2;        // Maximum segment size.
 const uint8_t TCP_OPT_WND_SCALE = 3;  // Window scale factor.
+const uint8_t TCP_OPT_SACK_PERMITTED = 4;  // Selective acknowledgements.
 
 const long DEFAULT_TIMEOUT =
     4000;  // If there are no pending clocks, wake up every 4 seconds
@@ -237,14 +250,21 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
 
   m_rto_base = 0;
 
-  m_cwnd = 2 * m_mss;
-  m_ssthresh = m_rbuf_len;
+  m_cc = absl::make_unique<NewRenoCongestionController>();
+  m_cc->OnMssChanged(m_mss);
+  // Sets the window scale factor for the default buffer size.
+  resizeReceiveBuffer(m_rbuf_len);
   m_lastrecv = m_lastsend = m_lasttraffic = now;
   m_bOutgoing = false;
 
   m_dup_acks = 0;
   m_recover = 0;
 
+  m_sack = false;
+  m_sack_high = 0;
+  m_rexmit_next = 0;
+  m_rcv_sack_recent = 0;
+
   m_ts_recent = m_ts_lastack = 0;
 
   m_rx_rto = DEF_RTO;
@@ -253,6 +273,7 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
   m_use_nagling = true;
   m_ack_delay = DEF_ACK_DELAY;
   m_support_wnd_scale = true;
+  m_support_sack = true;
 }
 
 PseudoTcp::~PseudoTcp() {}
@@ -301,11 +322,7 @@ void PseudoTcp::NotifyClock(uint32_t now) {
         return;
       }
 
-      uint32_t nInFlight = m_snd_nxt - m_snd_una;
-      m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
-      // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: " <<
-      // nInFlight << "  m_mss: " << m_mss;
-      m_cwnd = m_mss;
+      m_cc->OnRetransmitTimeout(m_snd_nxt - m_snd_una);
 
       // Back off retransmit timer.  Note: the limit is lower when connecting.
       uint32_t rto_limit = (m_state < TCP_ESTABLISHED) ? DEF_RTO : MAX_RTO;
@@ -392,8 +409,16 @@ void PseudoTcp::SetOption(Option opt, int value) {
   }
 }
 
+void PseudoTcp::SetCongestionController(
+    std::unique_ptr<PseudoTcpCongestionController> controller) {
+  RTC_DCHECK(m_state == TCP_LISTEN);
+  m_cc = std::move(controller);
+  m_cc->OnMssChanged(m_mss);
+  m_cc->SetSlowStartThreshold(m_rbuf_len);
+}
+
 uint32_t PseudoTcp::GetCongestionWindow() const {
-  return m_cwnd;
+  return m_cc->congestion_window();
 }
 
 uint32_t PseudoTcp::GetBytesInFlight() const {
@@ -516,6 +541,14 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
   uint32_t now = Now();
 
   std::unique_ptr<uint8_t[]> buffer(new uint8_t[MAX_PACKET]);
+  uint32_t sack_len = 0;
+  // Only pure ACKs carry SACK blocks. A zero-length RST doesn't.
+  if ((len == 0) && (flags == 0) && m_sack) {
+    sack_len = writeSackBlocks(buffer.get() + HEADER_SIZE);
+    if (sack_len > 0) {
+      flags |= FLAG_SACK;
+    }
+  }
   long_to_bytes(m_conv, buffer.get());
   long_to_bytes(seq, buffer.get() + 4);
   long_to_bytes(m_rcv_nxt, buffer.get() + 8);
@@ -548,7 +581,8 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
 #endif  // _DEBUGMSG
 
   IPseudoTcpNotify::WriteResult wres = m_notify->TcpWritePacket(
-      this, reinterpret_cast<char*>(buffer.get()), len + HEADER_SIZE);
+      this, reinterpret_cast<char*>(buffer.get()),
+      len + sack_len + HEADER_SIZE);
   // Note: When len is 0, this is an ACK packet.  We don't read the return value
   // for those, and thus we won't retry.  So go ahead and treat the packet as a
   // success (basically simulate as if it were dropped), which will prevent our
@@ -666,6 +700,14 @@ bool PseudoTcp::process(Segment& seg) {
     return false;
   }
 
+  // Selective acknowledgements are the payload of an otherwise empty ack.
+  if (seg.flags & FLAG_SACK) {
+    if (m_sack) {
+      applySackBlocks(seg.data, seg.len);
+    }
+    seg.len = 0;
+  }
+
   // Check for control data
   bool bConnect = false;
   if (seg.flags & FLAG_CTL) {
@@ -706,9 +748,11 @@ bool PseudoTcp::process(Segment& seg) {
   // Check if this is a valuable ack
   if ((seg.ack > m_snd_una) && (seg.ack <= m_snd_nxt)) {
     // Calculate round-trip time
+    int32_t rtt_sample = -1;
     if (seg.tsecr) {
       int32_t rtt = rtc::TimeDiff32(now, seg.tsecr);
       if (rtt >= 0) {
+        rtt_sample = rtt;
         if (m_rx_srtt == 0) {
           m_rx_srtt = rtt;
           m_rx_rttvar = rtt / 2;
@@ -754,10 +798,11 @@ bool PseudoTcp::process(Segment& seg) {
       }
     }
 
-    if (m_dup_acks >= 3) {
+    bool bRecovering = (m_dup_acks >= 3);
+    m_cc->OnAck(now, nAcked, rtt_sample, m_snd_nxt - m_snd_una, bRecovering);
+    if (bRecovering) {
       if (m_snd_una >= m_recover) {  // NewReno
-        uint32_t nInFlight = m_snd_nxt - m_snd_una;
-        m_cwnd = std::min(m_ssthresh, nInFlight + m_mss);  // (Fast Retransmit)
+        m_cc->OnRecoveryComplete(m_snd_nxt - m_snd_una);
 #if _DEBUGMSG >= _DBG_NORMAL
         RTC_LOG(LS_INFO) << "exit recovery";
 #endif  // _DEBUGMSG
@@ -766,20 +811,15 @@ bool PseudoTcp::process(Segment& seg) {
 #if _DEBUGMSG >= _DBG_NORMAL
         RTC_LOG(LS_INFO) << "recovery retransmit";
 #endif  // _DEBUGMSG
-        if (!transmit(m_slist.begin(), now)) {
+        bool bSuccess = m_sack ? retransmitLostSegments(now)
+                               : transmit(m_slist.begin(), now);
+        if (!bSuccess) {
           closedown(ECONNABORTED);
           return false;
         }
-        m_cwnd += m_mss - std::min(nAcked, m_cwnd);
       }
     } else {
       m_dup_acks = 0;
-      // Slow start, congestion avoidance
-      if (m_cwnd < m_ssthresh) {
-        m_cwnd += m_mss;
-      } else {
-        m_cwnd += std::max<uint32_t>(1, m_mss * m_mss / m_cwnd);
-      }
     }
   } else if (seg.ack == m_snd_una) {
     // !?! Note, tcp says don't do this... but otherwise how does a closed
@@ -796,18 +836,22 @@ bool PseudoTcp::process(Segment& seg) {
         RTC_LOG(LS_INFO) << "enter recovery";
         RTC_LOG(LS_INFO) << "recovery retransmit";
 #endif  // _DEBUGMSG
-        if (!transmit(m_slist.begin(), now)) {
+        m_rexmit_next = m_snd_una;
+        bool bSuccess = m_sack ? retransmitLostSegments(now)
+                               : transmit(m_slist.begin(), now);
+        if (!bSuccess) {
           closedown(ECONNABORTED);
           return false;
         }
         m_recover = m_snd_nxt;
-        uint32_t nInFlight = m_snd_nxt - m_snd_una;
-        m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
-        // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: "
-        // << nInFlight << "  m_mss: " << m_mss;
-        m_cwnd = m_ssthresh + 3 * m_mss;
+        m_cc->OnLossDetected(now, m_snd_nxt - m_snd_una);
       } else if (m_dup_acks > 3) {
-        m_cwnd += m_mss;
+        m_cc->OnDuplicateAck();
+        // The SACK blocks of this ack may reveal more lost segments.
+        if (m_sack && !retransmitLostSegments(now)) {
+          closedown(ECONNABORTED);
+          return false;
+        }
       }
     } else {
       m_dup_acks = 0;
@@ -948,6 +992,7 @@ bool PseudoTcp::process(Segment& seg) {
         RSegment rseg;
         rseg.seq = seg.seq;
         rseg.len = seg.len;
+        m_rcv_sack_recent = seg.seq;
         RList::iterator it = m_rlist.begin();
         while ((it != m_rlist.end()) && (it->seq < rseg.seq)) {
           ++it;
@@ -1022,7 +1067,7 @@ bool PseudoTcp::transmit(const SList::iterator& seg, uint32_t now) {
       // retransmit!?!
 
       m_mss = PACKET_MAXIMUMS[++m_msslevel] - PACKET_OVERHEAD;
-      m_cwnd = 2 * m_mss;  // I added this... haven't researched actual formula
+      m_cc->OnMssChanged(m_mss);
       if (m_mss < nTransmit) {
         nTransmit = m_mss;
         break;
@@ -1039,6 +1084,7 @@ bool PseudoTcp::transmit(const SList::iterator& seg, uint32_t now) {
     SSegment subseg(seg->seq + nTransmit, seg->len - nTransmit, seg->bCtrl);
     // subseg.tstamp = seg->tstamp;
     subseg.xmit = seg->xmit;
+    subseg.bSacked = seg->bSacked;
     seg->len = nTransmit;
 
     SList::iterator next = seg;
@@ -1061,7 +1107,7 @@ void PseudoTcp::attemptSend(SendFlags sflags) {
   uint32_t now = Now();
 
   if (rtc::TimeDiff32(now, m_lastsend) > static_cast<long>(m_rx_rto)) {
-    m_cwnd = m_mss;
+    m_cc->OnIdleRestart();
   }
 
 #if _DEBUGMSG
@@ -1069,7 +1115,7 @@ void PseudoTcp::attemptSend(SendFlags sflags) {
 #endif  // _DEBUGMSG
 
   while (true) {
-    uint32_t cwnd = m_cwnd;
+    uint32_t cwnd = m_cc->congestion_window();
     if ((m_dup_acks == 1) || (m_dup_acks == 2)) {  // Limited Transmit
       cwnd += m_dup_acks * m_mss;
     }
@@ -1097,12 +1143,11 @@ void PseudoTcp::attemptSend(SendFlags sflags) {
       m_sbuf.GetWriteRemaining(&available_space);
 
       bFirst = false;
-      RTC_LOG(LS_INFO) << "[cwnd: " << m_cwnd << "  nWindow: " << nWindow
+      RTC_LOG(LS_INFO) << "[cwnd: " << cwnd << "  nWindow: " << nWindow
                        << "  nInFlight: " << nInFlight
                        << "  nAvailable: " << nAvailable
                        << "  nQueued: " << snd_buffered
-                       << "  nEmpty: " << available_space
-                       << "  ssthresh: " << m_ssthresh << "]";
+                       << "  nEmpty: " << available_space << "]";
     }
 #endif  // _DEBUGMSG
 
@@ -1173,9 +1218,7 @@ void PseudoTcp::adjustMTU() {
 #if _DEBUGMSG >= _DBG_NORMAL
   RTC_LOG(LS_INFO) << "Adjusting mss to " << m_mss << " bytes";
 #endif  // _DEBUGMSG
-  // Enforce minimums on ssthresh and cwnd
-  m_ssthresh = std::max(m_ssthresh, 2 * m_mss);
-  m_cwnd = std::max(m_cwnd, m_mss);
+  m_cc->OnMssChanged(m_mss);
 }
 
 bool PseudoTcp::isReceiveBufferFull() const {
@@ -1186,6 +1229,24 @@ bool PseudoTcp::isReceiveBufferFull() const {
 
 void PseudoTcp::disableWindowScale() {
   m_support_wnd_scale = false;
+  // The window can't be advertised unscaled otherwise.
+  if (m_rwnd_scale > 0) {
+    resizeReceiveBuffer(LEGACY_RCV_BUF_SIZE);
+  }
+}
+
+void PseudoTcp::disableSack() {
+  m_support_sack = false;
+}
+
+uint32_t PseudoTcp::getSackedBytes() const {
+  uint32_t sacked = 0;
+  for (const SSegment& seg : m_slist) {
+    if (seg.bSacked) {
+      sacked += seg.len;
+    }
+  }
+  return sacked;
 }
 
 void PseudoTcp::queueConnectMessage() {
@@ -1197,6 +1258,10 @@ void PseudoTcp::queueConnectMessage() {
     buf.WriteUInt8(1);
     buf.WriteUInt8(m_rwnd_scale);
   }
+  if (m_support_sack) {
+    buf.WriteUInt8(TCP_OPT_SACK_PERMITTED);
+    buf.WriteUInt8(0);
+  }
   m_snd_wnd = static_cast<uint32_t>(buf.Length());
   queue(buf.Data(), static_cast<uint32_t>(buf.Length()), true);
 }
@@ -1240,11 +1305,17 @@ void PseudoTcp::parseOptions(const char* data, uint32_t len) {
 
     if (m_rwnd_scale > 0) {
       // Peer doesn't support TCP options and window scaling.
-      // Revert receive buffer size to default value.
-      resizeReceiveBuffer(DEFAULT_RCV_BUF_SIZE);
+      // Revert receive buffer size to one that fits an unscaled window.
+      resizeReceiveBuffer(LEGACY_RCV_BUF_SIZE);
       m_swnd_scale = 0;
     }
   }
+
+  m_sack = m_support_sack && (options_specified.find(TCP_OPT_SACK_PERMITTED) !=
+                              options_specified.end());
+  if (!m_sack) {
+    RTC_LOG(LS_INFO) << "Selective acknowledgements are disabled";
+  }
 }
 
 void PseudoTcp::applyOption(char kind, const char* data, uint32_t len) {
@@ -1258,7 +1329,10 @@ void PseudoTcp::applyOption(char kind, const char* data, uint32_t len) {
       RTC_LOG_F(WARNING) << "Invalid window scale option received.";
       return;
     }
-    applyWindowScaleOption(data[0]);
+    // Without our option, the peer falls back to unscaled windows.
+    if (m_support_wnd_scale) {
+      applyWindowScaleOption(data[0]);
+    }
   }
 }
 
@@ -1266,6 +1340,89 @@ void PseudoTcp::applyWindowScaleOption(uint8_t scale_factor) {
   m_swnd_scale = scale_factor;
 }
 
+uint32_t PseudoTcp::writeSackBlocks(uint8_t* buffer) const {
+  uint32_t recent[2] = {0, 0};
+  uint32_t others[MAX_SACK_BLOCKS - 1][2];
+  uint32_t nOthers = 0;
+  bool bHaveRecent = false;
+
+  RList::const_iterator it = m_rlist.begin();
+  while (it != m_rlist.end()) {
+    // Out-of-order segments may overlap or be adjacent.
+    uint32_t left = it->seq;
+    uint32_t right = it->seq + it->len;
+    for (++it; (it != m_rlist.end()) && (it->seq <= right); ++it) {
+      right = std::max(right, it->seq + it->len);
+    }
+    if ((left <= m_rcv_sack_recent) && (m_rcv_sack_recent < right)) {
+      recent[0] = left;
+      recent[1] = right;
+      bHaveRecent = true;
+    } else if (nOthers < MAX_SACK_BLOCKS - 1) {
+      others[nOthers][0] = left;
+      others[nOthers][1] = right;
+      ++nOthers;
+    } else if (bHaveRecent) {
+      break;
+    }
+  }
+
+  uint32_t len = 0;
+  if (bHaveRecent) {
+    long_to_bytes(recent[0], buffer);
+    long_to_bytes(recent[1], buffer + 4);
+    len += SACK_BLOCK_SIZE;
+  }
+  for (uint32_t i = 0; i < nOthers; ++i) {
+    long_to_bytes(others[i][0], buffer + len);
+    long_to_bytes(others[i][1], buffer + len + 4);
+    len += SACK_BLOCK_SIZE;
+  }
+  return len;
+}
+
+void PseudoTcp::applySackBlocks(const char* data, uint32_t len) {
+  for (uint32_t offset = 0; offset + SACK_BLOCK_SIZE <= len;
+       offset += SACK_BLOCK_SIZE) {
+    uint32_t left = bytes_to_long(data + offset);
+    uint32_t right = bytes_to_long(data + offset + 4);
+    // Ignore blocks that don't describe data in flight.
+    if ((left >= right) || (left < m_snd_una) || (right > m_snd_nxt)) {
+      continue;
+    }
+    m_sack_high = std::max(m_sack_high, right);
+    for (SList::iterator it = m_slist.begin();
+         (it != m_slist.end()) && (it->seq < right); ++it) {
+      if ((it->seq >= left) && (it->seq + it->len <= right)) {
+        it->bSacked = true;
+      }
+    }
+  }
+}
+
+bool PseudoTcp::retransmitLostSegments(uint32_t now) {
+  uint32_t nRetransmitted = 0;
+  for (SList::iterator it = m_slist.begin();
+       (it != m_slist.end()) && (it->xmit > 0) &&
+       (nRetransmitted < MAX_RETRANSMITS_PER_ACK);
+       ++it) {
+    if (it->bSacked || (it->seq < m_rexmit_next)) {
+      continue;
+    }
+    // Only data below a SACKed segment is known to be lost. The first
+    // unacknowledged segment is retransmitted regardless, as without SACK.
+    if ((it != m_slist.begin()) && (it->seq + it->len > m_sack_high)) {
+      break;
+    }
+    if (!transmit(it, now)) {
+      return false;
+    }
+    m_rexmit_next = it->seq + it->len;
+    ++nRetransmitted;
+  }
+  return true;
+}
+
 void PseudoTcp::resizeSendBuffer(uint32_t new_size) {
   m_sbuf_len = new_size;
   m_sbuf.SetCapacity(new_size);
@@ -1292,7 +1449,7 @@ void PseudoTcp::resizeReceiveBuffer(uint32_t new_size) {
   RTC_DCHECK(result);
   m_rbuf_len = new_size;
   m_rwnd_scale = scale_factor;
-  m_ssthresh = new_size;
+  m_cc->SetSlowStartThreshold(new_size);
 
   size_t available_space = 0;
   m_rbuf.GetWriteRemaining(&available_space);
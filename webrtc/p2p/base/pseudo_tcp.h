@@ -14,7 +14,9 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <list>
+#include <memory>
 
+#include "p2p/base/pseudo_tcp_congestion_controller.h"
 #include "rtc_base/memory/fifo_buffer.h"
 #include "rtc_base/system/rtc_export.h"
 
@@ -100,6 +102,11 @@ class RTC_EXPORT PseudoTcp {
   void GetOption(Option opt, int* value);
   void SetOption(Option opt, int value);
 
+  // Replaces the default NewReno congestion control. Must be called before
+  // Connect().
+  void SetCongestionController(
+      std::unique_ptr<PseudoTcpCongestionController> controller);
+
   // Returns current congestion window in bytes.
   uint32_t GetCongestionWindow() const;
 
@@ -128,11 +135,13 @@ class RTC_EXPORT PseudoTcp {
 
   struct SSegment {
     SSegment(uint32_t s, uint32_t l, bool c)
-        : seq(s), len(l), /*tstamp(0),*/ xmit(0), bCtrl(c) {}
+        : seq(s), len(l), /*tstamp(0),*/ xmit(0), bCtrl(c), bSacked(false) {}
     uint32_t seq, len;
     // uint32_t tstamp;
     uint8_t xmit;
     bool bCtrl;
+    // Reported as received by a selective acknowledgement.
+    bool bSacked;
   };
   typedef std::list<SSegment> SList;
 
@@ -175,6 +184,21 @@ class RTC_EXPORT PseudoTcp {
   // support for testing backward compatibility.
   void disableWindowScale();
 
+  // This method is only used in tests, to disable selective acknowledgements
+  // for testing backward compatibility.
+  void disableSack();
+
+  // This method is used in test only to query the number of bytes in flight
+  // that selective acknowledgements reported as received.
+  uint32_t getSackedBytes() const;
+
+  // Writes the ranges of out-of-order data in |m_rlist| as SACK blocks, the
+  // one that was extended last first. Returns the number of bytes written.
+  uint32_t writeSackBlocks(uint8_t* buffer) const;
+
+  // Marks the segments in |m_slist| covered by received SACK blocks.
+  void applySackBlocks(const char* data, uint32_t len);
+
  private:
   // Queue the connect message with TCP options.
   void queueConnectMessage();
@@ -188,6 +212,11 @@ class RTC_EXPORT PseudoTcp {
   // Apply window scale option.
   void applyWindowScaleOption(uint8_t scale_factor);
 
+  // Retransmits segments that SACKs show to be lost, starting with the first
+  // unacknowledged one, and at most two per call. Returns false if the
+  // connection should be closed.
+  bool retransmitLostSegments(uint32_t now);
+
   // Resize the send buffer with |new_size| in bytes.
   void resizeSendBuffer(uint32_t new_size);
 
@@ -230,11 +259,20 @@ class RTC_EXPORT PseudoTcp {
   uint32_t m_rx_rttvar, m_rx_srtt, m_rx_rto;
 
   // Congestion avoidance, Fast retransmit/recovery, Delayed ACKs
-  uint32_t m_ssthresh, m_cwnd;
-  uint8_t m_dup_acks;
+  std::unique_ptr<PseudoTcpCongestionController> m_cc;
+  uint32_t m_dup_acks;
   uint32_t m_recover;
   uint32_t m_t_ack;
 
+  // Selective acknowledgements (RFC 2018), used if both sides support them.
+  bool m_sack;
+  // Highest sequence number reported by a SACK block.
+  uint32_t m_sack_high;
+  // Lost segments below this have been retransmitted in the current recovery.
+  uint32_t m_rexmit_next;
+  // Start of the out-of-order segment received last.
+  uint32_t m_rcv_sack_recent;
+
   // Configuration options
   bool m_use_nagling;
   uint32_t m_ack_delay;
@@ -242,6 +280,8 @@ class RTC_EXPORT PseudoTcp {
   // This is used by unit tests to test backward compatibility of
   // PseudoTcp implementations that don't support window scaling.
   bool m_support_wnd_scale;
+  // Same as above, for selective acknowledgements.
+  bool m_support_sack;
 };
 
 }  // namespace cricket
@@ -0,0 +1,207 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/pseudo_tcp_congestion_controller.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace cricket {
+
+namespace {
+
+// The delivery rate filter covers this many round trips, as in BBR.
+const uint32_t kBandwidthWindowRounds = 10;
+const uint32_t kMinRttWindowMs = 10000;
+const uint32_t kNoRttSample = std::numeric_limits<uint32_t>::max();
+// Twice the bandwidth-delay product leaves room for delayed acks, and lets the
+// delivery rate, and with it the window, grow until the path is saturated.
+const uint32_t kCwndGain = 2;
+const uint32_t kMinWindowSegments = 4;
+
+}  // namespace
+
+NewRenoCongestionController::NewRenoCongestionController() = default;
+
+NewRenoCongestionController::~NewRenoCongestionController() = default;
+
+uint32_t NewRenoCongestionController::congestion_window() const {
+  return cwnd_;
+}
+
+void NewRenoCongestionController::OnMssChanged(uint32_t mss) {
+  if (mss_ == 0 || mss < mss_) {
+    // A window counted in larger segments could now be a burst of many more
+    // packets, so start over.
+    cwnd_ = 2 * mss;
+  } else {
+    cwnd_ = std::max(cwnd_, mss);
+  }
+  ssthresh_ = std::max(ssthresh_, 2 * mss);
+  mss_ = mss;
+}
+
+void NewRenoCongestionController::SetSlowStartThreshold(uint32_t threshold) {
+  ssthresh_ = threshold;
+}
+
+void NewRenoCongestionController::OnAck(uint32_t now,
+                                        uint32_t bytes_acked,
+                                        int32_t rtt_ms,
+                                        uint32_t bytes_in_flight,
+                                        bool in_recovery) {
+  if (in_recovery) {
+    // Partial ack: deflate by the amount acked, then add back one segment for
+    // the retransmission it triggers.
+    cwnd_ += mss_ - std::min(bytes_acked, cwnd_);
+  } else if (cwnd_ < ssthresh_) {
+    // Slow start.
+    cwnd_ += mss_;
+  } else {
+    // Congestion avoidance.
+    cwnd_ += std::max<uint32_t>(1, mss_ * mss_ / cwnd_);
+  }
+}
+
+void NewRenoCongestionController::OnLossDetected(uint32_t now,
+                                                 uint32_t bytes_in_flight) {
+  ssthresh_ = std::max(bytes_in_flight / 2, 2 * mss_);
+  cwnd_ = ssthresh_ + 3 * mss_;
+}
+
+void NewRenoCongestionController::OnDuplicateAck() {
+  cwnd_ += mss_;
+}
+
+void NewRenoCongestionController::OnRecoveryComplete(
+    uint32_t bytes_in_flight) {
+  cwnd_ = std::min(ssthresh_, bytes_in_flight + mss_);
+}
+
+void NewRenoCongestionController::OnRetransmitTimeout(
+    uint32_t bytes_in_flight) {
+  ssthresh_ = std::max(bytes_in_flight / 2, 2 * mss_);
+  cwnd_ = mss_;
+}
+
+void NewRenoCongestionController::OnIdleRestart() {
+  cwnd_ = mss_;
+}
+
+DeliveryRateCongestionController::DeliveryRateCongestionController()
+    : max_rate_filter_(kBandwidthWindowRounds, 0, 0),
+      min_rtt_filter_(kMinRttWindowMs, kNoRttSample, 0) {}
+
+DeliveryRateCongestionController::~DeliveryRateCongestionController() =
+    default;
+
+uint32_t DeliveryRateCongestionController::congestion_window() const {
+  return cwnd_;
+}
+
+void DeliveryRateCongestionController::OnMssChanged(uint32_t mss) {
+  if (mss_ == 0 || mss < mss_) {
+    cwnd_ = kMinWindowSegments * mss;
+  }
+  mss_ = mss;
+  cwnd_ = std::max(cwnd_, MinWindow());
+}
+
+void DeliveryRateCongestionController::SetSlowStartThreshold(
+    uint32_t threshold) {
+  // The window is derived from the delivery rate, not from a threshold.
+}
+
+void DeliveryRateCongestionController::OnAck(uint32_t now,
+                                             uint32_t bytes_acked,
+                                             int32_t rtt_ms,
+                                             uint32_t bytes_in_flight,
+                                             bool in_recovery) {
+  delivered_ += bytes_acked;
+  if (rtt_ms >= 0)
+    min_rtt_filter_.Update(static_cast<uint32_t>(rtt_ms), now);
+
+  if (!round_started_) {
+    round_started_ = true;
+    round_start_time_ = now;
+    round_start_delivered_ = delivered_;
+  } else {
+    uint32_t elapsed_ms = now - round_start_time_;
+    if (elapsed_ms >= std::max<uint32_t>(min_rtt_ms(), 1)) {
+      uint64_t rate = (delivered_ - round_start_delivered_) * 1000 / elapsed_ms;
+      max_rate_filter_.Update(rate, ++round_count_);
+      round_start_time_ = now;
+      round_start_delivered_ = delivered_;
+    }
+  }
+
+  uint32_t target = TargetWindow();
+  if (target == 0) {
+    // No estimate yet: grow like slow start.
+    cwnd_ += bytes_acked;
+  } else {
+    cwnd_ = std::max(std::min(cwnd_ + bytes_acked, target), MinWindow());
+  }
+}
+
+void DeliveryRateCongestionController::OnLossDetected(
+    uint32_t now,
+    uint32_t bytes_in_flight) {
+  uint32_t target = TargetWindow();
+  if (target == 0) {
+    // Lost during the first round trip; the path is smaller than the initial
+    // burst.
+    cwnd_ = std::max(cwnd_ / 2, MinWindow());
+  } else {
+    cwnd_ = std::min(cwnd_, target);
+  }
+}
+
+void DeliveryRateCongestionController::OnDuplicateAck() {}
+
+void DeliveryRateCongestionController::OnRecoveryComplete(
+    uint32_t bytes_in_flight) {}
+
+void DeliveryRateCongestionController::OnRetransmitTimeout(
+    uint32_t bytes_in_flight) {
+  // Everything in flight may be lost. Restart from a single segment; acks
+  // grow the window back to the target within a few round trips.
+  cwnd_ = mss_;
+}
+
+void DeliveryRateCongestionController::OnIdleRestart() {
+  // The path estimates stay valid while idle.
+}
+
+uint64_t DeliveryRateCongestionController::bandwidth_estimate_bytes_per_sec()
+    const {
+  return max_rate_filter_.GetBest();
+}
+
+uint32_t DeliveryRateCongestionController::min_rtt_ms() const {
+  uint32_t min_rtt = min_rtt_filter_.GetBest();
+  return min_rtt == kNoRttSample ? 0 : min_rtt;
+}
+
+uint32_t DeliveryRateCongestionController::MinWindow() const {
+  return kMinWindowSegments * mss_;
+}
+
+uint32_t DeliveryRateCongestionController::TargetWindow() const {
+  uint64_t rate = bandwidth_estimate_bytes_per_sec();
+  if (rate == 0)
+    return 0;
+  uint64_t bdp = rate * min_rtt_ms() / 1000;
+  return static_cast<uint32_t>(std::min<uint64_t>(
+      std::max<uint64_t>(kCwndGain * bdp, MinWindow()),
+      std::numeric_limits<uint32_t>::max()));
+}
+
+}  // namespace cricket
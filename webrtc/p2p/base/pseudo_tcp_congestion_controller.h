@@ -0,0 +1,143 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_PSEUDO_TCP_CONGESTION_CONTROLLER_H_
+#define P2P_BASE_PSEUDO_TCP_CONGESTION_CONTROLLER_H_
+
+#include <stdint.h>
+
+#include "modules/congestion_controller/bbr/windowed_filter.h"
+#include "rtc_base/system/rtc_export.h"
+
+namespace cricket {
+
+// Decides how much unacknowledged data a PseudoTcp may have in flight.
+// PseudoTcp keeps doing loss detection and retransmission itself and reports
+// the outcome to the controller. All sizes are in bytes and all times are
+// PseudoTcp::Now() values in milliseconds.
+class RTC_EXPORT PseudoTcpCongestionController {
+ public:
+  virtual ~PseudoTcpCongestionController() {}
+
+  virtual uint32_t congestion_window() const = 0;
+
+  // Called with the initial segment size before any other event, and again
+  // whenever the segment size changes.
+  virtual void OnMssChanged(uint32_t mss) = 0;
+  // Slow start, if the controller has one, ends at |threshold| until the
+  // first loss.
+  virtual void SetSlowStartThreshold(uint32_t threshold) = 0;
+
+  // |bytes_acked| new bytes were cumulatively acknowledged. |rtt_ms| is the
+  // round-trip time sampled from this ack, or -1. |in_recovery| is true for
+  // acks that arrive during fast recovery, including the one that ends it.
+  virtual void OnAck(uint32_t now,
+                     uint32_t bytes_acked,
+                     int32_t rtt_ms,
+                     uint32_t bytes_in_flight,
+                     bool in_recovery) = 0;
+  // Enough duplicate acks arrived to start fast retransmit and recovery.
+  virtual void OnLossDetected(uint32_t now, uint32_t bytes_in_flight) = 0;
+  // A further duplicate ack arrived during recovery.
+  virtual void OnDuplicateAck() = 0;
+  // Everything that was in flight when the loss was detected is acknowledged.
+  virtual void OnRecoveryComplete(uint32_t bytes_in_flight) = 0;
+  virtual void OnRetransmitTimeout(uint32_t bytes_in_flight) = 0;
+  // Nothing was sent for longer than the retransmit timeout.
+  virtual void OnIdleRestart() = 0;
+};
+
+// The NewReno slow start, congestion avoidance and fast recovery that
+// PseudoTcp has always used. This is the default controller.
+class RTC_EXPORT NewRenoCongestionController
+    : public PseudoTcpCongestionController {
+ public:
+  NewRenoCongestionController();
+  ~NewRenoCongestionController() override;
+
+  uint32_t congestion_window() const override;
+  void OnMssChanged(uint32_t mss) override;
+  void SetSlowStartThreshold(uint32_t threshold) override;
+  void OnAck(uint32_t now,
+             uint32_t bytes_acked,
+             int32_t rtt_ms,
+             uint32_t bytes_in_flight,
+             bool in_recovery) override;
+  void OnLossDetected(uint32_t now, uint32_t bytes_in_flight) override;
+  void OnDuplicateAck() override;
+  void OnRecoveryComplete(uint32_t bytes_in_flight) override;
+  void OnRetransmitTimeout(uint32_t bytes_in_flight) override;
+  void OnIdleRestart() override;
+
+ private:
+  uint32_t mss_ = 0;
+  uint32_t cwnd_ = 0;
+  uint32_t ssthresh_ = 0;
+};
+
+// Sizes the window from the path instead of from losses, like BBR: the
+// maximum delivery rate over the last few round trips times the minimum RTT
+// gives the bandwidth-delay product, and the window is kept at a multiple of
+// it. Random loss, as seen on long relayed paths, does not shrink the window.
+// There is no pacing, so the window is the only limit on bursts.
+class RTC_EXPORT DeliveryRateCongestionController
+    : public PseudoTcpCongestionController {
+ public:
+  DeliveryRateCongestionController();
+  ~DeliveryRateCongestionController() override;
+
+  uint32_t congestion_window() const override;
+  void OnMssChanged(uint32_t mss) override;
+  void SetSlowStartThreshold(uint32_t threshold) override;
+  void OnAck(uint32_t now,
+             uint32_t bytes_acked,
+             int32_t rtt_ms,
+             uint32_t bytes_in_flight,
+             bool in_recovery) override;
+  void OnLossDetected(uint32_t now, uint32_t bytes_in_flight) override;
+  void OnDuplicateAck() override;
+  void OnRecoveryComplete(uint32_t bytes_in_flight) override;
+  void OnRetransmitTimeout(uint32_t bytes_in_flight) override;
+  void OnIdleRestart() override;
+
+  // Returns 0 until the first round trip has completed.
+  uint64_t bandwidth_estimate_bytes_per_sec() const;
+  // Returns 0 until the first RTT sample.
+  uint32_t min_rtt_ms() const;
+
+ private:
+  uint32_t MinWindow() const;
+  // The window the controller converges to, or 0 without an estimate.
+  uint32_t TargetWindow() const;
+
+  uint32_t mss_ = 0;
+  uint32_t cwnd_ = 0;
+  // Delivery rate samples are taken once per round trip.
+  uint64_t delivered_ = 0;
+  bool round_started_ = false;
+  uint32_t round_start_time_ = 0;
+  uint64_t round_start_delivered_ = 0;
+  uint32_t round_count_ = 0;
+  // Indexed by round count.
+  webrtc::bbr::WindowedFilter<uint64_t,
+                              webrtc::bbr::MaxFilter<uint64_t>,
+                              uint32_t,
+                              uint32_t>
+      max_rate_filter_;
+  webrtc::bbr::WindowedFilter<uint32_t,
+                              webrtc::bbr::MinFilter<uint32_t>,
+                              uint32_t,
+                              uint32_t>
+      min_rtt_filter_;
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_PSEUDO_TCP_CONGESTION_CONTROLLER_H_
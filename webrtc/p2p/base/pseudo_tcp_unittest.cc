@@ -11,10 +11,21 @@
 #include <string.h>
 #include <algorithm>
 #include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "p2p/base/pseudo_tcp.h"
+#include "p2p/base/pseudo_tcp_congestion_controller.h"
+#include "rtc_base/arraysize.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/fake_clock.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/helpers.h"
 #include "rtc_base/location.h"
@@ -22,15 +33,21 @@
 #include "rtc_base/memory_stream.h"
 #include "rtc_base/message_handler.h"
 #include "rtc_base/message_queue.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
 #include "rtc_base/thread.h"
 #include "rtc_base/time_utils.h"
+#include "rtc_base/virtual_socket_server.h"
 #include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
 
 using cricket::PseudoTcp;
 
 static const int kConnectTimeoutMs = 10000;  // ~3 * default RTO of 3000ms
 static const int kTransferTimeoutMs = 15000;
 static const int kBlockSize = 4096;
+static const uint8_t kFlagRst = 0x04;
+static const uint8_t kFlagSack = 0x08;
 
 class PseudoTcpForTest : public cricket::PseudoTcp {
  public:
@@ -40,6 +57,22 @@ class PseudoTcpForTest : public cricket::PseudoTcp {
   bool isReceiveBufferFull() const { return PseudoTcp::isReceiveBufferFull(); }
 
   void disableWindowScale() { PseudoTcp::disableWindowScale(); }
+
+  void disableSack() { PseudoTcp::disableSack(); }
+
+  uint32_t getSackedBytes() const { return PseudoTcp::getSackedBytes(); }
+
+  uint32_t writeSackBlocks(uint8_t* buffer) const {
+    return PseudoTcp::writeSackBlocks(buffer);
+  }
+
+  void applySackBlocks(const char* data, uint32_t len) {
+    PseudoTcp::applySackBlocks(data, len);
+  }
+
+  void sendPacket(uint32_t seq, uint8_t flags) {
+    PseudoTcp::packet(seq, flags, 0, 0);
+  }
 };
 
 class PseudoTcpTestBase : public testing::Test,
@@ -100,6 +133,14 @@ class PseudoTcpTestBase : public testing::Test,
   }
   void DisableRemoteWindowScale() { remote_.disableWindowScale(); }
   void DisableLocalWindowScale() { local_.disableWindowScale(); }
+  void DisableRemoteSack() { remote_.disableSack(); }
+  void DisableLocalSack() { local_.disableSack(); }
+  void UseDeliveryRateCongestionControl() {
+    local_.SetCongestionController(
+        absl::make_unique<cricket::DeliveryRateCongestionController>());
+    remote_.SetCongestionController(
+        absl::make_unique<cricket::DeliveryRateCongestionController>());
+  }
 
  protected:
   int Connect() {
@@ -651,6 +692,39 @@ TEST_F(PseudoTcpTest, TestSendWithLossAndOptNaglingOff) {
   TestTransfer(100000);  // less data so test runs faster
 }
 
+// Test sending data with a 50 ms RTT and 10% packet loss with a receiver that
+// doesn't support selective acknowledgements.
+TEST_F(PseudoTcpTest, TestSendWithDelayAndLossRemoteNoSack) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetDelay(50);
+  SetLoss(10);
+  DisableRemoteSack();
+  TestTransfer(100000);  // less data so test runs faster
+}
+
+// Test sending data with a 50 ms RTT and 10% packet loss with a sender that
+// doesn't support selective acknowledgements.
+TEST_F(PseudoTcpTest, TestSendWithDelayAndLossLocalNoSack) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetDelay(50);
+  SetLoss(10);
+  DisableLocalSack();
+  TestTransfer(100000);  // less data so test runs faster
+}
+
+// Test sending data with a 50 ms RTT and 10% packet loss when the window
+// follows the delivery rate rather than losses.
+TEST_F(PseudoTcpTest, TestSendWithDelayAndLossDeliveryRateControl) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetDelay(50);
+  SetLoss(10);
+  UseDeliveryRateCongestionControl();
+  TestTransfer(100000);  // less data so test runs faster
+}
+
 // Regression test for bugs.webrtc.org/9208.
 //
 // This bug resulted in corrupted data if a "connect" segment was received after
@@ -842,6 +916,9 @@ TEST_F(PseudoTcpTestReceiveWindow, TestReceiveWindow) {
   SetRemoteMtu(1500);
   SetOptNagling(false);
   SetOptAckDelay(0);
+  // A scaled window is only advertised in multiples of the scale factor, so
+  // use one that doesn't need scaling to have it filled to the last byte.
+  SetRemoteOptRcvBuf(60 * 1024);
   TestTransfer(1024 * 1000);
 }
 
@@ -852,6 +929,8 @@ TEST_F(PseudoTcpTestReceiveWindow, TestSetVerySmallSendWindowSize) {
   SetOptNagling(false);
   SetOptAckDelay(0);
   SetOptSndBuf(900);
+  // Keeps the number of tiny sends needed to fill the window small.
+  SetRemoteOptRcvBuf(60 * 1024);
   TestTransfer(1024 * 1000);
   EXPECT_EQ(900u, EstimateSendWindowSize());
 }
@@ -868,6 +947,521 @@ TEST_F(PseudoTcpTestReceiveWindow, TestSetReceiveWindowSize) {
   EXPECT_EQ(100000u, EstimateReceiveWindowSize());
 }
 
+// Connects two PseudoTcps that only exchange packets when the test delivers
+// them, on a fake clock, so that specific segments can be dropped or reordered.
+class PseudoTcpTestManualNetwork : public testing::Test,
+                                   public cricket::IPseudoTcpNotify {
+ public:
+  PseudoTcpTestManualNetwork() : local_(this, 1), remote_(this, 1) {
+    // PseudoTcp treats a zero timestamp as unset.
+    fake_clock_.AdvanceTime(webrtc::TimeDelta::seconds(1));
+    for (PseudoTcpForTest* tcp : {&local_, &remote_}) {
+      tcp->NotifyMTU(1500);
+      tcp->SetOption(PseudoTcp::OPT_NODELAY, 1);
+      tcp->SetOption(PseudoTcp::OPT_ACKDELAY, 0);
+    }
+  }
+
+ protected:
+  static const uint32_t kHeaderSize = 24;
+  static const int kTimeoutMs = 60 * 1000;
+
+  static uint32_t SeqOf(const std::string& packet) {
+    return rtc::GetBE32(packet.data() + 4);
+  }
+  static uint8_t FlagsOf(const std::string& packet) {
+    return static_cast<uint8_t>(packet[13]);
+  }
+  static uint32_t EndOf(const std::string& packet) {
+    return SeqOf(packet) + static_cast<uint32_t>(packet.size()) - kHeaderSize;
+  }
+
+  void Connect() {
+    ASSERT_EQ(0, local_.Connect());
+    DeliverAll();
+    ASSERT_EQ(PseudoTcp::TCP_ESTABLISHED, local_.State());
+    ASSERT_EQ(PseudoTcp::TCP_ESTABLISHED, remote_.State());
+  }
+
+  void Send(int size) {
+    to_send_ += size;
+    WriteData();
+  }
+
+  // Delivers packets and fires the timers of both sides for |duration_ms|, or
+  // until all data sent has been read.
+  void Run(int duration_ms) {
+    for (int elapsed_ms = 0; received_ < to_send_ && elapsed_ms < duration_ms;
+         elapsed_ms += 10) {
+      DeliverAll();
+      fake_clock_.AdvanceTime(webrtc::TimeDelta::ms(10));
+      local_.NotifyClock(PseudoTcp::Now());
+      remote_.NotifyClock(PseudoTcp::Now());
+    }
+  }
+
+  void Transfer(int size) {
+    Send(size);
+    Run(kTimeoutMs);
+    EXPECT_EQ(to_send_, received_);
+  }
+
+  // Delivers queued packets in both directions, and the ones they trigger,
+  // until there are none left. Each round trip takes 2 ms.
+  void DeliverAll() {
+    while (!to_remote_.empty() || !to_local_.empty()) {
+      ++round_trips_;
+      fake_clock_.AdvanceTime(webrtc::TimeDelta::ms(1));
+      for (const std::string& packet : TakePacketsToRemote())
+        remote_.NotifyPacket(packet.data(), packet.size());
+      std::vector<std::string> packets(to_local_.begin(), to_local_.end());
+      to_local_.clear();
+      fake_clock_.AdvanceTime(webrtc::TimeDelta::ms(1));
+      for (const std::string& packet : packets)
+        local_.NotifyPacket(packet.data(), packet.size());
+    }
+  }
+
+  std::vector<std::string> TakePacketsToRemote() {
+    std::vector<std::string> packets(to_remote_.begin(), to_remote_.end());
+    to_remote_.clear();
+    return packets;
+  }
+
+  // Sends enough data to leave slow start behind, then at least |count|
+  // segments that stay queued for the test to deliver.
+  std::vector<std::string> SendSegmentsInFlight(size_t count) {
+    Transfer(100 * 1024);
+    Send(static_cast<int>(count) * 1500);
+    std::vector<std::string> packets = TakePacketsToRemote();
+    EXPECT_GE(packets.size(), count);
+    return packets;
+  }
+
+  // Drops the first transmission of the |index|th data segment sent after
+  // the connection is established, counting from 0.
+  void DropDataSegment(int index) { drop_indices_.insert(index); }
+
+  int ReadData() {
+    char block[kBlockSize];
+    int total = 0;
+    int result;
+    while ((result = remote_.Recv(block, sizeof(block))) > 0)
+      total += result;
+    received_ += total;
+    return total;
+  }
+
+  // IPseudoTcpNotify
+  void OnTcpOpen(PseudoTcp* tcp) override {
+    if (tcp == &local_)
+      WriteData();
+  }
+  void OnTcpReadable(PseudoTcp* tcp) override {
+    if (tcp == &remote_ && reading_)
+      ReadData();
+  }
+  void OnTcpWriteable(PseudoTcp* tcp) override {
+    if (tcp == &local_)
+      WriteData();
+  }
+  void OnTcpClosed(PseudoTcp* tcp, uint32_t error) override {
+    ADD_FAILURE() << "Connection closed with error " << error;
+  }
+  WriteResult TcpWritePacket(PseudoTcp* tcp,
+                             const char* buffer,
+                             size_t len) override {
+    std::string packet(buffer, len);
+    if (tcp == &remote_) {
+      to_local_.push_back(packet);
+      return WR_SUCCESS;
+    }
+    if (local_.State() == PseudoTcp::TCP_ESTABLISHED && len > kHeaderSize) {
+      if (++transmissions_[SeqOf(packet)] == 2) {
+        retransmitted_.insert(SeqOf(packet));
+        retransmit_round_trips_.insert(round_trips_);
+      }
+      if (drop_indices_.erase(data_segments_sent_++) > 0) {
+        dropped_.insert(SeqOf(packet));
+        return WR_SUCCESS;
+      }
+    }
+    to_remote_.push_back(packet);
+    return WR_SUCCESS;
+  }
+
+  void WriteData() {
+    char block[kBlockSize] = {0};
+    while (sent_ < to_send_) {
+      int result = local_.Send(
+          block, std::min<int>(sizeof(block), to_send_ - sent_));
+      if (result <= 0)
+        break;
+      sent_ += result;
+    }
+  }
+
+  rtc::ScopedFakeClock fake_clock_;
+  PseudoTcpForTest local_;
+  PseudoTcpForTest remote_;
+  std::deque<std::string> to_remote_;
+  std::deque<std::string> to_local_;
+  bool reading_ = true;
+  int to_send_ = 0;
+  int sent_ = 0;
+  int received_ = 0;
+  int round_trips_ = 0;
+  int data_segments_sent_ = 0;
+  std::set<int> drop_indices_;
+  // Sequence numbers of the dropped and the retransmitted segments.
+  std::set<uint32_t> dropped_;
+  std::set<uint32_t> retransmitted_;
+  // Number of transmissions of each data segment, by sequence number.
+  std::map<uint32_t, int> transmissions_;
+  // The round trips in which a segment was sent for the second time.
+  std::set<int> retransmit_round_trips_;
+};
+
+// Test that with SACK, all holes in a window are retransmitted right away, and
+// nothing else is.
+TEST_F(PseudoTcpTestManualNetwork, RetransmitsHolesWithSack) {
+  Connect();
+  for (int index : {40, 42, 44, 46, 48, 50})
+    DropDataSegment(index);
+  Transfer(200 * 1024);
+  EXPECT_EQ(6u, dropped_.size());
+  EXPECT_EQ(dropped_, retransmitted_);
+  EXPECT_EQ(1u, retransmit_round_trips_.size());
+}
+
+// Test that without SACK, the holes are retransmitted one per round trip.
+TEST_F(PseudoTcpTestManualNetwork, RetransmitsHolesWithoutSack) {
+  local_.disableSack();
+  Connect();
+  for (int index : {40, 42, 44, 46, 48, 50})
+    DropDataSegment(index);
+  Transfer(200 * 1024);
+  EXPECT_EQ(6u, dropped_.size());
+  EXPECT_EQ(dropped_, retransmitted_);
+  EXPECT_EQ(6u, retransmit_round_trips_.size());
+}
+
+// Test that adjacent out-of-order segments make up one SACK block, and that the
+// block received last comes first.
+TEST_F(PseudoTcpTestManualNetwork, WritesSackBlocks) {
+  Connect();
+  std::vector<std::string> packets = SendSegmentsInFlight(8);
+  for (size_t i : {0, 1, 6, 7, 3, 4})
+    remote_.NotifyPacket(packets[i].data(), packets[i].size());
+
+  uint8_t buffer[64];
+  ASSERT_EQ(16u, remote_.writeSackBlocks(buffer));
+  EXPECT_EQ(SeqOf(packets[3]), rtc::GetBE32(buffer));
+  EXPECT_EQ(EndOf(packets[4]), rtc::GetBE32(buffer + 4));
+  EXPECT_EQ(SeqOf(packets[6]), rtc::GetBE32(buffer + 8));
+  EXPECT_EQ(EndOf(packets[7]), rtc::GetBE32(buffer + 12));
+
+  // Nothing is out of order once the holes are filled.
+  for (size_t i : {2, 5})
+    remote_.NotifyPacket(packets[i].data(), packets[i].size());
+  EXPECT_EQ(0u, remote_.writeSackBlocks(buffer));
+}
+
+// Test that at most four SACK blocks are written, always including the one
+// received last.
+TEST_F(PseudoTcpTestManualNetwork, WritesAtMostFourSackBlocks) {
+  Connect();
+  std::vector<std::string> packets = SendSegmentsInFlight(11);
+  for (size_t i : {2, 4, 10, 6, 8})
+    remote_.NotifyPacket(packets[i].data(), packets[i].size());
+
+  uint8_t buffer[64];
+  ASSERT_EQ(32u, remote_.writeSackBlocks(buffer));
+  size_t offset = 0;
+  for (size_t i : {8, 2, 4, 6}) {
+    EXPECT_EQ(SeqOf(packets[i]), rtc::GetBE32(buffer + offset));
+    EXPECT_EQ(EndOf(packets[i]), rtc::GetBE32(buffer + offset + 4));
+    offset += 8;
+  }
+}
+
+// Test that only segments in flight that are entirely covered by a valid SACK
+// block are marked.
+TEST_F(PseudoTcpTestManualNetwork, AppliesSackBlocks) {
+  Connect();
+  std::vector<std::string> packets = SendSegmentsInFlight(10);
+  EXPECT_EQ(0u, local_.getSackedBytes());
+
+  const uint32_t blocks[][2] = {
+      // Covers segments 2 and 3.
+      {SeqOf(packets[2]), EndOf(packets[3])},
+      // Covers segment 6, and part of 5.
+      {SeqOf(packets[5]) + 1, EndOf(packets[6])},
+      // Starts below the first unacknowledged byte.
+      {SeqOf(packets[0]) - 1, EndOf(packets[0])},
+      // Ends beyond the last byte sent.
+      {SeqOf(packets[8]), EndOf(packets.back()) + 1},
+      // Empty.
+      {SeqOf(packets[9]), SeqOf(packets[9])},
+  };
+  // A truncated block at the end is ignored as well.
+  char data[sizeof(blocks) + 4] = {0};
+  for (size_t i = 0; i < arraysize(blocks); ++i) {
+    rtc::SetBE32(data + 8 * i, blocks[i][0]);
+    rtc::SetBE32(data + 8 * i + 4, blocks[i][1]);
+  }
+  local_.applySackBlocks(data, sizeof(data));
+  EXPECT_EQ(EndOf(packets[3]) - SeqOf(packets[2]) + EndOf(packets[6]) -
+                SeqOf(packets[6]),
+            local_.getSackedBytes());
+}
+
+// Test that SACK blocks are sent with ACKs, but not with an RST.
+TEST_F(PseudoTcpTestManualNetwork, SendsSackBlocksOnlyWithAcks) {
+  Connect();
+  std::vector<std::string> packets = SendSegmentsInFlight(3);
+  to_local_.clear();
+  remote_.NotifyPacket(packets[2].data(), packets[2].size());
+  ASSERT_FALSE(to_local_.empty());
+  EXPECT_EQ(kFlagSack, FlagsOf(to_local_.back()));
+  EXPECT_EQ(kHeaderSize + 8, to_local_.back().size());
+
+  to_local_.clear();
+  remote_.sendPacket(SeqOf(packets[0]), kFlagRst);
+  ASSERT_EQ(1u, to_local_.size());
+  EXPECT_EQ(kFlagRst, FlagsOf(to_local_.back()));
+  EXPECT_EQ(size_t{kHeaderSize}, to_local_.back().size());
+}
+
+// Test that a sender fills the whole default receive window of 512 KB when
+// the receiver doesn't read, and that the transfer then completes.
+TEST_F(PseudoTcpTestManualNetwork, FillsDefaultReceiveWindow) {
+  Connect();
+  reading_ = false;
+  Send(1024 * 1024);
+  Run(5000);
+  EXPECT_TRUE(remote_.isReceiveBufferFull());
+  EXPECT_EQ(0u, local_.GetBytesInFlight());
+  EXPECT_EQ(512 * 1024, ReadData());
+
+  reading_ = true;
+  Run(kTimeoutMs);
+  EXPECT_EQ(1024 * 1024, received_);
+}
+
+// Transfers data between two PseudoTcps over UDP sockets on a
+// VirtualSocketServer with a fake clock, so that long round trips and loss can
+// be simulated without slowing down the test, and reports the throughput and
+// the latency from Send() until the data is read on the other side.
+struct VirtualNetworkConfig {
+  int one_way_delay_ms = 0;
+  double loss = 0.0;
+  bool sack = true;
+  bool delivery_rate_control = false;
+};
+
+class PseudoTcpVirtualNetworkTest : public testing::Test,
+                                    public rtc::MessageHandler,
+                                    public cricket::IPseudoTcpNotify,
+                                    public sigslot::has_slots<> {
+ public:
+  PseudoTcpVirtualNetworkTest() : ss_(&fake_clock_), thread_(&ss_) {
+    rtc::SetRandomTestMode(true);
+    // PseudoTcp treats a zero timestamp as unset.
+    fake_clock_.AdvanceTime(webrtc::TimeDelta::seconds(1));
+    local_ = absl::make_unique<PseudoTcpForTest>(this, 1);
+    remote_ = absl::make_unique<PseudoTcpForTest>(this, 1);
+    local_->NotifyMTU(kMtu);
+    remote_->NotifyMTU(kMtu);
+    local_socket_.reset(rtc::AsyncUDPSocket::Create(
+        &ss_, rtc::SocketAddress("1.1.1.1", 0)));
+    remote_socket_.reset(rtc::AsyncUDPSocket::Create(
+        &ss_, rtc::SocketAddress("2.2.2.2", 0)));
+    local_socket_->SignalReadPacket.connect(
+        this, &PseudoTcpVirtualNetworkTest::OnReadPacket);
+    remote_socket_->SignalReadPacket.connect(
+        this, &PseudoTcpVirtualNetworkTest::OnReadPacket);
+  }
+  ~PseudoTcpVirtualNetworkTest() override { rtc::SetRandomTestMode(false); }
+
+ protected:
+  static const int kMtu = 1500;
+  static const int kTransferSize = 4 * 1024 * 1024;
+  static const int kTimeoutMs = 600 * 1000;
+
+  void TestTransfer(const VirtualNetworkConfig& config) {
+    ss_.set_delay_mean(config.one_way_delay_ms);
+    ss_.UpdateDelayDistribution();
+    ss_.set_drop_probability(config.loss);
+    if (!config.sack)
+      local_->disableSack();
+    if (config.delivery_rate_control) {
+      local_->SetCongestionController(
+          absl::make_unique<cricket::DeliveryRateCongestionController>());
+    }
+
+    const int64_t start_ms = rtc::TimeMillis();
+    ASSERT_EQ(0, local_->Connect());
+    UpdateClock(local_.get());
+    EXPECT_TRUE_SIMULATED_WAIT(received_ == kTransferSize, kTimeoutMs,
+                               fake_clock_);
+    const int64_t elapsed_ms = rtc::TimeMillis() - start_ms;
+    EXPECT_FALSE(corrupted_);
+    ASSERT_GT(latency_samples_, 0);
+
+    rtc::StringBuilder trace;
+    trace << "rtt_" << 2 * config.one_way_delay_ms << "ms_loss_"
+          << config.loss * 100 << "pct"
+          << (config.sack ? "_sack" : "_no_sack")
+          << (config.delivery_rate_control ? "_delivery_rate" : "_newreno");
+    webrtc::test::PrintResult(
+        "pseudo_tcp_throughput", "", trace.str(),
+        8.0 * received_ / std::max<int64_t>(elapsed_ms, 1), "kbps", false);
+    webrtc::test::PrintResult(
+        "pseudo_tcp_latency", "", trace.str(),
+        static_cast<double>(latency_sum_ms_) / latency_samples_, "ms", false);
+  }
+
+  // IPseudoTcpNotify
+  void OnTcpOpen(PseudoTcp* tcp) override {
+    if (tcp == local_.get())
+      WriteData();
+  }
+  void OnTcpReadable(PseudoTcp* tcp) override {
+    if (tcp == remote_.get())
+      ReadData();
+  }
+  void OnTcpWriteable(PseudoTcp* tcp) override {
+    if (tcp == local_.get())
+      WriteData();
+  }
+  void OnTcpClosed(PseudoTcp* tcp, uint32_t error) override {
+    ADD_FAILURE() << "Connection closed with error " << error;
+  }
+  WriteResult TcpWritePacket(PseudoTcp* tcp,
+                             const char* buffer,
+                             size_t len) override {
+    rtc::AsyncPacketSocket* socket =
+        tcp == local_.get() ? local_socket_.get() : remote_socket_.get();
+    rtc::AsyncPacketSocket* peer =
+        tcp == local_.get() ? remote_socket_.get() : local_socket_.get();
+    if (socket->SendTo(buffer, len, peer->GetLocalAddress(),
+                       rtc::PacketOptions()) < 0) {
+      return WR_FAIL;
+    }
+    return WR_SUCCESS;
+  }
+
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    PseudoTcp* tcp =
+        socket == local_socket_.get() ? local_.get() : remote_.get();
+    tcp->NotifyPacket(data, size);
+    UpdateClock(tcp);
+  }
+
+  void UpdateClock(PseudoTcp* tcp) {
+    long interval = 0;  // NOLINT
+    tcp->GetNextClock(PseudoTcp::Now(), interval);
+    interval = std::max<int>(interval, 0L);  // sometimes interval is < 0
+    uint32_t message = tcp == local_.get() ? MSG_LCLOCK : MSG_RCLOCK;
+    thread_.Clear(this, message);
+    thread_.PostDelayed(RTC_FROM_HERE, interval, this, message);
+  }
+
+  void OnMessage(rtc::Message* message) override {
+    PseudoTcp* tcp =
+        message->message_id == MSG_LCLOCK ? local_.get() : remote_.get();
+    tcp->NotifyClock(PseudoTcp::Now());
+    UpdateClock(tcp);
+  }
+
+ private:
+  enum { MSG_LCLOCK, MSG_RCLOCK };
+
+  // Writes a byte pattern that the receiver can verify, and notes when each
+  // chunk was handed to the sender.
+  void WriteData() {
+    char block[kBlockSize];
+    while (sent_ < kTransferSize) {
+      const int len =
+          std::min<int>(sizeof(block), kTransferSize - sent_);
+      for (int i = 0; i < len; ++i)
+        block[i] = static_cast<char>(sent_ + i);
+      const int result = local_->Send(block, len);
+      if (result <= 0)
+        break;
+      sent_ += result;
+      send_times_.emplace_back(sent_, rtc::TimeMillis());
+    }
+    UpdateClock(local_.get());
+  }
+
+  void ReadData() {
+    char block[kBlockSize];
+    int result;
+    while ((result = remote_->Recv(block, sizeof(block))) > 0) {
+      for (int i = 0; i < result; ++i)
+        corrupted_ |= block[i] != static_cast<char>(received_ + i);
+      received_ += result;
+    }
+    const int64_t now_ms = rtc::TimeMillis();
+    while (!send_times_.empty() && send_times_.front().first <= received_) {
+      latency_sum_ms_ += now_ms - send_times_.front().second;
+      ++latency_samples_;
+      send_times_.pop_front();
+    }
+    UpdateClock(remote_.get());
+  }
+
+  rtc::ScopedFakeClock fake_clock_;
+  rtc::VirtualSocketServer ss_;
+  rtc::AutoSocketServerThread thread_;
+  std::unique_ptr<PseudoTcpForTest> local_;
+  std::unique_ptr<PseudoTcpForTest> remote_;
+  std::unique_ptr<rtc::AsyncUDPSocket> local_socket_;
+  std::unique_ptr<rtc::AsyncUDPSocket> remote_socket_;
+  int sent_ = 0;
+  int received_ = 0;
+  bool corrupted_ = false;
+  // (end of the chunk in the stream, time it was sent)
+  std::deque<std::pair<int, int64_t>> send_times_;
+  int64_t latency_sum_ms_ = 0;
+  int latency_samples_ = 0;
+};
+
+TEST_F(PseudoTcpVirtualNetworkTest, LongRoundTrip) {
+  VirtualNetworkConfig config;
+  config.one_way_delay_ms = 100;
+  TestTransfer(config);
+}
+
+TEST_F(PseudoTcpVirtualNetworkTest, LongRoundTripWithLossWithoutSack) {
+  VirtualNetworkConfig config;
+  config.one_way_delay_ms = 100;
+  config.loss = 0.01;
+  config.sack = false;
+  TestTransfer(config);
+}
+
+TEST_F(PseudoTcpVirtualNetworkTest, LongRoundTripWithLoss) {
+  VirtualNetworkConfig config;
+  config.one_way_delay_ms = 100;
+  config.loss = 0.01;
+  TestTransfer(config);
+}
+
+TEST_F(PseudoTcpVirtualNetworkTest, LongRoundTripWithLossDeliveryRateControl) {
+  VirtualNetworkConfig config;
+  config.one_way_delay_ms = 100;
+  config.loss = 0.01;
+  config.delivery_rate_control = true;
+  TestTransfer(config);
+}
+
 /* Test sending data with mismatched MTUs. We should detect this and reduce
 // our packet size accordingly.
 // TODO(?): This doesn't actually work right now. The current code
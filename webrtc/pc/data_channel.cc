@@ -388,11 +388,13 @@ void DataChannel::OnDataReceived(const cricket::ReceiveDataParams& params,
   }
 
   bool binary = (params.type == cricket::DMT_BINARY);
-  auto buffer = absl::make_unique<DataBuffer>(payload, binary);
   if (state_ == kOpen && observer_) {
+    // The DataBuffer shares |payload|, so the observer gets the received data
+    // without a copy or an allocation.
+    const DataBuffer buffer(payload, binary);
     ++messages_received_;
-    bytes_received_ += buffer->size();
-    observer_->OnMessage(*buffer.get());
+    bytes_received_ += buffer.size();
+    observer_->OnMessage(buffer);
   } else {
     if (queued_received_data_.byte_count() + payload.size() >
         kMaxQueuedReceivedDataBytes) {
@@ -405,7 +407,8 @@ void DataChannel::OnDataReceived(const cricket::ReceiveDataParams& params,
 
       return;
     }
-    queued_received_data_.PushBack(std::move(buffer));
+    queued_received_data_.PushBack(
+        absl::make_unique<DataBuffer>(payload, binary));
   }
 }
 
@@ -705,6 +705,14 @@ rtc::scoped_refptr<RTCStatsReport> CreateReportFilteredBySelector(
   return TakeReferencedStats(report->Copy(), rtpstream_ids);
 }
 
+// Used for the requests that refresh the latest report. The result is picked
+// up by RTCStatsCollector::GetLatestReport() instead.
+class DiscardingStatsCallback : public RTCStatsCollectorCallback {
+ public:
+  void OnStatsDelivered(
+      const rtc::scoped_refptr<const RTCStatsReport>& report) override {}
+};
+
 }  // namespace
 
 RTCStatsCollector::RequestInfo::RequestInfo(
@@ -758,7 +766,9 @@ RTCStatsCollector::RTCStatsCollector(PeerConnectionInternal* pc,
       network_report_event_(true /* manual_reset */,
                             true /* initially_signaled */),
       cache_timestamp_us_(0),
-      cache_lifetime_us_(cache_lifetime_us) {
+      cache_lifetime_us_(cache_lifetime_us),
+      latest_report_timestamp_us_(0),
+      latest_report_refresh_pending_(false) {
   RTC_DCHECK(pc_);
   RTC_DCHECK(signaling_thread_);
   RTC_DCHECK(worker_thread_);
@@ -850,6 +860,20 @@ void RTCStatsCollector::ClearCachedStatsReport() {
   cached_report_ = nullptr;
 }
 
+rtc::scoped_refptr<const RTCStatsReport> RTCStatsCollector::GetLatestReport() {
+  int64_t now_us = rtc::TimeMicros();
+  rtc::CritScope lock(&latest_report_crit_);
+  if (!latest_report_refresh_pending_ &&
+      (!latest_report_ ||
+       now_us - latest_report_timestamp_us_ > cache_lifetime_us_)) {
+    latest_report_refresh_pending_ = true;
+    signaling_thread_->PostTask(
+        RTC_FROM_HERE,
+        rtc::Bind(&RTCStatsCollector::RefreshLatestReport_s, this));
+  }
+  return latest_report_;
+}
+
 void RTCStatsCollector::WaitForPendingRequest() {
   RTC_DCHECK(signaling_thread_->IsCurrent());
   // If a request is pending, blocks until the |network_report_event_| is
@@ -952,6 +976,7 @@ void RTCStatsCollector::MergeNetworkReport_s() {
   cached_report_ = partial_report_;
   partial_report_ = nullptr;
   transceiver_stats_infos_.clear();
+  UpdateLatestReport_s();
   // Trace WebRTC Stats when getStats is called on Javascript.
   // This allows access to WebRTC stats from trace logs. To enable them,
   // select the "webrtc_stats" category when recording traces.
@@ -994,6 +1019,27 @@ void RTCStatsCollector::DeliverCachedReport(
   }
 }
 
+void RTCStatsCollector::RefreshLatestReport_s() {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  if (cached_report_ &&
+      rtc::TimeMicros() - cache_timestamp_us_ <= cache_lifetime_us_) {
+    UpdateLatestReport_s();
+    return;
+  }
+  // Gathering completes in MergeNetworkReport_s(), which updates the latest
+  // report.
+  GetStatsReportInternal(RequestInfo(
+      new rtc::RefCountedObject<DiscardingStatsCallback>()));
+}
+
+void RTCStatsCollector::UpdateLatestReport_s() {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  rtc::CritScope lock(&latest_report_crit_);
+  latest_report_ = cached_report_;
+  latest_report_timestamp_us_ = cache_timestamp_us_;
+  latest_report_refresh_pending_ = false;
+}
+
 void RTCStatsCollector::ProduceCertificateStats_n(
     int64_t timestamp_us,
     const std::map<std::string, CertificateStatsPair>& transport_cert_stats,
@@ -27,10 +27,12 @@
 #include "pc/data_channel.h"
 #include "pc/peer_connection_internal.h"
 #include "pc/track_media_info_map.h"
+#include "rtc_base/critical_section.h"
 #include "rtc_base/event.h"
 #include "rtc_base/ref_count.h"
 #include "rtc_base/ssl_identity.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread_annotations.h"
 #include "rtc_base/time_utils.h"
 
 namespace webrtc {
@@ -68,6 +70,13 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   // Clears the cache's reference to the most recent stats report. Subsequently
   // calling |GetStatsReport| guarantees fresh stats.
   void ClearCachedStatsReport();
+  // Returns the most recently completed report, or null if none has been
+  // produced yet. Unlike the other methods this may be called on any thread.
+  // It never blocks or gathers stats on the calling thread: if the report is
+  // older than |cache_lifetime_| ms, gathering is started on the signaling
+  // thread and a later call returns the result. Meant for consumers that poll
+  // often, typically together with an |RTCStatsDeltaTracker|.
+  rtc::scoped_refptr<const RTCStatsReport> GetLatestReport();
 
   // If there is a |GetStatsReport| requests in-flight, waits until it has been
   // completed. Must be called on the signaling thread.
@@ -218,6 +227,10 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   // Merges |network_report_| into |partial_report_| and completes the request.
   // This is a NO-OP if |network_report_| is null.
   void MergeNetworkReport_s();
+  // Makes sure a fresh report becomes available to |GetLatestReport|.
+  void RefreshLatestReport_s();
+  // Publishes |cached_report_| to |GetLatestReport|.
+  void UpdateLatestReport_s();
 
   // Slots for signals (sigslot) that are wired up to |pc_|.
   void OnDataChannelCreated(DataChannel* channel);
@@ -264,6 +277,15 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   int64_t cache_timestamp_us_;
   int64_t cache_lifetime_us_;
   rtc::scoped_refptr<const RTCStatsReport> cached_report_;
+  // The last completed |cached_report_| and its |cache_timestamp_us_|, for
+  // |GetLatestReport|. Unlike |cached_report_| it is not reset by
+  // |ClearCachedStatsReport|.
+  rtc::CriticalSection latest_report_crit_;
+  rtc::scoped_refptr<const RTCStatsReport> latest_report_
+      RTC_GUARDED_BY(latest_report_crit_);
+  int64_t latest_report_timestamp_us_ RTC_GUARDED_BY(latest_report_crit_);
+  // Set while a refresh requested by |GetLatestReport| is in progress.
+  bool latest_report_refresh_pending_ RTC_GUARDED_BY(latest_report_crit_);
 
   // Data recorded and maintained by the stats collector during its lifetime.
   // Some stats are produced from this record instead of other components.
@@ -672,6 +672,35 @@ TEST_F(RTCStatsCollectorTest, CachedStatsReports) {
   EXPECT_NE(c.get(), d.get());
 }
 
+TEST_F(RTCStatsCollectorTest, LatestReportIsRefreshedInTheBackground) {
+  rtc::scoped_refptr<RTCStatsCollector> collector = stats_->stats_collector();
+  // The first call has no report to return, but starts gathering one.
+  EXPECT_FALSE(collector->GetLatestReport());
+  EXPECT_TRUE_WAIT(collector->GetLatestReport(), kGetStatsReportTimeoutMs);
+  rtc::scoped_refptr<const RTCStatsReport> a = collector->GetLatestReport();
+  // It is the same report that GetStatsReport() has cached.
+  EXPECT_EQ(a.get(), stats_->GetStatsReport().get());
+  // Clearing the cache doesn't clear the latest report.
+  collector->ClearCachedStatsReport();
+  EXPECT_EQ(a.get(), collector->GetLatestReport().get());
+
+  // Once the report is stale it is still returned, and a newer one is
+  // gathered in the background.
+  fake_clock_.AdvanceTime(TimeDelta::ms(51));
+  EXPECT_EQ(a.get(), collector->GetLatestReport().get());
+  EXPECT_TRUE_WAIT(collector->GetLatestReport().get() != a.get(),
+                   kGetStatsReportTimeoutMs);
+}
+
+TEST_F(RTCStatsCollectorTest, LatestReportIsUpdatedByGetStatsReport) {
+  rtc::scoped_refptr<const RTCStatsReport> a = stats_->GetStatsReport();
+  EXPECT_EQ(a.get(), stats_->stats_collector()->GetLatestReport().get());
+  fake_clock_.AdvanceTime(TimeDelta::ms(51));
+  rtc::scoped_refptr<const RTCStatsReport> b = stats_->GetStatsReport();
+  EXPECT_NE(a.get(), b.get());
+  EXPECT_EQ(b.get(), stats_->stats_collector()->GetLatestReport().get());
+}
+
 TEST_F(RTCStatsCollectorTest, MultipleCallbacksWithInvalidatedCacheInBetween) {
   rtc::scoped_refptr<const RTCStatsReport> a, b, c;
   stats_->stats_collector()->GetStatsReport(RTCStatsObtainer::Create(&a));
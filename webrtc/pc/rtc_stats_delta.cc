@@ -0,0 +1,112 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "pc/rtc_stats_delta.h"
+
+#include <utility>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+namespace {
+
+void AddNewObject(const RTCStats& stats,
+                  std::vector<RTCStatsDelta::ObjectDelta>* objects) {
+  RTCStatsDelta::ObjectDelta delta;
+  delta.stats = &stats;
+  delta.is_new = true;
+  for (const RTCStatsMemberInterface* member : stats.Members()) {
+    if (member->is_defined())
+      delta.members.push_back(member);
+  }
+  objects->push_back(std::move(delta));
+}
+
+void AddChangedObject(const RTCStats& previous,
+                      const RTCStats& current,
+                      std::vector<RTCStatsDelta::ObjectDelta>* objects) {
+  if (previous.type() != current.type()) {
+    // The ID was reused by an object of a different type.
+    AddNewObject(current, objects);
+    return;
+  }
+  std::vector<const RTCStatsMemberInterface*> previous_members =
+      previous.Members();
+  std::vector<const RTCStatsMemberInterface*> current_members =
+      current.Members();
+  // Objects of the same type list the same members in the same order.
+  RTC_DCHECK_EQ(previous_members.size(), current_members.size());
+  RTCStatsDelta::ObjectDelta delta;
+  delta.stats = &current;
+  delta.is_new = false;
+  for (size_t i = 0; i < current_members.size(); ++i) {
+    if (!(*current_members[i] == *previous_members[i]))
+      delta.members.push_back(current_members[i]);
+  }
+  if (!delta.members.empty())
+    objects->push_back(std::move(delta));
+}
+
+}  // namespace
+
+RTCStatsDelta::RTCStatsDelta() = default;
+RTCStatsDelta::RTCStatsDelta(RTCStatsDelta&& other) = default;
+RTCStatsDelta::~RTCStatsDelta() = default;
+RTCStatsDelta& RTCStatsDelta::operator=(RTCStatsDelta&& other) = default;
+
+RTCStatsDeltaTracker::RTCStatsDeltaTracker() = default;
+RTCStatsDeltaTracker::~RTCStatsDeltaTracker() = default;
+
+RTCStatsDelta RTCStatsDeltaTracker::Update(
+    rtc::scoped_refptr<const RTCStatsReport> report) {
+  RTC_DCHECK(report);
+  RTCStatsDelta delta;
+  delta.report = report;
+  if (!previous_report_) {
+    for (const RTCStats& stats : *report)
+      AddNewObject(stats, &delta.objects);
+    previous_report_ = std::move(report);
+    return delta;
+  }
+  // Polling RTCStatsCollector::GetLatestReport() more often than stats are
+  // gathered returns the same report again.
+  if (report == previous_report_)
+    return delta;
+
+  // Both reports are ordered by ID, so a single merge pass finds the new,
+  // changed and removed objects without any lookups.
+  RTCStatsReport::ConstIterator previous = previous_report_->begin();
+  RTCStatsReport::ConstIterator previous_end = previous_report_->end();
+  RTCStatsReport::ConstIterator current = report->begin();
+  RTCStatsReport::ConstIterator current_end = report->end();
+  while (previous != previous_end || current != current_end) {
+    if (current == current_end ||
+        (previous != previous_end && previous->id() < current->id())) {
+      delta.removed_ids.push_back(previous->id());
+      ++previous;
+    } else if (previous == previous_end || current->id() < previous->id()) {
+      AddNewObject(*current, &delta.objects);
+      ++current;
+    } else {
+      AddChangedObject(*previous, *current, &delta.objects);
+      ++previous;
+      ++current;
+    }
+  }
+  previous_report_ = std::move(report);
+  return delta;
+}
+
+void RTCStatsDeltaTracker::Reset() {
+  previous_report_ = nullptr;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,74 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef PC_RTC_STATS_DELTA_H_
+#define PC_RTC_STATS_DELTA_H_
+
+#include <string>
+#include <vector>
+
+#include "api/scoped_refptr.h"
+#include "api/stats/rtc_stats.h"
+#include "api/stats/rtc_stats_report.h"
+
+namespace webrtc {
+
+// The difference between two consecutive stats reports. Stats objects and
+// members are not copied; they point into |report|, which is kept alive by the
+// delta.
+struct RTCStatsDelta {
+  struct ObjectDelta {
+    // The stats object in |report|.
+    const RTCStats* stats;
+    // True if the object was not present in the previous report, in which case
+    // |members| lists all of its defined members.
+    bool is_new;
+    // The members whose value differs from the previous report, in the order
+    // of |RTCStats::Members|. A member that became undefined is included.
+    std::vector<const RTCStatsMemberInterface*> members;
+  };
+
+  RTCStatsDelta();
+  RTCStatsDelta(RTCStatsDelta&& other);
+  ~RTCStatsDelta();
+  RTCStatsDelta& operator=(RTCStatsDelta&& other);
+
+  bool empty() const { return objects.empty() && removed_ids.empty(); }
+
+  rtc::scoped_refptr<const RTCStatsReport> report;
+  // Objects that are new or have at least one changed member, ordered by ID.
+  std::vector<ObjectDelta> objects;
+  // IDs of objects present in the previous report but not in |report|.
+  std::vector<std::string> removed_ids;
+};
+
+// Produces delta-encoded reports for a consumer that polls stats periodically
+// and only cares about what changed since its previous poll. Each consumer
+// should use its own tracker. Not thread safe.
+class RTCStatsDeltaTracker {
+ public:
+  RTCStatsDeltaTracker();
+  ~RTCStatsDeltaTracker();
+
+  // Returns the delta between |report| and the report passed to the previous
+  // call, then remembers |report| as the new baseline. The first call reports
+  // every object as new. Timestamps are not compared, and passing the same
+  // report again gives an empty delta without comparing anything.
+  RTCStatsDelta Update(rtc::scoped_refptr<const RTCStatsReport> report);
+  // Forgets the baseline, so that the next Update() reports every object.
+  void Reset();
+
+ private:
+  rtc::scoped_refptr<const RTCStatsReport> previous_report_;
+};
+
+}  // namespace webrtc
+
+#endif  // PC_RTC_STATS_DELTA_H_
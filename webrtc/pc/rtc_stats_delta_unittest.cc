@@ -0,0 +1,113 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "pc/rtc_stats_delta.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "api/stats/rtcstats_objects.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+rtc::scoped_refptr<RTCStatsReport> CreateReport(uint32_t packets_sent,
+                                                uint64_t bytes_sent,
+                                                bool include_codec) {
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(0);
+  auto outbound = absl::make_unique<RTCOutboundRTPStreamStats>("outbound", 0);
+  outbound->ssrc = 1234u;
+  outbound->packets_sent = packets_sent;
+  outbound->bytes_sent = bytes_sent;
+  report->AddStats(std::move(outbound));
+  if (include_codec) {
+    auto codec = absl::make_unique<RTCCodecStats>("codec", 0);
+    codec->payload_type = 111u;
+    report->AddStats(std::move(codec));
+  }
+  return report;
+}
+
+}  // namespace
+
+TEST(RTCStatsDeltaTrackerTest, FirstUpdateReportsAllObjectsAsNew) {
+  RTCStatsDeltaTracker tracker;
+  RTCStatsDelta delta = tracker.Update(CreateReport(10, 1000, true));
+  ASSERT_EQ(2u, delta.objects.size());
+  EXPECT_TRUE(delta.removed_ids.empty());
+  // Objects are ordered by ID.
+  EXPECT_EQ("codec", delta.objects[0].stats->id());
+  EXPECT_TRUE(delta.objects[0].is_new);
+  ASSERT_EQ(1u, delta.objects[0].members.size());
+  EXPECT_EQ(delta.objects[0].members[0],
+            &delta.objects[0].stats->cast_to<RTCCodecStats>().payload_type);
+  EXPECT_EQ("outbound", delta.objects[1].stats->id());
+  EXPECT_TRUE(delta.objects[1].is_new);
+  EXPECT_EQ(3u, delta.objects[1].members.size());
+}
+
+TEST(RTCStatsDeltaTrackerTest, UnchangedReportGivesEmptyDelta) {
+  RTCStatsDeltaTracker tracker;
+  tracker.Update(CreateReport(10, 1000, true));
+  RTCStatsDelta delta = tracker.Update(CreateReport(10, 1000, true));
+  EXPECT_TRUE(delta.empty());
+  EXPECT_TRUE(delta.report);
+}
+
+TEST(RTCStatsDeltaTrackerTest, SameReportGivesEmptyDelta) {
+  RTCStatsDeltaTracker tracker;
+  rtc::scoped_refptr<RTCStatsReport> report = CreateReport(10, 1000, true);
+  tracker.Update(report);
+  RTCStatsDelta delta = tracker.Update(report);
+  EXPECT_TRUE(delta.empty());
+  EXPECT_EQ(report.get(), delta.report.get());
+}
+
+TEST(RTCStatsDeltaTrackerTest, OnlyChangedMembersAreReported) {
+  RTCStatsDeltaTracker tracker;
+  tracker.Update(CreateReport(10, 1000, true));
+  RTCStatsDelta delta = tracker.Update(CreateReport(11, 1000, true));
+  ASSERT_EQ(1u, delta.objects.size());
+  EXPECT_EQ("outbound", delta.objects[0].stats->id());
+  EXPECT_FALSE(delta.objects[0].is_new);
+  ASSERT_EQ(1u, delta.objects[0].members.size());
+  const RTCOutboundRTPStreamStats& outbound =
+      delta.objects[0].stats->cast_to<RTCOutboundRTPStreamStats>();
+  EXPECT_EQ(delta.objects[0].members[0], &outbound.packets_sent);
+  EXPECT_EQ(11u, *outbound.packets_sent);
+}
+
+TEST(RTCStatsDeltaTrackerTest, AddedAndRemovedObjectsAreReported) {
+  RTCStatsDeltaTracker tracker;
+  tracker.Update(CreateReport(10, 1000, true));
+  RTCStatsDelta delta = tracker.Update(CreateReport(10, 1000, false));
+  EXPECT_TRUE(delta.objects.empty());
+  ASSERT_EQ(1u, delta.removed_ids.size());
+  EXPECT_EQ("codec", delta.removed_ids[0]);
+
+  delta = tracker.Update(CreateReport(10, 1000, true));
+  EXPECT_TRUE(delta.removed_ids.empty());
+  ASSERT_EQ(1u, delta.objects.size());
+  EXPECT_EQ("codec", delta.objects[0].stats->id());
+  EXPECT_TRUE(delta.objects[0].is_new);
+}
+
+TEST(RTCStatsDeltaTrackerTest, ResetForgetsBaseline) {
+  RTCStatsDeltaTracker tracker;
+  tracker.Update(CreateReport(10, 1000, true));
+  tracker.Reset();
+  RTCStatsDelta delta = tracker.Update(CreateReport(10, 1000, true));
+  EXPECT_EQ(2u, delta.objects.size());
+}
+
+}  // namespace webrtc
@@ -0,0 +1,135 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "pc/srtp_session.h"
+#include "pc/test/srtp_test_util.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/ssl_stream_adapter.h"
+#include "rtc_base/system/arch.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace rtc {
+namespace {
+
+constexpr int kNumPackets = 20000;
+constexpr size_t kPacketSize = 1200;
+// Space for the largest auth tag of the tested cipher suites.
+constexpr size_t kMaxAuthTagLen = 16;
+
+const std::vector<int> kNoEncryptedHeaderExtensions;
+
+std::vector<CopyOnWriteBuffer> CreateRtpPackets() {
+  std::vector<CopyOnWriteBuffer> packets;
+  packets.reserve(kNumPackets);
+  for (int i = 0; i < kNumPackets; ++i) {
+    CopyOnWriteBuffer packet(kPacketSize, kPacketSize + kMaxAuthTagLen);
+    uint8_t* data = packet.data();
+    std::fill(data, data + kPacketSize, 0xAA);
+    data[0] = 0x80;
+    data[1] = 96;
+    SetBE16(data + 2, static_cast<uint16_t>(i));
+    SetBE32(data + 4, i * 3000);
+    SetBE32(data + 8, 0x12345678);
+    packets.push_back(std::move(packet));
+  }
+  return packets;
+}
+
+// Measures the time, and on x86 the cycles, that |kNumPackets| calls of |op|
+// take, and reports both per packet.
+template <typename Op>
+void MeasurePerPacket(const std::string& measurement,
+                      const std::string& trace,
+                      Op op) {
+  const int64_t start_ns = TimeNanos();
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  const uint64_t start_cycles = __rdtsc();
+#endif
+  for (int i = 0; i < kNumPackets; ++i)
+    op(i);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  const uint64_t elapsed_cycles = __rdtsc() - start_cycles;
+#endif
+  const int64_t elapsed_ns = TimeNanos() - start_ns;
+  webrtc::test::PrintResult(measurement, "", trace,
+                            static_cast<double>(elapsed_ns) / kNumPackets,
+                            "ns_per_packet", true);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  webrtc::test::PrintResult(measurement, "", trace,
+                            static_cast<double>(elapsed_cycles) / kNumPackets,
+                            "cycles_per_packet", false);
+#endif
+}
+
+// Protects and then unprotects |kNumPackets| RTP packets one at a time.
+void MeasureRtp(int crypto_suite) {
+  int key_len;
+  int salt_len;
+  ASSERT_TRUE(GetSrtpKeyAndSaltLengths(crypto_suite, &key_len, &salt_len));
+  ASSERT_LE(key_len + salt_len, kTestKeyLen);
+  cricket::SrtpSession send_session;
+  cricket::SrtpSession recv_session;
+  ASSERT_TRUE(send_session.SetSend(crypto_suite, kTestKey1, key_len + salt_len,
+                                   kNoEncryptedHeaderExtensions));
+  ASSERT_TRUE(recv_session.SetRecv(crypto_suite, kTestKey1, key_len + salt_len,
+                                   kNoEncryptedHeaderExtensions));
+  std::vector<CopyOnWriteBuffer> packets = CreateRtpPackets();
+  const std::string trace = SrtpCryptoSuiteToName(crypto_suite);
+
+  int num_protected = 0;
+  MeasurePerPacket("srtp_protect_rtp", trace, [&](int i) {
+    CopyOnWriteBuffer& packet = packets[i];
+    int len = static_cast<int>(packet.size());
+    if (send_session.ProtectRtp(packet.data(), len,
+                                static_cast<int>(packet.capacity()), &len)) {
+      packet.SetSize(len);
+      ++num_protected;
+    }
+  });
+  EXPECT_EQ(kNumPackets, num_protected);
+
+  int num_unprotected = 0;
+  MeasurePerPacket("srtp_unprotect_rtp", trace, [&](int i) {
+    CopyOnWriteBuffer& packet = packets[i];
+    int len = static_cast<int>(packet.size());
+    if (recv_session.UnprotectRtp(packet.data(), len, &len)) {
+      packet.SetSize(len);
+      ++num_unprotected;
+    }
+  });
+  EXPECT_EQ(kNumPackets, num_unprotected);
+}
+
+}  // namespace
+
+TEST(SrtpSessionPerformanceTest, AesCm128HmacSha1_80) {
+  MeasureRtp(SRTP_AES128_CM_SHA1_80);
+}
+
+TEST(SrtpSessionPerformanceTest, AeadAes128Gcm) {
+  MeasureRtp(SRTP_AEAD_AES_128_GCM);
+}
+
+}  // namespace rtc
@@ -13,9 +13,17 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
+#if defined(WEBRTC_POSIX)
+#include <pthread.h>
+#endif
+
+#include "api/function_view.h"
 #include "rtc_base/atomic_ops.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/critical_section.h"
@@ -28,8 +36,10 @@
 #include "rtc_base/time_utils.h"
 #include "rtc_base/trace_event.h"
 
-// This is a guesstimate that should be enough in most cases.
-static const size_t kEventLoggerArgsStrBufferInitialSize = 256;
+#if defined(WEBRTC_WIN)
+#include "rtc_base/win32.h"
+#endif
+
 static const size_t kTraceArgBufferLength = 32;
 
 namespace webrtc {
@@ -83,15 +93,159 @@ static void EventTracingThreadFunc(void* params);
 // Atomic-int fast path for avoiding logging when disabled.
 static volatile int g_event_logging_active = 0;
 
+// Maximum number of arguments of an event, see trace_event.h.
+constexpr int kMaxTraceArgs = 2;
+// Number of events buffered per thread, must be a power of two. Events are
+// dropped when the buffer of a thread is full.
+constexpr uint32_t kThreadBufferSize = 2048;
+static_assert((kThreadBufferSize & (kThreadBufferSize - 1)) == 0,
+              "The thread buffer size must be a power of two.");
+// The logging thread writes the formatted events in chunks of this size.
+constexpr size_t kOutputChunkSize = 64 * 1024;
+
+union TraceArgValue {
+  bool as_bool;
+  unsigned long long as_uint;
+  long long as_int;
+  double as_double;
+  const void* as_pointer;
+  const char* as_string;
+};
+// Assert that the size of the union is equal to the size of the as_uint field
+// since we are assigning to arbitrary types using it.
+static_assert(sizeof(TraceArgValue) == sizeof(unsigned long long),
+              "Size of TraceArg value union is not equal to the size of the "
+              "uint field of that union.");
+
+// Record of one event. Names and categories are string literals from the
+// TRACE_EVENT macros, so only their pointers are stored.
+struct TraceRecord {
+  uint64_t timestamp;
+  rtc::PlatformThreadId tid;
+  const char* name;
+  const unsigned char* category_enabled;
+  const char* arg_names[kMaxTraceArgs];
+  // For TRACE_VALUE_TYPE_COPY_STRING, the offset of the copy in
+  // |copied_strings|.
+  TraceArgValue arg_values[kMaxTraceArgs];
+  unsigned char arg_types[kMaxTraceArgs];
+  char phase;
+  uint8_t num_args;
+  // Null-terminated copies of the TRACE_VALUE_TYPE_COPY_STRING arguments.
+  // Records are reused, so this only allocates when a string is longer than
+  // any copied before into the same record.
+  std::string copied_strings;
+};
+
+// Ring buffer of the events of one thread. The thread adds events and the
+// logging thread drains them without taking any lock.
+class ThreadTraceBuffer {
+ public:
+  ThreadTraceBuffer() : records_(kThreadBufferSize) {}
+
+  // A buffer is owned by one thread at a time. It is released when the thread
+  // exits, and can then be taken over by a new thread.
+  bool TryAcquire() {
+    bool in_use = false;
+    if (!in_use_.compare_exchange_strong(in_use, true,
+                                         std::memory_order_acquire)) {
+      return false;
+    }
+    tid_ = rtc::CurrentThreadId();
+    return true;
+  }
+  void Release() { in_use_.store(false, std::memory_order_release); }
+
+  // The ID of the owning thread. Only called on the owning thread.
+  rtc::PlatformThreadId tid() const { return tid_; }
+
+  // Returns the record to fill in for the next event, or null if the buffer
+  // is full. Only called on the owning thread, followed by EndWrite().
+  TraceRecord* BeginWrite() {
+    const uint32_t write_index = write_index_.load(std::memory_order_relaxed);
+    if (write_index - read_index_.load(std::memory_order_acquire) ==
+        kThreadBufferSize) {
+      dropped_events_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    return &records_[write_index & (kThreadBufferSize - 1)];
+  }
+
+  // Publishes the record returned by BeginWrite() to the logging thread.
+  void EndWrite() {
+    write_index_.store(write_index_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_release);
+  }
+
+  // Calls |consumer| for every published event and frees their records. Only
+  // called on the logging thread, or when it is not running.
+  void Drain(rtc::FunctionView<void(const TraceRecord&)> consumer) {
+    const uint32_t write_index = write_index_.load(std::memory_order_acquire);
+    uint32_t read_index = read_index_.load(std::memory_order_relaxed);
+    for (; read_index != write_index; ++read_index)
+      consumer(records_[read_index & (kThreadBufferSize - 1)]);
+    read_index_.store(read_index, std::memory_order_release);
+  }
+
+  bool empty() const {
+    return write_index_.load(std::memory_order_acquire) ==
+           read_index_.load(std::memory_order_acquire);
+  }
+
+  // Discards all published events.
+  void Clear() {
+    read_index_.store(write_index_.load(std::memory_order_acquire),
+                      std::memory_order_release);
+    dropped_events_.store(0, std::memory_order_relaxed);
+  }
+
+  uint32_t TakeDroppedEvents() {
+    return dropped_events_.exchange(0, std::memory_order_relaxed);
+  }
+
+ private:
+  rtc::PlatformThreadId tid_ = 0;
+  std::vector<TraceRecord> records_;
+  std::atomic<uint32_t> write_index_{0};
+  std::atomic<uint32_t> read_index_{0};
+  std::atomic<uint32_t> dropped_events_{0};
+  std::atomic<bool> in_use_{false};
+};
+
+#if defined(WEBRTC_WIN)
+void WINAPI ReleaseThreadTraceBuffer(void* buffer) {
+#else
+void ReleaseThreadTraceBuffer(void* buffer) {
+#endif
+  if (buffer)
+    static_cast<ThreadTraceBuffer*>(buffer)->Release();
+}
+
 // TODO(pbos): Log metadata for all threads, etc.
 class EventLogger final {
  public:
   EventLogger()
-      : logging_thread_(EventTracingThreadFunc,
+      :
+#if defined(WEBRTC_WIN)
+        thread_buffer_key_(FlsAlloc(&ReleaseThreadTraceBuffer)),
+#endif
+        logging_thread_(EventTracingThreadFunc,
                         this,
                         "EventTracingThread",
-                        kLowPriority) {}
-  ~EventLogger() { RTC_DCHECK(thread_checker_.CalledOnValidThread()); }
+                        kLowPriority) {
+#if defined(WEBRTC_POSIX)
+    pthread_key_create(&thread_buffer_key_, &ReleaseThreadTraceBuffer);
+#endif
+  }
+  ~EventLogger() {
+    RTC_DCHECK(thread_checker_.CalledOnValidThread());
+#if defined(WEBRTC_POSIX)
+    pthread_key_delete(thread_buffer_key_);
+#endif
+#if defined(WEBRTC_WIN)
+    FlsFree(thread_buffer_key_);
+#endif
+  }
 
   void AddTraceEvent(const char* name,
                      const unsigned char* category_enabled,
@@ -100,28 +254,33 @@ class EventLogger final {
                      const char** arg_names,
                      const unsigned char* arg_types,
                      const unsigned long long* arg_values,
-                     uint64_t timestamp,
-                     int pid,
-                     rtc::PlatformThreadId thread_id) {
-    std::vector<TraceArg> args(num_args);
+                     uint64_t timestamp) {
+    RTC_DCHECK_LE(num_args, kMaxTraceArgs);
+    ThreadTraceBuffer* buffer = GetThreadBuffer();
+    TraceRecord* record = buffer->BeginWrite();
+    if (!record)
+      return;
+    record->timestamp = timestamp;
+    record->tid = buffer->tid();
+    record->name = name;
+    record->category_enabled = category_enabled;
+    record->phase = phase;
+    record->num_args = static_cast<uint8_t>(num_args);
+    record->copied_strings.clear();
     for (int i = 0; i < num_args; ++i) {
-      TraceArg& arg = args[i];
-      arg.name = arg_names[i];
-      arg.type = arg_types[i];
-      arg.value.as_uint = arg_values[i];
+      record->arg_names[i] = arg_names[i];
+      record->arg_types[i] = arg_types[i];
+      record->arg_values[i].as_uint = arg_values[i];
 
       // Value is a pointer to a temporary string, so we have to make a copy.
-      if (arg.type == TRACE_VALUE_TYPE_COPY_STRING) {
-        // Space for the string and for the terminating null character.
-        size_t str_length = strlen(arg.value.as_string) + 1;
-        char* str_copy = new char[str_length];
-        memcpy(str_copy, arg.value.as_string, str_length);
-        arg.value.as_string = str_copy;
+      if (arg_types[i] == TRACE_VALUE_TYPE_COPY_STRING) {
+        const char* str = record->arg_values[i].as_string;
+        record->arg_values[i].as_uint = record->copied_strings.size();
+        // Includes the terminating null character.
+        record->copied_strings.append(str, strlen(str) + 1);
       }
     }
-    rtc::CritScope lock(&crit_);
-    trace_events_.push_back(
-        {name, category_enabled, phase, args, timestamp, 1, thread_id});
+    buffer->EndWrite();
   }
 
   // The TraceEvent format is documented here:
@@ -129,63 +288,41 @@ class EventLogger final {
   void Log() {
     RTC_DCHECK(output_file_);
     static const int kLoggingIntervalMs = 100;
-    fprintf(output_file_, "{ \"traceEvents\": [\n");
-    bool has_logged_event = false;
+    output_.reserve(2 * kOutputChunkSize);
+    output_ = "{ \"traceEvents\": [\n";
+    has_logged_event_ = false;
+    uint64_t dropped_events = 0;
     while (true) {
       bool shutting_down = shutdown_event_.Wait(kLoggingIntervalMs);
-      std::vector<TraceEvent> events;
+      std::vector<ThreadTraceBuffer*> buffers;
       {
         rtc::CritScope lock(&crit_);
-        trace_events_.swap(events);
+        buffers.reserve(thread_buffers_.size());
+        for (const auto& buffer : thread_buffers_)
+          buffers.push_back(buffer.get());
       }
-      std::string args_str;
-      args_str.reserve(kEventLoggerArgsStrBufferInitialSize);
-      for (TraceEvent& e : events) {
-        args_str.clear();
-        if (!e.args.empty()) {
-          args_str += ", \"args\": {";
-          bool is_first_argument = true;
-          for (TraceArg& arg : e.args) {
-            if (!is_first_argument)
-              args_str += ",";
-            is_first_argument = false;
-            args_str += " \"";
-            args_str += arg.name;
-            args_str += "\": ";
-            args_str += TraceArgValueAsString(arg);
-
-            // Delete our copy of the string.
-            if (arg.type == TRACE_VALUE_TYPE_COPY_STRING) {
-              delete[] arg.value.as_string;
-              arg.value.as_string = nullptr;
-            }
-          }
-          args_str += " }";
-        }
-        fprintf(output_file_,
-                "%s{ \"name\": \"%s\""
-                ", \"cat\": \"%s\""
-                ", \"ph\": \"%c\""
-                ", \"ts\": %" PRIu64
-                ", \"pid\": %d"
-#if defined(WEBRTC_WIN)
-                ", \"tid\": %lu"
-#else
-                ", \"tid\": %d"
-#endif  // defined(WEBRTC_WIN)
-                "%s"
-                "}\n",
-                has_logged_event ? "," : " ", e.name, e.category_enabled,
-                e.phase, e.timestamp, e.pid, e.tid, args_str.c_str());
-        has_logged_event = true;
+      for (ThreadTraceBuffer* buffer : buffers) {
+        buffer->Drain([this](const TraceRecord& record) {
+          FormatEvent(record);
+          if (output_.size() >= kOutputChunkSize)
+            FlushOutput();
+        });
+        dropped_events += buffer->TakeDroppedEvents();
       }
+      FlushOutput();
       if (shutting_down)
         break;
     }
-    fprintf(output_file_, "]}\n");
+    output_ = "]}\n";
+    FlushOutput();
+    fflush(output_file_);
     if (output_file_owned_)
       fclose(output_file_);
     output_file_ = nullptr;
+    if (dropped_events > 0) {
+      RTC_LOG(LS_WARNING) << "Dropped " << dropped_events
+                          << " trace events because of full thread buffers.";
+    }
   }
 
   void Start(FILE* file, bool owned) {
@@ -198,9 +335,10 @@ class EventLogger final {
       rtc::CritScope lock(&crit_);
       // Since the atomic fast-path for adding events to the queue can be
       // bypassed while the logging thread is shutting down there may be some
-      // stale events in the queue, hence the vector needs to be cleared to not
-      // log events from a previous logging session (which may be days old).
-      trace_events_.clear();
+      // stale events in the buffers, hence they need to be cleared to not log
+      // events from a previous logging session (which may be days old).
+      for (const auto& buffer : thread_buffers_)
+        buffer->Clear();
     }
     // Enable event logging (fast-path). This should be disabled since starting
     // shouldn't be done twice.
@@ -226,103 +364,168 @@ class EventLogger final {
   }
 
  private:
-  struct TraceArg {
-    const char* name;
-    unsigned char type;
-    // Copied from webrtc/rtc_base/trace_event.h TraceValueUnion.
-    union TraceArgValue {
-      bool as_bool;
-      unsigned long long as_uint;
-      long long as_int;
-      double as_double;
-      const void* as_pointer;
-      const char* as_string;
-    } value;
-
-    // Assert that the size of the union is equal to the size of the as_uint
-    // field since we are assigning to arbitrary types using it.
-    static_assert(sizeof(TraceArgValue) == sizeof(unsigned long long),
-                  "Size of TraceArg value union is not equal to the size of "
-                  "the uint field of that union.");
-  };
-
-  struct TraceEvent {
-    const char* name;
-    const unsigned char* category_enabled;
-    char phase;
-    std::vector<TraceArg> args;
-    uint64_t timestamp;
-    int pid;
-    rtc::PlatformThreadId tid;
-  };
-
-  static std::string TraceArgValueAsString(TraceArg arg) {
-    std::string output;
-
-    if (arg.type == TRACE_VALUE_TYPE_STRING ||
-        arg.type == TRACE_VALUE_TYPE_COPY_STRING) {
-      // Space for every character to be an espaced character + two for
-      // quatation marks.
-      output.reserve(strlen(arg.value.as_string) * 2 + 2);
-      output += '\"';
-      const char* c = arg.value.as_string;
-      do {
-        if (*c == '"' || *c == '\\') {
-          output += '\\';
-          output += *c;
-        } else {
-          output += *c;
-        }
-      } while (*++c);
-      output += '\"';
-    } else {
-      output.resize(kTraceArgBufferLength);
-      size_t print_length = 0;
-      switch (arg.type) {
-        case TRACE_VALUE_TYPE_BOOL:
-          if (arg.value.as_bool) {
-            strcpy(&output[0], "true");
-            print_length = 4;
-          } else {
-            strcpy(&output[0], "false");
-            print_length = 5;
-          }
-          break;
-        case TRACE_VALUE_TYPE_UINT:
-          print_length = snprintf(&output[0], kTraceArgBufferLength, "%llu",
-                                  arg.value.as_uint);
-          break;
-        case TRACE_VALUE_TYPE_INT:
-          print_length = snprintf(&output[0], kTraceArgBufferLength, "%lld",
-                                  arg.value.as_int);
-          break;
-        case TRACE_VALUE_TYPE_DOUBLE:
-          print_length = snprintf(&output[0], kTraceArgBufferLength, "%f",
-                                  arg.value.as_double);
-          break;
-        case TRACE_VALUE_TYPE_POINTER:
-          print_length = snprintf(&output[0], kTraceArgBufferLength, "\"%p\"",
-                                  arg.value.as_pointer);
+  // Returns the buffer of the calling thread, assigned on its first event. The
+  // buffers live as long as the EventLogger. Once its thread has exited and
+  // its events have been logged, a buffer is reused by a new thread, so thread
+  // churn does not grow the memory use.
+  ThreadTraceBuffer* GetThreadBuffer() {
+#if defined(WEBRTC_POSIX)
+    void* buffer = pthread_getspecific(thread_buffer_key_);
+#endif
+#if defined(WEBRTC_WIN)
+    void* buffer = FlsGetValue(thread_buffer_key_);
+#endif
+    if (buffer)
+      return static_cast<ThreadTraceBuffer*>(buffer);
+    ThreadTraceBuffer* new_buffer = nullptr;
+    {
+      rtc::CritScope lock(&crit_);
+      for (const auto& released_buffer : thread_buffers_) {
+        // Events are only added by the owner, so an empty released buffer
+        // stays empty.
+        if (released_buffer->empty() && released_buffer->TryAcquire()) {
+          new_buffer = released_buffer.get();
           break;
+        }
+      }
+      if (!new_buffer) {
+        thread_buffers_.emplace_back(new ThreadTraceBuffer());
+        new_buffer = thread_buffers_.back().get();
+        new_buffer->TryAcquire();
+      }
+    }
+#if defined(WEBRTC_POSIX)
+    pthread_setspecific(thread_buffer_key_, new_buffer);
+#endif
+#if defined(WEBRTC_WIN)
+    FlsSetValue(thread_buffer_key_, new_buffer);
+#endif
+    return new_buffer;
+  }
+
+  void FormatEvent(const TraceRecord& record) {
+    output_ += has_logged_event_ ? ",{ \"name\": " : " { \"name\": ";
+    AppendJsonString(record.name, &output_);
+    output_ += ", \"cat\": ";
+    AppendJsonString(reinterpret_cast<const char*>(record.category_enabled),
+                     &output_);
+    output_ += ", \"ph\": ";
+    const char phase[] = {record.phase, '\0'};
+    AppendJsonString(phase, &output_);
+    // Long enough for any value of the numeric fields.
+    char numbers_str[80];
+    int length = snprintf(numbers_str, sizeof(numbers_str),
+                          ", \"ts\": %" PRIu64
+                          ", \"pid\": %d"
+#if defined(WEBRTC_WIN)
+                          ", \"tid\": %lu",
+#else
+                          ", \"tid\": %d",
+#endif  // defined(WEBRTC_WIN)
+                          record.timestamp, 1, record.tid);
+    RTC_DCHECK_GT(length, 0);
+    RTC_DCHECK_LT(length, sizeof(numbers_str));
+    output_ += numbers_str;
+    if (record.num_args > 0) {
+      output_ += ", \"args\": {";
+      for (int i = 0; i < record.num_args; ++i) {
+        if (i > 0)
+          output_ += ",";
+        output_ += " ";
+        AppendJsonString(record.arg_names[i], &output_);
+        output_ += ": ";
+        TraceArgValue value = record.arg_values[i];
+        if (record.arg_types[i] == TRACE_VALUE_TYPE_COPY_STRING)
+          value.as_string = &record.copied_strings[value.as_uint];
+        AppendTraceArgValue(record.arg_types[i], value, &output_);
       }
-      size_t output_length = print_length < kTraceArgBufferLength
-                                 ? print_length
-                                 : kTraceArgBufferLength - 1;
-      // This will hopefully be very close to nop. On most implementations, it
-      // just writes null byte and sets the length field of the string.
-      output.resize(output_length);
+      output_ += " }";
     }
+    output_ += "}\n";
+    has_logged_event_ = true;
+  }
+
+  void FlushOutput() {
+    if (output_.empty())
+      return;
+    fwrite(output_.data(), 1, output_.size(), output_file_);
+    output_.clear();
+  }
 
-    return output;
+  // Appends |str| as a quoted JSON string, escaping it as needed.
+  static void AppendJsonString(const char* str, std::string* output) {
+    *output += '\"';
+    for (const char* c = str; *c; ++c) {
+      if (*c == '"' || *c == '\\') {
+        *output += '\\';
+        *output += *c;
+      } else if (static_cast<unsigned char>(*c) < 0x20) {
+        char escaped[7];
+        snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+        *output += escaped;
+      } else {
+        *output += *c;
+      }
+    }
+    *output += '\"';
+  }
+
+  static void AppendTraceArgValue(unsigned char type,
+                                  TraceArgValue value,
+                                  std::string* output) {
+    if (type == TRACE_VALUE_TYPE_STRING ||
+        type == TRACE_VALUE_TYPE_COPY_STRING) {
+      AppendJsonString(value.as_string, output);
+      return;
+    }
+    char buffer[kTraceArgBufferLength];
+    int print_length = 0;
+    switch (type) {
+      case TRACE_VALUE_TYPE_BOOL:
+        print_length = snprintf(buffer, kTraceArgBufferLength, "%s",
+                                value.as_bool ? "true" : "false");
+        break;
+      case TRACE_VALUE_TYPE_UINT:
+        print_length =
+            snprintf(buffer, kTraceArgBufferLength, "%llu", value.as_uint);
+        break;
+      case TRACE_VALUE_TYPE_INT:
+        print_length =
+            snprintf(buffer, kTraceArgBufferLength, "%lld", value.as_int);
+        break;
+      case TRACE_VALUE_TYPE_DOUBLE:
+        print_length =
+            snprintf(buffer, kTraceArgBufferLength, "%f", value.as_double);
+        break;
+      case TRACE_VALUE_TYPE_POINTER:
+        print_length = snprintf(buffer, kTraceArgBufferLength, "\"%p\"",
+                                value.as_pointer);
+        break;
+    }
+    if (print_length <= 0)
+      return;
+    output->append(buffer,
+                   std::min(static_cast<size_t>(print_length),
+                            kTraceArgBufferLength - 1));
   }
 
   rtc::CriticalSection crit_;
-  std::vector<TraceEvent> trace_events_ RTC_GUARDED_BY(crit_);
+  std::vector<std::unique_ptr<ThreadTraceBuffer>> thread_buffers_
+      RTC_GUARDED_BY(crit_);
+#if defined(WEBRTC_POSIX)
+  pthread_key_t thread_buffer_key_;
+#endif
+#if defined(WEBRTC_WIN)
+  const DWORD thread_buffer_key_;
+#endif
   rtc::PlatformThread logging_thread_;
   rtc::Event shutdown_event_;
   rtc::ThreadChecker thread_checker_;
   FILE* output_file_ = nullptr;
   bool output_file_owned_ = false;
+  // Only accessed on the logging thread.
+  std::string output_;
+  bool has_logged_event_ = false;
 };
 
 static void EventTracingThreadFunc(void* params) {
@@ -358,7 +561,7 @@ void InternalAddTraceEvent(char phase,
 
   g_event_logger->AddTraceEvent(name, category_enabled, phase, num_args,
                                 arg_names, arg_types, arg_values,
-                                rtc::TimeMicros(), 1, rtc::CurrentThreadId());
+                                rtc::TimeMicros());
 }
 
 }  // namespace
@@ -10,8 +10,17 @@
 
 #include "rtc_base/event_tracer.h"
 
+#include <stdio.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
 #include "rtc_base/trace_event.h"
 #include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
 
 namespace {
 
@@ -52,6 +61,34 @@ static void AddTraceEventHandler(char phase,
   TestStatistics::Get()->Increment();
 }
 
+const int kEventsPerThread = 1000;
+
+void AddTestEvents(void* /*obj*/) {
+  for (int i = 0; i < kEventsPerThread; ++i) {
+    TRACE_EVENT_INSTANT1("webrtc", "EventTracerTestEvent", "value",
+                         TRACE_STR_COPY("copied \"string\""));
+  }
+}
+
+std::string ReadFile(FILE* file) {
+  std::string contents;
+  rewind(file);
+  char buffer[4096];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    contents.append(buffer, read);
+  return contents;
+}
+
+size_t CountOccurrences(const std::string& str, const std::string& pattern) {
+  size_t count = 0;
+  for (size_t pos = str.find(pattern); pos != std::string::npos;
+       pos = str.find(pattern, pos + pattern.size())) {
+    ++count;
+  }
+  return count;
+}
+
 }  // namespace
 
 namespace webrtc {
@@ -69,4 +106,111 @@ TEST(EventTracerTest, ScopedTraceEvent) {
   TestStatistics::Get()->Reset();
 }
 
+TEST(EventTracerTest, InternalCaptureFromSequentialThreads) {
+  const int kNumRounds = 5;
+  const int kThreadsPerRound = 20;
+  rtc::tracing::SetupInternalTracer();
+  FILE* file = tmpfile();
+  ASSERT_TRUE(file);
+  rtc::tracing::StartInternalCaptureToFile(file);
+  for (int i = 0; i < kNumRounds; ++i) {
+    for (int j = 0; j < kThreadsPerRound; ++j) {
+      rtc::PlatformThread thread(&AddTestEvents, nullptr, "EventTracerTest");
+      thread.Start();
+      thread.Stop();
+    }
+    // Lets the logging thread drain the buffers of the exited threads, so
+    // that the next round reuses them.
+    rtc::Thread::SleepMs(150);
+  }
+  rtc::tracing::StopInternalCapture();
+  rtc::tracing::ShutdownInternalTracer();
+
+  const std::string trace = ReadFile(file);
+  fclose(file);
+  EXPECT_EQ(static_cast<size_t>(kNumRounds * kThreadsPerRound *
+                                kEventsPerThread),
+            CountOccurrences(trace, "\"name\": \"EventTracerTestEvent\""));
+}
+
+TEST(EventTracerTest, InternalCaptureEscapesLongCopiedStrings) {
+  std::string value(1000, 'a');
+  value += "\"\\\n\x01";
+  rtc::tracing::SetupInternalTracer();
+  FILE* file = tmpfile();
+  ASSERT_TRUE(file);
+  rtc::tracing::StartInternalCaptureToFile(file);
+  TRACE_EVENT_INSTANT2("webrtc", "EventTracerTestEvent", "first",
+                       TRACE_STR_COPY(value.c_str()), "second",
+                       TRACE_STR_COPY(value.c_str()));
+  rtc::tracing::StopInternalCapture();
+  rtc::tracing::ShutdownInternalTracer();
+
+  const std::string trace = ReadFile(file);
+  fclose(file);
+  const std::string escaped_value =
+      "\"" + std::string(1000, 'a') + "\\\"\\\\\\u000a\\u0001\"";
+  EXPECT_EQ(1u, CountOccurrences(trace, "\"args\": { \"first\": " +
+                                            escaped_value +
+                                            ", \"second\": " + escaped_value +
+                                            " }"));
+}
+
+TEST(EventTracerTest, InternalCaptureFromMultipleThreads) {
+  const int kNumThreads = 4;
+  rtc::tracing::SetupInternalTracer();
+  FILE* file = tmpfile();
+  ASSERT_TRUE(file);
+  rtc::tracing::StartInternalCaptureToFile(file);
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back(
+        new rtc::PlatformThread(&AddTestEvents, nullptr, "EventTracerTest"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Stop();
+  rtc::tracing::StopInternalCapture();
+  rtc::tracing::ShutdownInternalTracer();
+
+  const std::string trace = ReadFile(file);
+  fclose(file);
+  EXPECT_EQ(0u, trace.find("{ \"traceEvents\": [\n"));
+  EXPECT_EQ(trace.size() - 3, trace.rfind("]}\n"));
+  EXPECT_EQ(static_cast<size_t>(kNumThreads * kEventsPerThread),
+            CountOccurrences(trace, "\"name\": \"EventTracerTestEvent\""));
+  EXPECT_EQ(
+      static_cast<size_t>(kNumThreads * kEventsPerThread),
+      CountOccurrences(trace,
+                       "\"args\": { \"value\": \"copied \\\"string\\\"\" }"));
+}
+
+// Measures the time spent by the traced thread on each event. Events are
+// added in bursts that fit in the thread buffer, so that none are dropped.
+TEST(EventTracerTest, DISABLED_InternalTracerOverheadPerEvent) {
+  const int kNumBursts = 50;
+  rtc::tracing::SetupInternalTracer();
+  FILE* file = tmpfile();
+  ASSERT_TRUE(file);
+  rtc::tracing::StartInternalCaptureToFile(file);
+  int64_t elapsed_ns = 0;
+  for (int i = 0; i < kNumBursts; ++i) {
+    const int64_t start_ns = rtc::TimeNanos();
+    for (int j = 0; j < kEventsPerThread; ++j) {
+      TRACE_EVENT_INSTANT2("webrtc", "EventTracerTestEvent", "burst", i,
+                           "event", j);
+    }
+    elapsed_ns += rtc::TimeNanos() - start_ns;
+    // Lets the logging thread drain the buffer.
+    rtc::Thread::SleepMs(150);
+  }
+  rtc::tracing::StopInternalCapture();
+  rtc::tracing::ShutdownInternalTracer();
+  fclose(file);
+  test::PrintResult(
+      "event_tracer_overhead", "", "instant_event",
+      static_cast<double>(elapsed_ns) / (kNumBursts * kEventsPerThread),
+      "ns_per_event", false);
+}
+
 }  // namespace webrtc
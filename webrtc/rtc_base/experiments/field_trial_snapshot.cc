@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "rtc_base/experiments/field_trial_snapshot.h"
+
+#include <string.h>
+
+#include <atomic>
+#include <vector>
+
+#include "system_wrappers/include/field_trial.h"
+
+namespace webrtc {
+namespace {
+const char kPersistentStringSeparator = '/';
+
+bool StartsWith(const std::string& str, absl::string_view prefix) {
+  return str.compare(0, prefix.size(), prefix.data(), prefix.size()) == 0;
+}
+
+#if !defined(WEBRTC_EXCLUDE_FIELD_TRIAL_DEFAULT)
+// The snapshot of the global field trial string at |trials_string|.
+struct SnapshotEntry {
+  const char* trials_string;
+  std::shared_ptr<const FieldTrialSnapshot> snapshot;
+};
+
+// The address alone isn't enough to tell whether the string changed, since a
+// new string may be installed in the buffer of the previous one.
+bool IsCurrent(const SnapshotEntry* entry, const char* trials_string) {
+  return entry && entry->trials_string == trials_string &&
+         strcmp(entry->snapshot->trials_string().c_str(), trials_string) == 0;
+}
+
+// The most recent entry. Entries are never deleted, so that a reader can use
+// an entry without a lock while it is being replaced. They are only added
+// when the field trial string changes.
+std::atomic<const SnapshotEntry*> g_latest_entry(nullptr);
+
+const SnapshotEntry* GetLatestEntry(const char* trials_string) {
+  static rtc::CriticalSection* const crit = new rtc::CriticalSection();
+  static std::vector<std::unique_ptr<SnapshotEntry>>* const entries =
+      new std::vector<std::unique_ptr<SnapshotEntry>>();
+  rtc::CritScope cs(crit);
+  const SnapshotEntry* latest = g_latest_entry.load(std::memory_order_relaxed);
+  if (IsCurrent(latest, trials_string))
+    return latest;
+  std::shared_ptr<const FieldTrialSnapshot> snapshot;
+  // Reuse the parsed trials if only the address changed.
+  if (latest && latest->snapshot->trials_string() == trials_string) {
+    snapshot = latest->snapshot;
+  } else {
+    snapshot = std::make_shared<const FieldTrialSnapshot>(trials_string);
+  }
+  entries->emplace_back(new SnapshotEntry{trials_string, snapshot});
+  g_latest_entry.store(entries->back().get(), std::memory_order_release);
+  return entries->back().get();
+}
+#endif
+}  // namespace
+
+FieldTrialSnapshot::FieldTrialSnapshot() : forwards_lookups_(true) {}
+
+FieldTrialSnapshot::FieldTrialSnapshot(std::string trials_string)
+    : forwards_lookups_(false), trials_string_(std::move(trials_string)) {
+  // Parsed like field_trial::FindFullName(): the first group of a trial wins
+  // and parsing stops at the first malformed entry.
+  size_t next_item = 0;
+  while (next_item < trials_string_.length()) {
+    size_t name_end =
+        trials_string_.find(kPersistentStringSeparator, next_item);
+    if (name_end == std::string::npos || next_item == name_end)
+      break;
+    size_t group_name_end =
+        trials_string_.find(kPersistentStringSeparator, name_end + 1);
+    if (group_name_end == std::string::npos || name_end + 1 == group_name_end)
+      break;
+    groups_.emplace(
+        trials_string_.substr(next_item, name_end - next_item),
+        trials_string_.substr(name_end + 1, group_name_end - name_end - 1));
+    next_item = group_name_end + 1;
+  }
+}
+
+FieldTrialSnapshot::~FieldTrialSnapshot() = default;
+
+std::string FieldTrialSnapshot::FindFullName(absl::string_view name) const {
+  if (forwards_lookups_)
+    return field_trial::FindFullName(std::string(name));
+  auto it = groups_.find(name);
+  return it != groups_.end() ? it->second : std::string();
+}
+
+bool FieldTrialSnapshot::IsEnabled(absl::string_view name) const {
+  return StartsWith(FindFullName(name), "Enabled");
+}
+
+bool FieldTrialSnapshot::IsDisabled(absl::string_view name) const {
+  return StartsWith(FindFullName(name), "Disabled");
+}
+
+std::shared_ptr<const FieldTrialSnapshot> GetFieldTrialSnapshot() {
+#if defined(WEBRTC_EXCLUDE_FIELD_TRIAL_DEFAULT)
+  // field_trial::FindFullName() is implemented by the embedder, and may not
+  // use the global string at all.
+  static const std::shared_ptr<const FieldTrialSnapshot>* const snapshot =
+      new std::shared_ptr<const FieldTrialSnapshot>(
+          std::make_shared<const FieldTrialSnapshot>());
+  return *snapshot;
+#else
+  static const char kEmptyTrialsString[] = "";
+  const char* trials_string = field_trial::GetFieldTrialString();
+  if (!trials_string)
+    trials_string = kEmptyTrialsString;
+  const SnapshotEntry* entry = g_latest_entry.load(std::memory_order_acquire);
+  if (!IsCurrent(entry, trials_string))
+    entry = GetLatestEntry(trials_string);
+  return entry->snapshot;
+#endif
+}
+
+}  // namespace webrtc
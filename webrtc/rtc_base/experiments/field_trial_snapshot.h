@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef RTC_BASE_EXPERIMENTS_FIELD_TRIAL_SNAPSHOT_H_
+#define RTC_BASE_EXPERIMENTS_FIELD_TRIAL_SNAPSHOT_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Immutable, parsed copy of a field trial string in the format
+// "Name1/Group1/Name2/Group2/", which is hashed by trial name. Looking up a
+// trial doesn't scan the string.
+class FieldTrialSnapshot {
+ public:
+  // Creates a snapshot that forwards every lookup to
+  // field_trial::FindFullName() and is never cached. Used when the embedder
+  // provides its own field trial implementation, whose trials can't be read
+  // from the string.
+  FieldTrialSnapshot();
+  explicit FieldTrialSnapshot(std::string trials_string);
+  ~FieldTrialSnapshot();
+
+  // Same as field_trial::FindFullName(): returns the group of the trial, or an
+  // empty string if the trial isn't set.
+  std::string FindFullName(absl::string_view name) const;
+  // Same as field_trial::IsEnabled() and field_trial::IsDisabled().
+  bool IsEnabled(absl::string_view name) const;
+  bool IsDisabled(absl::string_view name) const;
+
+  bool forwards_lookups() const { return forwards_lookups_; }
+  const std::string& trials_string() const { return trials_string_; }
+
+ private:
+  const bool forwards_lookups_;
+  const std::string trials_string_;
+  absl::flat_hash_map<std::string, std::string> groups_;
+};
+
+// Returns the snapshot of the current global field trial string. It is only
+// parsed again when the contents of the string change. Checking for that
+// takes no lock, but compares the whole string, so callers that look up
+// several trials should keep the returned pointer rather than call this for
+// every trial.
+std::shared_ptr<const FieldTrialSnapshot> GetFieldTrialSnapshot();
+
+// Parses a struct from the field trials once per global field trial string
+// and returns copies of it after that. Meant for settings that are read in
+// constructors of objects created in large numbers, e.g. per stream:
+//
+//   MySettings ParseMySettings(const FieldTrialSnapshot& trials) {
+//     MySettings settings;
+//     ParseFieldTrial({&settings.my_int},
+//                     trials.FindFullName("WebRTC-MyExperiment"));
+//     return settings;
+//   }
+//
+//   MySettings GetMySettings() {
+//     static CachedFieldTrialParser<MySettings>* const parser =
+//         new CachedFieldTrialParser<MySettings>(&ParseMySettings);
+//     return parser->Get();
+//   }
+template <typename T>
+class CachedFieldTrialParser {
+ public:
+  using ParseFunction = T (*)(const FieldTrialSnapshot& trials);
+
+  explicit CachedFieldTrialParser(ParseFunction parse) : parse_(parse) {}
+
+  T Get() {
+    std::shared_ptr<const FieldTrialSnapshot> snapshot =
+        GetFieldTrialSnapshot();
+    if (snapshot->forwards_lookups())
+      return parse_(*snapshot);
+    rtc::CritScope cs(&crit_);
+    if (snapshot != snapshot_ || !value_) {
+      value_.emplace(parse_(*snapshot));
+      snapshot_ = std::move(snapshot);
+    }
+    return *value_;
+  }
+
+ private:
+  const ParseFunction parse_;
+  rtc::CriticalSection crit_;
+  std::shared_ptr<const FieldTrialSnapshot> snapshot_ RTC_GUARDED_BY(crit_);
+  absl::optional<T> value_ RTC_GUARDED_BY(crit_);
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_EXPERIMENTS_FIELD_TRIAL_SNAPSHOT_H_
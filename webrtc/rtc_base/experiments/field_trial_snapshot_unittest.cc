@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "rtc_base/experiments/field_trial_snapshot.h"
+
+#include "rtc_base/experiments/field_trial_parser.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/field_trial.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+int g_num_parsed_settings = 0;
+
+struct TestSettings {
+  FieldTrialParameter<int> value{"value", 1};
+};
+
+TestSettings ParseTestSettings(const FieldTrialSnapshot& trials) {
+  ++g_num_parsed_settings;
+  TestSettings settings;
+  ParseFieldTrial({&settings.value}, trials.FindFullName("WebRTC-Test"));
+  return settings;
+}
+}  // namespace
+
+TEST(FieldTrialSnapshotTest, FindsGroups) {
+  FieldTrialSnapshot trials("WebRTC-A/Enabled-1/WebRTC-B/Disabled/");
+  EXPECT_EQ("Enabled-1", trials.FindFullName("WebRTC-A"));
+  EXPECT_EQ("Disabled", trials.FindFullName("WebRTC-B"));
+  EXPECT_EQ("", trials.FindFullName("WebRTC-C"));
+  EXPECT_TRUE(trials.IsEnabled("WebRTC-A"));
+  EXPECT_FALSE(trials.IsDisabled("WebRTC-A"));
+  EXPECT_TRUE(trials.IsDisabled("WebRTC-B"));
+  EXPECT_FALSE(trials.IsEnabled("WebRTC-C"));
+  EXPECT_FALSE(trials.IsDisabled("WebRTC-C"));
+}
+
+TEST(FieldTrialSnapshotTest, ParsesLikeFindFullName) {
+  // The first group wins, and parsing stops at a malformed entry.
+  FieldTrialSnapshot trials("WebRTC-A/First/WebRTC-A/Second/WebRTC-B//");
+  EXPECT_EQ("First", trials.FindFullName("WebRTC-A"));
+  EXPECT_EQ("", trials.FindFullName("WebRTC-B"));
+  FieldTrialSnapshot unterminated("WebRTC-A/Enabled");
+  EXPECT_EQ("", unterminated.FindFullName("WebRTC-A"));
+}
+
+TEST(FieldTrialSnapshotTest, FollowsGlobalFieldTrials) {
+  std::shared_ptr<const FieldTrialSnapshot> initial = GetFieldTrialSnapshot();
+  EXPECT_EQ(initial, GetFieldTrialSnapshot());
+  {
+    test::ScopedFieldTrials field_trials("WebRTC-Test/Enabled/");
+    std::shared_ptr<const FieldTrialSnapshot> snapshot =
+        GetFieldTrialSnapshot();
+    EXPECT_TRUE(snapshot->IsEnabled("WebRTC-Test"));
+    EXPECT_EQ(snapshot, GetFieldTrialSnapshot());
+  }
+  EXPECT_FALSE(GetFieldTrialSnapshot()->IsEnabled("WebRTC-Test"));
+}
+
+TEST(FieldTrialSnapshotTest, FollowsNewStringAtSameAddress) {
+  const char* const previous_trials = field_trial::GetFieldTrialString();
+  std::string trials;
+  trials.reserve(32);
+  trials = "WebRTC-Test/Enabled/";
+  const char* const address = trials.c_str();
+  field_trial::InitFieldTrialsFromString(address);
+  EXPECT_TRUE(GetFieldTrialSnapshot()->IsEnabled("WebRTC-Test"));
+  trials = "WebRTC-Test/Disabled/";
+  ASSERT_EQ(address, trials.c_str());
+  field_trial::InitFieldTrialsFromString(address);
+  EXPECT_TRUE(GetFieldTrialSnapshot()->IsDisabled("WebRTC-Test"));
+  field_trial::InitFieldTrialsFromString(previous_trials);
+}
+
+TEST(FieldTrialSnapshotTest, ForwardingSnapshotUsesFindFullName) {
+  FieldTrialSnapshot trials;
+  EXPECT_TRUE(trials.forwards_lookups());
+  test::ScopedFieldTrials field_trials("WebRTC-Test/Enabled-1/");
+  EXPECT_EQ("Enabled-1", trials.FindFullName("WebRTC-Test"));
+  EXPECT_TRUE(trials.IsEnabled("WebRTC-Test"));
+}
+
+TEST(FieldTrialSnapshotTest, CachedParserParsesOncePerTrialString) {
+  CachedFieldTrialParser<TestSettings> parser(&ParseTestSettings);
+  g_num_parsed_settings = 0;
+  {
+    test::ScopedFieldTrials field_trials("WebRTC-Test/value:2/");
+    EXPECT_EQ(2, parser.Get().value.Get());
+    EXPECT_EQ(2, parser.Get().value.Get());
+    EXPECT_EQ(1, g_num_parsed_settings);
+  }
+  {
+    test::ScopedFieldTrials field_trials("WebRTC-Test/value:3/");
+    EXPECT_EQ(3, parser.Get().value.Get());
+    EXPECT_EQ(2, g_num_parsed_settings);
+  }
+}
+
+}  // namespace webrtc
@@ -27,16 +27,25 @@
 static const int kMaxLogLineSize = 1024 - 60;
 #endif  // WEBRTC_MAC && !defined(WEBRTC_IOS) || WEBRTC_ANDROID
 
+#if defined(WEBRTC_POSIX)
+#include <pthread.h>
+#endif
+
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 #include <algorithm>
+#include <atomic>
 #include <cstdarg>
+#include <memory>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/platform_thread.h"
 #include "rtc_base/platform_thread_types.h"
 #include "rtc_base/string_encode.h"
 #include "rtc_base/string_utils.h"
@@ -48,12 +57,14 @@ namespace rtc {
 namespace {
 // By default, release builds don't log, debug builds at info level
 #if !defined(NDEBUG)
-static LoggingSeverity g_min_sev = LS_INFO;
-static LoggingSeverity g_dbg_sev = LS_INFO;
+constexpr LoggingSeverity kDefaultSeverity = LS_INFO;
 #else
-static LoggingSeverity g_min_sev = LS_NONE;
-static LoggingSeverity g_dbg_sev = LS_NONE;
+constexpr LoggingSeverity kDefaultSeverity = LS_NONE;
 #endif
+// Read without locking by every log call, so that messages below the current
+// severities are discarded as cheaply as possible.
+std::atomic<LoggingSeverity> g_min_sev(kDefaultSeverity);
+std::atomic<LoggingSeverity> g_dbg_sev(kDefaultSeverity);
 
 // Return the filename portion of the string (that following the last slash).
 const char* FilenameFromPath(const char* file) {
@@ -67,6 +78,158 @@ const char* FilenameFromPath(const char* file) {
 
 // Global lock for log subsystem, only needed to serialize access to streams_.
 CriticalSection g_log_crit;
+
+// Number of messages each thread can queue in async mode, must be a power of
+// two. When the queue of a thread is full, the thread passes its queued
+// messages and the new one to the streams synchronously.
+constexpr uint32_t kAsyncQueueSize = 256;
+static_assert((kAsyncQueueSize & (kAsyncQueueSize - 1)) == 0,
+              "The async queue size must be a power of two.");
+constexpr int kAsyncDispatchIntervalMs = 10;
+
+std::atomic<bool> g_async_logging(false);
+
+struct AsyncLogRecord {
+  std::string message;
+  LoggingSeverity severity = LS_NONE;
+  const char* tag = nullptr;
+};
+
+// Queue of the messages of one thread in async mode. Messages are added by the
+// thread that owns the queue and removed by the dispatching thread, without
+// locking.
+class AsyncLogQueue {
+ public:
+  AsyncLogQueue() : records_(kAsyncQueueSize) {}
+
+  // Takes the contents of |message|. Returns false if the queue is full.
+  bool Push(std::string* message, LoggingSeverity severity, const char* tag) {
+    const uint32_t write_index = write_index_.load(std::memory_order_relaxed);
+    if (write_index - read_index_.load(std::memory_order_acquire) ==
+        kAsyncQueueSize) {
+      return false;
+    }
+    AsyncLogRecord& record = records_[write_index & (kAsyncQueueSize - 1)];
+    record.message.swap(*message);
+    record.severity = severity;
+    record.tag = tag;
+    write_index_.store(write_index + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const {
+    return write_index_.load(std::memory_order_acquire) -
+           read_index_.load(std::memory_order_acquire);
+  }
+
+  // Calls |consumer| for every queued message and removes them. Must not be
+  // called concurrently.
+  template <typename Consumer>
+  void PopAll(Consumer consumer) {
+    const uint32_t write_index = write_index_.load(std::memory_order_acquire);
+    uint32_t read_index = read_index_.load(std::memory_order_relaxed);
+    for (; read_index != write_index; ++read_index) {
+      AsyncLogRecord& record = records_[read_index & (kAsyncQueueSize - 1)];
+      consumer(record);
+      record.message.clear();
+    }
+    read_index_.store(read_index, std::memory_order_release);
+  }
+
+  // A queue is owned by one thread at a time. It is released when the thread
+  // exits, and can then be taken over by a new thread.
+  bool TryAcquire() {
+    bool in_use = false;
+    return in_use_.compare_exchange_strong(in_use, true,
+                                           std::memory_order_acquire);
+  }
+  void Release() { in_use_.store(false, std::memory_order_release); }
+
+ private:
+  std::vector<AsyncLogRecord> records_;
+  std::atomic<uint32_t> write_index_{0};
+  std::atomic<uint32_t> read_index_{0};
+  std::atomic<bool> in_use_{false};
+};
+
+#if defined(WEBRTC_WIN)
+void WINAPI ReleaseAsyncLogQueue(void* queue) {
+#else
+void ReleaseAsyncLogQueue(void* queue) {
+#endif
+  if (queue)
+    static_cast<AsyncLogQueue*>(queue)->Release();
+}
+
+// State of the async mode. Like |streams_|, it is never destroyed.
+struct AsyncLogState {
+  AsyncLogState() {
+#if defined(WEBRTC_WIN)
+    queue_key = FlsAlloc(&ReleaseAsyncLogQueue);
+#else
+    pthread_key_create(&queue_key, &ReleaseAsyncLogQueue);
+#endif
+  }
+
+  // Returns the queue of the calling thread.
+  AsyncLogQueue* GetThreadQueue() {
+#if defined(WEBRTC_WIN)
+    void* queue = FlsGetValue(queue_key);
+#else
+    void* queue = pthread_getspecific(queue_key);
+#endif
+    if (queue)
+      return static_cast<AsyncLogQueue*>(queue);
+    AsyncLogQueue* new_queue = nullptr;
+    {
+      CritScope cs(&crit);
+      for (const auto& released_queue : queues) {
+        if (released_queue->TryAcquire()) {
+          new_queue = released_queue.get();
+          break;
+        }
+      }
+      if (!new_queue) {
+        queues.push_back(absl::make_unique<AsyncLogQueue>());
+        new_queue = queues.back().get();
+        new_queue->TryAcquire();
+      }
+    }
+#if defined(WEBRTC_WIN)
+    FlsSetValue(queue_key, new_queue);
+#else
+    pthread_setspecific(queue_key, new_queue);
+#endif
+    return new_queue;
+  }
+
+  std::vector<AsyncLogQueue*> GetQueues() {
+    CritScope cs(&crit);
+    std::vector<AsyncLogQueue*> result;
+    for (const auto& queue : queues)
+      result.push_back(queue.get());
+    return result;
+  }
+
+#if defined(WEBRTC_WIN)
+  DWORD queue_key;
+#else
+  pthread_key_t queue_key;
+#endif
+  CriticalSection crit;
+  std::vector<std::unique_ptr<AsyncLogQueue>> queues RTC_GUARDED_BY(crit);
+  // Serializes StartAsyncLogging() and StopAsyncLogging().
+  CriticalSection thread_crit;
+  std::unique_ptr<PlatformThread> thread RTC_GUARDED_BY(thread_crit);
+  // Serializes the readers of the queues.
+  CriticalSection flush_crit;
+  Event wake_event;
+};
+
+AsyncLogState* GetAsyncLogState() {
+  static AsyncLogState* const state = new AsyncLogState();
+  return state;
+}
 }  // namespace
 
 // Inefficient default implementation, override is recommended.
@@ -195,9 +358,9 @@ LogMessage::LogMessage(const char* file,
 LogMessage::~LogMessage() {
   FinishPrintStream();
 
-  const std::string str = print_stream_.Release();
+  std::string str = print_stream_.Release();
 
-  if (severity_ >= g_dbg_sev) {
+  if (severity_ >= g_dbg_sev.load(std::memory_order_relaxed)) {
 #if defined(WEBRTC_ANDROID)
     OutputToDebug(str, severity_, tag_);
 #else
@@ -205,16 +368,39 @@ LogMessage::~LogMessage() {
 #endif
   }
 
-  CritScope cs(&g_log_crit);
-  for (auto& kv : streams_) {
-    if (severity_ >= kv.second) {
 #if defined(WEBRTC_ANDROID)
-      kv.first->OnLogMessage(str, severity_, tag_);
+  const char* tag = tag_;
 #else
-      kv.first->OnLogMessage(str, severity_);
+  const char* tag = nullptr;
 #endif
+  if (g_async_logging.load(std::memory_order_relaxed)) {
+    AsyncLogState* state = GetAsyncLogState();
+    AsyncLogQueue* queue = state->GetThreadQueue();
+    if (queue->Push(&str, severity_, tag)) {
+      // Pairs with the fence in StopAsyncLogging(): either its final flush
+      // sees this message, or this thread sees that async mode has ended and
+      // flushes the message itself.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!g_async_logging.load(std::memory_order_relaxed)) {
+        FlushAsyncLogging();
+      } else if (queue->size() >= kAsyncQueueSize / 2) {
+        state->wake_event.Set();
+      }
+      return;
     }
+    // The queue is full. Pass the older messages of this thread to the
+    // streams first, so that they stay in order.
+    CritScope flush_cs(&state->flush_crit);
+    CritScope cs(&g_log_crit);
+    queue->PopAll([](const AsyncLogRecord& record) {
+      OutputToStreams(record.message, record.severity, record.tag);
+    });
+    OutputToStreams(str, severity_, tag);
+    return;
   }
+
+  CritScope cs(&g_log_crit);
+  OutputToStreams(str, severity_, tag);
 }
 
 void LogMessage::AddTag(const char* tag) {
@@ -228,11 +414,11 @@ rtc::StringBuilder& LogMessage::stream() {
 }
 
 int LogMessage::GetMinLogSeverity() {
-  return g_min_sev;
+  return g_min_sev.load(std::memory_order_relaxed);
 }
 
 LoggingSeverity LogMessage::GetLogToDebug() {
-  return g_dbg_sev;
+  return g_dbg_sev.load(std::memory_order_relaxed);
 }
 int64_t LogMessage::LogStartTime() {
   static const int64_t g_start = SystemTimeMillis();
@@ -253,7 +439,7 @@ void LogMessage::LogTimestamps(bool on) {
 }
 
 void LogMessage::LogToDebug(LoggingSeverity min_sev) {
-  g_dbg_sev = min_sev;
+  g_dbg_sev.store(min_sev, std::memory_order_relaxed);
   CritScope cs(&g_log_crit);
   UpdateMinLogSeverity();
 }
@@ -290,6 +476,46 @@ void LogMessage::RemoveLogToStream(LogSink* stream) {
   UpdateMinLogSeverity();
 }
 
+void LogMessage::StartAsyncLogging() {
+  AsyncLogState* state = GetAsyncLogState();
+  CritScope cs(&state->thread_crit);
+  if (state->thread)
+    return;
+  g_async_logging.store(true, std::memory_order_release);
+  state->thread = absl::make_unique<PlatformThread>(
+      &AsyncLoggingThread, nullptr, "LogDispatchThread", kLowPriority);
+  state->thread->Start();
+}
+
+void LogMessage::StopAsyncLogging() {
+  AsyncLogState* state = GetAsyncLogState();
+  {
+    CritScope cs(&state->thread_crit);
+    if (!state->thread)
+      return;
+    g_async_logging.store(false, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    state->wake_event.Set();
+    state->thread->Stop();
+    state->thread.reset();
+  }
+  FlushAsyncLogging();
+}
+
+void LogMessage::FlushAsyncLogging() {
+  AsyncLogState* state = GetAsyncLogState();
+  CritScope flush_cs(&state->flush_crit);
+  const std::vector<AsyncLogQueue*> queues = state->GetQueues();
+  // The streams get the queued messages in one batch. Messages of different
+  // threads are not ordered with respect to each other.
+  CritScope cs(&g_log_crit);
+  for (AsyncLogQueue* queue : queues) {
+    queue->PopAll([](const AsyncLogRecord& record) {
+      OutputToStreams(record.message, record.severity, record.tag);
+    });
+  }
+}
+
 void LogMessage::ConfigureLogging(const char* params) {
   LoggingSeverity current_level = LS_VERBOSE;
   LoggingSeverity debug_level = GetLogToDebug();
@@ -341,12 +567,35 @@ void LogMessage::ConfigureLogging(const char* params) {
 
 void LogMessage::UpdateMinLogSeverity()
     RTC_EXCLUSIVE_LOCKS_REQUIRED(g_log_crit) {
-  LoggingSeverity min_sev = g_dbg_sev;
+  LoggingSeverity min_sev = g_dbg_sev.load(std::memory_order_relaxed);
   for (const auto& kv : streams_) {
     const LoggingSeverity sev = kv.second;
     min_sev = std::min(min_sev, sev);
   }
-  g_min_sev = min_sev;
+  g_min_sev.store(min_sev, std::memory_order_relaxed);
+}
+
+void LogMessage::OutputToStreams(const std::string& str,
+                                 LoggingSeverity severity,
+                                 const char* tag)
+    RTC_EXCLUSIVE_LOCKS_REQUIRED(g_log_crit) {
+  for (auto& kv : streams_) {
+    if (severity >= kv.second) {
+#if defined(WEBRTC_ANDROID)
+      kv.first->OnLogMessage(str, severity, tag);
+#else
+      kv.first->OnLogMessage(str, severity);
+#endif
+    }
+  }
+}
+
+void LogMessage::AsyncLoggingThread(void* /* param */) {
+  AsyncLogState* state = GetAsyncLogState();
+  while (g_async_logging.load(std::memory_order_acquire)) {
+    state->wake_event.Wait(kAsyncDispatchIntervalMs);
+    FlushAsyncLogging();
+  }
 }
 
 #if defined(WEBRTC_ANDROID)
@@ -443,17 +692,9 @@ void LogMessage::OutputToDebug(const std::string& str,
 
 // static
 bool LogMessage::IsNoop(LoggingSeverity severity) {
-  if (severity >= g_dbg_sev || severity >= g_min_sev)
-    return false;
-
-  // TODO(tommi): We're grabbing this lock for every LogMessage instance that
-  // is going to be logged. This introduces unnecessary synchronization for
-  // a feature that's mostly used for testing.
-  CritScope cs(&g_log_crit);
-  if (streams_.size() > 0)
-    return false;
-
-  return true;
+  // |g_min_sev| is the lowest severity of the debug output and the streams, so
+  // no output takes messages below it.
+  return severity < g_min_sev.load(std::memory_order_relaxed);
 }
 
 void LogMessage::FinishPrintStream() {
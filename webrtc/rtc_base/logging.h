@@ -452,14 +452,23 @@ class LogMessage {
   // logging operations by pre-checking the logging level.
   static int GetMinLogSeverity();
 
+  // In async mode, messages are formatted on the logging thread but passed to
+  // the streams on a separate thread, so that streams doing I/O don't block
+  // the threads that log. Each thread queues its messages without locking.
+  // The debug output is not affected.
+  static void StartAsyncLogging();
+  // Passes the queued messages to the streams and leaves async mode.
+  static void StopAsyncLogging();
+  // Passes the messages queued so far to the streams before returning.
+  static void FlushAsyncLogging();
+
   // Parses the provided parameter stream to configure the options above.
   // Useful for configuring logging from the command line.
   static void ConfigureLogging(const char* params);
 
-  // Checks the current global debug severity and if the |streams_| collection
-  // is empty. If |severity| is smaller than the global severity and if the
-  // |streams_| collection is empty, the LogMessage will be considered a noop
-  // LogMessage.
+  // Checks |severity| against the global debug severity and the severities of
+  // the |streams_| collection. If |severity| is smaller than all of them, the
+  // LogMessage will be considered a noop LogMessage.
   static bool IsNoop(LoggingSeverity severity);
 
  private:
@@ -478,6 +487,13 @@ class LogMessage {
 #else
   static void OutputToDebug(const std::string& msg, LoggingSeverity severity);
 #endif
+  // |tag| is only used on Android.
+  static void OutputToStreams(const std::string& msg,
+                              LoggingSeverity severity,
+                              const char* tag);
+
+  // Passes queued messages to the streams while in async mode.
+  static void AsyncLoggingThread(void* param);
 
   // Called from the dtor (or from a test) to append optional extra error
   // information to the log stream and a newline character.
@@ -10,8 +10,10 @@
 
 #include "rtc_base/logging.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <algorithm>
+#include <string>
 
 #include "rtc_base/arraysize.h"
 #include "rtc_base/checks.h"
@@ -20,6 +22,7 @@
 #include "rtc_base/stream.h"
 #include "rtc_base/time_utils.h"
 #include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
 
 namespace rtc {
 
@@ -368,6 +371,157 @@ TEST(LogTest, Perf) {
                    << " total bytes logged: " << str.size();
 }
 
+class AsyncLogThread {
+ public:
+  AsyncLogThread() : thread_(&ThreadEntry, this, "AsyncLogThread") {}
+  ~AsyncLogThread() { thread_.Stop(); }
+
+  void Start() { thread_.Start(); }
+  void Stop() { thread_.Stop(); }
+
+ private:
+  void Run() {
+    for (int i = 0; i < 100; ++i)
+      RTC_LOG(LS_INFO) << "ASYNC_THREAD";
+  }
+
+  static void ThreadEntry(void* p) { static_cast<AsyncLogThread*>(p)->Run(); }
+
+  PlatformThread thread_;
+};
+
+size_t CountOccurrences(const std::string& str, const std::string& pattern) {
+  size_t count = 0;
+  for (size_t pos = str.find(pattern); pos != std::string::npos;
+       pos = str.find(pattern, pos + pattern.size())) {
+    ++count;
+  }
+  return count;
+}
+
+TEST(LogTest, AsyncLoggingFromMultipleThreads) {
+  std::string str;
+  LogSinkImpl<StringStream> stream(&str);
+  LogMessage::AddLogToStream(&stream, LS_INFO);
+  LogMessage::StartAsyncLogging();
+
+  AsyncLogThread thread1, thread2, thread3;
+  thread1.Start();
+  thread2.Start();
+  thread3.Start();
+  RTC_LOG(LS_INFO) << "ASYNC_MAIN";
+  RTC_LOG(LS_VERBOSE) << "VERBOSE";
+  thread1.Stop();
+  thread2.Stop();
+  thread3.Stop();
+  LogMessage::FlushAsyncLogging();
+
+  EXPECT_EQ(300u, CountOccurrences(str, "ASYNC_THREAD"));
+  EXPECT_EQ(1u, CountOccurrences(str, "ASYNC_MAIN"));
+  EXPECT_EQ(std::string::npos, str.find("VERBOSE"));
+
+  LogMessage::StopAsyncLogging();
+  LogMessage::RemoveLogToStream(&stream);
+}
+
+// Collects the messages, but takes long to handle the first one, so that the
+// queue of the logging thread fills up while the dispatch thread is busy.
+class SlowStartLogSink : public LogSink {
+ public:
+  explicit SlowStartLogSink(std::string* str) : str_(str) {}
+
+  void OnLogMessage(const std::string& message) override {
+    if (str_->empty()) {
+      Event event;
+      event.Wait(100);
+    }
+    *str_ += message;
+  }
+
+ private:
+  std::string* const str_;
+};
+
+// Messages that don't fit in the queue of the thread are passed to the
+// streams directly, after the queued ones, so none are lost or reordered.
+TEST(LogTest, AsyncLoggingWithFullQueue) {
+  const int kNumMessages = 2000;
+  std::string str;
+  SlowStartLogSink stream(&str);
+  LogMessage::AddLogToStream(&stream, LS_INFO);
+  LogMessage::StartAsyncLogging();
+  for (int i = 0; i < kNumMessages; ++i)
+    RTC_LOG(LS_INFO) << "ASYNC_MESSAGE " << i << ";";
+  LogMessage::StopAsyncLogging();
+  LogMessage::RemoveLogToStream(&stream);
+
+  EXPECT_EQ(static_cast<size_t>(kNumMessages),
+            CountOccurrences(str, "ASYNC_MESSAGE"));
+  size_t pos = 0;
+  for (int i = 0; i < kNumMessages; ++i) {
+    const std::string message = "ASYNC_MESSAGE " + std::to_string(i) + ";";
+    pos = str.find(message, pos);
+    ASSERT_NE(std::string::npos, pos) << message << " is missing or reordered";
+  }
+}
+
+// Writes every message to a file and flushes it, like a file sink does.
+class FileLogSink : public LogSink {
+ public:
+  FileLogSink() : file_(tmpfile()) {}
+  ~FileLogSink() override { fclose(file_); }
+
+  void OnLogMessage(const std::string& message) override {
+    fwrite(message.data(), 1, message.size(), file_);
+    fflush(file_);
+  }
+
+ private:
+  FILE* const file_;
+};
+
+// Measures the cost of a log call on the logging thread with no stream taking
+// the message, with a file stream, and with a file stream in async mode. The
+// messages are logged in bursts that fit in the async queue.
+TEST(LogTest, DISABLED_LogCallCost) {
+  static const int kBursts = 200;
+  static const int kMessagesPerBurst = 100;
+  const LoggingSeverity debug_sev = LogMessage::GetLogToDebug();
+  LogMessage::LogToDebug(LS_NONE);
+  const std::string message(80, 'X');
+  auto measure = [&message] {
+    Event event;
+    int64_t elapsed_ns = 0;
+    for (int i = 0; i < kBursts; ++i) {
+      const int64_t start_ns = TimeNanos();
+      for (int j = 0; j < kMessagesPerBurst; ++j)
+        RTC_LOG(LS_INFO) << message << j;
+      elapsed_ns += TimeNanos() - start_ns;
+      event.Wait(20);
+    }
+    return static_cast<double>(elapsed_ns) / (kBursts * kMessagesPerBurst);
+  };
+
+  const double no_sink_ns = measure();
+
+  FileLogSink stream;
+  LogMessage::AddLogToStream(&stream, LS_INFO);
+  const double sync_ns = measure();
+
+  LogMessage::StartAsyncLogging();
+  const double async_ns = measure();
+  LogMessage::StopAsyncLogging();
+
+  LogMessage::RemoveLogToStream(&stream);
+  LogMessage::LogToDebug(debug_sev);
+  webrtc::test::PrintResult("log_call_cost", "", "no_stream", no_sink_ns, "ns",
+                            false);
+  webrtc::test::PrintResult("log_call_cost", "", "file_stream", sync_ns, "ns",
+                            false);
+  webrtc::test::PrintResult("log_call_cost", "", "file_stream_async",
+                            async_ns, "ns", false);
+}
+
 TEST(LogTest, EnumsAreSupported) {
   enum class TestEnum { kValue0 = 0, kValue1 = 1 };
   std::string str;
@@ -0,0 +1,473 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_pooled.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/base/config.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "api/scoped_refptr.h"
+#include "api/task_queue/queued_task.h"
+#include "api/task_queue/task_queue_base.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/ref_count.h"
+#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+namespace {
+
+// Maximum number of tasks a worker runs from one queue before moving on to the
+// next runnable queue, so that a busy queue can't starve the others.
+constexpr int kMaxTasksPerSlice = 32;
+
+class TaskQueuePool;
+
+class PooledTaskQueue : public TaskQueueBase, public rtc::RefCountInterface {
+ public:
+  PooledTaskQueue(TaskQueuePool* pool, bool high_priority);
+
+  void Delete() override;
+  void PostTask(std::unique_ptr<QueuedTask> task) override;
+  void PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                       uint32_t milliseconds) override;
+
+  // Runs up to |kMaxTasksPerSlice| tasks on the calling worker thread. Returns
+  // true if tasks remain, in which case the caller must schedule the queue
+  // again.
+  bool RunSlice();
+
+  bool high_priority() const { return high_priority_; }
+
+ protected:
+  ~PooledTaskQueue() override = default;
+
+ private:
+  TaskQueuePool* const pool_;
+  const bool high_priority_;
+
+  // Signaled when a slice that was running during Delete() has returned.
+  rtc::Event slice_done_;
+
+  rtc::CriticalSection crit_;
+  std::deque<std::unique_ptr<QueuedTask>> tasks_ RTC_GUARDED_BY(crit_);
+  // Set while the queue sits in a worker's run queue or is running, so that
+  // at most one worker processes it at any time.
+  bool scheduled_ RTC_GUARDED_BY(crit_) = false;
+  bool running_ RTC_GUARDED_BY(crit_) = false;
+  bool deleted_ RTC_GUARDED_BY(crit_) = false;
+};
+
+class TaskQueuePool {
+ public:
+  explicit TaskQueuePool(int num_threads);
+  ~TaskQueuePool();
+
+  void OnQueueCreated();
+  void OnQueueDeleted();
+
+  // Makes |queue| runnable. It must not already be scheduled.
+  void Schedule(rtc::scoped_refptr<PooledTaskQueue> queue);
+  void PostDelayedTask(rtc::scoped_refptr<PooledTaskQueue> queue,
+                       std::unique_ptr<QueuedTask> task,
+                       uint32_t milliseconds);
+
+ private:
+  struct Worker {
+    TaskQueuePool* pool = nullptr;
+    rtc::Event wake;
+    std::unique_ptr<rtc::PlatformThread> thread;
+    rtc::CriticalSection crit;
+    // Owner takes from the front, thieves from the back.
+    std::deque<rtc::scoped_refptr<PooledTaskQueue>> run_queue
+        RTC_GUARDED_BY(crit);
+  };
+
+  struct DelayedTask {
+    rtc::scoped_refptr<PooledTaskQueue> queue;
+    std::unique_ptr<QueuedTask> task;
+  };
+  // Fire time in ms and posting order, so that tasks due at the same time
+  // are posted in FIFO order.
+  using DelayedTaskKey = std::pair<int64_t, uint64_t>;
+
+  static void WorkerMain(void* context);
+  static void TimerMain(void* context);
+
+  void RunWorker(Worker* worker);
+  void RunTimer();
+  rtc::scoped_refptr<PooledTaskQueue> FindWork(Worker* worker);
+  void Push(Worker* worker, rtc::scoped_refptr<PooledTaskQueue> queue);
+  void WakeIdleWorker(Worker* preferred);
+  Worker* CurrentWorker();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<uint32_t> next_worker_{0};
+  // Number of workers in |idle_workers_|, readable without taking |crit_|.
+  std::atomic<int> num_idle_{0};
+  std::atomic<int> num_queues_{0};
+
+  rtc::CriticalSection crit_;
+  bool quit_ RTC_GUARDED_BY(crit_) = false;
+  std::vector<Worker*> idle_workers_ RTC_GUARDED_BY(crit_);
+
+  rtc::Event timer_wake_;
+  rtc::PlatformThread timer_thread_;
+  rtc::CriticalSection timer_crit_;
+  bool timer_quit_ RTC_GUARDED_BY(timer_crit_) = false;
+  uint64_t delayed_order_ RTC_GUARDED_BY(timer_crit_) = 0;
+  std::map<DelayedTaskKey, DelayedTask> delayed_tasks_
+      RTC_GUARDED_BY(timer_crit_);
+};
+
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+ABSL_CONST_INIT thread_local void* current_worker = nullptr;
+#endif
+
+PooledTaskQueue::PooledTaskQueue(TaskQueuePool* pool, bool high_priority)
+    : pool_(pool), high_priority_(high_priority) {
+  pool_->OnQueueCreated();
+}
+
+void PooledTaskQueue::Delete() {
+  RTC_DCHECK(!IsCurrent());
+  std::deque<std::unique_ptr<QueuedTask>> pending_tasks;
+  bool running;
+  {
+    rtc::CritScope lock(&crit_);
+    deleted_ = true;
+    pending_tasks.swap(tasks_);
+    running = running_;
+  }
+  if (running)
+    slice_done_.Wait(rtc::Event::kForever);
+  pending_tasks.clear();
+  pool_->OnQueueDeleted();
+  // Drops the reference held on behalf of the owner. Run queues and the timer
+  // may still hold references, which they release without running anything.
+  Release();
+}
+
+void PooledTaskQueue::PostTask(std::unique_ptr<QueuedTask> task) {
+  {
+    rtc::CritScope lock(&crit_);
+    if (deleted_)
+      return;
+    tasks_.push_back(std::move(task));
+    if (scheduled_)
+      return;
+    scheduled_ = true;
+  }
+  pool_->Schedule(this);
+}
+
+void PooledTaskQueue::PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                                      uint32_t milliseconds) {
+  if (milliseconds == 0) {
+    PostTask(std::move(task));
+    return;
+  }
+  pool_->PostDelayedTask(this, std::move(task), milliseconds);
+}
+
+bool PooledTaskQueue::RunSlice() {
+  CurrentTaskQueueSetter set_current(this);
+  for (int i = 0; i < kMaxTasksPerSlice; ++i) {
+    std::unique_ptr<QueuedTask> task;
+    {
+      rtc::CritScope lock(&crit_);
+      if (deleted_ || tasks_.empty()) {
+        scheduled_ = false;
+        if (running_ && deleted_)
+          slice_done_.Set();
+        running_ = false;
+        return false;
+      }
+      running_ = true;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    QueuedTask* release_ptr = task.release();
+    if (release_ptr->Run())
+      delete release_ptr;
+  }
+
+  rtc::CritScope lock(&crit_);
+  running_ = false;
+  if (deleted_) {
+    scheduled_ = false;
+    slice_done_.Set();
+    return false;
+  }
+  if (tasks_.empty()) {
+    scheduled_ = false;
+    return false;
+  }
+  return true;
+}
+
+TaskQueuePool::TaskQueuePool(int num_threads)
+    : timer_thread_(&TaskQueuePool::TimerMain, this, "TaskQueuePoolTimer") {
+  RTC_DCHECK_GT(num_threads, 0);
+  for (int i = 0; i < num_threads; ++i) {
+    auto worker = absl::make_unique<Worker>();
+    worker->pool = this;
+    worker->thread = absl::make_unique<rtc::PlatformThread>(
+        &TaskQueuePool::WorkerMain, worker.get(),
+        "TaskQueuePool" + std::to_string(i));
+    workers_.push_back(std::move(worker));
+  }
+  for (auto& worker : workers_)
+    worker->thread->Start();
+  timer_thread_.Start();
+}
+
+TaskQueuePool::~TaskQueuePool() {
+  RTC_DCHECK_EQ(num_queues_.load(), 0)
+      << "All task queues must be deleted before their factory.";
+  {
+    rtc::CritScope lock(&timer_crit_);
+    timer_quit_ = true;
+  }
+  timer_wake_.Set();
+  timer_thread_.Stop();
+  {
+    rtc::CritScope lock(&crit_);
+    quit_ = true;
+  }
+  for (auto& worker : workers_)
+    worker->wake.Set();
+  for (auto& worker : workers_)
+    worker->thread->Stop();
+  // Whatever is left only belongs to deleted queues; releasing it here frees
+  // them.
+  for (auto& worker : workers_) {
+    rtc::CritScope lock(&worker->crit);
+    worker->run_queue.clear();
+  }
+  rtc::CritScope lock(&timer_crit_);
+  delayed_tasks_.clear();
+}
+
+void TaskQueuePool::OnQueueCreated() {
+  ++num_queues_;
+}
+
+void TaskQueuePool::OnQueueDeleted() {
+  --num_queues_;
+}
+
+void TaskQueuePool::Schedule(rtc::scoped_refptr<PooledTaskQueue> queue) {
+  // Queues posted to from a worker stay on that worker to keep producer and
+  // consumer on the same core; anything else is spread round-robin.
+  Worker* worker = CurrentWorker();
+  if (!worker)
+    worker = workers_[next_worker_++ % workers_.size()].get();
+  Push(worker, std::move(queue));
+  WakeIdleWorker(worker);
+}
+
+void TaskQueuePool::PostDelayedTask(rtc::scoped_refptr<PooledTaskQueue> queue,
+                                    std::unique_ptr<QueuedTask> task,
+                                    uint32_t milliseconds) {
+  const int64_t fire_at_ms = rtc::TimeMillis() + milliseconds;
+  bool is_earliest;
+  {
+    rtc::CritScope lock(&timer_crit_);
+    DelayedTaskKey key(fire_at_ms, delayed_order_++);
+    DelayedTask& delayed = delayed_tasks_[key];
+    delayed.queue = std::move(queue);
+    delayed.task = std::move(task);
+    is_earliest = delayed_tasks_.begin()->first == key;
+  }
+  // The timer only needs to recompute its wait time if the new task fires
+  // before everything it already knows about.
+  if (is_earliest)
+    timer_wake_.Set();
+}
+
+// static
+void TaskQueuePool::WorkerMain(void* context) {
+  Worker* worker = static_cast<Worker*>(context);
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  current_worker = worker;
+#endif
+  worker->pool->RunWorker(worker);
+}
+
+// static
+void TaskQueuePool::TimerMain(void* context) {
+  static_cast<TaskQueuePool*>(context)->RunTimer();
+}
+
+void TaskQueuePool::RunWorker(Worker* worker) {
+  while (true) {
+    rtc::scoped_refptr<PooledTaskQueue> queue = FindWork(worker);
+    if (!queue) {
+      {
+        rtc::CritScope lock(&crit_);
+        if (quit_)
+          return;
+        idle_workers_.push_back(worker);
+        ++num_idle_;
+      }
+      // Check again after registering as idle, since work scheduled before
+      // the registration didn't see this worker as idle.
+      queue = FindWork(worker);
+      if (!queue) {
+        worker->wake.Wait(rtc::Event::kForever);
+        continue;
+      }
+      rtc::CritScope lock(&crit_);
+      auto it =
+          std::find(idle_workers_.begin(), idle_workers_.end(), worker);
+      if (it != idle_workers_.end()) {
+        idle_workers_.erase(it);
+        --num_idle_;
+      }
+    }
+    if (queue->RunSlice()) {
+      Push(worker, std::move(queue));
+      WakeIdleWorker(nullptr);
+    }
+  }
+}
+
+void TaskQueuePool::RunTimer() {
+  while (true) {
+    std::vector<DelayedTask> due_tasks;
+    int wait_ms = rtc::Event::kForever;
+    {
+      rtc::CritScope lock(&timer_crit_);
+      if (timer_quit_)
+        return;
+      const int64_t now_ms = rtc::TimeMillis();
+      auto it = delayed_tasks_.begin();
+      while (it != delayed_tasks_.end() && it->first.first <= now_ms) {
+        due_tasks.push_back(std::move(it->second));
+        it = delayed_tasks_.erase(it);
+      }
+      if (it != delayed_tasks_.end())
+        wait_ms = static_cast<int>(it->first.first - now_ms);
+    }
+    for (DelayedTask& due : due_tasks)
+      due.queue->PostTask(std::move(due.task));
+    due_tasks.clear();
+    timer_wake_.Wait(wait_ms);
+  }
+}
+
+rtc::scoped_refptr<PooledTaskQueue> TaskQueuePool::FindWork(Worker* worker) {
+  rtc::scoped_refptr<PooledTaskQueue> queue;
+  {
+    rtc::CritScope lock(&worker->crit);
+    if (!worker->run_queue.empty()) {
+      queue = std::move(worker->run_queue.front());
+      worker->run_queue.pop_front();
+      return queue;
+    }
+  }
+  // Steal from the other workers, starting with the next one so that thieves
+  // don't all pile onto the first worker.
+  const size_t self =
+      std::find_if(workers_.begin(), workers_.end(),
+                   [worker](const std::unique_ptr<Worker>& w) {
+                     return w.get() == worker;
+                   }) -
+      workers_.begin();
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    Worker* victim = workers_[(self + i) % workers_.size()].get();
+    rtc::CritScope lock(&victim->crit);
+    if (!victim->run_queue.empty()) {
+      queue = std::move(victim->run_queue.back());
+      victim->run_queue.pop_back();
+      return queue;
+    }
+  }
+  return queue;
+}
+
+void TaskQueuePool::Push(Worker* worker,
+                         rtc::scoped_refptr<PooledTaskQueue> queue) {
+  rtc::CritScope lock(&worker->crit);
+  if (queue->high_priority()) {
+    worker->run_queue.push_front(std::move(queue));
+  } else {
+    worker->run_queue.push_back(std::move(queue));
+  }
+}
+
+void TaskQueuePool::WakeIdleWorker(Worker* preferred) {
+  if (num_idle_.load() == 0)
+    return;
+  Worker* idle_worker = nullptr;
+  {
+    rtc::CritScope lock(&crit_);
+    if (idle_workers_.empty())
+      return;
+    auto it =
+        std::find(idle_workers_.begin(), idle_workers_.end(), preferred);
+    if (it == idle_workers_.end())
+      it = idle_workers_.end() - 1;
+    idle_worker = *it;
+    idle_workers_.erase(it);
+    --num_idle_;
+  }
+  idle_worker->wake.Set();
+}
+
+TaskQueuePool::Worker* TaskQueuePool::CurrentWorker() {
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  Worker* worker = static_cast<Worker*>(current_worker);
+  if (worker && worker->pool == this)
+    return worker;
+#endif
+  return nullptr;
+}
+
+class TaskQueuePooledFactory final : public TaskQueueFactory {
+ public:
+  explicit TaskQueuePooledFactory(int num_threads) : pool_(num_threads) {}
+
+  std::unique_ptr<TaskQueueBase, TaskQueueDeleter> CreateTaskQueue(
+      absl::string_view name,
+      Priority priority) const override {
+    PooledTaskQueue* queue = new rtc::RefCountedObject<PooledTaskQueue>(
+        &pool_, priority == Priority::HIGH);
+    // Owned by the returned pointer until Delete().
+    queue->AddRef();
+    return std::unique_ptr<TaskQueueBase, TaskQueueDeleter>(queue);
+  }
+
+ private:
+  mutable TaskQueuePool pool_;
+};
+
+}  // namespace
+
+std::unique_ptr<TaskQueueFactory> CreateTaskQueuePooledFactory(
+    int num_threads) {
+  return absl::make_unique<TaskQueuePooledFactory>(num_threads);
+}
+
+}  // namespace webrtc
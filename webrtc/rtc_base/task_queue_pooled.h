@@ -0,0 +1,33 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_TASK_QUEUE_POOLED_H_
+#define RTC_BASE_TASK_QUEUE_POOLED_H_
+
+#include <memory>
+
+#include "api/task_queue/task_queue_factory.h"
+
+namespace webrtc {
+
+// Creates a factory whose task queues share a pool of |num_threads| worker
+// threads instead of owning a thread each. Every queue still runs its tasks
+// one at a time in FIFO order, and IsCurrent() is true while one of its tasks
+// runs, but consecutive tasks may run on different threads. Idle workers steal
+// runnable queues from busy ones, and all delayed tasks share one timer thread.
+// Typically |num_threads| is the number of cores.
+//
+// Unlike the other factories this one owns threads, so every task queue it
+// created must be deleted before the factory is destroyed.
+std::unique_ptr<TaskQueueFactory> CreateTaskQueuePooledFactory(int num_threads);
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_TASK_QUEUE_POOLED_H_
@@ -0,0 +1,97 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#if defined(WEBRTC_POSIX)
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "api/task_queue/default_task_queue_factory.h"
+#include "rtc_base/event.h"
+#include "rtc_base/task_queue_pooled.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumQueues = 1000;
+constexpr int kNumRounds = 50;
+
+int64_t ContextSwitches() {
+#if defined(WEBRTC_POSIX)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+#endif
+  return 0;
+}
+
+// Posts one task to each of |kNumQueues| queues per round, the way a timer
+// tick fans out to every call in a busy process, and reports the p99 delay
+// from posting to running and the context switches the process made.
+void MeasureFanOut(const std::string& trace, TaskQueueFactory* factory) {
+  std::vector<std::unique_ptr<TaskQueueBase, TaskQueueDeleter>> queues;
+  for (int i = 0; i < kNumQueues; ++i) {
+    queues.push_back(
+        factory->CreateTaskQueue("Queue", TaskQueueFactory::Priority::NORMAL));
+  }
+
+  std::vector<int64_t> latencies_us(kNumQueues * kNumRounds);
+  const int64_t start_switches = ContextSwitches();
+  for (int round = 0; round < kNumRounds; ++round) {
+    std::atomic<int> remaining(kNumQueues);
+    rtc::Event done;
+    for (int i = 0; i < kNumQueues; ++i) {
+      int64_t* latency_us = &latencies_us[round * kNumQueues + i];
+      const int64_t posted_us = rtc::TimeMicros();
+      queues[i]->PostTask(ToQueuedTask([&, latency_us, posted_us] {
+        *latency_us = rtc::TimeMicros() - posted_us;
+        if (--remaining == 0)
+          done.Set();
+      }));
+    }
+    ASSERT_TRUE(done.Wait(10000));
+  }
+  const int64_t switches = ContextSwitches() - start_switches;
+  queues.clear();
+
+  auto p99 = latencies_us.begin() + latencies_us.size() * 99 / 100;
+  std::nth_element(latencies_us.begin(), p99, latencies_us.end());
+  test::PrintResult("task_queue_1000_queues", "_p99_latency", trace, *p99,
+                    "us", true);
+  test::PrintResult("task_queue_1000_queues", "_context_switches", trace,
+                    switches, "count", true);
+}
+
+}  // namespace
+
+TEST(TaskQueuePooledPerformanceTest, DefaultFactory) {
+  std::unique_ptr<TaskQueueFactory> factory = CreateDefaultTaskQueueFactory();
+  MeasureFanOut("default", factory.get());
+}
+
+TEST(TaskQueuePooledPerformanceTest, PooledFactory) {
+  const int num_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  std::unique_ptr<TaskQueueFactory> factory =
+      CreateTaskQueuePooledFactory(num_threads);
+  MeasureFanOut("pooled", factory.get());
+}
+
+}  // namespace webrtc
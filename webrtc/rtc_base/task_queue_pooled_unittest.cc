@@ -0,0 +1,89 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_pooled.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/task_queue_test.h"
+#include "rtc_base/event.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+std::unique_ptr<TaskQueueFactory> CreateSingleThreadPoolFactory() {
+  return CreateTaskQueuePooledFactory(1);
+}
+
+std::unique_ptr<TaskQueueFactory> CreateMultiThreadPoolFactory() {
+  return CreateTaskQueuePooledFactory(4);
+}
+
+INSTANTIATE_TEST_SUITE_P(PooledSingleThread,
+                         TaskQueueTest,
+                         ::testing::Values(CreateSingleThreadPoolFactory));
+INSTANTIATE_TEST_SUITE_P(PooledMultiThread,
+                         TaskQueueTest,
+                         ::testing::Values(CreateMultiThreadPoolFactory));
+
+TEST(TaskQueuePooledTest, KeepsPerQueueOrderAcrossManyQueues) {
+  constexpr int kNumQueues = 100;
+  constexpr int kTasksPerQueue = 100;
+  std::unique_ptr<TaskQueueFactory> factory = CreateTaskQueuePooledFactory(4);
+  std::vector<std::unique_ptr<TaskQueueBase, TaskQueueDeleter>> queues;
+  for (int i = 0; i < kNumQueues; ++i) {
+    queues.push_back(factory->CreateTaskQueue(
+        "Queue", TaskQueueFactory::Priority::NORMAL));
+  }
+
+  std::vector<int> last_task(kNumQueues, -1);
+  std::atomic<int> remaining(kNumQueues * kTasksPerQueue);
+  rtc::Event done;
+  for (int task = 0; task < kTasksPerQueue; ++task) {
+    for (int i = 0; i < kNumQueues; ++i) {
+      TaskQueueBase* queue = queues[i].get();
+      queue->PostTask(ToQueuedTask([&, queue, i, task] {
+        EXPECT_TRUE(queue->IsCurrent());
+        EXPECT_EQ(last_task[i] + 1, task);
+        last_task[i] = task;
+        if (--remaining == 0)
+          done.Set();
+      }));
+    }
+  }
+  EXPECT_TRUE(done.Wait(10000));
+}
+
+TEST(TaskQueuePooledTest, DeleteWaitsForRunningTask) {
+  std::unique_ptr<TaskQueueFactory> factory = CreateTaskQueuePooledFactory(2);
+  auto queue =
+      factory->CreateTaskQueue("Queue", TaskQueueFactory::Priority::NORMAL);
+  rtc::Event started;
+  rtc::Event release;
+  bool finished = false;
+  queue->PostTask(ToQueuedTask([&] {
+    started.Set();
+    release.Wait(rtc::Event::kForever);
+    finished = true;
+  }));
+  ASSERT_TRUE(started.Wait(1000));
+  auto other_queue =
+      factory->CreateTaskQueue("Other", TaskQueueFactory::Priority::NORMAL);
+  other_queue->PostDelayedTask(ToQueuedTask([&] { release.Set(); }), 10);
+  queue = nullptr;
+  EXPECT_TRUE(finished);
+}
+
+}  // namespace
+}  // namespace webrtc
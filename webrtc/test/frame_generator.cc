@@ -13,6 +13,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <memory>
+#include <utility>
 
 #include "absl/memory/memory.h"
 #include "api/scoped_refptr.h"
@@ -28,6 +29,7 @@
 #include "rtc_base/random.h"
 #include "system_wrappers/include/clock.h"
 #include "test/frame_utils.h"
+#include "test/testsupport/mapped_frame_reader.h"
 
 namespace webrtc {
 namespace test {
@@ -265,6 +267,58 @@ class YuvFileGenerator : public FrameGenerator {
   std::unique_ptr<VideoFrame> temp_frame_;
 };
 
+// MappedFileGenerator works like YuvFileGenerator for a single file, but hands
+// out views into a memory-mapped file instead of copying every frame.
+class MappedFileGenerator : public FrameGenerator {
+ public:
+  MappedFileGenerator(std::unique_ptr<MappedFrameReader> reader,
+                      size_t width,
+                      size_t height,
+                      int frame_repeat_count)
+      : reader_(std::move(reader)),
+        width_(width),
+        height_(height),
+        frame_display_count_(frame_repeat_count),
+        current_display_count_(0) {
+    RTC_DCHECK_GT(frame_repeat_count, 0);
+  }
+
+  VideoFrame* NextFrame() override {
+    // Empty update by default.
+    VideoFrame::UpdateRect update_rect{0, 0, 0, 0};
+    if (current_display_count_ == 0) {
+      // A file with a single frame never changes after the first read.
+      if (!last_read_buffer_ || reader_->NumberOfFrames() > 1) {
+        last_read_buffer_ = reader_->ReadFrame();
+        RTC_CHECK(last_read_buffer_);
+        // Full update on a new frame from file.
+        update_rect = VideoFrame::UpdateRect{0, 0, static_cast<int>(width_),
+                                             static_cast<int>(height_)};
+      }
+    }
+    if (++current_display_count_ >= frame_display_count_)
+      current_display_count_ = 0;
+
+    temp_frame_ = absl::make_unique<VideoFrame>(
+        VideoFrame::Builder()
+            .set_video_frame_buffer(last_read_buffer_)
+            .set_rotation(webrtc::kVideoRotation_0)
+            .set_timestamp_us(0)
+            .set_update_rect(update_rect)
+            .build());
+    return temp_frame_.get();
+  }
+
+ private:
+  const std::unique_ptr<MappedFrameReader> reader_;
+  const size_t width_;
+  const size_t height_;
+  const int frame_display_count_;
+  int current_display_count_;
+  rtc::scoped_refptr<I420BufferInterface> last_read_buffer_;
+  std::unique_ptr<VideoFrame> temp_frame_;
+};
+
 // SlideGenerator works similarly to YuvFileGenerator but it fills the frames
 // with randomly sized and colored squares instead of reading their content
 // from files.
@@ -547,6 +601,21 @@ std::unique_ptr<FrameGenerator> FrameGenerator::CreateFromYuvFile(
       new YuvFileGenerator(files, width, height, frame_repeat_count));
 }
 
+std::unique_ptr<FrameGenerator> FrameGenerator::CreateFromMappedFile(
+    std::string filename,
+    size_t width,
+    size_t height,
+    int frame_repeat_count) {
+  auto reader = absl::make_unique<MappedFrameReader>(
+      filename, static_cast<int>(width), static_cast<int>(height),
+      /*loop=*/true);
+  RTC_CHECK(reader->Init()) << "Failed to map: '" << filename << "'";
+  RTC_CHECK_GT(reader->NumberOfFrames(), 0) << "No frames in: '" << filename
+                                            << "'";
+  return absl::make_unique<MappedFileGenerator>(std::move(reader), width,
+                                                height, frame_repeat_count);
+}
+
 std::unique_ptr<FrameGenerator>
 FrameGenerator::CreateScrollingInputFromYuvFiles(
     Clock* clock,
@@ -79,6 +79,16 @@ class FrameGenerator {
       size_t height,
       int frame_repeat_count);
 
+  // Creates a frame generator that repeatedly plays a memory-mapped yuv or
+  // y4m file. Frames are zero-copy views into the mapping and are read ahead,
+  // so this can feed capture-free pipelines at line rate. The
+  // frame_repeat_count works as for CreateFromYuvFile().
+  static std::unique_ptr<FrameGenerator> CreateFromMappedFile(
+      std::string filename,
+      size_t width,
+      size_t height,
+      int frame_repeat_count);
+
   // Creates a frame generator which takes a set of yuv files (wrapping a
   // frame generator created by CreateFromYuvFile() above), but outputs frames
   // that have been cropped to specified resolution: source_width/source_height
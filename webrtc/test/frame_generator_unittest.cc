@@ -128,6 +128,30 @@ TEST_F(FrameGeneratorTest, TwoFrameFile) {
   CheckFrameAndMutate(generator->NextFrame(), 0, 0, 0);
 }
 
+TEST_F(FrameGeneratorTest, MappedTwoFrameFile) {
+  std::unique_ptr<FrameGenerator> generator(
+      FrameGenerator::CreateFromMappedFile(two_frame_filename_, kFrameWidth,
+                                           kFrameHeight, 1));
+  CheckFrameAndMutate(generator->NextFrame(), 0, 0, 0);
+  CheckFrameAndMutate(generator->NextFrame(), 127, 127, 127);
+  CheckFrameAndMutate(generator->NextFrame(), 0, 0, 0);
+}
+
+TEST_F(FrameGeneratorTest, MappedSingleFrameFileWithRepeat) {
+  std::unique_ptr<FrameGenerator> generator(
+      FrameGenerator::CreateFromMappedFile(one_frame_filename_, kFrameWidth,
+                                           kFrameHeight, 2));
+  VideoFrame* frame = generator->NextFrame();
+  EXPECT_FALSE(frame->update_rect().IsEmpty());
+  CheckFrameAndMutate(frame, 255, 255, 255);
+  frame = generator->NextFrame();
+  EXPECT_TRUE(frame->update_rect().IsEmpty());
+  CheckFrameAndMutate(frame, 255, 255, 255);
+  frame = generator->NextFrame();
+  EXPECT_TRUE(frame->update_rect().IsEmpty());
+  CheckFrameAndMutate(frame, 255, 255, 255);
+}
+
 TEST_F(FrameGeneratorTest, MultipleFrameFiles) {
   std::vector<std::string> files;
   files.push_back(two_frame_filename_);
@@ -15,8 +15,11 @@
 
 #include "absl/memory/memory.h"
 #include "api/units/time_delta.h"
-#include "common_video/libyuv/include/webrtc_libyuv.h"
+#include "api/video/i420_buffer.h"
+#include "rtc_base/cpu_time.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/time_utils.h"
+#include "test/pc/e2e/analyzer/video/frame_quality_metrics.h"
 #include "test/testsupport/perf_test.h"
 
 namespace webrtc {
@@ -43,6 +46,33 @@ void LogStreamInternalStats(const std::string& name, const StreamStats& stats) {
                 << stats.dropped_before_encoder;
 }
 
+// Native buffers are counted as if they were I420.
+int64_t FrameSizeBytes(const absl::optional<VideoFrame>& frame) {
+  if (!frame)
+    return 0;
+  const int64_t pixels = static_cast<int64_t>(frame->width()) * frame->height();
+  return pixels + 2 * ((frame->width() + 1) / 2) * ((frame->height() + 1) / 2);
+}
+
+// Scales the buffer with more pixels down to the resolution of the other one,
+// so that the metrics are computed on planes of the same size.
+void MatchResolution(rtc::scoped_refptr<I420BufferInterface>* reference,
+                     rtc::scoped_refptr<I420BufferInterface>* test) {
+  if ((*reference)->width() == (*test)->width() &&
+      (*reference)->height() == (*test)->height()) {
+    return;
+  }
+  const bool scale_reference = (*reference)->width() * (*reference)->height() >
+                               (*test)->width() * (*test)->height();
+  rtc::scoped_refptr<I420BufferInterface>* larger =
+      scale_reference ? reference : test;
+  const I420BufferInterface& smaller = scale_reference ? **test : **reference;
+  rtc::scoped_refptr<I420Buffer> scaled =
+      I420Buffer::Create(smaller.width(), smaller.height());
+  scaled->ScaleFrom(**larger);
+  *larger = scaled;
+}
+
 }  // namespace
 
 void RateCounter::AddEvent(Timestamp event_time) {
@@ -63,7 +93,12 @@ double RateCounter::GetEventsPerSecond() const {
 }
 
 DefaultVideoQualityAnalyzer::DefaultVideoQualityAnalyzer()
-    : clock_(Clock::GetRealTimeClock()) {}
+    : DefaultVideoQualityAnalyzer(DefaultVideoQualityAnalyzerOptions()) {}
+DefaultVideoQualityAnalyzer::DefaultVideoQualityAnalyzer(
+    DefaultVideoQualityAnalyzerOptions options)
+    : options_(options), clock_(Clock::GetRealTimeClock()) {
+  RTC_CHECK_GE(options_.reference_frame_downscale_factor, 1);
+}
 DefaultVideoQualityAnalyzer::~DefaultVideoQualityAnalyzer() {
   Stop();
 }
@@ -90,9 +125,23 @@ uint16_t DefaultVideoQualityAnalyzer::OnFrameCaptured(
     const webrtc::VideoFrame& frame) {
   // |next_frame_id| is atomic, so we needn't lock here.
   uint16_t frame_id = next_frame_id_++;
+  // Downscaling is done before taking the locks, so that it doesn't block the
+  // other streams.
+  VideoFrame reference_frame = frame;
+  absl::optional<int64_t> store_cpu_time_us;
+  if (options_.reference_frame_downscale_factor > 1) {
+    const int64_t start_cpu_time_ns = rtc::GetThreadCpuTimeNanos();
+    reference_frame = CreateDownscaledReferenceFrame(stream_label, frame);
+    store_cpu_time_us = (rtc::GetThreadCpuTimeNanos() - start_cpu_time_ns) /
+                        rtc::kNumNanosecsPerMicrosec;
+  }
   {
     // Ensure stats for this stream exists.
     rtc::CritScope crit(&comparison_lock_);
+    if (store_cpu_time_us) {
+      analyzer_stats_.reference_frame_store_cpu_time_us.AddSample(
+          *store_cpu_time_us);
+    }
     if (stream_stats_.find(stream_label) == stream_stats_.end()) {
       stream_stats_.insert({stream_label, StreamStats()});
       // Assume that the first freeze was before first stream frame captured.
@@ -121,13 +170,15 @@ uint16_t DefaultVideoQualityAnalyzer::OnFrameCaptured(
       state->frame_ids.pop_front();
       frame_counters_.dropped++;
       stream_frame_counters_[stream_label].dropped++;
+      captured_frames_in_flight_bytes_ -= FrameSizeBytes(it->second);
       AddComparison(it->second, absl::nullopt, true, stats_it->second);
 
       captured_frames_in_flight_.erase(it);
       frame_stats_.erase(stats_it);
     }
+    captured_frames_in_flight_bytes_ += FrameSizeBytes(reference_frame);
     captured_frames_in_flight_.insert(
-        std::pair<uint16_t, VideoFrame>(frame_id, frame));
+        std::pair<uint16_t, VideoFrame>(frame_id, std::move(reference_frame)));
     // Set frame id on local copy of the frame
     captured_frames_in_flight_.at(frame_id).set_id(frame_id);
     frame_stats_.insert(std::pair<uint16_t, FrameStats>(
@@ -236,6 +287,8 @@ void DefaultVideoQualityAnalyzer::OnFrameRendered(
     auto dropped_frame_it = captured_frames_in_flight_.find(dropped_frame_id);
     RTC_CHECK(dropped_frame_it != captured_frames_in_flight_.end());
 
+    captured_frames_in_flight_bytes_ -=
+        FrameSizeBytes(dropped_frame_it->second);
     AddComparison(dropped_frame_it->second, absl::nullopt, true,
                   dropped_frame_stats_it->second);
 
@@ -255,6 +308,7 @@ void DefaultVideoQualityAnalyzer::OnFrameRendered(
     stream_stats_[stream_label].skipped_between_rendered.AddSample(
         dropped_count);
   }
+  captured_frames_in_flight_bytes_ -= FrameSizeBytes(captured_frame);
   AddComparison(captured_frame, frame, false, *frame_stats);
 
   captured_frames_in_flight_.erase(frame_it);
@@ -352,6 +406,30 @@ AnalyzerStats DefaultVideoQualityAnalyzer::GetAnalyzerStats() const {
   return analyzer_stats_;
 }
 
+VideoFrame DefaultVideoQualityAnalyzer::CreateDownscaledReferenceFrame(
+    const std::string& stream_label,
+    const VideoFrame& frame) {
+  rtc::scoped_refptr<I420BufferInterface> source =
+      frame.video_frame_buffer()->ToI420();
+  const int width =
+      std::max(1, source->width() / options_.reference_frame_downscale_factor);
+  const int height =
+      std::max(1, source->height() / options_.reference_frame_downscale_factor);
+  rtc::scoped_refptr<I420Buffer> buffer;
+  {
+    rtc::CritScope crit(&reference_pools_lock_);
+    buffer = reference_pools_[stream_label].CreateBuffer(width, height);
+  }
+  RTC_CHECK(buffer);
+  buffer->ScaleFrom(*source);
+  return VideoFrame::Builder()
+      .set_video_frame_buffer(buffer)
+      .set_timestamp_rtp(frame.timestamp())
+      .set_timestamp_us(frame.timestamp_us())
+      .set_rotation(frame.rotation())
+      .build();
+}
+
 void DefaultVideoQualityAnalyzer::AddComparison(
     absl::optional<VideoFrame> captured,
     absl::optional<VideoFrame> rendered,
@@ -359,14 +437,23 @@ void DefaultVideoQualityAnalyzer::AddComparison(
     FrameStats frame_stats) {
   rtc::CritScope crit(&comparison_lock_);
   analyzer_stats_.comparisons_queue_size.AddSample(comparisons_.size());
+  const bool queue_full =
+      options_.max_comparisons_queue_size > 0 &&
+      comparisons_.size() >= options_.max_comparisons_queue_size;
+  if (queue_full) {
+    analyzer_stats_.comparisons_dropped++;
+  }
   // If there too many computations waiting in the queue, we won't provide
   // frames itself to make future computations lighter.
-  if (comparisons_.size() >= kMaxActiveComparisons) {
+  if (queue_full || comparisons_.size() >= kMaxActiveComparisons) {
     comparisons_.emplace_back(dropped, frame_stats);
   } else {
+    comparisons_bytes_ += FrameSizeBytes(captured) + FrameSizeBytes(rendered);
     comparisons_.emplace_back(std::move(captured), std::move(rendered), dropped,
                               frame_stats);
   }
+  analyzer_stats_.memory_usage_bytes.AddSample(
+      captured_frames_in_flight_bytes_ + comparisons_bytes_);
   comparison_available_event_.Set();
 }
 
@@ -383,6 +470,8 @@ void DefaultVideoQualityAnalyzer::ProcessComparisons() {
       if (!comparisons_.empty()) {
         comparison = comparisons_.front();
         comparisons_.pop_front();
+        comparisons_bytes_ -= FrameSizeBytes(comparison->captured) +
+                              FrameSizeBytes(comparison->rendered);
         if (!comparisons_.empty()) {
           comparison_available_event_.Set();
         }
@@ -413,9 +502,18 @@ void DefaultVideoQualityAnalyzer::ProcessComparison(
   // Perform expensive psnr and ssim calculations while not holding lock.
   double psnr = -1.0;
   double ssim = -1.0;
+  absl::optional<int64_t> cpu_time_us;
   if (comparison.captured && !comparison.dropped) {
-    psnr = I420PSNR(&*comparison.captured, &*comparison.rendered);
-    ssim = I420SSIM(&*comparison.captured, &*comparison.rendered);
+    const int64_t start_cpu_time_ns = rtc::GetThreadCpuTimeNanos();
+    rtc::scoped_refptr<I420BufferInterface> reference =
+        comparison.captured->video_frame_buffer()->ToI420();
+    rtc::scoped_refptr<I420BufferInterface> test =
+        comparison.rendered->video_frame_buffer()->ToI420();
+    MatchResolution(&reference, &test);
+    psnr = ComputeI420Psnr(*reference, *test);
+    ssim = ComputeI420Ssim(*reference, *test);
+    cpu_time_us = (rtc::GetThreadCpuTimeNanos() - start_cpu_time_ns) /
+                  rtc::kNumNanosecsPerMicrosec;
   }
 
   const FrameStats& frame_stats = comparison.frame_stats;
@@ -428,6 +526,9 @@ void DefaultVideoQualityAnalyzer::ProcessComparison(
   if (!comparison.captured) {
     analyzer_stats_.overloaded_comparisons_done++;
   }
+  if (cpu_time_us) {
+    analyzer_stats_.comparison_cpu_time_us.AddSample(*cpu_time_us);
+  }
   if (psnr > 0) {
     stats->psnr.AddSample(psnr);
   }
@@ -500,6 +601,25 @@ void DefaultVideoQualityAnalyzer::ReportResults() {
   RTC_LOG(INFO) << "comparisons_done=" << analyzer_stats_.comparisons_done;
   RTC_LOG(INFO) << "overloaded_comparisons_done="
                 << analyzer_stats_.overloaded_comparisons_done;
+  RTC_LOG(INFO) << "comparisons_dropped="
+                << analyzer_stats_.comparisons_dropped;
+  RTC_LOG(INFO) << "memory_usage_bytes max="
+                << (analyzer_stats_.memory_usage_bytes.IsEmpty()
+                        ? 0
+                        : analyzer_stats_.memory_usage_bytes.GetMax());
+
+  // Overhead of the analyzer itself.
+  ReportResult("analyzer_memory_usage", test_label_,
+               analyzer_stats_.memory_usage_bytes, "bytes");
+  ReportResult("analyzer_comparison_cpu_time", test_label_,
+               analyzer_stats_.comparison_cpu_time_us, "us");
+  if (options_.reference_frame_downscale_factor > 1) {
+    ReportResult("analyzer_reference_frame_store_cpu_time", test_label_,
+                 analyzer_stats_.reference_frame_store_cpu_time_us, "us");
+  }
+  test::PrintResult("analyzer_comparisons_dropped", "", test_label_,
+                    analyzer_stats_.comparisons_dropped, "unitless",
+                    /*important=*/false);
 }
 
 void DefaultVideoQualityAnalyzer::ReportResults(std::string test_case_name,
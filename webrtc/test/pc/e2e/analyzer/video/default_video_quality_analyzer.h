@@ -23,6 +23,7 @@
 #include "api/units/timestamp.h"
 #include "api/video/encoded_image.h"
 #include "api/video/video_frame.h"
+#include "common_video/include/i420_buffer_pool.h"
 #include "rtc_base/critical_section.h"
 #include "rtc_base/event.h"
 #include "rtc_base/numerics/samples_stats_counter.h"
@@ -112,11 +113,40 @@ struct AnalyzerStats {
   // comparison doesn't include metrics, that require heavy computations like
   // SSIM and PSNR.
   int64_t overloaded_comparisons_done = 0;
+  // Amount of comparisons that were queued without frames, because the queue
+  // already held the maximum amount of comparisons. They are also counted as
+  // overloaded, and contribute to all stream stats except SSIM and PSNR.
+  int64_t comparisons_dropped = 0;
+  // Bytes of video frames held by the analyzer, both for frames in flight and
+  // in queued comparisons, measured when new element is added to the queue.
+  SamplesStatsCounter memory_usage_bytes;
+  // CPU time of the comparison thread spent to compute PSNR and SSIM of a
+  // single comparison.
+  SamplesStatsCounter comparison_cpu_time_us;
+  // CPU time of the capturing thread spent to store a downscaled reference
+  // frame. Empty if reference frames aren't downscaled.
+  SamplesStatsCounter reference_frame_store_cpu_time_us;
+};
+
+struct DefaultVideoQualityAnalyzerOptions {
+  // If greater than 1, captured frames are kept until they are rendered
+  // downscaled by this factor in both dimensions, in buffers reused from a
+  // per stream pool. Rendered frames are downscaled to the same resolution
+  // before the comparison, so PSNR and SSIM describe the downscaled video.
+  int reference_frame_downscale_factor = 1;
+  // If greater than 0, comparisons that are added while the queue holds this
+  // amount of comparisons don't keep their frames, so SSIM and PSNR aren't
+  // computed for them. They are counted in AnalyzerStats::comparisons_dropped.
+  // Independently of this, comparisons added to a long queue are overloaded,
+  // so only values below that length change which frames are compared.
+  size_t max_comparisons_queue_size = 0;
 };
 
 class DefaultVideoQualityAnalyzer : public VideoQualityAnalyzerInterface {
  public:
   DefaultVideoQualityAnalyzer();
+  explicit DefaultVideoQualityAnalyzer(
+      DefaultVideoQualityAnalyzerOptions options);
   ~DefaultVideoQualityAnalyzer() override;
 
   void Start(std::string test_case_name, int max_threads_count) override;
@@ -223,10 +253,15 @@ class DefaultVideoQualityAnalyzer : public VideoQualityAnalyzerInterface {
                             const VideoFrame& frame)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Returns a copy of |frame| with a downscaled buffer from the pool of
+  // |stream_label|.
+  VideoFrame CreateDownscaledReferenceFrame(const std::string& stream_label,
+                                            const VideoFrame& frame);
   void AddComparison(absl::optional<VideoFrame> captured,
                      absl::optional<VideoFrame> rendered,
                      bool dropped,
-                     FrameStats frame_stats);
+                     FrameStats frame_stats)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   static void ProcessComparisonsThread(void* obj);
   void ProcessComparisons();
   void ProcessComparison(const FrameComparison& comparison);
@@ -244,6 +279,7 @@ class DefaultVideoQualityAnalyzer : public VideoQualityAnalyzerInterface {
   std::string GetTestCaseName(const std::string& stream_label) const;
   Timestamp Now();
 
+  const DefaultVideoQualityAnalyzerOptions options_;
   webrtc::Clock* const clock_;
   std::atomic<uint16_t> next_frame_id_{0};
 
@@ -255,6 +291,7 @@ class DefaultVideoQualityAnalyzer : public VideoQualityAnalyzerInterface {
   // stream or deemed dropped.
   std::map<uint16_t, VideoFrame> captured_frames_in_flight_
       RTC_GUARDED_BY(lock_);
+  int64_t captured_frames_in_flight_bytes_ RTC_GUARDED_BY(lock_) = 0;
   // Global frames count for all video streams.
   FrameCounters frame_counters_ RTC_GUARDED_BY(lock_);
   // Frame counters per each stream.
@@ -269,8 +306,15 @@ class DefaultVideoQualityAnalyzer : public VideoQualityAnalyzerInterface {
   std::map<std::string, Timestamp> stream_last_freeze_end_time_
       RTC_GUARDED_BY(comparison_lock_);
   std::deque<FrameComparison> comparisons_ RTC_GUARDED_BY(comparison_lock_);
+  int64_t comparisons_bytes_ RTC_GUARDED_BY(comparison_lock_) = 0;
   AnalyzerStats analyzer_stats_ RTC_GUARDED_BY(comparison_lock_);
 
+  rtc::CriticalSection reference_pools_lock_;
+  // Buffers for downscaled reference frames per stream label. A buffer goes
+  // back to its pool when the comparison of its frame is done.
+  std::map<std::string, I420BufferPool> reference_pools_
+      RTC_GUARDED_BY(reference_pools_lock_);
+
   std::vector<std::unique_ptr<rtc::PlatformThread>> thread_pool_;
   rtc::Event comparison_available_event_;
 };
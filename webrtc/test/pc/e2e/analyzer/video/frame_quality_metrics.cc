@@ -0,0 +1,224 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/pc/e2e/analyzer/video/frame_quality_metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace webrtc_pc_e2e {
+namespace {
+
+constexpr double kPerfectPsnr = 48.0;
+constexpr int kSsimBlockSize = 4;
+// SSIM constants for 8x8 windows, (0.01 * 255)^2 and (0.03 * 255)^2 scaled
+// by 64^2 and stored with 12 fractional bits, as in libyuv.
+constexpr int64_t kSsimC1 = 26634;
+constexpr int64_t kSsimC2 = 239708;
+
+uint64_t SumSquaredError(const uint8_t* a,
+                         int stride_a,
+                         const uint8_t* b,
+                         int stride_b,
+                         int width,
+                         int height) {
+  uint64_t sse = 0;
+  for (int y = 0; y < height; ++y) {
+    // A row of up to 66051 pixels can't overflow a 32 bit sum, which keeps
+    // the inner loop vectorizable.
+    uint32_t row_sse = 0;
+    for (int x = 0; x < width; ++x) {
+      const int diff = a[x] - b[x];
+      row_sse += diff * diff;
+    }
+    sse += row_sse;
+    a += stride_a;
+    b += stride_b;
+  }
+  return sse;
+}
+
+// Sums of one block of the reference (a) and test (b) planes.
+struct SsimSums {
+  std::vector<uint32_t> a;
+  std::vector<uint32_t> b;
+  std::vector<uint32_t> sq_a;
+  std::vector<uint32_t> sq_b;
+  std::vector<uint32_t> a_x_b;
+
+  explicit SsimSums(size_t size)
+      : a(size), b(size), sq_a(size), sq_b(size), a_x_b(size) {}
+};
+
+// Computes the sums of every 4x4 block in a row of |block_sums->a.size()|
+// blocks. |column_sums| is scratch space for the sums over 4 rows of each
+// column.
+void ComputeBlockSums(const uint8_t* a,
+                      int stride_a,
+                      const uint8_t* b,
+                      int stride_b,
+                      SsimSums* column_sums,
+                      SsimSums* block_sums) {
+  const size_t columns = column_sums->a.size();
+  uint32_t* sum_a = column_sums->a.data();
+  uint32_t* sum_b = column_sums->b.data();
+  uint32_t* sum_sq_a = column_sums->sq_a.data();
+  uint32_t* sum_sq_b = column_sums->sq_b.data();
+  uint32_t* sum_a_x_b = column_sums->a_x_b.data();
+  for (size_t x = 0; x < columns; ++x) {
+    sum_a[x] = 0;
+    sum_b[x] = 0;
+    sum_sq_a[x] = 0;
+    sum_sq_b[x] = 0;
+    sum_a_x_b[x] = 0;
+  }
+  for (int y = 0; y < kSsimBlockSize; ++y) {
+    for (size_t x = 0; x < columns; ++x) {
+      const uint32_t pixel_a = a[x];
+      const uint32_t pixel_b = b[x];
+      sum_a[x] += pixel_a;
+      sum_b[x] += pixel_b;
+      sum_sq_a[x] += pixel_a * pixel_a;
+      sum_sq_b[x] += pixel_b * pixel_b;
+      sum_a_x_b[x] += pixel_a * pixel_b;
+    }
+    a += stride_a;
+    b += stride_b;
+  }
+  for (size_t block = 0; block < block_sums->a.size(); ++block) {
+    const size_t x = block * kSsimBlockSize;
+    block_sums->a[block] =
+        sum_a[x] + sum_a[x + 1] + sum_a[x + 2] + sum_a[x + 3];
+    block_sums->b[block] =
+        sum_b[x] + sum_b[x + 1] + sum_b[x + 2] + sum_b[x + 3];
+    block_sums->sq_a[block] =
+        sum_sq_a[x] + sum_sq_a[x + 1] + sum_sq_a[x + 2] + sum_sq_a[x + 3];
+    block_sums->sq_b[block] =
+        sum_sq_b[x] + sum_sq_b[x + 1] + sum_sq_b[x + 2] + sum_sq_b[x + 3];
+    block_sums->a_x_b[block] =
+        sum_a_x_b[x] + sum_a_x_b[x + 1] + sum_a_x_b[x + 2] + sum_a_x_b[x + 3];
+  }
+}
+
+double Ssim8x8(int64_t sum_a,
+               int64_t sum_b,
+               int64_t sum_sq_a,
+               int64_t sum_sq_b,
+               int64_t sum_a_x_b) {
+  constexpr int64_t kCount = 64;
+  constexpr int64_t c1 = (kSsimC1 * kCount * kCount) >> 12;
+  constexpr int64_t c2 = (kSsimC2 * kCount * kCount) >> 12;
+  const int64_t sum_a_x_sum_b = sum_a * sum_b;
+  const int64_t sum_a_sq = sum_a * sum_a;
+  const int64_t sum_b_sq = sum_b * sum_b;
+  // libyuv converts the 64 bit products of these factors to double. All
+  // factors are below 2^31 and exact in double, and a double multiplication
+  // rounds the exact product the same way as that conversion does, so this
+  // gives the same result without 64 bit integer multiplications.
+  const double ssim_n =
+      static_cast<double>(2 * sum_a_x_sum_b + c1) *
+      static_cast<double>(2 * kCount * sum_a_x_b - 2 * sum_a_x_sum_b + c2);
+  const double ssim_d =
+      static_cast<double>(sum_a_sq + sum_b_sq + c1) *
+      static_cast<double>(kCount * sum_sq_a - sum_a_sq + kCount * sum_sq_b -
+                          sum_b_sq + c2);
+  // |c1| and |c2| are positive, so |ssim_d| is too.
+  return ssim_n / ssim_d;
+}
+
+// The window at (x, y) covers the blocks starting at (x, y), (x + 4, y),
+// (x, y + 4) and (x + 4, y + 4), so every window is the sum of two
+// horizontally adjacent blocks in two consecutive block rows.
+double PlaneSsim(const uint8_t* a,
+                 int stride_a,
+                 const uint8_t* b,
+                 int stride_b,
+                 int width,
+                 int height) {
+  // Windows start every 4 pixels while x < width - 8 and y < height - 8.
+  const int windows_x = (width - 8 + kSsimBlockSize - 1) / kSsimBlockSize;
+  const int windows_y = (height - 8 + kSsimBlockSize - 1) / kSsimBlockSize;
+  // libyuv divides by the zero window count here, so do the same. The
+  // analyzer drops the NaN like it drops any SSIM that isn't positive.
+  if (windows_x <= 0 || windows_y <= 0)
+    return std::numeric_limits<double>::quiet_NaN();
+  const size_t blocks = windows_x + 1;
+  SsimSums column_sums(blocks * kSsimBlockSize);
+  SsimSums upper(blocks);
+  SsimSums lower(blocks);
+  ComputeBlockSums(a, stride_a, b, stride_b, &column_sums, &upper);
+  double ssim_total = 0.0;
+  for (int window_y = 0; window_y < windows_y; ++window_y) {
+    const int lower_y = (window_y + 1) * kSsimBlockSize;
+    ComputeBlockSums(a + lower_y * stride_a, stride_a, b + lower_y * stride_b,
+                     stride_b, &column_sums, &lower);
+    for (int x = 0; x < windows_x; ++x) {
+      ssim_total += Ssim8x8(
+          upper.a[x] + upper.a[x + 1] + lower.a[x] + lower.a[x + 1],
+          upper.b[x] + upper.b[x + 1] + lower.b[x] + lower.b[x + 1],
+          upper.sq_a[x] + upper.sq_a[x + 1] + lower.sq_a[x] + lower.sq_a[x + 1],
+          upper.sq_b[x] + upper.sq_b[x + 1] + lower.sq_b[x] + lower.sq_b[x + 1],
+          upper.a_x_b[x] + upper.a_x_b[x + 1] + lower.a_x_b[x] +
+              lower.a_x_b[x + 1]);
+    }
+    std::swap(upper, lower);
+  }
+  return ssim_total / (windows_x * windows_y);
+}
+
+}  // namespace
+
+double ComputeI420Psnr(const I420BufferInterface& reference,
+                       const I420BufferInterface& test) {
+  RTC_CHECK_EQ(reference.width(), test.width());
+  RTC_CHECK_EQ(reference.height(), test.height());
+  const uint64_t sse =
+      SumSquaredError(reference.DataY(), reference.StrideY(), test.DataY(),
+                      test.StrideY(), test.width(), test.height()) +
+      SumSquaredError(reference.DataU(), reference.StrideU(), test.DataU(),
+                      test.StrideU(), test.ChromaWidth(),
+                      test.ChromaHeight()) +
+      SumSquaredError(reference.DataV(), reference.StrideV(), test.DataV(),
+                      test.StrideV(), test.ChromaWidth(), test.ChromaHeight());
+  if (sse == 0)
+    return kPerfectPsnr;
+  const uint64_t samples =
+      static_cast<uint64_t>(test.width()) * test.height() +
+      2 * static_cast<uint64_t>(test.ChromaWidth()) * test.ChromaHeight();
+  const double inverse_mse = static_cast<double>(samples) / sse;
+  return std::min(10.0 * std::log10(255.0 * 255.0 * inverse_mse),
+                  kPerfectPsnr);
+}
+
+double ComputeI420Ssim(const I420BufferInterface& reference,
+                       const I420BufferInterface& test) {
+  RTC_CHECK_EQ(reference.width(), test.width());
+  RTC_CHECK_EQ(reference.height(), test.height());
+  const double ssim_y =
+      PlaneSsim(reference.DataY(), reference.StrideY(), test.DataY(),
+                test.StrideY(), test.width(), test.height());
+  const double ssim_u =
+      PlaneSsim(reference.DataU(), reference.StrideU(), test.DataU(),
+                test.StrideU(), test.ChromaWidth(), test.ChromaHeight());
+  const double ssim_v =
+      PlaneSsim(reference.DataV(), reference.StrideV(), test.DataV(),
+                test.StrideV(), test.ChromaWidth(), test.ChromaHeight());
+  return ssim_y * 0.8 + 0.1 * (ssim_u + ssim_v);
+}
+
+}  // namespace webrtc_pc_e2e
+}  // namespace webrtc
@@ -0,0 +1,37 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef TEST_PC_E2E_ANALYZER_VIDEO_FRAME_QUALITY_METRICS_H_
+#define TEST_PC_E2E_ANALYZER_VIDEO_FRAME_QUALITY_METRICS_H_
+
+#include "api/video/video_frame_buffer.h"
+
+namespace webrtc {
+namespace webrtc_pc_e2e {
+
+// Both functions compare buffers of the same resolution and return the same
+// values as I420PSNR() and I420SSIM() from common_video for such buffers. They
+// work on the planes directly, without converting or copying them.
+//
+// PSNR is computed over the sum of squared errors of all three planes and is
+// capped at 48 dB.
+double ComputeI420Psnr(const I420BufferInterface& reference,
+                       const I420BufferInterface& test);
+// SSIM is computed on 8x8 windows placed every 4 pixels and weights the Y,
+// U and V planes 0.8, 0.1 and 0.1. Instead of summing every window from
+// scratch, the per-window sums are combined from sums over 4x4 blocks, which
+// are computed with loops the compiler can vectorize.
+double ComputeI420Ssim(const I420BufferInterface& reference,
+                       const I420BufferInterface& test);
+
+}  // namespace webrtc_pc_e2e
+}  // namespace webrtc
+
+#endif  // TEST_PC_E2E_ANALYZER_VIDEO_FRAME_QUALITY_METRICS_H_
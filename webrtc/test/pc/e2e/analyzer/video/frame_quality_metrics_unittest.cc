@@ -0,0 +1,264 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/pc/e2e/analyzer/video/frame_quality_metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "api/scoped_refptr.h"
+#include "api/video/i420_buffer.h"
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+#include "third_party/libyuv/include/libyuv/compare.h"
+
+namespace webrtc {
+namespace webrtc_pc_e2e {
+namespace {
+
+// Straightforward implementation of the libyuv SSIM, which sums every 8x8
+// window from scratch.
+double ReferenceSsim8x8(const uint8_t* a,
+                        int stride_a,
+                        const uint8_t* b,
+                        int stride_b) {
+  int64_t sum_a = 0;
+  int64_t sum_b = 0;
+  int64_t sum_sq_a = 0;
+  int64_t sum_sq_b = 0;
+  int64_t sum_a_x_b = 0;
+  for (int y = 0; y < 8; ++y) {
+    for (int x = 0; x < 8; ++x) {
+      sum_a += a[x];
+      sum_b += b[x];
+      sum_sq_a += a[x] * a[x];
+      sum_sq_b += b[x] * b[x];
+      sum_a_x_b += a[x] * b[x];
+    }
+    a += stride_a;
+    b += stride_b;
+  }
+  const int64_t count = 64;
+  const int64_t c1 = (26634 * count * count) >> 12;
+  const int64_t c2 = (239708 * count * count) >> 12;
+  const int64_t sum_a_x_sum_b = sum_a * sum_b;
+  const int64_t ssim_n = (2 * sum_a_x_sum_b + c1) *
+                         (2 * count * sum_a_x_b - 2 * sum_a_x_sum_b + c2);
+  const int64_t ssim_d =
+      (sum_a * sum_a + sum_b * sum_b + c1) *
+      (count * sum_sq_a - sum_a * sum_a + count * sum_sq_b - sum_b * sum_b +
+       c2);
+  return ssim_n * 1.0 / ssim_d;
+}
+
+double ReferencePlaneSsim(const uint8_t* a,
+                          int stride_a,
+                          const uint8_t* b,
+                          int stride_b,
+                          int width,
+                          int height) {
+  double ssim_total = 0;
+  int samples = 0;
+  for (int y = 0; y < height - 8; y += 4) {
+    for (int x = 0; x < width - 8; x += 4) {
+      ssim_total += ReferenceSsim8x8(a + y * stride_a + x, stride_a,
+                                     b + y * stride_b + x, stride_b);
+      ++samples;
+    }
+  }
+  return ssim_total / samples;
+}
+
+double ReferenceSsim(const I420BufferInterface& a,
+                     const I420BufferInterface& b) {
+  return 0.8 * ReferencePlaneSsim(a.DataY(), a.StrideY(), b.DataY(),
+                                  b.StrideY(), a.width(), a.height()) +
+         0.1 * (ReferencePlaneSsim(a.DataU(), a.StrideU(), b.DataU(),
+                                   b.StrideU(), a.ChromaWidth(),
+                                   a.ChromaHeight()) +
+                ReferencePlaneSsim(a.DataV(), a.StrideV(), b.DataV(),
+                                   b.StrideV(), a.ChromaWidth(),
+                                   a.ChromaHeight()));
+}
+
+void FillPlane(uint8_t* data, int stride, int width, int height, int value) {
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x)
+      data[y * stride + x] = static_cast<uint8_t>(value);
+  }
+}
+
+// Padded strides make sure that the kernels don't read past the plane width.
+rtc::scoped_refptr<I420Buffer> CreatePaddedBuffer(int width, int height) {
+  return I420Buffer::Create(width, height, width + 13, (width + 1) / 2 + 7,
+                            (width + 1) / 2 + 5);
+}
+
+rtc::scoped_refptr<I420Buffer> CreateConstantBuffer(int width,
+                                                    int height,
+                                                    int value) {
+  rtc::scoped_refptr<I420Buffer> buffer = CreatePaddedBuffer(width, height);
+  FillPlane(buffer->MutableDataY(), buffer->StrideY(), width, height, value);
+  FillPlane(buffer->MutableDataU(), buffer->StrideU(), buffer->ChromaWidth(),
+            buffer->ChromaHeight(), value);
+  FillPlane(buffer->MutableDataV(), buffer->StrideV(), buffer->ChromaWidth(),
+            buffer->ChromaHeight(), value);
+  return buffer;
+}
+
+void FillRandomPlane(Random* random,
+                     uint8_t* data,
+                     int stride,
+                     int width,
+                     int height) {
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x)
+      data[y * stride + x] = static_cast<uint8_t>(random->Rand(0, 255));
+  }
+}
+
+rtc::scoped_refptr<I420Buffer> CreateRandomBuffer(Random* random,
+                                                  int width,
+                                                  int height) {
+  rtc::scoped_refptr<I420Buffer> buffer = CreatePaddedBuffer(width, height);
+  FillRandomPlane(random, buffer->MutableDataY(), buffer->StrideY(), width,
+                  height);
+  FillRandomPlane(random, buffer->MutableDataU(), buffer->StrideU(),
+                  buffer->ChromaWidth(), buffer->ChromaHeight());
+  FillRandomPlane(random, buffer->MutableDataV(), buffer->StrideV(),
+                  buffer->ChromaWidth(), buffer->ChromaHeight());
+  return buffer;
+}
+
+// Returns a copy of |buffer| with every sample moved by up to +-|noise|.
+rtc::scoped_refptr<I420Buffer> AddNoise(Random* random,
+                                        const I420BufferInterface& buffer,
+                                        int noise) {
+  rtc::scoped_refptr<I420Buffer> noisy = I420Buffer::Copy(buffer);
+  auto add_noise = [random, noise](uint8_t* data, int stride, int width,
+                                   int height) {
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        const int value = data[y * stride + x] + random->Rand(-noise, noise);
+        data[y * stride + x] =
+            static_cast<uint8_t>(std::min(255, std::max(0, value)));
+      }
+    }
+  };
+  add_noise(noisy->MutableDataY(), noisy->StrideY(), noisy->width(),
+            noisy->height());
+  add_noise(noisy->MutableDataU(), noisy->StrideU(), noisy->ChromaWidth(),
+            noisy->ChromaHeight());
+  add_noise(noisy->MutableDataV(), noisy->StrideV(), noisy->ChromaWidth(),
+            noisy->ChromaHeight());
+  return noisy;
+}
+
+// What I420PSNR() in common_video returns for frames of the same size.
+double LibyuvPsnr(const I420BufferInterface& a, const I420BufferInterface& b) {
+  const double psnr = libyuv::I420Psnr(
+      a.DataY(), a.StrideY(), a.DataU(), a.StrideU(), a.DataV(), a.StrideV(),
+      b.DataY(), b.StrideY(), b.DataU(), b.StrideU(), b.DataV(), b.StrideV(),
+      a.width(), a.height());
+  return std::min(psnr, 48.0);
+}
+
+double LibyuvSsim(const I420BufferInterface& a, const I420BufferInterface& b) {
+  return libyuv::I420Ssim(a.DataY(), a.StrideY(), a.DataU(), a.StrideU(),
+                          a.DataV(), a.StrideV(), b.DataY(), b.StrideY(),
+                          b.DataU(), b.StrideU(), b.DataV(), b.StrideV(),
+                          a.width(), a.height());
+}
+
+}  // namespace
+
+TEST(FrameQualityMetricsTest, IdenticalFramesHavePerfectScores) {
+  Random random(1);
+  rtc::scoped_refptr<I420Buffer> buffer = CreateRandomBuffer(&random, 64, 48);
+  EXPECT_EQ(ComputeI420Psnr(*buffer, *buffer), 48.0);
+  EXPECT_EQ(ComputeI420Ssim(*buffer, *buffer), 1.0);
+}
+
+TEST(FrameQualityMetricsTest, PsnrOfConstantDifference) {
+  rtc::scoped_refptr<I420Buffer> reference = CreateConstantBuffer(33, 17, 100);
+  rtc::scoped_refptr<I420Buffer> test = CreateConstantBuffer(33, 17, 104);
+  // The mean squared error is 16.
+  EXPECT_DOUBLE_EQ(ComputeI420Psnr(*reference, *test),
+                   10.0 * std::log10(255.0 * 255.0 / 16.0));
+  // A mean squared error of 1 is above the 48 dB cap.
+  test = CreateConstantBuffer(33, 17, 101);
+  EXPECT_EQ(ComputeI420Psnr(*reference, *test), 48.0);
+}
+
+TEST(FrameQualityMetricsTest, SsimMatchesPerWindowComputation) {
+  Random random(2);
+  const int kSizes[][2] = {{20, 18}, {17, 19}, {64, 48}, {98, 61}, {321, 241}};
+  for (const auto& size : kSizes) {
+    rtc::scoped_refptr<I420Buffer> reference =
+        CreateRandomBuffer(&random, size[0], size[1]);
+    for (int noise : {1, 8, 64}) {
+      rtc::scoped_refptr<I420Buffer> test =
+          AddNoise(&random, *reference, noise);
+      EXPECT_EQ(ComputeI420Ssim(*reference, *test),
+                ReferenceSsim(*reference, *test))
+          << size[0] << "x" << size[1] << ", noise " << noise;
+    }
+  }
+}
+
+// The analyzer used libyuv before, so its results must not move.
+TEST(FrameQualityMetricsTest, MatchesLibyuvOnRandomFrames) {
+  // Both sides add up the same integer sums, only the final floating point
+  // steps may round differently.
+  constexpr double kTolerance = 1e-9;
+  Random random(4);
+  const int kSizes[][2] = {{18, 18}, {17, 19}, {98, 61}, {320, 180}};
+  for (const auto& size : kSizes) {
+    rtc::scoped_refptr<I420Buffer> reference =
+        CreateRandomBuffer(&random, size[0], size[1]);
+    for (int noise : {0, 1, 8, 64}) {
+      rtc::scoped_refptr<I420Buffer> test =
+          AddNoise(&random, *reference, noise);
+      EXPECT_NEAR(ComputeI420Psnr(*reference, *test),
+                  LibyuvPsnr(*reference, *test), kTolerance)
+          << size[0] << "x" << size[1] << ", noise " << noise;
+      EXPECT_NEAR(ComputeI420Ssim(*reference, *test),
+                  LibyuvSsim(*reference, *test), kTolerance)
+          << size[0] << "x" << size[1] << ", noise " << noise;
+    }
+  }
+}
+
+// The 8x8 chroma planes of a 16x16 frame have no SSIM window.
+TEST(FrameQualityMetricsTest, SsimIsNanLikeLibyuvWithoutWindows) {
+  Random random(5);
+  rtc::scoped_refptr<I420Buffer> reference =
+      CreateRandomBuffer(&random, 16, 16);
+  rtc::scoped_refptr<I420Buffer> test = AddNoise(&random, *reference, 8);
+  EXPECT_TRUE(std::isnan(LibyuvSsim(*reference, *test)));
+  EXPECT_TRUE(std::isnan(ComputeI420Ssim(*reference, *test)));
+}
+
+TEST(FrameQualityMetricsTest, SsimDecreasesWithNoise) {
+  Random random(3);
+  rtc::scoped_refptr<I420Buffer> reference =
+      CreateRandomBuffer(&random, 160, 120);
+  const double ssim_low_noise =
+      ComputeI420Ssim(*reference, *AddNoise(&random, *reference, 4));
+  const double ssim_high_noise =
+      ComputeI420Ssim(*reference, *AddNoise(&random, *reference, 32));
+  EXPECT_LT(ssim_low_noise, 1.0);
+  EXPECT_LT(ssim_high_noise, ssim_low_noise);
+  EXPECT_GT(ssim_high_noise, 0.0);
+}
+
+}  // namespace webrtc_pc_e2e
+}  // namespace webrtc
@@ -9,11 +9,16 @@
  */
 #include "test/scenario/call_client.h"
 
+#include <algorithm>
+#include <cmath>
 #include <utility>
 
 #include "absl/memory/memory.h"
 #include "modules/audio_mixer/audio_mixer_impl.h"
 #include "modules/congestion_controller/goog_cc/test/goog_cc_printer.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/time_utils.h"
+#include "test/testsupport/perf_test.h"
 
 namespace webrtc {
 namespace test {
@@ -30,25 +35,6 @@ const uint32_t kReceiverLocalAudioSsrc = 0x1234567;
 
 const char* kPriorityStreamId = "priority-track";
 
-CallClientFakeAudio InitAudio(TimeController* time_controller) {
-  CallClientFakeAudio setup;
-  auto capturer = TestAudioDeviceModule::CreatePulsedNoiseCapturer(256, 48000);
-  auto renderer = TestAudioDeviceModule::CreateDiscardRenderer(48000);
-  setup.fake_audio_device = TestAudioDeviceModule::Create(
-      time_controller->GetTaskQueueFactory(), std::move(capturer),
-      std::move(renderer), 1.f);
-  setup.apm = AudioProcessingBuilder().Create();
-  setup.fake_audio_device->Init();
-  AudioState::Config audio_state_config;
-  audio_state_config.audio_mixer = AudioMixerImpl::Create();
-  audio_state_config.audio_processing = setup.apm;
-  audio_state_config.audio_device_module = setup.fake_audio_device;
-  setup.audio_state = AudioState::Create(audio_state_config);
-  setup.fake_audio_device->RegisterAudioCallback(
-      setup.audio_state->audio_transport());
-  return setup;
-}
-
 Call* CreateCall(TimeController* time_controller,
                  CallClientConfig config,
                  LoggingNetworkControllerFactory* network_controller_factory,
@@ -67,6 +53,25 @@ Call* CreateCall(TimeController* time_controller,
                       time_controller->CreateProcessThread("CallModules"),
                       time_controller->CreateProcessThread("Pacer"));
 }
+}  // namespace
+
+CallClientFakeAudio InitFakeAudio(TimeController* time_controller) {
+  CallClientFakeAudio setup;
+  auto capturer = TestAudioDeviceModule::CreatePulsedNoiseCapturer(256, 48000);
+  auto renderer = TestAudioDeviceModule::CreateDiscardRenderer(48000);
+  setup.fake_audio_device = TestAudioDeviceModule::Create(
+      time_controller->GetTaskQueueFactory(), std::move(capturer),
+      std::move(renderer), 1.f);
+  setup.apm = AudioProcessingBuilder().Create();
+  setup.fake_audio_device->Init();
+  AudioState::Config audio_state_config;
+  audio_state_config.audio_mixer = AudioMixerImpl::Create();
+  audio_state_config.audio_processing = setup.apm;
+  audio_state_config.audio_device_module = setup.fake_audio_device;
+  setup.audio_state = AudioState::Create(audio_state_config);
+  setup.fake_audio_device->RegisterAudioCallback(
+      setup.audio_state->audio_transport());
+  return setup;
 }
 
 LoggingNetworkControllerFactory::LoggingNetworkControllerFactory(
@@ -159,15 +164,36 @@ CallClient::CallClient(
                                   log_writer_factory_.get(),
                                   config.transport),
       header_parser_(RtpHeaderParser::Create()),
-      task_queue_(time_controller->GetTaskQueueFactory()->CreateTaskQueue(
-          "CallClient",
-          TaskQueueFactory::Priority::NORMAL)) {
+      task_queue_(nullptr),
+      owned_task_queue_(absl::make_unique<TaskQueueForTest>(
+          time_controller->GetTaskQueueFactory()->CreateTaskQueue(
+              "CallClient",
+              TaskQueueFactory::Priority::NORMAL))) {
+  task_queue_ = owned_task_queue_.get();
   SendTask([this, config] {
-    fake_audio_setup_ = InitAudio(time_controller_);
-    call_.reset(CreateCall(time_controller_, config,
-                           &network_controller_factory_,
-                           fake_audio_setup_.audio_state));
-    transport_ = absl::make_unique<NetworkNodeTransport>(clock_, call_.get());
+    fake_audio_setup_ = InitFakeAudio(time_controller_);
+    InitCall(config);
+  });
+}
+
+CallClient::CallClient(
+    TimeController* time_controller,
+    std::unique_ptr<LogWriterFactoryInterface> log_writer_factory,
+    CallClientConfig config,
+    TaskQueueForTest* task_queue,
+    CallClientFakeAudio shared_audio)
+    : time_controller_(time_controller),
+      clock_(time_controller->GetClock()),
+      log_writer_factory_(std::move(log_writer_factory)),
+      network_controller_factory_(time_controller,
+                                  log_writer_factory_.get(),
+                                  config.transport),
+      header_parser_(RtpHeaderParser::Create()),
+      task_queue_(task_queue) {
+  RTC_DCHECK(task_queue_);
+  SendTask([this, config, shared_audio] {
+    fake_audio_setup_ = shared_audio;
+    InitCall(config);
   });
 }
 
@@ -215,7 +241,7 @@ void CallClient::OnPacketReceived(EmulatedIpPacket packet) {
     MediaType media_type;
     EmulatedIpPacket packet;
   };
-  task_queue_.PostTask(Closure{call_.get(), media_type, std::move(packet)});
+  task_queue_->PostTask(Closure{call_.get(), media_type, std::move(packet)});
 }
 
 std::unique_ptr<RtcEventLogOutput> CallClient::GetLogWriter(std::string name) {
@@ -263,10 +289,83 @@ void CallClient::AddExtensions(std::vector<RtpExtension> extensions) {
 
 void CallClient::SendTask(std::function<void()> task) {
   time_controller_->InvokeWithControlledYield(
-      [&] { task_queue_.SendTask(std::move(task)); });
+      [&] { task_queue_->SendTask(std::move(task)); });
+}
+
+void CallClient::InitCall(CallClientConfig config) {
+  call_.reset(CreateCall(time_controller_, config, &network_controller_factory_,
+                         fake_audio_setup_.audio_state));
+  transport_ = absl::make_unique<NetworkNodeTransport>(clock_, call_.get());
 }
 
 CallClientPair::~CallClientPair() = default;
 
+CallClientPool::CallClientPool(Clock* clock,
+                               CallClientPoolConfig config,
+                               std::vector<CallClient*> clients,
+                               int64_t memory_per_client_bytes)
+    : clock_(clock),
+      config_(config),
+      clients_(std::move(clients)),
+      memory_per_client_bytes_(memory_per_client_bytes),
+      start_time_(Timestamp::us(clock->TimeInMicroseconds())),
+      start_cpu_time_ns_(rtc::GetProcessCpuTimeNanos()),
+      estimates_(clients_.size()) {}
+
+CallClientPool::~CallClientPool() = default;
+
+void CallClientPool::SampleEstimates() {
+  rtc::CritScope crit(&crit_);
+  sample_times_.push_back(Timestamp::us(clock_->TimeInMicroseconds()));
+  for (size_t i = 0; i < clients_.size(); ++i)
+    estimates_[i].push_back(clients_[i]->send_bandwidth());
+}
+
+CallClientPool::Results CallClientPool::GetResults() const {
+  Results results;
+  results.num_clients = clients_.size();
+  results.memory_per_client_bytes = memory_per_client_bytes_;
+  const Timestamp now = Timestamp::us(clock_->TimeInMicroseconds());
+  const double elapsed_seconds = (now - start_time_).seconds<double>();
+  if (elapsed_seconds > 0) {
+    results.cpu_ms_per_client_second =
+        (rtc::GetProcessCpuTimeNanos() - start_cpu_time_ns_) /
+        static_cast<double>(rtc::kNumNanosecsPerMillisec) /
+        clients_.size() / elapsed_seconds;
+  }
+
+  rtc::CritScope crit(&crit_);
+  for (const std::vector<DataRate>& estimates : estimates_) {
+    if (estimates.empty() || estimates.back().IsZero())
+      continue;
+    const double final_bps = estimates.back().bps<double>();
+    // Find the first sample after the last one outside of the margin.
+    size_t converged_index = estimates.size() - 1;
+    while (converged_index > 0 &&
+           std::abs(estimates[converged_index - 1].bps<double>() - final_bps) <=
+               config_.convergence_margin * final_bps) {
+      --converged_index;
+    }
+    results.convergence_times.push_back(sample_times_[converged_index] -
+                                        start_time_);
+  }
+  return results;
+}
+
+void CallClientPool::PrintResults(std::string test_name) const {
+  const Results results = GetResults();
+  test::PrintResult("memory_per_client", "", test_name,
+                    results.memory_per_client_bytes, "bytes", false);
+  test::PrintResult("cpu_time_per_client", "", test_name,
+                    results.cpu_ms_per_client_second, "ms/s", false);
+  std::vector<double> convergence_ms;
+  for (TimeDelta time : results.convergence_times)
+    convergence_ms.push_back(time.ms<double>());
+  if (!convergence_ms.empty()) {
+    test::PrintResultList("bwe_convergence_time", "", test_name,
+                          convergence_ms, "ms", false);
+  }
+}
+
 }  // namespace test
 }  // namespace webrtc
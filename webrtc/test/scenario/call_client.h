@@ -22,6 +22,7 @@
 #include "modules/congestion_controller/test/controller_printer.h"
 #include "modules/rtp_rtcp/include/rtp_header_parser.h"
 #include "rtc_base/constructor_magic.h"
+#include "rtc_base/critical_section.h"
 #include "rtc_base/task_queue_for_test.h"
 #include "test/logging/log_writer.h"
 #include "test/scenario/column_printer.h"
@@ -61,6 +62,10 @@ struct CallClientFakeAudio {
   rtc::scoped_refptr<TestAudioDeviceModule> fake_audio_device;
   rtc::scoped_refptr<AudioState> audio_state;
 };
+// Creates the fake audio device and the audio state a client sends and
+// receives audio with. Called on a task queue created by |time_controller|.
+CallClientFakeAudio InitFakeAudio(TimeController* time_controller);
+
 // CallClient represents a participant in a call scenario. It is created by the
 // Scenario class and is used as sender and receiver when setting up a media
 // stream session.
@@ -69,6 +74,14 @@ class CallClient : public EmulatedNetworkReceiverInterface {
   CallClient(TimeController* time_controller,
              std::unique_ptr<LogWriterFactoryInterface> log_writer_factory,
              CallClientConfig config);
+  // Creates a client that runs on |task_queue| and uses |shared_audio|
+  // instead of owning a task queue and a fake audio device. |task_queue| must
+  // outlive the client.
+  CallClient(TimeController* time_controller,
+             std::unique_ptr<LogWriterFactoryInterface> log_writer_factory,
+             CallClientConfig config,
+             TaskQueueForTest* task_queue,
+             CallClientFakeAudio shared_audio);
   RTC_DISALLOW_COPY_AND_ASSIGN(CallClient);
 
   ~CallClient();
@@ -99,6 +112,7 @@ class CallClient : public EmulatedNetworkReceiverInterface {
   std::string GetNextPriorityId();
   void AddExtensions(std::vector<RtpExtension> extensions);
   void SendTask(std::function<void()> task);
+  void InitCall(CallClientConfig config);
 
   TimeController* const time_controller_;
   Clock* clock_;
@@ -119,8 +133,10 @@ class CallClient : public EmulatedNetworkReceiverInterface {
   int next_audio_local_ssrc_index_ = 0;
   int next_priority_index_ = 0;
   std::map<uint32_t, MediaType> ssrc_media_types_;
-  // Defined last so it's destroyed first.
-  TaskQueueForTest task_queue_;
+  TaskQueueForTest* task_queue_;
+  // Null for clients on a shared task queue. Defined last so it's destroyed
+  // first.
+  std::unique_ptr<TaskQueueForTest> owned_task_queue_;
 };
 
 class CallClientPair {
@@ -139,6 +155,54 @@ class CallClientPair {
   CallClient* const first_;
   CallClient* const second_;
 };
+
+// CallClientPool is a set of clients created by Scenario::CreateClientPool()
+// for load tests. It measures the memory and CPU used by the clients and how
+// long their send bandwidth estimates take to converge.
+class CallClientPool {
+ public:
+  struct Results {
+    size_t num_clients = 0;
+    // Growth of the process resident size when the clients were created.
+    int64_t memory_per_client_bytes = 0;
+    // Process CPU time since the clients were created, per client and second
+    // of scenario time.
+    double cpu_ms_per_client_second = 0;
+    // Time from creation until the send bandwidth estimate stayed within the
+    // convergence margin of its last value, for clients that have an
+    // estimate.
+    std::vector<TimeDelta> convergence_times;
+  };
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(CallClientPool);
+  ~CallClientPool();
+  size_t size() const { return clients_.size(); }
+  CallClient* client(size_t index) const { return clients_[index]; }
+  const std::vector<CallClient*>& clients() const { return clients_; }
+
+  Results GetResults() const;
+  // Reports the results through test::PrintResult().
+  void PrintResults(std::string test_name) const;
+
+ private:
+  friend class Scenario;
+  CallClientPool(Clock* clock,
+                 CallClientPoolConfig config,
+                 std::vector<CallClient*> clients,
+                 int64_t memory_per_client_bytes);
+  void SampleEstimates();
+
+  Clock* const clock_;
+  const CallClientPoolConfig config_;
+  const std::vector<CallClient*> clients_;
+  const int64_t memory_per_client_bytes_;
+  const Timestamp start_time_;
+  const int64_t start_cpu_time_ns_;
+  rtc::CriticalSection crit_;
+  std::vector<Timestamp> sample_times_ RTC_GUARDED_BY(crit_);
+  // Send bandwidth estimates per client, one for each sample time.
+  std::vector<std::vector<DataRate>> estimates_ RTC_GUARDED_BY(crit_);
+};
 }  // namespace test
 }  // namespace webrtc
 
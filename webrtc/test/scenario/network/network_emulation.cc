@@ -70,10 +70,13 @@ void EmulatedNetworkNode::HandlePacketReceived(EmulatedIpPacket packet) {
   if (routing_.find(packet.to.ipaddr()) == routing_.end()) {
     return;
   }
-  uint64_t packet_id = next_packet_id_++;
+  // The id is only consumed by accepted packets, so that ids in |packets_|
+  // are consecutive.
+  uint64_t packet_id = next_packet_id_;
   bool sent = network_behavior_->EnqueuePacket(
       PacketInFlightInfo(packet.size(), packet.arrival_time.us(), packet_id));
   if (sent) {
+    ++next_packet_id_;
     packets_.emplace_back(StoredPacket{packet_id, std::move(packet), false});
   }
   if (process_task_.Running())
@@ -105,14 +108,14 @@ void EmulatedNetworkNode::Process(Timestamp at_time) {
   std::vector<PacketDeliveryInfo> delivery_infos =
       network_behavior_->DequeueDeliverablePackets(at_time.us());
   for (PacketDeliveryInfo& delivery_info : delivery_infos) {
-    StoredPacket* packet = nullptr;
-    for (auto& stored_packet : packets_) {
-      if (stored_packet.id == delivery_info.packet_id) {
-        packet = &stored_packet;
-        break;
-      }
-    }
-    RTC_CHECK(packet);
+    // Ids in |packets_| are consecutive, so the packet is found by its offset
+    // from the front instead of by a linear search.
+    RTC_CHECK(!packets_.empty());
+    RTC_CHECK_GE(delivery_info.packet_id, packets_.front().id);
+    const size_t index = delivery_info.packet_id - packets_.front().id;
+    RTC_CHECK_LT(index, packets_.size());
+    StoredPacket* packet = &packets_[index];
+    RTC_DCHECK_EQ(packet->id, delivery_info.packet_id);
     RTC_DCHECK(!packet->removed);
     auto receiver_it = routing_.find(packet->packet.to.ipaddr());
     RTC_CHECK(receiver_it != routing_.end());
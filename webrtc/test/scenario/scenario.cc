@@ -15,6 +15,7 @@
 #include "api/audio_codecs/builtin_audio_decoder_factory.h"
 #include "api/audio_codecs/builtin_audio_encoder_factory.h"
 #include "rtc_base/flags.h"
+#include "rtc_base/memory_usage.h"
 #include "rtc_base/socket_address.h"
 #include "test/logging/file_log_writer.h"
 #include "test/scenario/network/network_emulation.h"
@@ -108,13 +109,58 @@ StatesPrinter* Scenario::CreatePrinter(std::string name,
 CallClient* Scenario::CreateClient(std::string name, CallClientConfig config) {
   CallClient* client =
       new CallClient(time_controller_.get(), GetLogWriterFactory(name), config);
+  AddClient(client, config);
+  return client;
+}
+
+CallClientPool* Scenario::CreateClientPool(std::string name,
+                                           CallClientPoolConfig config) {
+  RTC_CHECK_GT(config.num_clients, 0);
+  RTC_CHECK_GT(config.num_task_queues, 0);
+  const int64_t memory_before_bytes = rtc::GetProcessResidentSizeBytes();
+  std::vector<TaskQueueForTest*> task_queues;
+  for (size_t i = 0; i < config.num_task_queues; ++i) {
+    client_task_queues_.push_back(absl::make_unique<TaskQueueForTest>(
+        time_controller_->GetTaskQueueFactory()->CreateTaskQueue(
+            "CallClientPool", TaskQueueFactory::Priority::NORMAL)));
+    task_queues.push_back(client_task_queues_.back().get());
+  }
+  // The clients keep the shared audio alive.
+  CallClientFakeAudio shared_audio;
+  time_controller_->InvokeWithControlledYield([&] {
+    task_queues[0]->SendTask([&] {
+      shared_audio = InitFakeAudio(time_controller_.get());
+    });
+  });
+
+  std::vector<CallClient*> clients;
+  for (size_t i = 0; i < config.num_clients; ++i) {
+    const std::string client_name =
+        name.empty() ? name : name + "_" + std::to_string(i);
+    CallClient* client = new CallClient(
+        time_controller_.get(), GetLogWriterFactory(client_name),
+        config.client, task_queues[i % task_queues.size()], shared_audio);
+    AddClient(client, config.client);
+    clients.push_back(client);
+  }
+  const int64_t memory_per_client_bytes =
+      (rtc::GetProcessResidentSizeBytes() - memory_before_bytes) /
+      static_cast<int64_t>(config.num_clients);
+
+  CallClientPool* pool = new CallClientPool(clock_, config, std::move(clients),
+                                            memory_per_client_bytes);
+  client_pools_.emplace_back(pool);
+  Every(config.stats_interval, [pool] { pool->SampleEstimates(); });
+  return pool;
+}
+
+void Scenario::AddClient(CallClient* client, const CallClientConfig& config) {
   if (config.transport.state_log_interval.IsFinite()) {
     Every(config.transport.state_log_interval, [this, client]() {
       client->network_controller_factory_.LogCongestionControllerStats(Now());
     });
   }
   clients_.emplace_back(client);
-  return client;
 }
 
 CallClient* Scenario::CreateClient(
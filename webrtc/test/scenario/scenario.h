@@ -18,6 +18,7 @@
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/fake_clock.h"
 #include "rtc_base/task_queue.h"
+#include "rtc_base/task_queue_for_test.h"
 #include "rtc_base/task_utils/repeating_task.h"
 #include "test/logging/log_writer.h"
 #include "test/scenario/audio_stream.h"
@@ -59,6 +60,14 @@ class Scenario {
   CallClient* CreateClient(
       std::string name,
       std::function<void(CallClientConfig*)> config_modifier);
+  // Creates clients for load tests with many participants. Rather than each
+  // owning a task queue and a fake audio device, the clients are spread
+  // round-robin over a few task queues and share one fake audio setup, like
+  // the calls of a PeerConnectionFactory share its audio state. Combined with
+  // simulated time and the fake video codecs, this allows modeling large
+  // rooms on one machine.
+  CallClientPool* CreateClientPool(std::string name,
+                                   CallClientPoolConfig config);
 
   CallClientPair* CreateRoutes(CallClient* first,
                                std::vector<EmulatedNetworkNode*> send_link,
@@ -165,13 +174,17 @@ class Scenario {
 
  private:
   TimeDelta TimeUntilTarget(TimeDelta target_time_offset);
+  void AddClient(CallClient* client, const CallClientConfig& config);
 
   NullReceiver null_receiver_;
   const std::unique_ptr<LogWriterFactoryInterface> log_writer_factory_;
   std::unique_ptr<TimeController> time_controller_;
   Clock* clock_;
 
+  // Shared by the clients of the client pools, so destroyed after them.
+  std::vector<std::unique_ptr<TaskQueueForTest>> client_task_queues_;
   std::vector<std::unique_ptr<CallClient>> clients_;
+  std::vector<std::unique_ptr<CallClientPool>> client_pools_;
   std::vector<std::unique_ptr<CallClientPair>> client_pairs_;
   std::vector<std::unique_ptr<EmulatedNetworkNode>> network_nodes_;
   std::vector<std::unique_ptr<CrossTrafficSource>> cross_traffic_sources_;
@@ -62,6 +62,18 @@ struct CallClientConfig {
   TransportControllerConfig transport;
 };
 
+struct CallClientPoolConfig {
+  size_t num_clients = 2;
+  // Number of task queues the clients are spread over.
+  size_t num_task_queues = 4;
+  CallClientConfig client;
+  // Interval for sampling the send bandwidth estimates of the clients.
+  TimeDelta stats_interval = TimeDelta::ms(100);
+  // An estimate has converged once it stays within this fraction of its last
+  // value.
+  double convergence_margin = 0.1;
+};
+
 struct SimulatedTimeClientConfig {
   TransportControllerConfig transport;
   struct Feedback {
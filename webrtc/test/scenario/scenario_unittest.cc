@@ -55,5 +55,35 @@ TEST(ScenarioTest, StartsAndStopsWithoutErrors) {
   EXPECT_TRUE(packet_received);
   EXPECT_TRUE(bitrate_changed);
 }
+
+TEST(ScenarioTest, ClientPoolConvergesWithSharedTaskQueues) {
+  Scenario s("scenario/client_pool", /*real_time=*/false);
+  CallClientPoolConfig pool_config;
+  pool_config.num_clients = 6;
+  pool_config.num_task_queues = 2;
+  pool_config.client.transport.rates.start_rate = DataRate::kbps(300);
+  pool_config.convergence_margin = 0.3;
+  CallClientPool* pool = s.CreateClientPool("client", pool_config);
+  ASSERT_EQ(pool->size(), 6u);
+
+  NetworkNodeConfig network_config;
+  network_config.simulation.bandwidth = DataRate::kbps(1000);
+  network_config.simulation.delay = TimeDelta::ms(50);
+  for (size_t i = 0; i + 1 < pool->size(); i += 2) {
+    auto* route = s.CreateRoutes(
+        pool->client(i), {s.CreateSimulationNode(network_config)},
+        pool->client(i + 1), {s.CreateSimulationNode(network_config)});
+    s.CreateVideoStream(route->forward(), VideoStreamConfig());
+  }
+  s.RunFor(TimeDelta::seconds(20));
+
+  CallClientPool::Results results = pool->GetResults();
+  pool->PrintResults("client_pool");
+  EXPECT_EQ(results.num_clients, 6u);
+  EXPECT_GT(results.cpu_ms_per_client_second, 0);
+  ASSERT_EQ(results.convergence_times.size(), 6u);
+  for (TimeDelta convergence_time : results.convergence_times)
+    EXPECT_LT(convergence_time, TimeDelta::seconds(15));
+}
 }  // namespace test
 }  // namespace webrtc
@@ -0,0 +1,279 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/testsupport/mapped_frame_reader.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "common_video/include/video_frame_buffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/keep_ref_until_done.h"
+#include "rtc_base/ref_count.h"
+#include "rtc_base/ref_counted_object.h"
+
+#if defined(WEBRTC_WIN)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace webrtc {
+namespace test {
+namespace {
+
+const char kY4mFileSignature[] = "YUV4MPEG2";
+const char kY4mFrameSignature[] = "FRAME";
+
+}  // namespace
+
+// Read-only mapping of a whole file. Shared by the reader and all buffers
+// handed out by it.
+class MappedFile : public rtc::RefCountInterface {
+ public:
+  // Returns nullptr on failure.
+  static rtc::scoped_refptr<MappedFile> Open(const std::string& filename) {
+#if defined(WEBRTC_WIN)
+    HANDLE file =
+        ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                      nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+                      nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+      return nullptr;
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+      ::CloseHandle(file);
+      return nullptr;
+    }
+    HANDLE mapping =
+        ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    ::CloseHandle(file);
+    if (mapping == nullptr)
+      return nullptr;
+    // The view keeps the mapping object alive.
+    void* data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if (data == nullptr)
+      return nullptr;
+    return new rtc::RefCountedObject<MappedFile>(
+        static_cast<const uint8_t*>(data), static_cast<size_t>(size.QuadPart));
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return nullptr;
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+      close(fd);
+      return nullptr;
+    }
+    const size_t size = static_cast<size_t>(file_stat.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file open.
+    close(fd);
+    if (data == MAP_FAILED)
+      return nullptr;
+    return new rtc::RefCountedObject<MappedFile>(
+        static_cast<const uint8_t*>(data), size);
+#endif
+  }
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  // Hints that the whole file is read front to back.
+  void AdviseSequential() const {
+#if !defined(WEBRTC_WIN)
+    madvise(const_cast<uint8_t*>(data_), size_, MADV_SEQUENTIAL);
+#endif
+  }
+
+  // Asks the kernel to start reading [offset, offset + length) in.
+  void AdviseWillNeed(size_t offset, size_t length) const {
+#if !defined(WEBRTC_WIN)
+    if (offset >= size_ || length == 0)
+      return;
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t aligned_offset = offset - offset % page_size;
+    length = std::min(length + offset - aligned_offset, size_ - aligned_offset);
+    madvise(const_cast<uint8_t*>(data_) + aligned_offset, length,
+            MADV_WILLNEED);
+#endif
+  }
+
+ protected:
+  MappedFile(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+  ~MappedFile() override {
+#if defined(WEBRTC_WIN)
+    ::UnmapViewOfFile(data_);
+#else
+    munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+  }
+
+ private:
+  const uint8_t* const data_;
+  const size_t size_;
+};
+
+MappedFrameReader::MappedFrameReader(std::string input_filename,
+                                     int width,
+                                     int height,
+                                     bool loop)
+    : MappedFrameReader(input_filename,
+                        width,
+                        height,
+                        loop,
+                        kDefaultPrefetchFrames) {}
+
+MappedFrameReader::MappedFrameReader(std::string input_filename,
+                                     int width,
+                                     int height,
+                                     bool loop,
+                                     int prefetch_frames)
+    : input_filename_(input_filename),
+      width_(width),
+      height_(height),
+      loop_(loop),
+      prefetch_frames_(prefetch_frames),
+      image_length_in_bytes_(width * height +
+                             2 * ((width + 1) / 2) * ((height + 1) / 2)),
+      frame_length_in_bytes_(image_length_in_bytes_),
+      first_frame_offset_(0),
+      frame_header_length_(0),
+      number_of_frames_(-1),
+      next_frame_index_(0) {
+  RTC_DCHECK_GE(prefetch_frames_, 0);
+}
+
+MappedFrameReader::~MappedFrameReader() {
+  Close();
+}
+
+bool MappedFrameReader::Init() {
+  if (width_ <= 0 || height_ <= 0) {
+    fprintf(stderr, "Frame width and height must be >0, was %d x %d\n", width_,
+            height_);
+    return false;
+  }
+  file_ = MappedFile::Open(input_filename_);
+  if (!file_) {
+    fprintf(stderr, "Couldn't map input file for reading: %s\n",
+            input_filename_.c_str());
+    return false;
+  }
+  const uint8_t* data = file_->data();
+  const size_t size = file_->size();
+
+  const size_t signature_length = strlen(kY4mFileSignature);
+  if (size >= signature_length &&
+      memcmp(data, kY4mFileSignature, signature_length) == 0) {
+    // Y4M: a file header line, then "FRAME" header lines before each image.
+    // All frame headers are assumed to be as long as the first one.
+    const void* file_header_end = memchr(data, '\n', size);
+    if (file_header_end == nullptr) {
+      fprintf(stderr, "Failed to read file header from input file: %s\n",
+              input_filename_.c_str());
+      Close();
+      return false;
+    }
+    first_frame_offset_ =
+        static_cast<const uint8_t*>(file_header_end) - data + 1;
+    const void* frame_header_end =
+        memchr(data + first_frame_offset_, '\n', size - first_frame_offset_);
+    if (frame_header_end == nullptr) {
+      fprintf(stderr, "Failed to read frame header from input file: %s\n",
+              input_filename_.c_str());
+      Close();
+      return false;
+    }
+    frame_header_length_ = static_cast<const uint8_t*>(frame_header_end) -
+                           (data + first_frame_offset_) + 1;
+    frame_length_in_bytes_ = frame_header_length_ + image_length_in_bytes_;
+  }
+
+  number_of_frames_ = static_cast<int>((size - first_frame_offset_) /
+                                       frame_length_in_bytes_);
+  next_frame_index_ = 0;
+  file_->AdviseSequential();
+  Prefetch(0, prefetch_frames_);
+  return true;
+}
+
+rtc::scoped_refptr<I420BufferInterface> MappedFrameReader::ReadFrame() {
+  if (!file_) {
+    fprintf(stderr, "MappedFrameReader is not initialized\n");
+    return nullptr;
+  }
+  if (next_frame_index_ >= number_of_frames_) {
+    if (!loop_ || number_of_frames_ == 0)
+      return nullptr;
+    next_frame_index_ = 0;
+  }
+  const uint8_t* frame =
+      file_->data() + first_frame_offset_ +
+      static_cast<size_t>(next_frame_index_) * frame_length_in_bytes_;
+  if (frame_header_length_ > 0 &&
+      memcmp(frame, kY4mFrameSignature, strlen(kY4mFrameSignature)) != 0) {
+    fprintf(stderr, "Unexpected frame header in input file: %s\n",
+            input_filename_.c_str());
+    return nullptr;
+  }
+  ++next_frame_index_;
+  // Keep |prefetch_frames_| frames in flight by requesting the one that just
+  // entered the read-ahead window. With looping, the window wraps around.
+  if (prefetch_frames_ > 0) {
+    int ahead = next_frame_index_ + prefetch_frames_ - 1;
+    if (loop_)
+      ahead %= number_of_frames_;
+    Prefetch(ahead, 1);
+  }
+
+  const uint8_t* y = frame + frame_header_length_;
+  const int chroma_width = (width_ + 1) / 2;
+  const int chroma_height = (height_ + 1) / 2;
+  const uint8_t* u = y + width_ * height_;
+  const uint8_t* v = u + chroma_width * chroma_height;
+  return WrapI420Buffer(width_, height_, y, width_, u, chroma_width, v,
+                        chroma_width, rtc::KeepRefUntilDone(file_));
+}
+
+void MappedFrameReader::Close() {
+  file_ = nullptr;
+}
+
+size_t MappedFrameReader::FrameLength() const {
+  return frame_length_in_bytes_;
+}
+
+int MappedFrameReader::NumberOfFrames() const {
+  return number_of_frames_;
+}
+
+int MappedFrameReader::NextFrameIndex() const {
+  return next_frame_index_;
+}
+
+void MappedFrameReader::Prefetch(int first_frame, int num_frames) const {
+  if (num_frames <= 0 || first_frame >= number_of_frames_)
+    return;
+  num_frames = std::min(num_frames, number_of_frames_ - first_frame);
+  file_->AdviseWillNeed(
+      first_frame_offset_ +
+          static_cast<size_t>(first_frame) * frame_length_in_bytes_,
+      static_cast<size_t>(num_frames) * frame_length_in_bytes_);
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef TEST_TESTSUPPORT_MAPPED_FRAME_READER_H_
+#define TEST_TESTSUPPORT_MAPPED_FRAME_READER_H_
+
+#include <stddef.h>
+
+#include <string>
+
+#include "api/scoped_refptr.h"
+#include "api/video/video_frame_buffer.h"
+
+namespace webrtc {
+namespace test {
+
+class MappedFile;
+
+// Reads I420 frames from a memory-mapped .yuv or .y4m file. Unlike
+// FrameReader, the returned buffers are zero-copy views into the mapping,
+// which makes it suitable for feeding pipelines from large test corpora at
+// line rate. The file is detected as Y4M if it starts with "YUV4MPEG2".
+//
+// The kernel is told that the file is read sequentially, and the next
+// |prefetch_frames| frames are requested ahead of every read. The mapping
+// stays valid until both the reader and all buffers returned by it are gone.
+class MappedFrameReader {
+ public:
+  static constexpr int kDefaultPrefetchFrames = 4;
+
+  // Parameters:
+  //   input_filename          The file to read from.
+  //   width, height           Size of each frame to read.
+  //   loop                    Restart at the first frame after the last one
+  //                           instead of returning nullptr.
+  MappedFrameReader(std::string input_filename,
+                    int width,
+                    int height,
+                    bool loop);
+  MappedFrameReader(std::string input_filename,
+                    int width,
+                    int height,
+                    bool loop,
+                    int prefetch_frames);
+  ~MappedFrameReader();
+
+  // Maps the input file. Returns false if an error has occurred, in addition
+  // to printing to stderr.
+  bool Init();
+
+  // Returns a view of the next frame, or nullptr at the end of the file when
+  // not looping, or if the reader is not initialized.
+  rtc::scoped_refptr<I420BufferInterface> ReadFrame();
+
+  // Drops the reader's reference to the mapping. Buffers that are still
+  // referenced remain valid.
+  void Close();
+
+  // Frame length in bytes of a single frame image, including the Y4M frame
+  // header if any.
+  size_t FrameLength() const;
+  // Total number of frames in the input file.
+  int NumberOfFrames() const;
+  // Index of the frame returned by the next call to ReadFrame().
+  int NextFrameIndex() const;
+
+ private:
+  // Hints that |num_frames| frames starting at |first_frame| will be read.
+  void Prefetch(int first_frame, int num_frames) const;
+
+  const std::string input_filename_;
+  const int width_;
+  const int height_;
+  const bool loop_;
+  const int prefetch_frames_;
+  // Size of the I420 image, without headers.
+  const size_t image_length_in_bytes_;
+  size_t frame_length_in_bytes_;
+  // Offset of the first frame; non-zero for the Y4M file header.
+  size_t first_frame_offset_;
+  // Offset of the image within a frame; non-zero for the Y4M frame header.
+  size_t frame_header_length_;
+  int number_of_frames_;
+  int next_frame_index_;
+  rtc::scoped_refptr<MappedFile> file_;
+};
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // TEST_TESTSUPPORT_MAPPED_FRAME_READER_H_
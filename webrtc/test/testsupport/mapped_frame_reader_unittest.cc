@@ -0,0 +1,134 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/testsupport/mapped_frame_reader.h"
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "api/scoped_refptr.h"
+#include "api/video/video_frame_buffer.h"
+#include "test/gtest.h"
+#include "test/testsupport/file_utils.h"
+
+namespace webrtc {
+namespace test {
+
+namespace {
+// Two 2x2 I420 frames.
+const std::string kYuvFileContents = "bazoukJUMBLE";
+const std::string kY4mFileContents =
+    "YUV4MPEG2 W2 H2 F30:1 C420\nFRAME\nbazoukFRAME\nJUMBLE";
+
+const int kFrameWidth = 2;
+const int kFrameHeight = 2;
+const size_t kFrameLength = 3 * kFrameWidth * kFrameHeight / 2;  // I420.
+const size_t kY4mFrameHeaderLength = 6;  // "FRAME\n"
+
+void ExpectFrame(const std::string& expected,
+                 const rtc::scoped_refptr<I420BufferInterface>& buffer) {
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(kFrameWidth, buffer->width());
+  EXPECT_EQ(kFrameHeight, buffer->height());
+  // Expect I420 packed as YUV.
+  EXPECT_EQ(expected[0], buffer->DataY()[0]);
+  EXPECT_EQ(expected[1], buffer->DataY()[1]);
+  EXPECT_EQ(expected[2], buffer->DataY()[kFrameWidth]);
+  EXPECT_EQ(expected[3], buffer->DataY()[kFrameWidth + 1]);
+  EXPECT_EQ(expected[4], buffer->DataU()[0]);
+  EXPECT_EQ(expected[5], buffer->DataV()[0]);
+}
+}  // namespace
+
+class MappedFrameReaderTest : public testing::Test {
+ protected:
+  MappedFrameReaderTest() = default;
+  ~MappedFrameReaderTest() override = default;
+
+  void TearDown() override { remove(temp_filename_.c_str()); }
+
+  void WriteFile(const std::string& contents) {
+    temp_filename_ = webrtc::test::TempFilename(webrtc::test::OutputPath(),
+                                                "mapped_frame_reader_unittest");
+    FILE* dummy = fopen(temp_filename_.c_str(), "wb");
+    fwrite(contents.data(), 1, contents.size(), dummy);
+    fclose(dummy);
+  }
+
+  std::string temp_filename_;
+};
+
+TEST_F(MappedFrameReaderTest, ReadsYuvFrames) {
+  WriteFile(kYuvFileContents);
+  MappedFrameReader frame_reader(temp_filename_, kFrameWidth, kFrameHeight,
+                                 /*loop=*/false);
+  ASSERT_TRUE(frame_reader.Init());
+  EXPECT_EQ(kFrameLength, frame_reader.FrameLength());
+  EXPECT_EQ(2, frame_reader.NumberOfFrames());
+
+  ExpectFrame("bazouk", frame_reader.ReadFrame());
+  ExpectFrame("JUMBLE", frame_reader.ReadFrame());
+  EXPECT_FALSE(frame_reader.ReadFrame());  // End of file.
+}
+
+TEST_F(MappedFrameReaderTest, ReadsY4mFrames) {
+  WriteFile(kY4mFileContents);
+  MappedFrameReader frame_reader(temp_filename_, kFrameWidth, kFrameHeight,
+                                 /*loop=*/false);
+  ASSERT_TRUE(frame_reader.Init());
+  EXPECT_EQ(kY4mFrameHeaderLength + kFrameLength, frame_reader.FrameLength());
+  EXPECT_EQ(2, frame_reader.NumberOfFrames());
+
+  ExpectFrame("bazouk", frame_reader.ReadFrame());
+  ExpectFrame("JUMBLE", frame_reader.ReadFrame());
+  EXPECT_FALSE(frame_reader.ReadFrame());  // End of file.
+}
+
+TEST_F(MappedFrameReaderTest, LoopsToFirstFrame) {
+  WriteFile(kYuvFileContents);
+  MappedFrameReader frame_reader(temp_filename_, kFrameWidth, kFrameHeight,
+                                 /*loop=*/true, /*prefetch_frames=*/1);
+  ASSERT_TRUE(frame_reader.Init());
+
+  ExpectFrame("bazouk", frame_reader.ReadFrame());
+  ExpectFrame("JUMBLE", frame_reader.ReadFrame());
+  EXPECT_EQ(2, frame_reader.NextFrameIndex());
+  ExpectFrame("bazouk", frame_reader.ReadFrame());
+  EXPECT_EQ(1, frame_reader.NextFrameIndex());
+}
+
+TEST_F(MappedFrameReaderTest, BuffersOutliveReader) {
+  WriteFile(kYuvFileContents);
+  auto frame_reader = absl::make_unique<MappedFrameReader>(
+      temp_filename_, kFrameWidth, kFrameHeight, /*loop=*/false);
+  ASSERT_TRUE(frame_reader->Init());
+  rtc::scoped_refptr<I420BufferInterface> buffer = frame_reader->ReadFrame();
+  frame_reader.reset();
+  ExpectFrame("bazouk", buffer);
+}
+
+TEST_F(MappedFrameReaderTest, ReadFrameUninitialized) {
+  WriteFile(kYuvFileContents);
+  MappedFrameReader frame_reader(temp_filename_, kFrameWidth, kFrameHeight,
+                                 /*loop=*/false);
+  EXPECT_FALSE(frame_reader.ReadFrame());
+}
+
+TEST_F(MappedFrameReaderTest, InitFailsForMissingFile) {
+  MappedFrameReader frame_reader("non_existent_file.yuv", kFrameWidth,
+                                 kFrameHeight, /*loop=*/false);
+  EXPECT_FALSE(frame_reader.Init());
+}
+
+}  // namespace test
+}  // namespace webrtc